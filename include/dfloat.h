@@ -191,6 +191,47 @@ namespace xu
       typename std::enable_if_t<std::is_floating_point<T>::value, bool> = true>
     explicit operator T() const;
 
+    /**
+      @brief  Construct dfloat equal to `coef * 10^exp`, with the given sign
+      @note   Truncates to 18 significant digits
+      @note   Overflow results in NaN, underflow results in denormal or zero
+      */
+    static dfloat from_scaled(Sign sign_, mant2_t coef, pow2_t exp);
+
+    /**
+      @brief  Construct dfloat equal to `coef * 10^exp`
+      */
+    static dfloat from_scaled(int64_t coef, pow2_t exp);
+
+    /**
+      @brief  Convert to the integer `coef` such that `coef * 10^exp` is the
+              value truncated to a multiple of 10^exp
+      @return false if nan or if `coef` would not fit in `int64_t`
+      */
+    bool to_scaled(int64_t& coef, pow2_t exp) const;
+
+    /**
+      @brief  Convert to the integer `coef` and exponent `exp` such that
+              `coef * 10^exp` is exactly the value, with no trailing zeros in
+              `coef` (zero is 0 * 10^0)
+      @return false if nan
+      */
+    bool to_decimal(int64_t& coef, pow2_t& exp) const;
+
+    /**
+      @brief  Convert to an unsigned integer key which sorts like the value:
+              `a < b` exactly when `a.to_key() < b.to_key()`, and equal
+              values have equal keys
+      @note   NaN has a key larger than every number; no key is 0
+      @note   Lets min/max, sorting and hashing work on plain integers
+      */
+    mant2_t to_key() const;
+
+    /**
+      @brief  Convert back a key made by `to_key`
+      */
+    static dfloat from_key(mant2_t key);
+
     //  ====================
     //  Comparison Operators
     //  ====================
@@ -348,67 +389,114 @@ namespace xu
     //  ==============
     
     static bool isfinite(const dfloat& d);
-    
+
+    /**
+      @brief  Fused multiply-add
+              Computes `a * b + c` with a single truncation at the end
+      @note   The product is kept exact in `mant2_t` before the addition, so
+              the result may differ from `a * b + c` in the last digit
+      */
+    static dfloat fma(const dfloat& a, const dfloat& b, const dfloat& c);
+
+  protected:
+    /**
+      @brief  Construct dfloat equal to `coef * 10^exp`
+      @note   Truncates to 18 significant digits
+      @note   Overflow results in NaN, underflow results in denormal or zero
+      */
+    static dfloat _normalize(Sign sign_, mant2_t coef, pow2_t exp);
+
+    /**
+      @brief  Returns 10^n for n in [0, 38], the powers of ten that fit in
+              `mant2_t`
+      */
+    static mant2_t _pow10(pow2_t n);
+
+    /**
+      @brief  Returns the number of decimal digits in a nonzero `mant2_t`
+      */
+    static pow2_t _digits(mant2_t x);
+
   } __attribute__((packed));
 
   /**
     @brief  operator+ free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   dfloat operator+(T x, const dfloat& d);
 
   /**
     @brief  operator- free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   dfloat operator-(T x, const dfloat& d);
 
   /**
     @brief  operator* free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   dfloat operator*(T x, const dfloat& d);
 
   /**
     @brief  operator/ free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   dfloat operator/(T x, const dfloat& d);
 
   /**
     @brief  operator== free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   bool operator==(T x, const dfloat& d);
 
   /**
     @brief  operator!= free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   bool operator!=(T x, const dfloat& d);
 
   /**
     @brief  operator> free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   bool operator>(T x, const dfloat& d);
 
   /**
     @brief  operator< free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   bool operator<(T x, const dfloat& d);
 
   /**
     @brief  operator>= free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   bool operator>=(T x, const dfloat& d);
 
   /**
     @brief  operator<= free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
   bool operator<=(T x, const dfloat& d);
 }
 
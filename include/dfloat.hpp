@@ -41,7 +41,7 @@ namespace xu
     typename T,
     typename std::enable_if_t<
       std::is_integral<T>::value && std::is_unsigned<T>::value,
-      bool> = true>
+      bool>>
   inline
   dfloat::dfloat(T value)
   {
@@ -75,7 +75,7 @@ namespace xu
     typename T,
     typename std::enable_if_t<
       std::is_integral<T>::value && std::is_signed<T>::value,
-      bool> = true>
+      bool>>
   inline
   dfloat::dfloat(T value)
     : dfloat(typename std::make_unsigned<T>::type(value >= 0 ? value : -value))
@@ -88,7 +88,7 @@ namespace xu
 
   template <
     typename T,
-    typename std::enable_if_t<std::is_floating_point<T>::value, bool> = true>
+    typename std::enable_if_t<std::is_floating_point<T>::value, bool>>
   inline
   dfloat::dfloat(T value)
   {
@@ -155,7 +155,7 @@ namespace xu
     typename T,
     typename std::enable_if_t<
       std::is_integral<T>::value && std::is_unsigned<T>::value,
-      bool> = true>
+      bool>>
   inline
   dfloat::operator T() const
   {
@@ -256,7 +256,7 @@ namespace xu
     typename T,
     typename std::enable_if_t<
       std::is_integral<T>::value && std::is_signed<T>::value,
-      bool> = true>
+      bool>>
   inline
   dfloat::operator T() const
   {
@@ -269,7 +269,7 @@ namespace xu
 
   template <
     typename T,
-    typename std::enable_if_t<std::is_floating_point<T>::value, bool> = true>
+    typename std::enable_if_t<std::is_floating_point<T>::value, bool>>
   inline
   dfloat::operator T() const
   {
@@ -313,6 +313,196 @@ namespace xu
     }
   }
 
+  inline
+  dfloat dfloat::from_scaled(Sign sign_, mant2_t coef, pow2_t exp)
+  {
+    if (sign_ == Sign::_NAN_)
+    {
+      return dfloat(Sign::_NAN_, 0, 0);
+    }
+
+    if (sign_ == Sign::ZERO)
+    {
+      return dfloat(Sign::ZERO, 0, 0);
+    }
+
+    return _normalize(sign_, coef, exp);
+  }
+
+  inline
+  dfloat dfloat::from_scaled(int64_t coef, pow2_t exp)
+  {
+    /* negate in the unsigned domain so that the minimum value does not overflow */
+    if (coef < 0)
+    {
+      return _normalize(Sign::NEG, (mant2_t)(0 - (uint64_t)coef), exp);
+    }
+    else
+    {
+      return _normalize(Sign::POS, (mant2_t)coef, exp);
+    }
+  }
+
+  inline
+  bool dfloat::to_scaled(int64_t& coef, pow2_t exp) const
+  {
+    if (sign == Sign::_NAN_)
+    {
+      return false;
+    }
+
+    if (sign == Sign::ZERO)
+    {
+      coef = 0;
+      return true;
+    }
+
+    /* value is `mant * 10^(pow - SCALE_POW)` */
+    pow2_t shift = (pow2_t)pow - SCALE_POW - exp;
+
+    mant2_t new_mant;
+
+    if (shift >= 0)
+    {
+      /* mant has at least one digit, so anything more would not fit */
+      if (shift > 19)
+      {
+        return false;
+      }
+
+      new_mant = (mant2_t)mant * _pow10(shift);
+    }
+    else
+    {
+      if (shift < -19)
+      {
+        coef = 0;
+        return true;
+      }
+
+      new_mant = mant / _pow10(-shift);
+    }
+
+    /* the magnitude of the minimum value is one more than the maximum */
+    constexpr mant2_t INT64_CAP = (mant2_t)std::numeric_limits<int64_t>::max() + 1;
+
+    if (sign == Sign::NEG)
+    {
+      if (new_mant > INT64_CAP)
+      {
+        return false;
+      }
+
+      coef = (int64_t)(0 - (uint64_t)new_mant);
+    }
+    else
+    {
+      if (new_mant >= INT64_CAP)
+      {
+        return false;
+      }
+
+      coef = (int64_t)new_mant;
+    }
+
+    return true;
+  }
+
+  inline
+  bool dfloat::to_decimal(int64_t& coef, pow2_t& exp) const
+  {
+    if (sign == Sign::_NAN_)
+    {
+      return false;
+    }
+
+    if (sign == Sign::ZERO)
+    {
+      coef = 0;
+      exp = 0;
+      return true;
+    }
+
+    mant_t m = mant;
+    pow2_t e = (pow2_t)pow - SCALE_POW;
+
+    /* mant is nonzero, so at most SCALE_POW trailing zeros */
+    if (m % 100000000 == 0)
+    {
+      m /= 100000000;
+      e += 8;
+    }
+    if (m % 10000 == 0)
+    {
+      m /= 10000;
+      e += 4;
+    }
+    while (m % BASE == 0)
+    {
+      m /= BASE;
+      e += 1;
+    }
+
+    coef = sign == Sign::NEG ? -(int64_t)m : (int64_t)m;
+    exp = e;
+
+    return true;
+  }
+
+  /*
+    Key layout, from the most significant bits:
+      bits 120-127  class: 1 negative, 2 zero, 3 positive, 4 nan
+      bits 64-71    pow - MIN_POW
+      bits 0-63     mant
+    Normalized numbers sort by (pow, mant), so negative numbers store the
+    complement of both
+  */
+  inline
+  dfloat::mant2_t dfloat::to_key() const
+  {
+    constexpr int CLASS_SHIFT = 120;
+    constexpr mant2_t LOW_MASK = ((mant2_t)1 << CLASS_SHIFT) - 1;
+
+    switch (sign)
+    {
+      case Sign::NEG:
+      {
+        mant2_t low = ((mant2_t)(uint8_t)(pow - MIN_POW) << 64) | mant;
+        return ((mant2_t)1 << CLASS_SHIFT) | (~low & LOW_MASK);
+      }
+      case Sign::ZERO:
+        return (mant2_t)2 << CLASS_SHIFT;
+      case Sign::POS:
+        return ((mant2_t)3 << CLASS_SHIFT) | ((mant2_t)(uint8_t)(pow - MIN_POW) << 64) | mant;
+      case Sign::_NAN_:
+      default:
+        return (mant2_t)4 << CLASS_SHIFT;
+    }
+  }
+
+  inline
+  dfloat dfloat::from_key(mant2_t key)
+  {
+    constexpr int CLASS_SHIFT = 120;
+    constexpr mant2_t LOW_MASK = ((mant2_t)1 << CLASS_SHIFT) - 1;
+
+    unsigned cls = (unsigned)(key >> CLASS_SHIFT);
+    mant2_t low = key & LOW_MASK;
+
+    switch (cls)
+    {
+      case 1:
+        low = ~low & LOW_MASK;
+        return dfloat(Sign::NEG, (mant_t)low, (pow_t)((int)(uint8_t)(low >> 64) + MIN_POW));
+      case 2:
+        return dfloat(Sign::ZERO, 0, 0);
+      case 3:
+        return dfloat(Sign::POS, (mant_t)low, (pow_t)((int)(uint8_t)(low >> 64) + MIN_POW));
+      default:
+        return dfloat(Sign::_NAN_, 0, 0);
+    }
+  }
+
   inline
   bool dfloat::operator==(const dfloat& other) const
   {
@@ -1312,8 +1502,11 @@ dfloat_parse_frac2:
     }
 
 dfloat_parse_e1:
-    /* Make sure mant is between SCALE and SCALE*BASE before proceeding */
-    while (mant < SCALE)
+    /*
+      Make sure mant is between SCALE and SCALE*BASE before proceeding; zero
+      mant (e.g. "0.0e5") is left for dfloat_parse_done
+    */
+    while (mant != 0 and mant < SCALE)
     {
       if (pow <= MIN_POW)
       {
@@ -1465,6 +1658,12 @@ dfloat_parse_fail:
     return dfloat(Sign::_NAN_, 0, 0);
 
 dfloat_parse_done:
+    /* only zeros, e.g. "0.00" */
+    if (mant == 0)
+    {
+      goto dfloat_parse_zero;
+    }
+
     /* Make sure mant is between SCALE and SCALE*BASE before proceeding */
     while (mant < SCALE)
     {
@@ -1661,35 +1860,232 @@ dfloat_parse_done:
     return d.sign != Sign::_NAN_;
   }
 
-  template <typename T>
+  inline
+  dfloat dfloat::fma(const dfloat& a, const dfloat& b, const dfloat& c)
+  {
+    /* edge case: any is NaN */
+    if (a.sign == Sign::_NAN_ or b.sign == Sign::_NAN_ or c.sign == Sign::_NAN_)
+    {
+      return dfloat(Sign::_NAN_, 0, 0);
+    }
+
+    /* edge case: product is zero */
+    if (a.sign == Sign::ZERO or b.sign == Sign::ZERO)
+    {
+      return c;
+    }
+
+    /* exact product: at most 36 digits, so it always fits in `mant2_t` */
+    Sign p_sign = (a.sign == b.sign) ? Sign::POS : Sign::NEG;
+    mant2_t p_mant = (mant2_t)a.mant * (mant2_t)b.mant;
+    pow2_t p_exp = (pow2_t)a.pow + (pow2_t)b.pow - 2 * SCALE_POW;
+
+    /* edge case: addend is zero */
+    if (c.sign == Sign::ZERO)
+    {
+      return _normalize(p_sign, p_mant, p_exp);
+    }
+
+    mant2_t c_mant = c.mant;
+    pow2_t c_exp = (pow2_t)c.pow - SCALE_POW;
+
+    /*
+      Widen both operands to exactly 38 digits. Neither operand has more than
+      36 significant digits, so the two lowest digits are always zero, which
+      keeps the alignment below exact whenever the exponents are within two of
+      each other (the only case where the subtraction can cancel digits)
+    */
+    constexpr pow2_t WIDE_DIGITS = 38;
+
+    pow2_t p_shift = WIDE_DIGITS - _digits(p_mant);
+    p_mant *= _pow10(p_shift);
+    p_exp -= p_shift;
+
+    pow2_t c_shift = WIDE_DIGITS - _digits(c_mant);
+    c_mant *= _pow10(c_shift);
+    c_exp -= c_shift;
+
+    /* l will hold the larger magnitude operand */
+    Sign l_sign, s_sign;
+    mant2_t l_mant, s_mant;
+    pow2_t l_exp, s_exp;
+
+    if (p_exp > c_exp or (p_exp == c_exp and p_mant >= c_mant))
+    {
+      l_sign = p_sign; l_mant = p_mant; l_exp = p_exp;
+      s_sign = c.sign; s_mant = c_mant; s_exp = c_exp;
+    }
+    else
+    {
+      l_sign = c.sign; l_mant = c_mant; l_exp = c_exp;
+      s_sign = p_sign; s_mant = p_mant; s_exp = p_exp;
+    }
+
+    /*
+      Align the smaller operand, remembering whether any nonzero digits were
+      dropped so that the subtraction still truncates towards zero
+    */
+    pow2_t shift = l_exp - s_exp;
+    bool sticky = false;
+
+    if (shift > WIDE_DIGITS)
+    {
+      sticky = true;
+      s_mant = 0;
+    }
+    else if (shift > 0)
+    {
+      mant2_t divisor = _pow10(shift);
+      sticky = (s_mant % divisor) != 0;
+      s_mant /= divisor;
+    }
+
+    if (l_sign == s_sign)
+    {
+      /* at most 2 * 10^38, which still fits */
+      return _normalize(l_sign, l_mant + s_mant, l_exp);
+    }
+    else
+    {
+      mant2_t diff = l_mant - s_mant - (sticky ? 1 : 0);
+
+      if (diff == 0 and not sticky)
+      {
+        return dfloat(Sign::ZERO, 0, 0);
+      }
+
+      return _normalize(l_sign, diff, l_exp);
+    }
+  }
+
+  inline
+  dfloat dfloat::_normalize(Sign sign_, mant2_t coef, pow2_t exp)
+  {
+    if (coef == 0)
+    {
+      return dfloat(Sign::ZERO, 0, 0);
+    }
+
+    pow2_t digits = _digits(coef);
+
+    /* power of the leading digit */
+    pow2_t new_pow = exp + digits - 1;
+
+    /* scale the coefficient to exactly SCALE_POW + 1 digits */
+    if (digits > SCALE_POW + 1)
+    {
+      coef /= _pow10(digits - SCALE_POW - 1);
+    }
+    else if (digits < SCALE_POW + 1)
+    {
+      coef *= _pow10(SCALE_POW + 1 - digits);
+    }
+
+    /* overflow results in nan */
+    if (new_pow > MAX_POW)
+    {
+      return dfloat(Sign::_NAN_, 0, 0);
+    }
+
+    /* underflow results in denormal or zero */
+    if (new_pow < MIN_POW)
+    {
+      pow2_t shift = MIN_POW - new_pow;
+
+      if (shift > SCALE_POW)
+      {
+        return dfloat(Sign::ZERO, 0, 0);
+      }
+
+      coef /= _pow10(shift);
+      new_pow = MIN_POW;
+
+      if (coef == 0)
+      {
+        return dfloat(Sign::ZERO, 0, 0);
+      }
+    }
+
+    return dfloat(sign_, (mant_t)coef, (pow_t)new_pow);
+  }
+
+  inline
+  dfloat::mant2_t dfloat::_pow10(pow2_t n)
+  {
+    struct table_t
+    {
+      mant2_t values[39];
+
+      constexpr table_t()
+        : values()
+      {
+        mant2_t p = 1;
+        for (size_t i = 0; i < 39; i++)
+        {
+          values[i] = p;
+          p *= BASE;
+        }
+      }
+    };
+
+    static constexpr table_t table;
+
+    return table.values[n];
+  }
+
+  inline
+  dfloat::pow2_t dfloat::_digits(mant2_t x)
+  {
+    uint64_t hi = (uint64_t)(x >> 64);
+    uint64_t lo = (uint64_t)x;
+
+    pow2_t bits = hi != 0 ? 128 - __builtin_clzll(hi) : 64 - __builtin_clzll(lo);
+
+    /* 1233 / 4096 approximates log10(2) from below */
+    pow2_t t = (bits * 1233) >> 12;
+
+    return t + (x >= _pow10(t) ? 1 : 0);
+  }
+
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   dfloat operator+(T x, const dfloat& d)
   {
     return dfloat(x) + d;
   }
 
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   dfloat operator-(T x, const dfloat& d)
   {
     return dfloat(x) - d;
   }
 
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   dfloat operator*(T x, const dfloat& d)
   {
     return dfloat(x) * d;
   }
 
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   dfloat operator/(T x, const dfloat& d)
   {
     return dfloat(x) / d;
   }
 
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   bool operator==(T x, const dfloat& d)
   {
@@ -1699,7 +2095,9 @@ dfloat_parse_done:
   /**
     @brief  operator!= free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   bool operator!=(T x, const dfloat& d)
   {
@@ -1709,7 +2107,9 @@ dfloat_parse_done:
   /**
     @brief  operator> free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   bool operator>(T x, const dfloat& d)
   {
@@ -1719,7 +2119,9 @@ dfloat_parse_done:
   /**
     @brief  operator< free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   bool operator<(T x, const dfloat& d)
   {
@@ -1729,7 +2131,9 @@ dfloat_parse_done:
   /**
     @brief  operator>= free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   bool operator>=(T x, const dfloat& d)
   {
@@ -1739,7 +2143,9 @@ dfloat_parse_done:
   /**
     @brief  operator<= free function with dfloat as right operand
     */
-  template <typename T>
+  template <
+    typename T,
+    typename std::enable_if_t<std::is_arithmetic<T>::value, bool>>
   inline
   bool operator<=(T x, const dfloat& d)
   {
@@ -0,0 +1,84 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  Day-count convention: how the time between two dates is turned
+            into a fraction of a year
+    */
+  enum class day_count : uint8_t
+  {
+    ACT_360,      // actual days / 360
+    ACT_365,      // actual days / 365 (fixed)
+    THIRTY_360,   // 30/360 bond basis: months of 30 days, a 31st is the 30th
+    ACT_ACT       // ACT/ACT ISDA: days in leap years / 366 + other days / 365
+  };
+
+  /**
+    @brief  Days since 1970-01-01 of a proleptic Gregorian date
+    @note   `month` is 1 to 12, `day` is 1 to 31; not validated
+    */
+  int32_t days_from_civil(int32_t year, uint32_t month, uint32_t day);
+
+  /**
+    @brief  Date of a number of days since 1970-01-01
+    */
+  void civil_from_days(int32_t days, int32_t& year, uint32_t& month, uint32_t& day);
+
+  /**
+    @brief  Fraction of a year from `start` to `end` (days since 1970-01-01)
+            as `num / den`, exactly
+    @return false if `end` is before `start`
+    */
+  bool year_fraction(int32_t start, int32_t end, day_count convention, int64_t& num, int64_t& den);
+
+  /**
+    @brief  `notional * rate * year_fraction(start, end)`
+    @note   The product is formed exactly from the decimal coefficients
+            and divided by the denominator of the fraction with enough
+            digits that the result is truncated once, as a single
+            `dfloat::from_scaled`
+    @note   If either operand is NaN, `end` is before `start`, or the
+            result is out of range, result is NaN.
+    */
+  dfloat accrued_interest(const dfloat& notional, const dfloat& rate, int32_t start, int32_t end,
+    day_count convention);
+
+  /**
+    @brief  `out[i] = accrued_interest(notionals[i], rates[i], starts[i],
+            ends[i], convention)` for `count` positions
+    @note   Positions are split into contiguous ranges across `threads`
+            threads. The convention is resolved once per call, not per
+            position
+    */
+  void accrue(const int32_t* starts, const int32_t* ends, const dfloat* notionals, const dfloat* rates,
+    size_t count, day_count convention, dfloat* out, size_t threads);
+}
@@ -0,0 +1,331 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include "dfloat.hpp"
+#include "dfloat_accumulator.hpp"
+#include "dfloat_column.hpp"
+#include "dfloat_accrual.h"
+
+namespace xu
+{
+  /* 400-year eras, after Howard Hinnant's chrono-compatible date algorithms */
+  inline
+  int32_t days_from_civil(int32_t year, uint32_t month, uint32_t day)
+  {
+    year -= month <= 2;
+
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t yoe = (uint32_t)(year - era * 400);
+    uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + (int32_t)doe - 719468;
+  }
+
+  inline
+  void civil_from_days(int32_t days, int32_t& year, uint32_t& month, uint32_t& day)
+  {
+    days += 719468;
+
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    uint32_t doe = (uint32_t)(days - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = (int32_t)yoe + era * 400 + (month <= 2);
+  }
+
+  /* the year of `civil_from_days`, without the month and day */
+  inline
+  int32_t _year_of(int32_t days)
+  {
+    days += 719468;
+
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    uint32_t doe = (uint32_t)(days - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+
+    /* the year of the algorithm starts on March 1st; January is day 306 */
+    return (int32_t)yoe + era * 400 + (doy >= 306);
+  }
+
+  inline
+  bool _leap_year(int32_t year)
+  {
+    return year % 4 == 0 and (year % 100 != 0 or year % 400 == 0);
+  }
+
+  /* denominator of the year fraction; over 365 * 366 for ACT/ACT, a day of a common year counts 366 and a day of a leap year 365 */
+  constexpr int64_t _year_length(day_count convention)
+  {
+    return convention == day_count::ACT_365 ? 365 : convention == day_count::ACT_ACT ? 365 * 366 : 360;
+  }
+
+  /* numerator of the year fraction over `_year_length(C)`, for `start <= end` */
+  template <day_count C>
+  inline
+  int64_t _year_fraction(int32_t start, int32_t end)
+  {
+    switch (C)
+    {
+      case day_count::ACT_360:
+      case day_count::ACT_365:
+      {
+        return end - start;
+      }
+      case day_count::THIRTY_360:
+      {
+        int32_t y1, y2;
+        uint32_t m1, m2, d1, d2;
+
+        civil_from_days(start, y1, m1, d1);
+        civil_from_days(end, y2, m2, d2);
+
+        if (d1 == 31)
+        {
+          d1 = 30;
+        }
+        if (d2 == 31 and d1 == 30)
+        {
+          d2 = 30;
+        }
+
+        return (int64_t)360 * (y2 - y1) + (int64_t)30 * ((int32_t)m2 - (int32_t)m1) + ((int32_t)d2 - (int32_t)d1);
+      }
+      case day_count::ACT_ACT:
+      default:
+      {
+        constexpr int64_t YEAR = _year_length(day_count::ACT_ACT);
+
+        int32_t y1 = _year_of(start);
+        int64_t w1 = _leap_year(y1) ? 365 : 366;
+
+        /* most periods end in the year they start */
+        int32_t first = days_from_civil(y1 + 1, 1, 1);
+
+        if (end < first)
+        {
+          return (int64_t)(end - start) * w1;
+        }
+
+        int32_t y2 = _year_of(end);
+        int64_t w2 = _leap_year(y2) ? 365 : 366;
+
+        int32_t last = days_from_civil(y2, 1, 1);
+
+        return (int64_t)(first - start) * w1 + (int64_t)(y2 - y1 - 1) * YEAR + (int64_t)(end - last) * w2;
+      }
+    }
+  }
+
+  inline
+  bool year_fraction(int32_t start, int32_t end, day_count convention, int64_t& num, int64_t& den)
+  {
+    if (end < start)
+    {
+      return false;
+    }
+
+    switch (convention)
+    {
+      case day_count::ACT_360:
+        num = _year_fraction<day_count::ACT_360>(start, end);
+        break;
+      case day_count::ACT_365:
+        num = _year_fraction<day_count::ACT_365>(start, end);
+        break;
+      case day_count::THIRTY_360:
+        num = _year_fraction<day_count::THIRTY_360>(start, end);
+        break;
+      case day_count::ACT_ACT:
+      default:
+        num = _year_fraction<day_count::ACT_ACT>(start, end);
+        break;
+    }
+
+    den = _year_length(convention);
+
+    return true;
+  }
+
+  /*
+    `notional * rate * num / DEN`, truncated once, for a nonnegative `num`
+    DEN is a constant of the convention, below 2^18, so that its divisions
+    become multiplications
+  */
+  template <uint64_t DEN>
+  inline
+  dfloat _accrue(const dfloat& notional, const dfloat& rate, int64_t num)
+  {
+    using uwide_t = dfloat_accumulator::uwide_t;
+    using Sign = dfloat::Sign;
+
+    int64_t n_coef, r_coef;
+    dfloat::pow2_t n_exp, r_exp;
+
+    if (not notional.to_decimal(n_coef, n_exp) or not rate.to_decimal(r_coef, r_exp))
+    {
+      return dfloat::from_scaled(Sign::_NAN_, 0, 0);
+    }
+
+    if (n_coef == 0 or r_coef == 0 or num == 0)
+    {
+      return dfloat(0);
+    }
+
+    bool neg = (n_coef < 0) != (r_coef < 0);
+
+    /* coefficients have at most 18 digits, so the product fits */
+    uwide_t mag = (uwide_t)(uint64_t)(n_coef < 0 ? -n_coef : n_coef) * (uint64_t)(r_coef < 0 ? -r_coef : r_coef);
+
+    /* quotient and remainder of `mag * num / den` */
+    uwide_t base;
+    uint64_t rem;
+    uint64_t product;
+
+    if ((mag >> 64) == 0 and not __builtin_mul_overflow((uint64_t)mag, (uint64_t)num, &product))
+    {
+      base = product / DEN;
+      rem = product % DEN;
+    }
+    else
+    {
+      /* (q * den + r) * num / den = q * num + r * num / den */
+      uwide_t q = mag / DEN;
+      uwide_t r = (mag % DEN) * (uint64_t)num;
+
+      if (__builtin_mul_overflow(q, (uwide_t)num, &base))
+      {
+        return dfloat::from_scaled(Sign::_NAN_, 0, 0);
+      }
+
+      base += r / DEN;
+      rem = (uint64_t)(r % DEN);
+    }
+
+    int32_t exp = n_exp + r_exp;
+
+    /* long division continues until 18 digits are known, so that truncating them is the only rounding */
+    constexpr uint64_t DIGITS_18 = 100000000000000000ull;
+
+    while (base < DIGITS_18 and rem != 0)
+    {
+      /* 1233 / 4096 approximates log10(2) from below */
+      int digits = 0;
+      if (base != 0)
+      {
+        int bits = 64 - __builtin_clzll((uint64_t)base);
+        digits = (bits * 1233) >> 12;
+        digits += (uint64_t)base >= dfloat_accumulator::pow10(digits) ? 1 : 0;
+      }
+
+      /* the remainder is below 2^18, so 13 digits at a time stay in 64 bits */
+      int step = 18 - digits < 13 ? 18 - digits : 13;
+
+      uint64_t scale = (uint64_t)dfloat_accumulator::pow10(step);
+      uint64_t t = rem * scale;
+
+      base = base * scale + t / DEN;
+      rem = t % DEN;
+      exp -= step;
+    }
+
+    return dfloat::from_scaled(neg ? Sign::NEG : Sign::POS, (dfloat::mant2_t)base, (dfloat::pow2_t)exp);
+  }
+
+  inline
+  dfloat accrued_interest(const dfloat& notional, const dfloat& rate, int32_t start, int32_t end,
+    day_count convention)
+  {
+    int64_t num, den;
+
+    if (not year_fraction(start, end, convention, num, den))
+    {
+      return dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+    }
+
+    switch (convention)
+    {
+      case day_count::ACT_365:
+        return _accrue<_year_length(day_count::ACT_365)>(notional, rate, num);
+      case day_count::ACT_ACT:
+        return _accrue<_year_length(day_count::ACT_ACT)>(notional, rate, num);
+      case day_count::ACT_360:
+      case day_count::THIRTY_360:
+      default:
+        return _accrue<_year_length(day_count::ACT_360)>(notional, rate, num);
+    }
+  }
+
+  template <day_count C>
+  inline
+  void _accrue_range(const int32_t* starts, const int32_t* ends, const dfloat* notionals, const dfloat* rates,
+    size_t begin, size_t end, dfloat* out)
+  {
+    const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+    for (size_t i = begin; i < end; i++)
+    {
+      if (ends[i] < starts[i])
+      {
+        out[i] = NaN;
+        continue;
+      }
+
+      out[i] = _accrue<_year_length(C)>(notionals[i], rates[i], _year_fraction<C>(starts[i], ends[i]));
+    }
+  }
+
+  inline
+  void accrue(const int32_t* starts, const int32_t* ends, const dfloat* notionals, const dfloat* rates,
+    size_t count, day_count convention, dfloat* out, size_t threads)
+  {
+    parallel_blocks(count, threads, dfloat_column::BLOCK_SIZE,
+      [&](size_t begin, size_t end)
+      {
+        switch (convention)
+        {
+          case day_count::ACT_360:
+            _accrue_range<day_count::ACT_360>(starts, ends, notionals, rates, begin, end, out);
+            break;
+          case day_count::ACT_365:
+            _accrue_range<day_count::ACT_365>(starts, ends, notionals, rates, begin, end, out);
+            break;
+          case day_count::THIRTY_360:
+            _accrue_range<day_count::THIRTY_360>(starts, ends, notionals, rates, begin, end, out);
+            break;
+          case day_count::ACT_ACT:
+          default:
+            _accrue_range<day_count::ACT_ACT>(starts, ends, notionals, rates, begin, end, out);
+            break;
+        }
+      });
+  }
+}
@@ -0,0 +1,130 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  Exact running sum of dfloat values and products of dfloat values
+    @note   Held as a signed 128-bit coefficient and a decimal exponent, so
+            `add_product(price, quantity)` keeps all 36 digits of the
+            product and a sum of many of them loses nothing; only `value`
+            and `divide` truncate, once
+    @note   The exponent is the smallest of the operands seen. Trailing
+            zeros are dropped when that is needed to line operands up. If
+            the exact sum needs more than 38 digits anyway, the accumulator
+            becomes NaN rather than silently inexact
+    @note   NaN operands make the accumulator NaN
+    */
+  class dfloat_accumulator
+  {
+  public:
+    using wide_t = __int128;
+    using uwide_t = unsigned __int128;
+
+  public:
+    dfloat_accumulator();
+
+    explicit dfloat_accumulator(const dfloat& x);
+
+    void add(const dfloat& x);
+
+    void subtract(const dfloat& x);
+
+    /**
+      @brief  Add the exact product `a * b`
+      */
+    void add_product(const dfloat& a, const dfloat& b);
+
+    void subtract_product(const dfloat& a, const dfloat& b);
+
+    void add(const dfloat_accumulator& other);
+
+    void subtract(const dfloat_accumulator& other);
+
+    /**
+      @brief  Add `coef * 10^exp`
+      */
+    void add_scaled(wide_t coef, dfloat::pow2_t exp);
+
+    void reset();
+
+    bool isnan() const;
+
+    bool is_zero() const;
+
+    /**
+      @brief  -1, 0 or 1; 0 if NaN
+      */
+    int sign() const;
+
+    /**
+      @brief  Coefficient and exponent such that the sum is exactly
+              `coef * 10^exp`
+      */
+    wide_t coef() const;
+
+    dfloat::pow2_t exp() const;
+
+    /**
+      @brief  Sum truncated to a dfloat
+      */
+    dfloat value() const;
+
+    /**
+      @brief  Quotient of the exact sums, truncated once to a dfloat
+      @note   NaN if either is NaN or `divisor` is zero
+      */
+    dfloat divide(const dfloat_accumulator& divisor) const;
+
+    /**
+      @brief  Exact comparison: -1, 0 or 1
+      @note   NaN compares as 0 with anything; check `isnan` first
+      */
+    int compare(const dfloat_accumulator& other) const;
+
+    bool operator==(const dfloat_accumulator& other) const;
+
+    bool operator!=(const dfloat_accumulator& other) const;
+
+    /**
+      @brief  10^n for n in [0, 38]
+      */
+    static uwide_t pow10(dfloat::pow2_t n);
+
+  protected:
+    /* bring `coef * 10^exp` and the sum to the same exponent */
+    static bool _align(wide_t& a, dfloat::pow2_t& a_exp, wide_t& b, dfloat::pow2_t& b_exp);
+
+    static wide_t _strip(wide_t x, dfloat::pow2_t& exp);
+
+    wide_t coef_;
+    dfloat::pow2_t exp_;
+    bool nan_;
+  };
+}
@@ -0,0 +1,465 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include "dfloat.hpp"
+#include "dfloat_accumulator.h"
+
+namespace xu
+{
+  inline
+  dfloat_accumulator::dfloat_accumulator()
+    : coef_(0), exp_(0), nan_(false)
+  {
+  }
+
+  inline
+  dfloat_accumulator::dfloat_accumulator(const dfloat& x)
+    : dfloat_accumulator()
+  {
+    add(x);
+  }
+
+  inline
+  void dfloat_accumulator::add(const dfloat& x)
+  {
+    int64_t c;
+    dfloat::pow2_t e;
+
+    if (not x.to_decimal(c, e))
+    {
+      nan_ = true;
+      return;
+    }
+
+    add_scaled(c, e);
+  }
+
+  inline
+  void dfloat_accumulator::subtract(const dfloat& x)
+  {
+    int64_t c;
+    dfloat::pow2_t e;
+
+    if (not x.to_decimal(c, e))
+    {
+      nan_ = true;
+      return;
+    }
+
+    /* at most 18 digits, negation cannot overflow */
+    add_scaled(-(wide_t)c, e);
+  }
+
+  inline
+  void dfloat_accumulator::add_product(const dfloat& a, const dfloat& b)
+  {
+    int64_t ca, cb;
+    dfloat::pow2_t ea, eb;
+
+    if (not a.to_decimal(ca, ea) or not b.to_decimal(cb, eb))
+    {
+      nan_ = true;
+      return;
+    }
+
+    /* below 10^36, well within 128 bits */
+    add_scaled((wide_t)ca * cb, ea + eb);
+  }
+
+  inline
+  void dfloat_accumulator::subtract_product(const dfloat& a, const dfloat& b)
+  {
+    int64_t ca, cb;
+    dfloat::pow2_t ea, eb;
+
+    if (not a.to_decimal(ca, ea) or not b.to_decimal(cb, eb))
+    {
+      nan_ = true;
+      return;
+    }
+
+    add_scaled(-((wide_t)ca * cb), ea + eb);
+  }
+
+  inline
+  void dfloat_accumulator::add(const dfloat_accumulator& other)
+  {
+    if (other.nan_)
+    {
+      nan_ = true;
+      return;
+    }
+
+    add_scaled(other.coef_, other.exp_);
+  }
+
+  inline
+  void dfloat_accumulator::subtract(const dfloat_accumulator& other)
+  {
+    if (other.nan_)
+    {
+      nan_ = true;
+      return;
+    }
+
+    /* the one coefficient whose negation does not fit */
+    if (other.coef_ == -(wide_t)(((uwide_t)1 << 127) - 1) - 1)
+    {
+      nan_ = true;
+      return;
+    }
+
+    add_scaled(-other.coef_, other.exp_);
+  }
+
+  inline
+  void dfloat_accumulator::add_scaled(wide_t coef, dfloat::pow2_t exp)
+  {
+    if (nan_ or coef == 0)
+    {
+      return;
+    }
+
+    if (coef_ == 0)
+    {
+      coef_ = coef;
+      exp_ = exp;
+      return;
+    }
+
+    wide_t a = coef_;
+    dfloat::pow2_t a_exp = exp_;
+
+    wide_t sum;
+
+    if (not _align(a, a_exp, coef, exp) or __builtin_add_overflow(a, coef, &sum))
+    {
+      nan_ = true;
+      return;
+    }
+
+    coef_ = sum;
+    exp_ = a_exp;
+  }
+
+  inline
+  void dfloat_accumulator::reset()
+  {
+    coef_ = 0;
+    exp_ = 0;
+    nan_ = false;
+  }
+
+  inline
+  bool dfloat_accumulator::isnan() const
+  {
+    return nan_;
+  }
+
+  inline
+  bool dfloat_accumulator::is_zero() const
+  {
+    return not nan_ and coef_ == 0;
+  }
+
+  inline
+  int dfloat_accumulator::sign() const
+  {
+    if (nan_)
+    {
+      return 0;
+    }
+
+    return coef_ > 0 ? 1 : coef_ < 0 ? -1 : 0;
+  }
+
+  inline
+  dfloat_accumulator::wide_t dfloat_accumulator::coef() const
+  {
+    return coef_;
+  }
+
+  inline
+  dfloat::pow2_t dfloat_accumulator::exp() const
+  {
+    return exp_;
+  }
+
+  inline
+  dfloat dfloat_accumulator::value() const
+  {
+    using Sign = dfloat::Sign;
+
+    if (nan_)
+    {
+      return dfloat::from_scaled(Sign::_NAN_, 0, 0);
+    }
+
+    if (coef_ == 0)
+    {
+      return dfloat::from_scaled(Sign::ZERO, 0, 0);
+    }
+
+    Sign s = coef_ < 0 ? Sign::NEG : Sign::POS;
+    uwide_t mag = coef_ < 0 ? (uwide_t)0 - (uwide_t)coef_ : (uwide_t)coef_;
+
+    return dfloat::from_scaled(s, mag, exp_);
+  }
+
+  inline
+  dfloat dfloat_accumulator::divide(const dfloat_accumulator& divisor) const
+  {
+    using Sign = dfloat::Sign;
+
+    if (nan_ or divisor.nan_ or divisor.coef_ == 0)
+    {
+      return dfloat::from_scaled(Sign::_NAN_, 0, 0);
+    }
+
+    if (coef_ == 0)
+    {
+      return dfloat::from_scaled(Sign::ZERO, 0, 0);
+    }
+
+    Sign s = (coef_ < 0) != (divisor.coef_ < 0) ? Sign::NEG : Sign::POS;
+
+    uwide_t a = coef_ < 0 ? (uwide_t)0 - (uwide_t)coef_ : (uwide_t)coef_;
+    uwide_t b = divisor.coef_ < 0 ? (uwide_t)0 - (uwide_t)divisor.coef_ : (uwide_t)divisor.coef_;
+
+    int32_t e = (int32_t)exp_ - divisor.exp_;
+
+    uwide_t q = a / b;
+    uwide_t r = a % b;
+
+    /*
+      Long division, one digit at a time, until one digit more than a
+      dfloat holds. 10 * r may not fit, so the next digit is counted while
+      adding r to itself modulo b
+    */
+    while (r != 0 and q < (uwide_t)dfloat::MANT_CAP * dfloat::BASE)
+    {
+      unsigned digit = 0;
+      uwide_t acc = 0;
+
+      for (unsigned i = 0; i < dfloat::BASE; i++)
+      {
+        if (acc >= b - r)
+        {
+          acc -= b - r;
+          digit++;
+        }
+        else
+        {
+          acc += r;
+        }
+      }
+
+      q = q * dfloat::BASE + digit;
+      r = acc;
+      e--;
+    }
+
+    return dfloat::from_scaled(s, q, (dfloat::pow2_t)e);
+  }
+
+  inline
+  int dfloat_accumulator::compare(const dfloat_accumulator& other) const
+  {
+    if (nan_ or other.nan_)
+    {
+      return 0;
+    }
+
+    int s = sign();
+    int t = other.sign();
+
+    if (s != t)
+    {
+      return s < t ? -1 : 1;
+    }
+
+    if (s == 0)
+    {
+      return 0;
+    }
+
+    wide_t a = coef_;
+    wide_t b = other.coef_;
+    dfloat::pow2_t a_exp = exp_;
+    dfloat::pow2_t b_exp = other.exp_;
+
+    if (_align(a, a_exp, b, b_exp))
+    {
+      return a < b ? -1 : a > b ? 1 : 0;
+    }
+
+    /* too far apart to line up: the one with more integral digits is larger */
+    auto magnitude = [](wide_t x, dfloat::pow2_t e)
+    {
+      uwide_t m = x < 0 ? (uwide_t)0 - (uwide_t)x : (uwide_t)x;
+      int32_t digits = 0;
+      while (m != 0)
+      {
+        m /= dfloat::BASE;
+        digits++;
+      }
+      return digits + e;
+    };
+
+    int32_t ma = magnitude(a, a_exp);
+    int32_t mb = magnitude(b, b_exp);
+
+    return (ma < mb ? -1 : 1) * s;
+  }
+
+  inline
+  bool dfloat_accumulator::operator==(const dfloat_accumulator& other) const
+  {
+    return not nan_ and not other.nan_ and compare(other) == 0;
+  }
+
+  inline
+  bool dfloat_accumulator::operator!=(const dfloat_accumulator& other) const
+  {
+    return not (*this == other);
+  }
+
+  inline
+  bool dfloat_accumulator::_align(wide_t& a, dfloat::pow2_t& a_exp, wide_t& b, dfloat::pow2_t& b_exp)
+  {
+    if (a == 0)
+    {
+      a_exp = b_exp;
+      return true;
+    }
+
+    if (b == 0)
+    {
+      b_exp = a_exp;
+      return true;
+    }
+
+    /* the common case when adding amounts of one currency */
+    if (a_exp == b_exp)
+    {
+      return true;
+    }
+
+    /* lower the larger exponent, scaling its coefficient up */
+    auto lower = [](wide_t& x, dfloat::pow2_t& x_exp, dfloat::pow2_t target)
+    {
+      int32_t shift = x_exp - target;
+
+      if (shift > 38)
+      {
+        return false;
+      }
+
+      /* below 2^64 * 10^18 cannot overflow, and needs no checked multiply */
+      uwide_t magnitude = x < 0 ? (uwide_t)0 - (uwide_t)x : (uwide_t)x;
+
+      if (shift <= 18 and (magnitude >> 64) == 0)
+      {
+        x *= (wide_t)pow10(shift);
+        x_exp = target;
+
+        return true;
+      }
+
+      wide_t scaled;
+
+      if (__builtin_mul_overflow(x, (wide_t)pow10(shift), &scaled))
+      {
+        return false;
+      }
+
+      x = scaled;
+      x_exp = target;
+
+      return true;
+    };
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+      if (a_exp >= b_exp ? lower(a, a_exp, b_exp) : lower(b, b_exp, a_exp))
+      {
+        return true;
+      }
+
+      /* trailing zeros carry no information; drop them and try again */
+      a = _strip(a, a_exp);
+      b = _strip(b, b_exp);
+    }
+
+    return false;
+  }
+
+  inline
+  dfloat_accumulator::uwide_t dfloat_accumulator::pow10(dfloat::pow2_t n)
+  {
+    struct table_t
+    {
+      uwide_t values[39];
+
+      constexpr table_t()
+        : values()
+      {
+        uwide_t p = 1;
+        for (size_t i = 0; i < 39; i++)
+        {
+          values[i] = p;
+          p *= dfloat::BASE;
+        }
+      }
+    };
+
+    static constexpr table_t table;
+
+    return table.values[n];
+  }
+
+  inline
+  dfloat_accumulator::wide_t dfloat_accumulator::_strip(wide_t x, dfloat::pow2_t& exp)
+  {
+    if (x == 0)
+    {
+      return x;
+    }
+
+    while (x % 100000000 == 0)
+    {
+      x /= 100000000;
+      exp += 8;
+    }
+    while (x % dfloat::BASE == 0)
+    {
+      x /= dfloat::BASE;
+      exp += 1;
+    }
+
+    return x;
+  }
+}
@@ -0,0 +1,116 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_column.h"
+#include "dfloat_rounding.h"
+
+namespace xu
+{
+  struct amortization_policy
+  {
+    /**
+      @brief  Every amount is a multiple of `10^exp`, e.g. -2 for cents
+      */
+    dfloat::pow2_t exp = -2;
+
+    /**
+      @brief  Rounding of the interest of each period
+      */
+    rounding_mode interest_rounding = rounding_mode::HALF_UP;
+
+    /**
+      @brief  Rounding of the level payment and of the principal
+      */
+    rounding_mode payment_rounding = rounding_mode::HALF_UP;
+
+    /**
+      @brief  The periodic rate is the annual rate divided by this
+      */
+    uint32_t periods_per_year = 12;
+  };
+
+  /**
+    @brief  Rows of `amortize`, one per period of each loan, grouped by loan
+            in input order
+    */
+  struct amortization_schedule
+  {
+    std::vector<uint32_t> loan;
+
+    /**
+      @brief  From 1 to the term of the loan
+      */
+    std::vector<uint32_t> period;
+
+    dfloat_column payment;
+    dfloat_column interest;
+    dfloat_column principal;
+
+    /**
+      @brief  Balance after the payment of the period
+      */
+    dfloat_column balance;
+
+    size_t size() const;
+
+    void clear();
+  };
+
+  /**
+    @brief  Level payment of a loan: `L * r / (1 - (1 + r)^-n)` for the
+            periodic rate `r`, or `L / n` if the rate is zero
+    @note   `L` is first rounded to the unit of the policy. The formula is
+            evaluated in dfloat and rounded once by `payment_rounding`
+    @note   If the principal or rate is NaN or negative, or the term is 0,
+            result is NaN.
+    */
+  dfloat level_payment(const dfloat& principal, const dfloat& annual_rate, uint32_t term,
+    const amortization_policy& policy);
+
+  /**
+    @brief  Amortization schedules of `count` loans, replacing the contents
+            of `out`
+    @note   Each period, the interest is `balance * annual_rate /
+            periods_per_year` rounded once from the exact fraction; the
+            payment goes first to interest and the rest to principal. The
+            last period pays off whatever balance is left
+    @note   The balances are kept in integer units of the policy, so a
+            period costs a few integer operations; only the output is
+            converted to dfloat
+    @note   Every loan owns a fixed range of rows (the prefix sum of the
+            terms), so loans are split across `threads` threads without
+            any merge
+    @return number of loans scheduled; the rows of a loan that cannot be
+            scheduled (see `level_payment`, or an amount too large for 64
+            bits) are NaN
+    */
+  size_t amortize(const dfloat* principals, const dfloat* annual_rates, const uint32_t* terms, size_t count,
+    const amortization_policy& policy, amortization_schedule& out, size_t threads);
+}
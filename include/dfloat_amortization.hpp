@@ -0,0 +1,272 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include "dfloat.hpp"
+#include "dfloat_column.hpp"
+#include "dfloat_rounding.hpp"
+#include "dfloat_amortization.h"
+
+namespace xu
+{
+  inline
+  size_t amortization_schedule::size() const
+  {
+    return loan.size();
+  }
+
+  inline
+  void amortization_schedule::clear()
+  {
+    loan.clear();
+    period.clear();
+    payment.resize(0);
+    interest.resize(0);
+    principal.resize(0);
+    balance.resize(0);
+  }
+
+  /* `x^n` by repeated squaring, truncated at each step */
+  inline
+  dfloat _power(dfloat x, uint32_t n)
+  {
+    dfloat result = 1;
+
+    while (n != 0)
+    {
+      if (n & 1)
+      {
+        result *= x;
+      }
+
+      n >>= 1;
+
+      if (n != 0)
+      {
+        x *= x;
+      }
+    }
+
+    return result;
+  }
+
+  /* level payment in units of the policy, from the principal in units */
+  inline
+  bool _level_units(int64_t principal, const dfloat& annual_rate, uint32_t term,
+    const amortization_policy& policy, int64_t& payment)
+  {
+    int64_t rate_coef;
+    dfloat::pow2_t rate_exp;
+
+    /* comparing with dfloat(0) would read its unset mantissa */
+    if (annual_rate.to_decimal(rate_coef, rate_exp) and rate_coef == 0)
+    {
+      payment = (int64_t)divide_rounded(principal, term, policy.payment_rounding);
+      return true;
+    }
+
+    dfloat r = annual_rate / dfloat(policy.periods_per_year);
+    dfloat growth = _power(1 + r, term);
+
+    dfloat amount = dfloat::from_scaled(principal, policy.exp) * r * growth / (growth - 1);
+
+    return round_to_units(amount, policy.exp, policy.payment_rounding, payment);
+  }
+
+  inline
+  dfloat level_payment(const dfloat& principal, const dfloat& annual_rate, uint32_t term,
+    const amortization_policy& policy)
+  {
+    const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+    int64_t rate_coef;
+    dfloat::pow2_t rate_exp;
+
+    if (term == 0 or policy.periods_per_year == 0 or not annual_rate.to_decimal(rate_coef, rate_exp) or rate_coef < 0)
+    {
+      return NaN;
+    }
+
+    int64_t units;
+    int64_t payment;
+
+    if (not round_to_units(principal, policy.exp, policy.payment_rounding, units) or units < 0
+      or not _level_units(units, annual_rate, term, policy, payment))
+    {
+      return NaN;
+    }
+
+    return dfloat::from_scaled(payment, policy.exp);
+  }
+
+  inline
+  size_t amortize(const dfloat* principals, const dfloat* annual_rates, const uint32_t* terms, size_t count,
+    const amortization_policy& policy, amortization_schedule& out, size_t threads)
+  {
+    using wide_t = dfloat_accumulator::wide_t;
+
+    /* loan `i` owns rows [offsets[i], offsets[i + 1]) */
+    std::vector<size_t> offsets(count + 1);
+    offsets[0] = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+      offsets[i + 1] = offsets[i] + terms[i];
+    }
+
+    size_t rows = offsets[count];
+
+    out.loan.resize(rows);
+    out.period.resize(rows);
+    out.payment.resize(rows);
+    out.interest.resize(rows);
+    out.principal.resize(rows);
+    out.balance.resize(rows);
+
+    uint32_t* loan_out = out.loan.data();
+    uint32_t* period_out = out.period.data();
+    dfloat* payment_out = out.payment.data();
+    dfloat* interest_out = out.interest.data();
+    dfloat* principal_out = out.principal.data();
+    dfloat* balance_out = out.balance.data();
+
+    const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+    const dfloat::pow2_t exp = policy.exp;
+
+    std::atomic<size_t> scheduled(0);
+
+    /* loans, not rows, are split; a block of loans is usually many rows */
+    constexpr size_t LOAN_BLOCK = 64;
+
+    parallel_blocks(count, threads, LOAN_BLOCK,
+      [&](size_t begin, size_t end)
+      {
+        size_t done = 0;
+
+        for (size_t i = begin; i < end; i++)
+        {
+          size_t first = offsets[i];
+          uint32_t term = terms[i];
+
+          for (uint32_t k = 0; k < term; k++)
+          {
+            loan_out[first + k] = (uint32_t)i;
+            period_out[first + k] = k + 1;
+          }
+
+          int64_t balance;
+          int64_t level;
+          int64_t coef;
+          dfloat::pow2_t coef_exp;
+
+          /* interest of a period is `balance * mult / den`, exactly */
+          wide_t mult = 0;
+          wide_t den = policy.periods_per_year;
+
+          bool ok = term != 0 and den != 0
+            and annual_rates[i].to_decimal(coef, coef_exp) and coef >= 0
+            and round_to_units(principals[i], exp, policy.payment_rounding, balance) and balance >= 0
+            and _level_units(balance, annual_rates[i], term, policy, level);
+
+          if (ok)
+          {
+            mult = coef;
+
+            for (; coef_exp > 0 and ok; coef_exp--)
+            {
+              ok = not __builtin_mul_overflow(mult, (wide_t)dfloat::BASE, &mult);
+            }
+            for (; coef_exp < 0 and ok; coef_exp++)
+            {
+              ok = not __builtin_mul_overflow(den, (wide_t)dfloat::BASE, &den);
+            }
+          }
+
+          for (uint32_t k = 0; k < term and ok; k++)
+          {
+            size_t r = first + k;
+
+            wide_t num;
+
+            /* a 64 by 64-bit product always fits; the checked multiply is a library call */
+            if (mult <= INT64_MAX)
+            {
+              num = (wide_t)balance * (int64_t)mult;
+            }
+            else if (__builtin_mul_overflow((wide_t)balance, mult, &num))
+            {
+              ok = false;
+              break;
+            }
+
+            wide_t owed = divide_rounded(num, den, policy.interest_rounding);
+
+            if (owed > INT64_MAX)
+            {
+              ok = false;
+              break;
+            }
+
+            int64_t interest = (int64_t)owed;
+
+            /* the last payment clears the balance; an earlier one never overshoots it */
+            int64_t repaid = k + 1 == term ? balance : std::min(level - interest, balance);
+
+            int64_t paid;
+
+            if (__builtin_add_overflow(interest, repaid, &paid) or __builtin_sub_overflow(balance, repaid, &balance))
+            {
+              ok = false;
+              break;
+            }
+
+            payment_out[r] = dfloat::from_scaled(paid, exp);
+            interest_out[r] = dfloat::from_scaled(interest, exp);
+            principal_out[r] = dfloat::from_scaled(repaid, exp);
+            balance_out[r] = dfloat::from_scaled(balance, exp);
+          }
+
+          if (ok)
+          {
+            ++done;
+            continue;
+          }
+
+          for (uint32_t k = 0; k < term; k++)
+          {
+            payment_out[first + k] = NaN;
+            interest_out[first + k] = NaN;
+            principal_out[first + k] = NaN;
+            balance_out[first + k] = NaN;
+          }
+        }
+
+        scheduled += done;
+      });
+
+    return scheduled;
+  }
+}
@@ -0,0 +1,177 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define XU_HAVE_IO_URING 1
+#endif
+#endif
+
+namespace xu
+{
+  /**
+    @brief  A completed read handed out by `async_file_reader`
+    */
+  struct file_chunk
+  {
+    const char* data;
+
+    /**
+      @brief  `chunk_size` bytes, or fewer for the last chunk of the file
+      */
+    size_t size;
+
+    /**
+      @brief  Position of `data[0]` in the file, a multiple of `chunk_size`
+      */
+    uint64_t offset;
+
+    /**
+      @brief  Buffer holding the chunk, to give back with `release`
+      */
+    size_t buffer;
+  };
+
+  /**
+    @brief  Reads a whole file through a ring of `depth` buffers, keeping
+            reads in flight while the caller processes completed chunks, so
+            that I/O and parsing overlap
+    @note   On Linux the reads are submitted through io_uring (raw system
+            calls, no liburing). Elsewhere, or if io_uring is unavailable
+            (old kernel, seccomp), a background thread issues `pread`s
+            instead; the interface is the same
+    @note   `next` and `release` may be called from several parser threads.
+            Chunks come back in completion order, not file order; use
+            `offset` if order matters
+    @note   If the file cannot be opened, `is_open()` is false
+    */
+  class async_file_reader
+  {
+  public:
+    async_file_reader(const std::string& filepath, size_t chunk_size = 1 << 20, size_t depth = 8, bool allow_io_uring = true);
+
+    ~async_file_reader();
+
+    async_file_reader(const async_file_reader& other) = delete;
+
+    async_file_reader& operator=(const async_file_reader& other) = delete;
+
+    bool is_open() const;
+
+    bool uses_io_uring() const;
+
+    uint64_t file_size() const;
+
+    /**
+      @brief  Wait for the next completed chunk
+      @return false once every chunk has been handed out, or on a read error
+      */
+    bool next(file_chunk& chunk);
+
+    /**
+      @brief  Give the buffer of `chunk` back so that it can be read into
+              again; `chunk.data` is invalid afterwards
+      */
+    void release(const file_chunk& chunk);
+
+    /**
+      @brief  True if a read failed; `next` then returns false
+      */
+    bool failed() const;
+
+  protected:
+    /* queue reads into free buffers, caller holds the mutex */
+    void _submit();
+
+    /* io_uring: wait for at least one completion, caller holds the mutex */
+    bool _reap(std::unique_lock<std::mutex>& lock);
+
+    /* fallback: background thread reading into free buffers */
+    void _read_loop();
+
+    bool _uring_setup(size_t entries);
+
+    void _uring_teardown();
+
+    int fd_;
+    uint64_t file_size_;
+    size_t chunk_size_;
+
+    std::vector<std::vector<char>> buffers_;
+    std::vector<uint64_t> offsets_;
+    std::vector<size_t> sizes_;
+    std::vector<size_t> done_;
+
+    std::deque<size_t> free_;
+    std::deque<size_t> completed_;
+    std::deque<size_t> retry_;
+    uint64_t next_offset_;
+    size_t in_flight_;
+    uint64_t handed_out_;
+    uint64_t chunk_count_;
+    bool failed_;
+    bool stopping_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+
+    std::thread thread_;
+
+    /* io_uring state, unused by the fallback */
+    int ring_fd_;
+    void* sq_ring_;
+    size_t sq_ring_size_;
+    void* cq_ring_;
+    size_t cq_ring_size_;
+    void* sqes_;
+    size_t sqes_size_;
+    unsigned* sq_tail_;
+    unsigned* sq_mask_;
+    unsigned* sq_array_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned* cq_mask_;
+    void* cqes_;
+    bool reaping_;
+  };
+
+  /**
+    @brief  Run `fn(chunk)` on every chunk of `reader` from `threads`
+            parser threads, releasing each chunk afterwards
+    @return false if a read failed
+    */
+  template <typename F>
+  bool for_each_chunk(async_file_reader& reader, size_t threads, F fn);
+}
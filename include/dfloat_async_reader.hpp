@@ -0,0 +1,554 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "dfloat_async_reader.h"
+
+#ifdef XU_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace xu
+{
+  inline
+  async_file_reader::async_file_reader(const std::string& filepath, size_t chunk_size, size_t depth, bool allow_io_uring)
+    : fd_(-1), file_size_(0), chunk_size_(chunk_size > 0 ? chunk_size : 1),
+      next_offset_(0), in_flight_(0), handed_out_(0), chunk_count_(0), failed_(false), stopping_(false),
+      ring_fd_(-1), sq_ring_(nullptr), sq_ring_size_(0), cq_ring_(nullptr), cq_ring_size_(0),
+      sqes_(nullptr), sqes_size_(0), sq_tail_(nullptr), sq_mask_(nullptr), sq_array_(nullptr),
+      cq_head_(nullptr), cq_tail_(nullptr), cq_mask_(nullptr), cqes_(nullptr), reaping_(false)
+  {
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+      return;
+    }
+
+    struct stat st;
+
+    if (::fstat(fd, &st) != 0)
+    {
+      ::close(fd);
+      return;
+    }
+
+    fd_ = fd;
+    file_size_ = st.st_size;
+    chunk_count_ = (file_size_ + chunk_size_ - 1) / chunk_size_;
+
+    depth = std::max<size_t>(depth, 1);
+
+    buffers_.resize(depth);
+    offsets_.resize(depth, 0);
+    sizes_.resize(depth, 0);
+    done_.resize(depth, 0);
+
+    for (size_t i = 0; i < depth; i++)
+    {
+      buffers_[i].resize(chunk_size_);
+      free_.push_back(i);
+    }
+
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if (allow_io_uring and _uring_setup(depth))
+    {
+      return;
+    }
+
+    thread_ = std::thread([this]() { _read_loop(); });
+  }
+
+  inline
+  async_file_reader::~async_file_reader()
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      stopping_ = true;
+      changed_.notify_all();
+
+      /* the kernel may still write into the buffers until reads complete */
+      while (ring_fd_ >= 0 and in_flight_ > retry_.size())
+      {
+        while (reaping_)
+        {
+          changed_.wait(lock);
+        }
+        if (in_flight_ > retry_.size() and not _reap(lock))
+        {
+          break;
+        }
+      }
+    }
+
+    if (thread_.joinable())
+    {
+      thread_.join();
+    }
+
+    _uring_teardown();
+
+    if (fd_ >= 0)
+    {
+      ::close(fd_);
+    }
+  }
+
+  inline
+  bool async_file_reader::is_open() const
+  {
+    return fd_ >= 0;
+  }
+
+  inline
+  bool async_file_reader::uses_io_uring() const
+  {
+    return ring_fd_ >= 0;
+  }
+
+  inline
+  uint64_t async_file_reader::file_size() const
+  {
+    return file_size_;
+  }
+
+  inline
+  bool async_file_reader::failed() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+  }
+
+  inline
+  bool async_file_reader::next(file_chunk& chunk)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true)
+    {
+      if (not completed_.empty())
+      {
+        size_t i = completed_.front();
+        completed_.pop_front();
+        handed_out_++;
+
+        chunk.data = buffers_[i].data();
+        chunk.size = sizes_[i];
+        chunk.offset = offsets_[i];
+        chunk.buffer = i;
+
+        return true;
+      }
+
+      if (fd_ < 0 or failed_ or handed_out_ == chunk_count_)
+      {
+        return false;
+      }
+
+      if (ring_fd_ >= 0)
+      {
+        _submit();
+
+        /* waiting would block forever for entries that were never submitted */
+        if (failed_)
+        {
+          changed_.notify_all();
+          continue;
+        }
+
+        /* one thread waits in the kernel, the others for it */
+        if (in_flight_ > retry_.size() and not reaping_)
+        {
+          if (not _reap(lock))
+          {
+            failed_ = true;
+            changed_.notify_all();
+          }
+          continue;
+        }
+      }
+
+      changed_.wait(lock);
+    }
+  }
+
+  inline
+  void async_file_reader::release(const file_chunk& chunk)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    free_.push_back(chunk.buffer);
+    changed_.notify_all();
+  }
+
+  inline
+  void async_file_reader::_read_loop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (not stopping_ and not failed_ and next_offset_ < file_size_)
+    {
+      if (free_.empty())
+      {
+        changed_.wait(lock);
+        continue;
+      }
+
+      size_t i = free_.front();
+      free_.pop_front();
+
+      offsets_[i] = next_offset_;
+      sizes_[i] = std::min<uint64_t>(chunk_size_, file_size_ - next_offset_);
+      next_offset_ += sizes_[i];
+
+      lock.unlock();
+
+      size_t done = 0;
+      bool ok = true;
+
+      while (ok and done < sizes_[i])
+      {
+        ssize_t n = ::pread(fd_, buffers_[i].data() + done, sizes_[i] - done, offsets_[i] + done);
+        ok = n > 0;
+        done += ok ? n : 0;
+      }
+
+      lock.lock();
+
+      if (ok)
+      {
+        completed_.push_back(i);
+      }
+      else
+      {
+        failed_ = true;
+      }
+
+      changed_.notify_all();
+    }
+  }
+
+#ifdef XU_HAVE_IO_URING
+
+  inline
+  bool async_file_reader::_uring_setup(size_t entries)
+  {
+    io_uring_params params = {};
+
+    int ring_fd = (int)::syscall(__NR_io_uring_setup, (unsigned)entries, &params);
+
+    if (ring_fd < 0)
+    {
+      return false;
+    }
+
+    /* IORING_OP_READ needs 5.6; FAST_POLL arrived in 5.7 and is easy to check */
+    if ((params.features & IORING_FEAT_FAST_POLL) == 0)
+    {
+      ::close(ring_fd);
+      return false;
+    }
+
+    ring_fd_ = ring_fd;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+    if (single)
+    {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+
+    void* sq = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    void* cq = single
+      ? sq
+      : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+
+    sq_ring_ = sq == MAP_FAILED ? nullptr : sq;
+    cq_ring_ = cq == MAP_FAILED ? nullptr : cq;
+    sqes_ = sqes == MAP_FAILED ? nullptr : sqes;
+
+    if (sq_ring_ == nullptr or cq_ring_ == nullptr or sqes_ == nullptr)
+    {
+      _uring_teardown();
+      return false;
+    }
+
+    char* sq_base = static_cast<char*>(sq_ring_);
+    char* cq_base = static_cast<char*>(cq_ring_);
+
+    sq_tail_ = reinterpret_cast<unsigned*>(sq_base + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq_base + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned*>(cq_base + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq_base + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq_base + params.cq_off.ring_mask);
+    cqes_ = cq_base + params.cq_off.cqes;
+
+    return true;
+  }
+
+  inline
+  void async_file_reader::_uring_teardown()
+  {
+    if (sqes_ != nullptr)
+    {
+      ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr and cq_ring_ != sq_ring_)
+    {
+      ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr)
+    {
+      ::munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0)
+    {
+      ::close(ring_fd_);
+    }
+
+    sqes_ = sq_ring_ = cq_ring_ = nullptr;
+    ring_fd_ = -1;
+  }
+
+  inline
+  void async_file_reader::_submit()
+  {
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(sqes_);
+
+    unsigned first = *sq_tail_;
+    unsigned tail = first;
+
+    /* buffers in the order of their entries, to undo those the kernel does not take */
+    std::vector<size_t> queued;
+
+    auto push = [&](size_t i)
+    {
+      unsigned idx = tail & *sq_mask_;
+
+      io_uring_sqe& sqe = sqes[idx];
+      sqe = io_uring_sqe();
+      sqe.opcode = IORING_OP_READ;
+      sqe.fd = fd_;
+      sqe.addr = (uint64_t)(uintptr_t)(buffers_[i].data() + done_[i]);
+      sqe.len = (uint32_t)(sizes_[i] - done_[i]);
+      sqe.off = offsets_[i] + done_[i];
+      sqe.user_data = i;
+
+      sq_array_[idx] = idx;
+      tail++;
+      queued.push_back(i);
+    };
+
+    /* finish short reads first, they already hold a buffer */
+    while (not retry_.empty())
+    {
+      push(retry_.front());
+      retry_.pop_front();
+    }
+
+    while (not free_.empty() and next_offset_ < file_size_ and not stopping_)
+    {
+      size_t i = free_.front();
+      free_.pop_front();
+
+      offsets_[i] = next_offset_;
+      sizes_[i] = std::min<uint64_t>(chunk_size_, file_size_ - next_offset_);
+      done_[i] = 0;
+      next_offset_ += sizes_[i];
+
+      push(i);
+      in_flight_++;
+    }
+
+    if (queued.empty())
+    {
+      return;
+    }
+
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    long r = ::syscall(__NR_io_uring_enter, ring_fd_, (unsigned)queued.size(), 0, 0, nullptr, 0);
+
+    size_t submitted = r <= 0 ? 0 : (size_t)r;
+
+    if (submitted == queued.size())
+    {
+      return;
+    }
+
+    /* the kernel has not consumed the rest, so they can be taken back out of the ring */
+    __atomic_store_n(sq_tail_, first + (unsigned)submitted, __ATOMIC_RELEASE);
+
+    if (submitted == 0)
+    {
+      /* no progress, e.g. an error: no completion will ever come for these */
+      failed_ = true;
+
+      for (size_t k = submitted; k < queued.size(); k++)
+      {
+        in_flight_--;
+        free_.push_back(queued[k]);
+      }
+    }
+    else
+    {
+      /* a partial submit: the rest is still in flight and goes first next time */
+      for (size_t k = queued.size(); k > submitted; k--)
+      {
+        retry_.push_front(queued[k - 1]);
+      }
+    }
+  }
+
+  inline
+  bool async_file_reader::_reap(std::unique_lock<std::mutex>& lock)
+  {
+    reaping_ = true;
+    lock.unlock();
+
+    long r = ::syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+    lock.lock();
+    reaping_ = false;
+
+    if (r < 0 and errno != EINTR)
+    {
+      changed_.notify_all();
+      return false;
+    }
+
+    io_uring_cqe* cqes = static_cast<io_uring_cqe*>(cqes_);
+
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+
+    bool ok = true;
+
+    for (; head != tail; head++)
+    {
+      const io_uring_cqe& cqe = cqes[head & *cq_mask_];
+      size_t i = (size_t)cqe.user_data;
+
+      if (cqe.res <= 0)
+      {
+        /* an error, or the file shrank */
+        ok = false;
+        in_flight_--;
+        continue;
+      }
+
+      done_[i] += cqe.res;
+
+      if (done_[i] == sizes_[i])
+      {
+        completed_.push_back(i);
+        in_flight_--;
+      }
+      else
+      {
+        /* a short read is resubmitted by the next `_submit` */
+        retry_.push_back(i);
+      }
+    }
+
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+    changed_.notify_all();
+
+    return ok;
+  }
+
+#else
+
+  inline
+  bool async_file_reader::_uring_setup(size_t)
+  {
+    return false;
+  }
+
+  inline
+  void async_file_reader::_uring_teardown()
+  {
+  }
+
+  inline
+  void async_file_reader::_submit()
+  {
+  }
+
+  inline
+  bool async_file_reader::_reap(std::unique_lock<std::mutex>&)
+  {
+    return false;
+  }
+
+#endif
+
+  template <typename F>
+  inline
+  bool for_each_chunk(async_file_reader& reader, size_t threads, F fn)
+  {
+    auto work = [&]()
+    {
+      file_chunk chunk;
+
+      while (reader.next(chunk))
+      {
+        fn(chunk);
+        reader.release(chunk);
+      }
+    };
+
+    std::vector<std::thread> extra;
+    for (size_t t = 1; t < threads; t++)
+    {
+      extra.emplace_back(work);
+    }
+
+    work();
+
+    for (std::thread& th : extra)
+    {
+      th.join();
+    }
+
+    return not reader.failed();
+  }
+}
@@ -0,0 +1,83 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  Number of fields processed together by the batch functions
+    */
+  constexpr size_t BATCH_LANES = 8;
+
+  /**
+    @brief  Parse `N` fixed-width numeric fields at once
+            Field `i` is the `width` characters starting at `src + i * stride`
+    @note   Fields may be padded with spaces on either side, and may contain a
+            sign before the first digit and a decimal point between digits,
+            e.g. "  -1234.56  "
+    @note   Each field is a lane: the characters at the same position in every
+            field are classified and multiplied into the lane accumulators
+            together, so the inner loop has no data-dependent branches and can
+            be vectorized by the compiler
+    @note   Fields that do not fit that layout (e.g. scientific notation, more
+            than 19 significant digits) fall back to `dfloat::parse`, so the
+            result is the same as parsing the trimmed field
+    @return number of fields that fell back to `dfloat::parse`
+    */
+  template <size_t N>
+  size_t parse_fixed(const char* src, size_t width, size_t stride, dfloat* out);
+
+  /**
+    @brief  Parse `count` fixed-width fields, `BATCH_LANES` at a time
+    @return number of fields that fell back to `dfloat::parse`
+    */
+  size_t parse_fixed(const char* src, size_t width, size_t stride, size_t count, dfloat* out);
+
+  /**
+    @brief  Format `N` dfloats as fixed-width, right-aligned fields with
+            `decimals` digits after the decimal point
+            Field `i` is written to the `width` characters starting at
+            `dst + i * stride`, the characters in between are left untouched
+    @note   Values are truncated to `decimals` places, like all dfloat
+            operations
+    @note   Digits are extracted from every lane together using fixed-point
+            multiplication, without any division by a variable
+    @note   Fields that do not fit in `width` are filled with '*', nan is
+            written as "nan"
+    @note   Unlike `print_to`, this never uses scientific notation and always
+            prints exactly `decimals` places
+    */
+  template <size_t N>
+  void format_fixed(const dfloat* src, size_t width, size_t decimals, size_t stride, char* dst);
+
+  /**
+    @brief  Format `count` dfloats as fixed-width fields, `BATCH_LANES` at a
+            time
+    */
+  void format_fixed(const dfloat* src, size_t width, size_t decimals, size_t stride, size_t count, char* dst);
+}
@@ -0,0 +1,385 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include "dfloat.hpp"
+#include "dfloat_batch.h"
+
+namespace xu
+{
+  template <size_t N>
+  inline
+  size_t parse_fixed(const char* src, size_t width, size_t stride, dfloat* out)
+  {
+    /*
+      Per-lane state
+        acc         digits accumulated so far, ignoring the decimal point
+        sig         significant digits in acc, to detect overflow
+        frac        digits seen after the decimal point
+        started     a non-space character was seen
+        ended       a space was seen after the field started
+        dot         a decimal point was seen
+        prev_digit  the previous character was a digit
+        last_digit  the last non-space character was a digit
+        neg         a minus sign was seen
+        bad         the field does not fit the layout, use the fallback
+    */
+    uint64_t acc[N] = {};
+    uint32_t sig[N] = {};
+    uint32_t frac[N] = {};
+    uint8_t started[N] = {};
+    uint8_t ended[N] = {};
+    uint8_t dot[N] = {};
+    uint8_t prev_digit[N] = {};
+    uint8_t last_digit[N] = {};
+    uint8_t neg[N] = {};
+    uint8_t bad[N] = {};
+
+    /* one row holds the character at the same position of every field */
+    uint8_t row[N];
+
+    for (size_t j = 0; j < width; j++)
+    {
+      for (size_t l = 0; l < N; l++)
+      {
+        row[l] = (uint8_t)src[l * stride + j];
+      }
+
+      for (size_t l = 0; l < N; l++)
+      {
+        uint8_t c = row[l];
+        uint8_t d = c - '0';
+
+        uint8_t is_digit = d < 10;
+        uint8_t is_space = c == ' ';
+        uint8_t is_dot = c == '.';
+        uint8_t is_sign = (c == '+') | (c == '-');
+
+        bad[l] |= (is_digit | is_space | is_dot | is_sign) ^ 1;
+        bad[l] |= ended[l] & (is_space ^ 1);
+        bad[l] |= is_sign & started[l];
+        bad[l] |= is_dot & ((prev_digit[l] ^ 1) | dot[l]);
+
+        ended[l] |= started[l] & is_space;
+        started[l] |= is_space ^ 1;
+        neg[l] |= c == '-';
+
+        sig[l] += is_digit & ((acc[l] != 0) | (d != 0));
+        acc[l] = acc[l] * (is_digit ? dfloat::BASE : 1) + (is_digit ? d : 0);
+        frac[l] += is_digit & dot[l];
+
+        dot[l] |= is_dot;
+        prev_digit[l] = is_digit;
+        last_digit[l] = (last_digit[l] & is_space) | is_digit;
+      }
+    }
+
+    size_t fallbacks = 0;
+
+    for (size_t l = 0; l < N; l++)
+    {
+      /* no digits at all, or nothing after the decimal point; trailing spaces are fine */
+      bad[l] |= last_digit[l] ^ 1;
+
+      /* acc may have overflowed */
+      bad[l] |= sig[l] > 19;
+
+      if (bad[l])
+      {
+        const char* begin = src + l * stride;
+        const char* end = begin + width;
+
+        while (begin != end and *begin == ' ')
+        {
+          ++begin;
+        }
+        while (end != begin and *(end - 1) == ' ')
+        {
+          --end;
+        }
+
+        out[l] = dfloat::parse(std::string(begin, end));
+        ++fallbacks;
+      }
+      else
+      {
+        out[l] = dfloat::from_scaled(
+          neg[l] ? dfloat::Sign::NEG : dfloat::Sign::POS,
+          acc[l],
+          -(dfloat::pow2_t)frac[l]);
+      }
+    }
+
+    return fallbacks;
+  }
+
+  inline
+  size_t parse_fixed(const char* src, size_t width, size_t stride, size_t count, dfloat* out)
+  {
+    size_t batched = count - count % BATCH_LANES;
+    size_t fallbacks = 0;
+
+    for (size_t i = 0; i < batched; i += BATCH_LANES)
+    {
+      fallbacks += parse_fixed<BATCH_LANES>(src + i * stride, width, stride, out + i);
+    }
+
+    /* the leftover lanes, at most BATCH_LANES - 1 of them */
+    src += batched * stride;
+    out += batched;
+
+    for (size_t i = 0; i < count % BATCH_LANES; i++)
+    {
+      fallbacks += parse_fixed<1>(src + i * stride, width, stride, out + i);
+    }
+
+    return fallbacks;
+  }
+
+  template <size_t N>
+  inline
+  void format_fixed(const dfloat* src, size_t width, size_t decimals, size_t stride, char* dst)
+  {
+    /* 3 chunks of 8 digits hold any `int64_t` */
+    constexpr size_t CHUNK_DIGITS = 8;
+    constexpr size_t ROWS = 3 * CHUNK_DIGITS;
+    constexpr uint64_t CHUNK_CAP = 100000000;
+
+    /*
+      For x < 10^8, `x * FIX_MUL` is x / 10^7 as a fixed-point number with
+      FIX_BITS fractional bits; the integer part is the leading digit, and
+      multiplying the fractional part by 10 shifts in the next digit. The
+      error from rounding FIX_MUL up stays below one digit for all 8 digits
+      */
+    constexpr uint64_t FIX_BITS = 57;
+    constexpr uint64_t FIX_MASK = ((uint64_t)1 << FIX_BITS) - 1;
+    constexpr uint64_t FIX_MUL = ((uint64_t)1 << FIX_BITS) / (CHUNK_CAP / 10) + 1;
+
+    uint64_t mag[N];
+    uint8_t neg[N];
+    uint8_t bad[N];
+
+    for (size_t l = 0; l < N; l++)
+    {
+      int64_t coef = 0;
+      bad[l] = (decimals > ROWS - 1) or not src[l].to_scaled(coef, -(dfloat::pow2_t)decimals);
+      neg[l] = coef < 0;
+      mag[l] = neg[l] ? 0 - (uint64_t)coef : (uint64_t)coef;
+    }
+
+    /* digits[r][l] is digit r (most significant first) of lane l */
+    uint8_t digits[ROWS][N];
+
+    for (size_t chunk = 0; chunk < 3; chunk++)
+    {
+      uint64_t fix[N];
+
+      for (size_t l = 0; l < N; l++)
+      {
+        uint64_t x;
+
+        switch (chunk)
+        {
+          case 0:
+            x = mag[l] / (CHUNK_CAP * CHUNK_CAP);
+            break;
+          case 1:
+            x = mag[l] / CHUNK_CAP % CHUNK_CAP;
+            break;
+          default:
+            x = mag[l] % CHUNK_CAP;
+            break;
+        }
+
+        fix[l] = x * FIX_MUL;
+      }
+
+      for (size_t r = 0; r < CHUNK_DIGITS; r++)
+      {
+        for (size_t l = 0; l < N; l++)
+        {
+          digits[chunk * CHUNK_DIGITS + r][l] = (uint8_t)(fix[l] >> FIX_BITS);
+          fix[l] = (fix[l] & FIX_MASK) * dfloat::BASE;
+        }
+      }
+    }
+
+    /* count leading zeros, at least one digit is kept before the point */
+    uint8_t lead[N] = {};
+    uint8_t seen[N] = {};
+
+    for (size_t r = 0; r < ROWS; r++)
+    {
+      for (size_t l = 0; l < N; l++)
+      {
+        seen[l] |= digits[r][l] != 0;
+        lead[l] += seen[l] ^ 1;
+      }
+    }
+
+    for (size_t l = 0; l < N; l++)
+    {
+      char* field = dst + l * stride;
+
+      if (not dfloat::isfinite(src[l]) and width >= 3)
+      {
+        std::fill(field, field + width - 3, ' ');
+        std::copy_n("nan", 3, field + width - 3);
+        continue;
+      }
+
+      size_t num_digits = ROWS - lead[l];
+      if (num_digits < decimals + 1)
+      {
+        num_digits = decimals + 1;
+      }
+
+      size_t len = num_digits + (decimals > 0 ? 1 : 0) + neg[l];
+
+      if (bad[l] or len > width)
+      {
+        std::fill(field, field + width, '*');
+        continue;
+      }
+
+      char* it = field;
+
+      it = std::fill_n(it, width - len, ' ');
+
+      if (neg[l])
+      {
+        *it++ = '-';
+      }
+
+      for (size_t r = ROWS - num_digits; r < ROWS - decimals; r++)
+      {
+        *it++ = (char)('0' + digits[r][l]);
+      }
+
+      if (decimals > 0)
+      {
+        *it++ = '.';
+
+        for (size_t r = ROWS - decimals; r < ROWS; r++)
+        {
+          *it++ = (char)('0' + digits[r][l]);
+        }
+      }
+    }
+  }
+
+  /* one field of `format_fixed`, for the lanes left over after whole batches */
+  inline
+  void _format_fixed_field(const dfloat& x, size_t width, size_t decimals, char* field)
+  {
+    /* the same limit as the batch, whose 24 digit rows keep one before the point */
+    constexpr size_t MAX_DIGITS = 24;
+
+    if (not dfloat::isfinite(x) and width >= 3)
+    {
+      std::fill(field, field + width - 3, ' ');
+      std::copy_n("nan", 3, field + width - 3);
+      return;
+    }
+
+    int64_t coef = 0;
+
+    if (decimals > MAX_DIGITS - 1 or not x.to_scaled(coef, -(dfloat::pow2_t)decimals))
+    {
+      std::fill(field, field + width, '*');
+      return;
+    }
+
+    bool neg = coef < 0;
+    uint64_t mag = neg ? 0 - (uint64_t)coef : (uint64_t)coef;
+
+    /* least significant first */
+    char digits[MAX_DIGITS];
+    size_t num_digits = 0;
+
+    do
+    {
+      digits[num_digits++] = (char)('0' + mag % dfloat::BASE);
+      mag /= dfloat::BASE;
+    }
+    while (mag != 0);
+
+    while (num_digits < decimals + 1)
+    {
+      digits[num_digits++] = '0';
+    }
+
+    size_t len = num_digits + (decimals > 0 ? 1 : 0) + neg;
+
+    if (len > width)
+    {
+      std::fill(field, field + width, '*');
+      return;
+    }
+
+    char* it = std::fill_n(field, width - len, ' ');
+
+    if (neg)
+    {
+      *it++ = '-';
+    }
+
+    for (size_t r = num_digits; r > decimals; r--)
+    {
+      *it++ = digits[r - 1];
+    }
+
+    if (decimals > 0)
+    {
+      *it++ = '.';
+
+      for (size_t r = decimals; r > 0; r--)
+      {
+        *it++ = digits[r - 1];
+      }
+    }
+  }
+
+  inline
+  void format_fixed(const dfloat* src, size_t width, size_t decimals, size_t stride, size_t count, char* dst)
+  {
+    size_t batched = count - count % BATCH_LANES;
+
+    for (size_t i = 0; i < batched; i += BATCH_LANES)
+    {
+      format_fixed<BATCH_LANES>(src + i, width, decimals, stride, dst + i * stride);
+    }
+
+    /* the leftover lanes, at most BATCH_LANES - 1 of them */
+    src += batched;
+    dst += batched * stride;
+
+    for (size_t i = 0; i < count % BATCH_LANES; i++)
+    {
+      _format_fixed_field(src[i], width, decimals, dst + i * stride);
+    }
+  }
+}
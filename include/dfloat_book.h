@@ -0,0 +1,168 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "dfloat.h"
+
+namespace xu
+{
+  enum class book_side : uint8_t
+  {
+    BID,
+    ASK
+  };
+
+  /**
+    @brief  New size of one venue's price level
+    @note   A size of zero (or negative, or NaN) removes the venue from the
+            level
+    */
+  struct book_update
+  {
+    uint16_t venue;
+    book_side side;
+    dfloat price;
+    dfloat size;
+  };
+
+  /**
+    @brief  A price level of the consolidated book
+    */
+  struct book_level
+  {
+    dfloat price;
+
+    /**
+      @brief  Sum of the sizes of all venues at this price
+      */
+    dfloat size;
+
+    /**
+      @brief  Number of venues with a size at this price
+      */
+    uint16_t venues;
+  };
+
+  /**
+    @brief  Price levels of many venues merged into one book per side
+    @note   Each side is a sorted array of `dfloat::to_key` keys (asks with
+            the key complemented) with the best price last, so the best
+            level is read in O(1) and most updates, which touch the top of
+            the book, move few elements. Sizes of every venue sit in a
+            parallel array, `num_venues` per level
+    @note   Lookups compare integer keys, never dfloats; they gallop down
+            from the top of the book, so the cost grows with the distance
+            from the best price rather than with the depth
+    */
+  class consolidated_book
+  {
+  public:
+    explicit consolidated_book(size_t num_venues);
+
+    size_t num_venues() const;
+
+    /**
+      @brief  Set one venue's size at one price; updates for venues out of
+              range and NaN prices are ignored
+      */
+    void apply(const book_update& update);
+
+    /**
+      @brief  Apply `count` updates, with the same result as applying them
+              one by one
+      @note   Batches that are large next to the book, such as a venue's
+              snapshot, are sorted by price and merged into each side in a
+              single pass, instead of shifting the arrays per new level
+      */
+    void apply(const book_update* updates, size_t count);
+
+    /**
+      @brief  Remove every level of `venue`, e.g. when it disconnects
+      */
+    void clear_venue(uint16_t venue);
+
+    void clear();
+
+    /**
+      @return false if the side is empty
+      */
+    bool best(book_side side, book_level& level) const;
+
+    size_t depth(book_side side) const;
+
+    /**
+      @brief  The `i`-th level from the best one (0 is the best)
+      @note   The total is summed from the venue sizes here rather than
+              kept up to date on every update, which would cost
+              `num_venues` additions per update
+      */
+    book_level level(book_side side, size_t i) const;
+
+    /**
+      @brief  Size of `venue` at `price`, 0 if none
+      */
+    dfloat venue_size(book_side side, const dfloat& price, uint16_t venue) const;
+
+  protected:
+    struct levels
+    {
+      /* ascending, best level last */
+      std::vector<dfloat::mant2_t> keys;
+      std::vector<uint16_t> venues;
+      std::vector<dfloat> sizes;
+    };
+
+    static dfloat::mant2_t _side_key(book_side side, const dfloat& price);
+
+    static dfloat _price(book_side side, dfloat::mant2_t key);
+
+    /* first index whose key is not below `key` */
+    static size_t _find(const levels& side, dfloat::mant2_t key);
+
+    /* set one venue's size in level `i`, updating its venue count */
+    void _set(levels& side, size_t i, uint16_t venue, const dfloat& size);
+
+    void _erase(levels& side, size_t i);
+
+    /* apply updates sorted by key in one pass over the side */
+    void _merge(levels& side, const std::vector<std::pair<dfloat::mant2_t, const book_update*>>& updates);
+
+    levels& _levels(book_side side);
+
+    const levels& _levels(book_side side) const;
+
+    size_t num_venues_;
+    levels bids_;
+    levels asks_;
+
+    /* reused by `_merge` to build the new side */
+    levels scratch_;
+    std::vector<std::pair<dfloat::mant2_t, const book_update*>> sorted_;
+  };
+}
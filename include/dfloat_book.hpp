@@ -0,0 +1,379 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include "dfloat.hpp"
+#include "dfloat_book.h"
+
+namespace xu
+{
+  inline
+  bool _book_positive(const dfloat& size)
+  {
+    /* compares keys, not dfloats; NaN has the largest key */
+    return size.to_key() > dfloat(0).to_key() and dfloat::isfinite(size);
+  }
+
+  inline
+  consolidated_book::consolidated_book(size_t num_venues)
+    : num_venues_(num_venues)
+  {
+  }
+
+  inline
+  size_t consolidated_book::num_venues() const
+  {
+    return num_venues_;
+  }
+
+  inline
+  dfloat::mant2_t consolidated_book::_side_key(book_side side, const dfloat& price)
+  {
+    /* complemented for asks, so that the lowest ask is last */
+    return side == book_side::BID ? price.to_key() : ~price.to_key();
+  }
+
+  inline
+  dfloat consolidated_book::_price(book_side side, dfloat::mant2_t key)
+  {
+    return dfloat::from_key(side == book_side::BID ? key : ~key);
+  }
+
+  inline
+  consolidated_book::levels& consolidated_book::_levels(book_side side)
+  {
+    return side == book_side::BID ? bids_ : asks_;
+  }
+
+  inline
+  const consolidated_book::levels& consolidated_book::_levels(book_side side) const
+  {
+    return side == book_side::BID ? bids_ : asks_;
+  }
+
+  inline
+  size_t consolidated_book::_find(const levels& side, dfloat::mant2_t key)
+  {
+    /*
+      Most updates are near the top of the book, which is at the end: gallop
+      down from there, then binary search the last step, so the cost grows
+      with the distance from the top rather than with the depth
+    */
+    const dfloat::mant2_t* keys = side.keys.data();
+
+    size_t hi = side.keys.size();
+    size_t step = 1;
+
+    /* keys in [hi, size) are not below `key` */
+    while (step <= hi and keys[hi - step] >= key)
+    {
+      hi -= step;
+      step *= 2;
+    }
+
+    const dfloat::mant2_t* base = keys + (step <= hi ? hi - step + 1 : 0);
+    size_t len = keys + hi - base;
+
+    /* without branches on the comparisons, which are unpredictable here */
+    while (len > 1)
+    {
+      size_t half = len / 2;
+      base += base[half - 1] < key ? half : 0;
+      len -= half;
+    }
+
+    return base - keys + (len == 1 and *base < key);
+  }
+
+  inline
+  void consolidated_book::_set(levels& side, size_t i, uint16_t venue, const dfloat& size)
+  {
+    dfloat* sizes = side.sizes.data() + i * num_venues_;
+
+    bool was = _book_positive(sizes[venue]);
+    bool now = _book_positive(size);
+
+    sizes[venue] = now ? size : dfloat(0);
+    side.venues[i] = side.venues[i] + (now ? 1 : 0) - (was ? 1 : 0);
+  }
+
+  inline
+  void consolidated_book::_erase(levels& side, size_t i)
+  {
+    side.keys.erase(side.keys.begin() + i);
+    side.venues.erase(side.venues.begin() + i);
+    side.sizes.erase(side.sizes.begin() + i * num_venues_, side.sizes.begin() + (i + 1) * num_venues_);
+  }
+
+  inline
+  void consolidated_book::apply(const book_update& update)
+  {
+    if (update.venue >= num_venues_ or not dfloat::isfinite(update.price))
+    {
+      return;
+    }
+
+    levels& side = _levels(update.side);
+    dfloat::mant2_t key = _side_key(update.side, update.price);
+
+    size_t i = _find(side, key);
+    bool exists = i < side.keys.size() and side.keys[i] == key;
+
+    if (not exists)
+    {
+      if (not _book_positive(update.size))
+      {
+        return;
+      }
+
+      side.keys.insert(side.keys.begin() + i, key);
+      side.venues.insert(side.venues.begin() + i, 0);
+      side.sizes.insert(side.sizes.begin() + i * num_venues_, num_venues_, dfloat(0));
+    }
+
+    _set(side, i, update.venue, update.size);
+
+    if (side.venues[i] == 0)
+    {
+      _erase(side, i);
+    }
+  }
+
+  inline
+  void consolidated_book::apply(const book_update* updates, size_t count)
+  {
+    /*
+      A merge rewrites the whole side, so it only pays off when the batch is
+      not small next to the book, e.g. a snapshot; streams of updates near
+      the top of the book shift few elements when applied one by one
+    */
+    constexpr size_t MERGE_THRESHOLD = 64;
+    constexpr size_t MERGE_RATIO = 4;
+
+    size_t depth = bids_.keys.size() + asks_.keys.size();
+
+    if (count < MERGE_THRESHOLD or count * MERGE_RATIO < depth)
+    {
+      for (size_t i = 0; i < count; i++)
+      {
+        apply(updates[i]);
+      }
+      return;
+    }
+
+    for (book_side s : {book_side::BID, book_side::ASK})
+    {
+      sorted_.clear();
+
+      for (size_t i = 0; i < count; i++)
+      {
+        const book_update& u = updates[i];
+
+        if (u.side == s and u.venue < num_venues_ and dfloat::isfinite(u.price))
+        {
+          sorted_.emplace_back(_side_key(s, u.price), &u);
+        }
+      }
+
+      /* stable, so updates to the same level keep their order */
+      std::stable_sort(sorted_.begin(), sorted_.end(),
+        [](const std::pair<dfloat::mant2_t, const book_update*>& a, const std::pair<dfloat::mant2_t, const book_update*>& b)
+        {
+          return a.first < b.first;
+        });
+
+      if (not sorted_.empty())
+      {
+        _merge(_levels(s), sorted_);
+      }
+    }
+  }
+
+  inline
+  void consolidated_book::_merge(levels& side, const std::vector<std::pair<dfloat::mant2_t, const book_update*>>& updates)
+  {
+    levels& out = scratch_;
+
+    out.keys.clear();
+    out.venues.clear();
+    out.sizes.clear();
+
+    size_t n = side.keys.size();
+    size_t m = updates.size();
+    size_t i = 0;
+    size_t j = 0;
+
+    auto copy_level = [&](size_t k)
+    {
+      out.keys.push_back(side.keys[k]);
+      out.venues.push_back(side.venues[k]);
+      out.sizes.insert(out.sizes.end(), side.sizes.begin() + k * num_venues_, side.sizes.begin() + (k + 1) * num_venues_);
+    };
+
+    while (i < n or j < m)
+    {
+      if (j == m or (i < n and side.keys[i] < updates[j].first))
+      {
+        copy_level(i++);
+        continue;
+      }
+
+      dfloat::mant2_t key = updates[j].first;
+
+      if (i < n and side.keys[i] == key)
+      {
+        copy_level(i++);
+      }
+      else
+      {
+        out.keys.push_back(key);
+        out.venues.push_back(0);
+        out.sizes.insert(out.sizes.end(), num_venues_, dfloat(0));
+      }
+
+      size_t last = out.keys.size() - 1;
+
+      for (; j < m and updates[j].first == key; j++)
+      {
+        _set(out, last, updates[j].second->venue, updates[j].second->size);
+      }
+
+      if (out.venues[last] == 0)
+      {
+        _erase(out, last);
+      }
+    }
+
+    std::swap(side.keys, out.keys);
+    std::swap(side.venues, out.venues);
+    std::swap(side.sizes, out.sizes);
+  }
+
+  inline
+  void consolidated_book::clear_venue(uint16_t venue)
+  {
+    if (venue >= num_venues_)
+    {
+      return;
+    }
+
+    for (levels* side : {&bids_, &asks_})
+    {
+      size_t kept = 0;
+
+      for (size_t i = 0; i < side->keys.size(); i++)
+      {
+        _set(*side, i, venue, dfloat(0));
+
+        if (side->venues[i] == 0)
+        {
+          continue;
+        }
+
+        if (kept != i)
+        {
+          side->keys[kept] = side->keys[i];
+          side->venues[kept] = side->venues[i];
+          std::copy(side->sizes.begin() + i * num_venues_, side->sizes.begin() + (i + 1) * num_venues_,
+            side->sizes.begin() + kept * num_venues_);
+        }
+
+        kept++;
+      }
+
+      side->keys.resize(kept);
+      side->venues.resize(kept);
+      side->sizes.resize(kept * num_venues_);
+    }
+  }
+
+  inline
+  void consolidated_book::clear()
+  {
+    for (levels* side : {&bids_, &asks_})
+    {
+      side->keys.clear();
+      side->venues.clear();
+      side->sizes.clear();
+    }
+  }
+
+  inline
+  bool consolidated_book::best(book_side side, book_level& level) const
+  {
+    if (depth(side) == 0)
+    {
+      return false;
+    }
+
+    level = this->level(side, 0);
+    return true;
+  }
+
+  inline
+  size_t consolidated_book::depth(book_side side) const
+  {
+    return _levels(side).keys.size();
+  }
+
+  inline
+  book_level consolidated_book::level(book_side side, size_t i) const
+  {
+    const levels& s = _levels(side);
+    size_t k = s.keys.size() - 1 - i;
+
+    const dfloat* sizes = s.sizes.data() + k * num_venues_;
+
+    dfloat total = 0;
+    for (size_t v = 0; v < num_venues_; v++)
+    {
+      total += sizes[v];
+    }
+
+    return {_price(side, s.keys[k]), total, s.venues[k]};
+  }
+
+  inline
+  dfloat consolidated_book::venue_size(book_side side, const dfloat& price, uint16_t venue) const
+  {
+    const levels& s = _levels(side);
+
+    if (venue >= num_venues_ or not dfloat::isfinite(price))
+    {
+      return 0;
+    }
+
+    dfloat::mant2_t key = _side_key(side, price);
+    size_t i = _find(s, key);
+
+    if (i < s.keys.size() and s.keys[i] == key)
+    {
+      return s.sizes[i * num_venues_ + venue];
+    }
+
+    return 0;
+  }
+}
@@ -0,0 +1,302 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  Run `fn(begin, end)` over [0, count) split into contiguous ranges
+            on up to `threads` threads
+    @note   Ranges are multiples of `block` elements (except the last), so
+            that each thread works on its own cache lines
+    @note   If `threads` is 0 or 1, `fn` is called once on the calling thread
+    */
+  template <typename F>
+  void parallel_blocks(size_t count, size_t threads, size_t block, F fn);
+
+  /**
+    @brief  Base of all lazy column expressions (CRTP)
+            An expression is only evaluated when it is assigned to a
+            `dfloat_column`, one element at a time, so no intermediate column
+            is ever materialized
+    */
+  template <typename E>
+  struct column_expr
+  {
+    const E& self() const;
+
+    size_t size() const;
+
+    dfloat operator[](size_t idx) const;
+  };
+
+  /**
+    @brief  Contiguous column of dfloat values
+    */
+  class dfloat_column : public column_expr<dfloat_column>
+  {
+  public:
+    using value_type = dfloat;
+    using iterator = std::vector<dfloat>::iterator;
+    using const_iterator = std::vector<dfloat>::const_iterator;
+
+    /**
+      @brief  Number of elements evaluated per block when assigning an
+              expression
+      */
+    static constexpr size_t BLOCK_SIZE = 4096;
+
+  public:
+    dfloat_column() = default;
+
+    /**
+      @brief  Construct column of `count` uninitialized values
+      */
+    explicit dfloat_column(size_t count);
+
+    dfloat_column(size_t count, const dfloat& value);
+
+    dfloat_column(std::initializer_list<dfloat> values);
+
+    dfloat_column(const dfloat_column& other) = default;
+
+    dfloat_column& operator=(const dfloat_column& other) = default;
+
+    dfloat_column(dfloat_column&& other) = default;
+
+    dfloat_column& operator=(dfloat_column&& other) = default;
+
+    /**
+      @brief  Evaluate expression into a new column
+      */
+    template <typename E>
+    dfloat_column(const column_expr<E>& expr);
+
+    /**
+      @brief  Evaluate expression into this column in a single fused pass
+      @note   The column may appear in the expression itself, since each
+              element only depends on the operands at the same index
+      */
+    template <typename E>
+    dfloat_column& operator=(const column_expr<E>& expr);
+
+    /**
+      @brief  Evaluate expression into this column, splitting the work into
+              blocks across `threads` threads
+      */
+    template <typename E>
+    dfloat_column& assign(const column_expr<E>& expr, size_t threads);
+
+    size_t size() const;
+
+    void resize(size_t count);
+
+    dfloat* data();
+
+    const dfloat* data() const;
+
+    dfloat& operator[](size_t idx);
+
+    const dfloat& operator[](size_t idx) const;
+
+    iterator begin();
+
+    iterator end();
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+  private:
+    std::vector<dfloat> values_;
+  };
+
+  /**
+    @brief  Selects how an operand is held inside an expression node
+            Columns are held by reference and must outlive the expression,
+            everything else (sub-expressions, scalars) is held by value
+    */
+  template <typename E>
+  struct expr_operand
+  {
+    using type = const E;
+  };
+
+  template <>
+  struct expr_operand<dfloat_column>
+  {
+    using type = const dfloat_column&;
+  };
+
+  /**
+    @brief  A dfloat broadcast over every index
+    */
+  struct scalar_expr : public column_expr<scalar_expr>
+  {
+    dfloat value;
+    size_t count;
+
+    scalar_expr(const dfloat& value_, size_t count_);
+
+    size_t size() const;
+
+    dfloat operator[](size_t idx) const;
+  };
+
+  struct add_op { static dfloat apply(const dfloat& a, const dfloat& b); };
+  struct sub_op { static dfloat apply(const dfloat& a, const dfloat& b); };
+  struct mul_op { static dfloat apply(const dfloat& a, const dfloat& b); };
+  struct div_op { static dfloat apply(const dfloat& a, const dfloat& b); };
+
+  /**
+    @brief  Element-wise binary operation
+    @note   Operands must have the same size, otherwise behavior is undefined
+    */
+  template <typename Op, typename L, typename R>
+  struct binary_expr : public column_expr<binary_expr<Op, L, R>>
+  {
+    typename expr_operand<L>::type lhs;
+    typename expr_operand<R>::type rhs;
+
+    binary_expr(const L& lhs_, const R& rhs_);
+
+    size_t size() const;
+
+    dfloat operator[](size_t idx) const;
+  };
+
+  /**
+    @brief  Element-wise negation
+    */
+  template <typename E>
+  struct negate_expr : public column_expr<negate_expr<E>>
+  {
+    typename expr_operand<E>::type operand;
+
+    explicit negate_expr(const E& operand_);
+
+    size_t size() const;
+
+    dfloat operator[](size_t idx) const;
+  };
+
+  /**
+    @brief  Element-wise fused multiply-add `a * b + c`
+            Built automatically from a sum (or difference) whose operand is a
+            product, and evaluated with `dfloat::fma`
+    */
+  template <typename A, typename B, typename C>
+  struct fma_expr : public column_expr<fma_expr<A, B, C>>
+  {
+    typename expr_operand<A>::type a;
+    typename expr_operand<B>::type b;
+    typename expr_operand<C>::type c;
+
+    fma_expr(const A& a_, const B& b_, const C& c_);
+
+    size_t size() const;
+
+    dfloat operator[](size_t idx) const;
+  };
+
+  template <typename L, typename R>
+  using mul_expr = binary_expr<mul_op, L, R>;
+
+  //  =========
+  //  Operators
+  //  =========
+
+  template <typename L, typename R>
+  binary_expr<add_op, L, R> operator+(const column_expr<L>& l, const column_expr<R>& r);
+
+  template <typename L, typename R>
+  binary_expr<sub_op, L, R> operator-(const column_expr<L>& l, const column_expr<R>& r);
+
+  template <typename L, typename R>
+  mul_expr<L, R> operator*(const column_expr<L>& l, const column_expr<R>& r);
+
+  template <typename L, typename R>
+  binary_expr<div_op, L, R> operator/(const column_expr<L>& l, const column_expr<R>& r);
+
+  template <typename E>
+  negate_expr<E> operator-(const column_expr<E>& e);
+
+  /* a * b + c */
+  template <typename A, typename B, typename C>
+  fma_expr<A, B, C> operator+(const column_expr<mul_expr<A, B>>& l, const column_expr<C>& r);
+
+  /* c + a * b */
+  template <typename A, typename B, typename C>
+  fma_expr<A, B, C> operator+(const column_expr<C>& l, const column_expr<mul_expr<A, B>>& r);
+
+  /* a * b + c * d, only the first product is fused */
+  template <typename A, typename B, typename C, typename D>
+  fma_expr<A, B, mul_expr<C, D>> operator+(const column_expr<mul_expr<A, B>>& l, const column_expr<mul_expr<C, D>>& r);
+
+  /* a * b - c */
+  template <typename A, typename B, typename C>
+  fma_expr<A, B, negate_expr<C>> operator-(const column_expr<mul_expr<A, B>>& l, const column_expr<C>& r);
+
+  /* c - a * b */
+  template <typename A, typename B, typename C>
+  fma_expr<negate_expr<A>, B, C> operator-(const column_expr<C>& l, const column_expr<mul_expr<A, B>>& r);
+
+  /* a * b - c * d, only the first product is fused */
+  template <typename A, typename B, typename C, typename D>
+  fma_expr<A, B, negate_expr<mul_expr<C, D>>> operator-(const column_expr<mul_expr<A, B>>& l, const column_expr<mul_expr<C, D>>& r);
+
+  /*
+    Scalar operands are broadcast to the size of the column operand
+  */
+
+  template <typename E>
+  binary_expr<add_op, E, scalar_expr> operator+(const column_expr<E>& l, const dfloat& r);
+
+  template <typename E>
+  binary_expr<add_op, scalar_expr, E> operator+(const dfloat& l, const column_expr<E>& r);
+
+  template <typename E>
+  binary_expr<sub_op, E, scalar_expr> operator-(const column_expr<E>& l, const dfloat& r);
+
+  template <typename E>
+  binary_expr<sub_op, scalar_expr, E> operator-(const dfloat& l, const column_expr<E>& r);
+
+  template <typename E>
+  mul_expr<E, scalar_expr> operator*(const column_expr<E>& l, const dfloat& r);
+
+  template <typename E>
+  mul_expr<scalar_expr, E> operator*(const dfloat& l, const column_expr<E>& r);
+
+  template <typename E>
+  binary_expr<div_op, E, scalar_expr> operator/(const column_expr<E>& l, const dfloat& r);
+
+  template <typename E>
+  binary_expr<div_op, scalar_expr, E> operator/(const dfloat& l, const column_expr<E>& r);
+}
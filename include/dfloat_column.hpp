@@ -0,0 +1,460 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <thread>
+#include "dfloat.hpp"
+#include "dfloat_column.h"
+
+namespace xu
+{
+  template <typename F>
+  inline
+  void parallel_blocks(size_t count, size_t threads, size_t block, F fn)
+  {
+    if (threads <= 1 or count <= block)
+    {
+      fn((size_t)0, count);
+      return;
+    }
+
+    /* round each thread's share up to a whole number of blocks */
+    size_t blocks = (count + block - 1) / block;
+    size_t blocks_per_thread = (blocks + threads - 1) / threads;
+    size_t range = blocks_per_thread * block;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    for (size_t begin = 0; begin < count; begin += range)
+    {
+      size_t end = begin + range < count ? begin + range : count;
+
+      workers.emplace_back(
+        [&fn, begin, end]()
+        {
+          fn(begin, end);
+        });
+    }
+
+    for (std::thread& worker : workers)
+    {
+      worker.join();
+    }
+  }
+
+  template <typename E>
+  inline
+  const E& column_expr<E>::self() const
+  {
+    return static_cast<const E&>(*this);
+  }
+
+  template <typename E>
+  inline
+  size_t column_expr<E>::size() const
+  {
+    return self().size();
+  }
+
+  template <typename E>
+  inline
+  dfloat column_expr<E>::operator[](size_t idx) const
+  {
+    return self()[idx];
+  }
+
+  inline
+  dfloat_column::dfloat_column(size_t count)
+    : values_(count)
+  {
+
+  }
+
+  inline
+  dfloat_column::dfloat_column(size_t count, const dfloat& value)
+    : values_(count, value)
+  {
+
+  }
+
+  inline
+  dfloat_column::dfloat_column(std::initializer_list<dfloat> values)
+    : values_(values)
+  {
+
+  }
+
+  template <typename E>
+  inline
+  dfloat_column::dfloat_column(const column_expr<E>& expr)
+  {
+    operator=(expr);
+  }
+
+  template <typename E>
+  inline
+  dfloat_column& dfloat_column::operator=(const column_expr<E>& expr)
+  {
+    return assign(expr, 1);
+  }
+
+  template <typename E>
+  inline
+  dfloat_column& dfloat_column::assign(const column_expr<E>& expr, size_t threads)
+  {
+    const E& e = expr.self();
+
+    size_t count = e.size();
+
+    /*
+      Only resize when necessary: if this column appears in the expression,
+      reallocating would leave the expression reading freed memory
+    */
+    if (values_.size() != count)
+    {
+      values_.resize(count);
+    }
+
+    dfloat* out = values_.data();
+
+    parallel_blocks(count, threads, BLOCK_SIZE,
+      [out, &e](size_t begin, size_t end)
+      {
+        for (size_t i = begin; i < end; i++)
+        {
+          out[i] = e[i];
+        }
+      });
+
+    return *this;
+  }
+
+  inline
+  size_t dfloat_column::size() const
+  {
+    return values_.size();
+  }
+
+  inline
+  void dfloat_column::resize(size_t count)
+  {
+    values_.resize(count);
+  }
+
+  inline
+  dfloat* dfloat_column::data()
+  {
+    return values_.data();
+  }
+
+  inline
+  const dfloat* dfloat_column::data() const
+  {
+    return values_.data();
+  }
+
+  inline
+  dfloat& dfloat_column::operator[](size_t idx)
+  {
+    return values_[idx];
+  }
+
+  inline
+  const dfloat& dfloat_column::operator[](size_t idx) const
+  {
+    return values_[idx];
+  }
+
+  inline
+  dfloat_column::iterator dfloat_column::begin()
+  {
+    return values_.begin();
+  }
+
+  inline
+  dfloat_column::iterator dfloat_column::end()
+  {
+    return values_.end();
+  }
+
+  inline
+  dfloat_column::const_iterator dfloat_column::begin() const
+  {
+    return values_.begin();
+  }
+
+  inline
+  dfloat_column::const_iterator dfloat_column::end() const
+  {
+    return values_.end();
+  }
+
+  inline
+  scalar_expr::scalar_expr(const dfloat& value_, size_t count_)
+    : value(value_),
+      count(count_)
+  {
+
+  }
+
+  inline
+  size_t scalar_expr::size() const
+  {
+    return count;
+  }
+
+  inline
+  dfloat scalar_expr::operator[](size_t) const
+  {
+    return value;
+  }
+
+  inline
+  dfloat add_op::apply(const dfloat& a, const dfloat& b)
+  {
+    return a + b;
+  }
+
+  inline
+  dfloat sub_op::apply(const dfloat& a, const dfloat& b)
+  {
+    return a - b;
+  }
+
+  inline
+  dfloat mul_op::apply(const dfloat& a, const dfloat& b)
+  {
+    return a * b;
+  }
+
+  inline
+  dfloat div_op::apply(const dfloat& a, const dfloat& b)
+  {
+    return a / b;
+  }
+
+  template <typename Op, typename L, typename R>
+  inline
+  binary_expr<Op, L, R>::binary_expr(const L& lhs_, const R& rhs_)
+    : lhs(lhs_),
+      rhs(rhs_)
+  {
+
+  }
+
+  template <typename Op, typename L, typename R>
+  inline
+  size_t binary_expr<Op, L, R>::size() const
+  {
+    return lhs.size();
+  }
+
+  template <typename Op, typename L, typename R>
+  inline
+  dfloat binary_expr<Op, L, R>::operator[](size_t idx) const
+  {
+    return Op::apply(lhs[idx], rhs[idx]);
+  }
+
+  template <typename E>
+  inline
+  negate_expr<E>::negate_expr(const E& operand_)
+    : operand(operand_)
+  {
+
+  }
+
+  template <typename E>
+  inline
+  size_t negate_expr<E>::size() const
+  {
+    return operand.size();
+  }
+
+  template <typename E>
+  inline
+  dfloat negate_expr<E>::operator[](size_t idx) const
+  {
+    return -operand[idx];
+  }
+
+  template <typename A, typename B, typename C>
+  inline
+  fma_expr<A, B, C>::fma_expr(const A& a_, const B& b_, const C& c_)
+    : a(a_),
+      b(b_),
+      c(c_)
+  {
+
+  }
+
+  template <typename A, typename B, typename C>
+  inline
+  size_t fma_expr<A, B, C>::size() const
+  {
+    return a.size();
+  }
+
+  template <typename A, typename B, typename C>
+  inline
+  dfloat fma_expr<A, B, C>::operator[](size_t idx) const
+  {
+    return dfloat::fma(a[idx], b[idx], c[idx]);
+  }
+
+  template <typename L, typename R>
+  inline
+  binary_expr<add_op, L, R> operator+(const column_expr<L>& l, const column_expr<R>& r)
+  {
+    return binary_expr<add_op, L, R>(l.self(), r.self());
+  }
+
+  template <typename L, typename R>
+  inline
+  binary_expr<sub_op, L, R> operator-(const column_expr<L>& l, const column_expr<R>& r)
+  {
+    return binary_expr<sub_op, L, R>(l.self(), r.self());
+  }
+
+  template <typename L, typename R>
+  inline
+  mul_expr<L, R> operator*(const column_expr<L>& l, const column_expr<R>& r)
+  {
+    return mul_expr<L, R>(l.self(), r.self());
+  }
+
+  template <typename L, typename R>
+  inline
+  binary_expr<div_op, L, R> operator/(const column_expr<L>& l, const column_expr<R>& r)
+  {
+    return binary_expr<div_op, L, R>(l.self(), r.self());
+  }
+
+  template <typename E>
+  inline
+  negate_expr<E> operator-(const column_expr<E>& e)
+  {
+    return negate_expr<E>(e.self());
+  }
+
+  template <typename A, typename B, typename C>
+  inline
+  fma_expr<A, B, C> operator+(const column_expr<mul_expr<A, B>>& l, const column_expr<C>& r)
+  {
+    return fma_expr<A, B, C>(l.self().lhs, l.self().rhs, r.self());
+  }
+
+  template <typename A, typename B, typename C>
+  inline
+  fma_expr<A, B, C> operator+(const column_expr<C>& l, const column_expr<mul_expr<A, B>>& r)
+  {
+    return fma_expr<A, B, C>(r.self().lhs, r.self().rhs, l.self());
+  }
+
+  template <typename A, typename B, typename C, typename D>
+  inline
+  fma_expr<A, B, mul_expr<C, D>> operator+(const column_expr<mul_expr<A, B>>& l, const column_expr<mul_expr<C, D>>& r)
+  {
+    return fma_expr<A, B, mul_expr<C, D>>(l.self().lhs, l.self().rhs, r.self());
+  }
+
+  template <typename A, typename B, typename C>
+  inline
+  fma_expr<A, B, negate_expr<C>> operator-(const column_expr<mul_expr<A, B>>& l, const column_expr<C>& r)
+  {
+    return fma_expr<A, B, negate_expr<C>>(l.self().lhs, l.self().rhs, negate_expr<C>(r.self()));
+  }
+
+  template <typename A, typename B, typename C>
+  inline
+  fma_expr<negate_expr<A>, B, C> operator-(const column_expr<C>& l, const column_expr<mul_expr<A, B>>& r)
+  {
+    return fma_expr<negate_expr<A>, B, C>(negate_expr<A>(r.self().lhs), r.self().rhs, l.self());
+  }
+
+  template <typename A, typename B, typename C, typename D>
+  inline
+  fma_expr<A, B, negate_expr<mul_expr<C, D>>> operator-(const column_expr<mul_expr<A, B>>& l, const column_expr<mul_expr<C, D>>& r)
+  {
+    return fma_expr<A, B, negate_expr<mul_expr<C, D>>>(l.self().lhs, l.self().rhs, negate_expr<mul_expr<C, D>>(r.self()));
+  }
+
+  template <typename E>
+  inline
+  binary_expr<add_op, E, scalar_expr> operator+(const column_expr<E>& l, const dfloat& r)
+  {
+    return binary_expr<add_op, E, scalar_expr>(l.self(), scalar_expr(r, l.size()));
+  }
+
+  template <typename E>
+  inline
+  binary_expr<add_op, scalar_expr, E> operator+(const dfloat& l, const column_expr<E>& r)
+  {
+    return binary_expr<add_op, scalar_expr, E>(scalar_expr(l, r.size()), r.self());
+  }
+
+  template <typename E>
+  inline
+  binary_expr<sub_op, E, scalar_expr> operator-(const column_expr<E>& l, const dfloat& r)
+  {
+    return binary_expr<sub_op, E, scalar_expr>(l.self(), scalar_expr(r, l.size()));
+  }
+
+  template <typename E>
+  inline
+  binary_expr<sub_op, scalar_expr, E> operator-(const dfloat& l, const column_expr<E>& r)
+  {
+    return binary_expr<sub_op, scalar_expr, E>(scalar_expr(l, r.size()), r.self());
+  }
+
+  template <typename E>
+  inline
+  mul_expr<E, scalar_expr> operator*(const column_expr<E>& l, const dfloat& r)
+  {
+    return mul_expr<E, scalar_expr>(l.self(), scalar_expr(r, l.size()));
+  }
+
+  template <typename E>
+  inline
+  mul_expr<scalar_expr, E> operator*(const dfloat& l, const column_expr<E>& r)
+  {
+    return mul_expr<scalar_expr, E>(scalar_expr(l, r.size()), r.self());
+  }
+
+  template <typename E>
+  inline
+  binary_expr<div_op, E, scalar_expr> operator/(const column_expr<E>& l, const dfloat& r)
+  {
+    return binary_expr<div_op, E, scalar_expr>(l.self(), scalar_expr(r, l.size()));
+  }
+
+  template <typename E>
+  inline
+  binary_expr<div_op, scalar_expr, E> operator/(const dfloat& l, const column_expr<E>& r)
+  {
+    return binary_expr<div_op, scalar_expr, E>(scalar_expr(l, r.size()), r.self());
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  Maximum size of a compact encoding
+    */
+  constexpr size_t COMPACT_MAX_SIZE = 10;
+
+  /**
+    @brief  Write `d` in the compact canonical encoding: the exponent as one
+            byte, then the coefficient as a zigzag varint, from
+            `dfloat::to_decimal`; nan is the single byte 0x80
+    @note   Every value has exactly one encoding, so equal values have equal
+            bytes, e.g. 123.45 is {0xfe, 0xf2, 0xc0, 0x01}
+    @return number of bytes written, at most COMPACT_MAX_SIZE
+    */
+  size_t encode_compact(const dfloat& d, char* dst);
+
+  /**
+    @brief  Read one compact encoding from [src, src + size)
+    @return number of bytes read, or 0 if truncated or not canonical
+            (overlong varint, trailing zeros in the coefficient, exponent
+            out of range)
+    */
+  size_t decode_compact(const char* src, size_t size, dfloat& out);
+
+  /**
+    @brief  Write an unsigned LEB128 varint
+    @return number of bytes written, at most 10
+    */
+  size_t encode_varint(uint64_t x, char* dst);
+
+  /**
+    @brief  Read an unsigned LEB128 varint
+    @return number of bytes read, or 0 if truncated or overlong
+    */
+  size_t decode_varint(const char* src, size_t size, uint64_t& x);
+}
@@ -0,0 +1,146 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include "dfloat.hpp"
+#include "dfloat_compact.h"
+
+namespace xu
+{
+  inline
+  size_t encode_varint(uint64_t x, char* dst)
+  {
+    size_t n = 0;
+
+    while (x >= 0x80)
+    {
+      dst[n++] = (char)(uint8_t)(x | 0x80);
+      x >>= 7;
+    }
+
+    dst[n++] = (char)(uint8_t)x;
+
+    return n;
+  }
+
+  inline
+  size_t decode_varint(const char* src, size_t size, uint64_t& x)
+  {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(src);
+
+    uint64_t v = 0;
+
+    for (size_t n = 0; n < size and n < 10; n++)
+    {
+      uint8_t byte = p[n];
+
+      /* the tenth byte holds only the top bit */
+      if (n == 9 and byte > 1)
+      {
+        return 0;
+      }
+
+      v |= (uint64_t)(byte & 0x7f) << (7 * n);
+
+      if ((byte & 0x80) == 0)
+      {
+        /* a zero final byte after the first is overlong */
+        if (n > 0 and byte == 0)
+        {
+          return 0;
+        }
+
+        x = v;
+        return n + 1;
+      }
+    }
+
+    return 0;
+  }
+
+  /* exponent byte of nan, outside the range of `to_decimal` */
+  constexpr int8_t COMPACT_NAN = -128;
+
+  inline
+  size_t encode_compact(const dfloat& d, char* dst)
+  {
+    int64_t coef;
+    dfloat::pow2_t exp;
+
+    if (not d.to_decimal(coef, exp))
+    {
+      dst[0] = (char)COMPACT_NAN;
+      return 1;
+    }
+
+    uint64_t zigzag = ((uint64_t)coef << 1) ^ (uint64_t)(coef >> 63);
+
+    dst[0] = (char)(int8_t)exp;
+
+    return 1 + encode_varint(zigzag, dst + 1);
+  }
+
+  inline
+  size_t decode_compact(const char* src, size_t size, dfloat& out)
+  {
+    if (size < 1)
+    {
+      return 0;
+    }
+
+    int8_t exp = (int8_t)src[0];
+
+    if (exp == COMPACT_NAN)
+    {
+      out = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+      return 1;
+    }
+
+    uint64_t zigzag;
+    size_t n = decode_varint(src + 1, size - 1, zigzag);
+
+    if (n == 0)
+    {
+      return 0;
+    }
+
+    int64_t coef = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+
+    dfloat d = dfloat::from_scaled(coef, exp);
+
+    /* canonical only if this is exactly what encoding `d` would produce */
+    int64_t check_coef;
+    dfloat::pow2_t check_exp;
+
+    if (not d.to_decimal(check_coef, check_exp) or check_coef != coef or check_exp != exp)
+    {
+      return 0;
+    }
+
+    out = d;
+
+    return 1 + n;
+  }
+}
@@ -0,0 +1,66 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace xu
+{
+  /**
+    @brief  Byte order of a field in a buffer
+    */
+  enum class byte_order : uint8_t
+  {
+    LITTLE,
+    BIG
+  };
+
+  /**
+    @brief  Byte order of this machine
+    */
+  constexpr byte_order NATIVE_ORDER =
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ ? byte_order::BIG : byte_order::LITTLE;
+
+  /**
+    @brief  Read an integer of type `T` stored in `Order` at any address
+    @note   Compiles to a plain (possibly unaligned) load, plus a byte swap
+            if `Order` is not the native order
+    */
+  template <byte_order Order, typename T>
+  T load(const char* src);
+
+  /**
+    @brief  Write an integer of type `T` in `Order` at any address
+    */
+  template <byte_order Order, typename T>
+  void store(T value, char* dst);
+
+  /**
+    @brief  Reverse the bytes of an integer
+    */
+  template <typename T>
+  T byteswap(T value);
+}
@@ -0,0 +1,86 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+#include "dfloat_endian.h"
+
+namespace xu
+{
+  template <typename T>
+  inline
+  T byteswap(T value)
+  {
+    static_assert(std::is_integral<T>::value, "byteswap requires an integer type");
+
+    using U = typename std::make_unsigned<T>::type;
+
+    U u = (U)value;
+
+    switch (sizeof(T))
+    {
+      case 1:
+        break;
+      case 2:
+        u = (U)__builtin_bswap16((uint16_t)u);
+        break;
+      case 4:
+        u = (U)__builtin_bswap32((uint32_t)u);
+        break;
+      case 8:
+        u = (U)__builtin_bswap64((uint64_t)u);
+        break;
+    }
+
+    return (T)u;
+  }
+
+  template <byte_order Order, typename T>
+  inline
+  T load(const char* src)
+  {
+    static_assert(std::is_integral<T>::value, "load requires an integer type");
+
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+
+    return Order == NATIVE_ORDER ? value : byteswap(value);
+  }
+
+  template <byte_order Order, typename T>
+  inline
+  void store(T value, char* dst)
+  {
+    static_assert(std::is_integral<T>::value, "store requires an integer type");
+
+    if (Order != NATIVE_ORDER)
+    {
+      value = byteswap(value);
+    }
+
+    std::memcpy(dst, &value, sizeof(T));
+  }
+}
@@ -0,0 +1,370 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "dfloat_generator.h requires C++20 coroutines (-std=c++20)"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <istream>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include "dfloat.h"
+#include "dfloat_locale.h"
+
+namespace xu
+{
+  /**
+    @brief  Synchronous generator: a coroutine which `co_yield`s values of
+            type `T`, consumed with a range-for loop
+    @note   The coroutine runs only when the consumer asks for the next
+            value, so a chain of generators processes one batch at a time
+            from source to sink without materializing anything in between
+    @note   The yielded value is referenced, not copied; it stays valid until
+            the consumer advances
+    @note   The coroutine frame is the only allocation, made once when the
+            stage is created
+    */
+  template <typename T>
+  class generator
+  {
+  public:
+    struct promise_type
+    {
+      const T* value_ = nullptr;
+      std::exception_ptr error_;
+
+      generator get_return_object();
+
+      std::suspend_always initial_suspend() noexcept;
+
+      std::suspend_always final_suspend() noexcept;
+
+      std::suspend_always yield_value(const T& value) noexcept;
+
+      void return_void() noexcept;
+
+      void unhandled_exception();
+
+      /* a synchronous generator cannot wait for anything */
+      template <typename U>
+      std::suspend_never await_transform(U&& value) = delete;
+    };
+
+    class iterator
+    {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using difference_type = std::ptrdiff_t;
+      using value_type = T;
+      using reference = const T&;
+      using pointer = const T*;
+
+      iterator() = default;
+
+      explicit iterator(std::coroutine_handle<promise_type> handle);
+
+      iterator& operator++();
+
+      void operator++(int);
+
+      reference operator*() const;
+
+      pointer operator->() const;
+
+      bool operator==(std::default_sentinel_t) const;
+
+    private:
+      std::coroutine_handle<promise_type> handle_;
+    };
+
+  public:
+    generator() = default;
+
+    explicit generator(std::coroutine_handle<promise_type> handle);
+
+    generator(generator&& other) noexcept;
+
+    generator& operator=(generator&& other) noexcept;
+
+    generator(const generator& other) = delete;
+
+    generator& operator=(const generator& other) = delete;
+
+    ~generator();
+
+    /**
+      @brief  Run the coroutine up to its first value
+      @note   May only be called once
+      */
+    iterator begin();
+
+    std::default_sentinel_t end() const;
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+  };
+
+  /**
+    @brief  Asynchronous generator: a coroutine which may `co_await` (e.g.
+            another async stage) between the values it `co_yield`s
+    @note   Consumed from another coroutine with `co_await gen.next()`,
+            which gives a pointer to the next value, or nullptr at the end
+    @note   Control passes directly between producer and consumer (symmetric
+            transfer), there is no scheduler
+    */
+  template <typename T>
+  class async_generator
+  {
+  public:
+    struct promise_type
+    {
+      const T* value_ = nullptr;
+      std::exception_ptr error_;
+      std::coroutine_handle<> consumer_;
+
+      struct resume_consumer
+      {
+        bool await_ready() noexcept;
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+
+        void await_resume() noexcept;
+      };
+
+      async_generator get_return_object();
+
+      std::suspend_always initial_suspend() noexcept;
+
+      resume_consumer final_suspend() noexcept;
+
+      resume_consumer yield_value(const T& value) noexcept;
+
+      void return_void() noexcept;
+
+      void unhandled_exception();
+    };
+
+    struct next_awaiter
+    {
+      std::coroutine_handle<promise_type> handle_;
+
+      bool await_ready() noexcept;
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept;
+
+      const T* await_resume();
+    };
+
+  public:
+    async_generator() = default;
+
+    explicit async_generator(std::coroutine_handle<promise_type> handle);
+
+    async_generator(async_generator&& other) noexcept;
+
+    async_generator& operator=(async_generator&& other) noexcept;
+
+    async_generator(const async_generator& other) = delete;
+
+    async_generator& operator=(const async_generator& other) = delete;
+
+    ~async_generator();
+
+    /**
+      @brief  Resume the producer until it yields or finishes
+      @return Awaitable giving the yielded value, or nullptr once finished
+      */
+    next_awaiter next();
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+  };
+
+  /**
+    @brief  Lazily started coroutine producing one `T`, e.g. the sink of an
+            async pipeline
+    @note   Started by `co_await` from another coroutine, or by `sync_wait`
+    */
+  template <typename T>
+  class task
+  {
+  public:
+    struct promise_type
+    {
+      T value_ = T();
+      std::exception_ptr error_;
+      std::coroutine_handle<> continuation_;
+      std::atomic<bool> finished_ {false};
+
+      struct final_awaiter
+      {
+        bool await_ready() noexcept;
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+
+        void await_resume() noexcept;
+      };
+
+      task get_return_object();
+
+      std::suspend_always initial_suspend() noexcept;
+
+      final_awaiter final_suspend() noexcept;
+
+      void return_value(T value);
+
+      void unhandled_exception();
+    };
+
+    struct awaiter
+    {
+      std::coroutine_handle<promise_type> handle_;
+
+      bool await_ready() noexcept;
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept;
+
+      T await_resume();
+    };
+
+  public:
+    explicit task(std::coroutine_handle<promise_type> handle);
+
+    task(task&& other) noexcept;
+
+    task(const task& other) = delete;
+
+    task& operator=(const task& other) = delete;
+
+    ~task();
+
+    awaiter operator co_await() && noexcept;
+
+    /**
+      @brief  Run the task and block until it finishes, even if it is
+              resumed on another thread
+      */
+    T get() &&;
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+  };
+
+  template <typename T>
+  T sync_wait(task<T>&& t);
+
+  /**
+    @brief  A batch of lines, each without its line terminator
+    */
+  using line_batch = std::span<const std::string_view>;
+
+  /**
+    @brief  A batch of values
+    */
+  using value_batch = std::span<const dfloat>;
+
+  /**
+    @brief  Split [data, data + size) into lines, `batch` lines at a time
+    @note   Lines end with '\n', an optional '\r' before it is dropped. The
+            last line need not be terminated
+    @note   Lines reference `data`, which must outlive the generator
+    */
+  generator<line_batch> split_lines(const char* data, size_t size, size_t batch);
+
+  /**
+    @brief  Read lines from `in`, `batch` lines at a time
+    @note   Line buffers are reused from batch to batch, so after the first
+            batches no further allocation is made
+    */
+  generator<line_batch> read_lines(std::istream& in, size_t batch);
+
+  /**
+    @brief  Parse each line as a number written in `fmt` (see `parse_locale`)
+    @note   Bad lines give NaN
+    */
+  generator<value_batch> parse_lines(generator<line_batch> lines, number_format fmt = number_format());
+
+  /**
+    @brief  Parse `count` fixed-width fields (see `parse_fixed`), `batch`
+            fields at a time
+    */
+  generator<value_batch> parse_fields(const char* src, size_t width, size_t stride, size_t count, size_t batch);
+
+  /**
+    @brief  Keep the values for which `pred(value)` is true
+    @note   A batch which becomes empty is skipped, so batches may be
+            smaller than the input batches but never empty
+    */
+  template <typename Pred>
+  generator<value_batch> filter(generator<value_batch> values, Pred pred);
+
+  /**
+    @brief  Replace each value by `fn(value)`
+    */
+  template <typename F>
+  generator<value_batch> transform(generator<value_batch> values, F fn);
+
+  /**
+    @brief  Format each value as a line of `width` characters with
+            `decimals` places (see `format_fixed`) followed by '\n'
+    @return One block of text per batch
+    */
+  generator<std::string_view> format_lines(generator<value_batch> values, size_t width, size_t decimals);
+
+  /**
+    @brief  Fold every value into `init` with `fn(acc, value)`
+    */
+  template <typename T, typename F>
+  T reduce(generator<value_batch> values, T init, F fn);
+
+  /**
+    @brief  Sum of every value, 0 if there is none
+    @note   Each addition truncates like `operator+`; NaN if any value is NaN
+    */
+  dfloat sum(generator<value_batch> values);
+
+  /**
+    @brief  Smallest value, NaN if there is none
+    @note   NaN values are skipped
+    */
+  dfloat min(generator<value_batch> values);
+
+  /**
+    @brief  Largest value, NaN if there is none
+    @note   NaN values are skipped
+    */
+  dfloat max(generator<value_batch> values);
+
+  /**
+    @brief  Number of values
+    */
+  size_t count(generator<value_batch> values);
+}
@@ -0,0 +1,752 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dfloat.hpp"
+#include "dfloat_batch.hpp"
+#include "dfloat_generator.h"
+#include "dfloat_locale.hpp"
+
+namespace xu
+{
+  template <typename T>
+  inline
+  generator<T> generator<T>::promise_type::get_return_object()
+  {
+    return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+  }
+
+  template <typename T>
+  inline
+  std::suspend_always generator<T>::promise_type::initial_suspend() noexcept
+  {
+    return {};
+  }
+
+  template <typename T>
+  inline
+  std::suspend_always generator<T>::promise_type::final_suspend() noexcept
+  {
+    return {};
+  }
+
+  template <typename T>
+  inline
+  std::suspend_always generator<T>::promise_type::yield_value(const T& value) noexcept
+  {
+    /* a temporary lives until the end of the co_yield expression, which
+       includes the suspension */
+    value_ = &value;
+    return {};
+  }
+
+  template <typename T>
+  inline
+  void generator<T>::promise_type::return_void() noexcept
+  {
+  }
+
+  template <typename T>
+  inline
+  void generator<T>::promise_type::unhandled_exception()
+  {
+    error_ = std::current_exception();
+  }
+
+  template <typename T>
+  inline
+  generator<T>::iterator::iterator(std::coroutine_handle<promise_type> handle)
+    : handle_(handle)
+  {
+  }
+
+  template <typename T>
+  inline
+  typename generator<T>::iterator& generator<T>::iterator::operator++()
+  {
+    handle_.resume();
+
+    if (handle_.done() and handle_.promise().error_)
+    {
+      std::rethrow_exception(handle_.promise().error_);
+    }
+
+    return *this;
+  }
+
+  template <typename T>
+  inline
+  void generator<T>::iterator::operator++(int)
+  {
+    ++*this;
+  }
+
+  template <typename T>
+  inline
+  typename generator<T>::iterator::reference generator<T>::iterator::operator*() const
+  {
+    return *handle_.promise().value_;
+  }
+
+  template <typename T>
+  inline
+  typename generator<T>::iterator::pointer generator<T>::iterator::operator->() const
+  {
+    return handle_.promise().value_;
+  }
+
+  template <typename T>
+  inline
+  bool generator<T>::iterator::operator==(std::default_sentinel_t) const
+  {
+    return not handle_ or handle_.done();
+  }
+
+  template <typename T>
+  inline
+  generator<T>::generator(std::coroutine_handle<promise_type> handle)
+    : handle_(handle)
+  {
+  }
+
+  template <typename T>
+  inline
+  generator<T>::generator(generator&& other) noexcept
+    : handle_(std::exchange(other.handle_, nullptr))
+  {
+  }
+
+  template <typename T>
+  inline
+  generator<T>& generator<T>::operator=(generator&& other) noexcept
+  {
+    if (this != &other)
+    {
+      if (handle_)
+      {
+        handle_.destroy();
+      }
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  template <typename T>
+  inline
+  generator<T>::~generator()
+  {
+    /* also destroys the stages this one reads from, held in its frame */
+    if (handle_)
+    {
+      handle_.destroy();
+    }
+  }
+
+  template <typename T>
+  inline
+  typename generator<T>::iterator generator<T>::begin()
+  {
+    iterator it(handle_);
+
+    if (handle_)
+    {
+      ++it;
+    }
+
+    return it;
+  }
+
+  template <typename T>
+  inline
+  std::default_sentinel_t generator<T>::end() const
+  {
+    return std::default_sentinel;
+  }
+
+  template <typename T>
+  inline
+  bool async_generator<T>::promise_type::resume_consumer::await_ready() noexcept
+  {
+    return false;
+  }
+
+  template <typename T>
+  inline
+  std::coroutine_handle<> async_generator<T>::promise_type::resume_consumer::await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+  {
+    return handle.promise().consumer_;
+  }
+
+  template <typename T>
+  inline
+  void async_generator<T>::promise_type::resume_consumer::await_resume() noexcept
+  {
+  }
+
+  template <typename T>
+  inline
+  async_generator<T> async_generator<T>::promise_type::get_return_object()
+  {
+    return async_generator(std::coroutine_handle<promise_type>::from_promise(*this));
+  }
+
+  template <typename T>
+  inline
+  std::suspend_always async_generator<T>::promise_type::initial_suspend() noexcept
+  {
+    return {};
+  }
+
+  template <typename T>
+  inline
+  typename async_generator<T>::promise_type::resume_consumer async_generator<T>::promise_type::final_suspend() noexcept
+  {
+    return {};
+  }
+
+  template <typename T>
+  inline
+  typename async_generator<T>::promise_type::resume_consumer async_generator<T>::promise_type::yield_value(const T& value) noexcept
+  {
+    value_ = &value;
+    return {};
+  }
+
+  template <typename T>
+  inline
+  void async_generator<T>::promise_type::return_void() noexcept
+  {
+  }
+
+  template <typename T>
+  inline
+  void async_generator<T>::promise_type::unhandled_exception()
+  {
+    error_ = std::current_exception();
+  }
+
+  template <typename T>
+  inline
+  bool async_generator<T>::next_awaiter::await_ready() noexcept
+  {
+    /* a finished generator must not be resumed again */
+    return not handle_ or handle_.done();
+  }
+
+  template <typename T>
+  inline
+  std::coroutine_handle<> async_generator<T>::next_awaiter::await_suspend(std::coroutine_handle<> consumer) noexcept
+  {
+    handle_.promise().consumer_ = consumer;
+    return handle_;
+  }
+
+  template <typename T>
+  inline
+  const T* async_generator<T>::next_awaiter::await_resume()
+  {
+    if (not handle_)
+    {
+      return nullptr;
+    }
+
+    if (handle_.done())
+    {
+      if (handle_.promise().error_)
+      {
+        std::rethrow_exception(std::exchange(handle_.promise().error_, nullptr));
+      }
+      return nullptr;
+    }
+
+    return handle_.promise().value_;
+  }
+
+  template <typename T>
+  inline
+  async_generator<T>::async_generator(std::coroutine_handle<promise_type> handle)
+    : handle_(handle)
+  {
+  }
+
+  template <typename T>
+  inline
+  async_generator<T>::async_generator(async_generator&& other) noexcept
+    : handle_(std::exchange(other.handle_, nullptr))
+  {
+  }
+
+  template <typename T>
+  inline
+  async_generator<T>& async_generator<T>::operator=(async_generator&& other) noexcept
+  {
+    if (this != &other)
+    {
+      if (handle_)
+      {
+        handle_.destroy();
+      }
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  template <typename T>
+  inline
+  async_generator<T>::~async_generator()
+  {
+    if (handle_)
+    {
+      handle_.destroy();
+    }
+  }
+
+  template <typename T>
+  inline
+  typename async_generator<T>::next_awaiter async_generator<T>::next()
+  {
+    return next_awaiter{handle_};
+  }
+
+  template <typename T>
+  inline
+  bool task<T>::promise_type::final_awaiter::await_ready() noexcept
+  {
+    return false;
+  }
+
+  template <typename T>
+  inline
+  std::coroutine_handle<> task<T>::promise_type::final_awaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+  {
+    promise_type& promise = handle.promise();
+
+    if (promise.continuation_)
+    {
+      return promise.continuation_;
+    }
+
+    /* started by `get`, which may be waiting on another thread */
+    promise.finished_.store(true, std::memory_order_release);
+    promise.finished_.notify_all();
+
+    return std::noop_coroutine();
+  }
+
+  template <typename T>
+  inline
+  void task<T>::promise_type::final_awaiter::await_resume() noexcept
+  {
+  }
+
+  template <typename T>
+  inline
+  task<T> task<T>::promise_type::get_return_object()
+  {
+    return task(std::coroutine_handle<promise_type>::from_promise(*this));
+  }
+
+  template <typename T>
+  inline
+  std::suspend_always task<T>::promise_type::initial_suspend() noexcept
+  {
+    return {};
+  }
+
+  template <typename T>
+  inline
+  typename task<T>::promise_type::final_awaiter task<T>::promise_type::final_suspend() noexcept
+  {
+    return {};
+  }
+
+  template <typename T>
+  inline
+  void task<T>::promise_type::return_value(T value)
+  {
+    value_ = std::move(value);
+  }
+
+  template <typename T>
+  inline
+  void task<T>::promise_type::unhandled_exception()
+  {
+    error_ = std::current_exception();
+  }
+
+  template <typename T>
+  inline
+  bool task<T>::awaiter::await_ready() noexcept
+  {
+    return false;
+  }
+
+  template <typename T>
+  inline
+  std::coroutine_handle<> task<T>::awaiter::await_suspend(std::coroutine_handle<> caller) noexcept
+  {
+    handle_.promise().continuation_ = caller;
+    return handle_;
+  }
+
+  template <typename T>
+  inline
+  T task<T>::awaiter::await_resume()
+  {
+    if (handle_.promise().error_)
+    {
+      std::rethrow_exception(handle_.promise().error_);
+    }
+    return std::move(handle_.promise().value_);
+  }
+
+  template <typename T>
+  inline
+  task<T>::task(std::coroutine_handle<promise_type> handle)
+    : handle_(handle)
+  {
+  }
+
+  template <typename T>
+  inline
+  task<T>::task(task&& other) noexcept
+    : handle_(std::exchange(other.handle_, nullptr))
+  {
+  }
+
+  template <typename T>
+  inline
+  task<T>::~task()
+  {
+    if (handle_)
+    {
+      handle_.destroy();
+    }
+  }
+
+  template <typename T>
+  inline
+  typename task<T>::awaiter task<T>::operator co_await() && noexcept
+  {
+    return awaiter{handle_};
+  }
+
+  template <typename T>
+  inline
+  T task<T>::get() &&
+  {
+    handle_.resume();
+    handle_.promise().finished_.wait(false, std::memory_order_acquire);
+
+    if (handle_.promise().error_)
+    {
+      std::rethrow_exception(handle_.promise().error_);
+    }
+    return std::move(handle_.promise().value_);
+  }
+
+  template <typename T>
+  inline
+  T sync_wait(task<T>&& t)
+  {
+    return std::move(t).get();
+  }
+
+  inline
+  generator<line_batch> split_lines(const char* data, size_t size, size_t batch)
+  {
+    batch = std::max<size_t>(batch, 1);
+
+    std::vector<std::string_view> lines;
+    lines.reserve(batch);
+
+    const char* it = data;
+    const char* end = data + size;
+
+    while (it != end)
+    {
+      const char* newline = static_cast<const char*>(std::memchr(it, '\n', end - it));
+      const char* stop = newline != nullptr ? newline : end;
+
+      if (stop != it and *(stop - 1) == '\r')
+      {
+        --stop;
+      }
+
+      lines.emplace_back(it, stop - it);
+      it = newline != nullptr ? newline + 1 : end;
+
+      if (lines.size() == batch)
+      {
+        co_yield line_batch(lines);
+        lines.clear();
+      }
+    }
+
+    if (not lines.empty())
+    {
+      co_yield line_batch(lines);
+    }
+  }
+
+  inline
+  generator<line_batch> read_lines(std::istream& in, size_t batch)
+  {
+    batch = std::max<size_t>(batch, 1);
+
+    std::vector<std::string> buffers(batch);
+    std::vector<std::string_view> lines(batch);
+
+    size_t n = 0;
+
+    while (std::getline(in, buffers[n]))
+    {
+      std::string& line = buffers[n];
+
+      if (not line.empty() and line.back() == '\r')
+      {
+        line.pop_back();
+      }
+
+      lines[n] = line;
+
+      if (++n == batch)
+      {
+        co_yield line_batch(lines.data(), n);
+        n = 0;
+      }
+    }
+
+    if (n > 0)
+    {
+      co_yield line_batch(lines.data(), n);
+    }
+  }
+
+  inline
+  generator<value_batch> parse_lines(generator<line_batch> lines, number_format fmt)
+  {
+    std::vector<dfloat> out;
+
+    for (line_batch batch : lines)
+    {
+      if (out.size() < batch.size())
+      {
+        out.resize(batch.size());
+      }
+
+      for (size_t i = 0; i < batch.size(); i++)
+      {
+        const char* begin = batch[i].data();
+        out[i] = parse_locale(begin, begin + batch[i].size(), fmt);
+      }
+
+      co_yield value_batch(out.data(), batch.size());
+    }
+  }
+
+  inline
+  generator<value_batch> parse_fields(const char* src, size_t width, size_t stride, size_t count, size_t batch)
+  {
+    batch = std::max<size_t>(batch, 1);
+
+    std::vector<dfloat> out(std::min(batch, count));
+
+    for (size_t i = 0; i < count; i += batch)
+    {
+      size_t n = std::min(batch, count - i);
+
+      parse_fixed(src + i * stride, width, stride, n, out.data());
+
+      co_yield value_batch(out.data(), n);
+    }
+  }
+
+  template <typename Pred>
+  inline
+  generator<value_batch> filter(generator<value_batch> values, Pred pred)
+  {
+    std::vector<dfloat> out;
+
+    for (value_batch batch : values)
+    {
+      if (out.size() < batch.size())
+      {
+        out.resize(batch.size());
+      }
+
+      size_t n = 0;
+
+      for (const dfloat& x : batch)
+      {
+        if (pred(x))
+        {
+          out[n++] = x;
+        }
+      }
+
+      if (n > 0)
+      {
+        co_yield value_batch(out.data(), n);
+      }
+    }
+  }
+
+  template <typename F>
+  inline
+  generator<value_batch> transform(generator<value_batch> values, F fn)
+  {
+    std::vector<dfloat> out;
+
+    for (value_batch batch : values)
+    {
+      if (out.size() < batch.size())
+      {
+        out.resize(batch.size());
+      }
+
+      for (size_t i = 0; i < batch.size(); i++)
+      {
+        out[i] = fn(batch[i]);
+      }
+
+      co_yield value_batch(out.data(), batch.size());
+    }
+  }
+
+  inline
+  generator<std::string_view> format_lines(generator<value_batch> values, size_t width, size_t decimals)
+  {
+    const size_t stride = width + 1;
+
+    std::string text;
+
+    for (value_batch batch : values)
+    {
+      size_t size = batch.size() * stride;
+
+      if (text.size() < size)
+      {
+        text.resize(size);
+      }
+
+      format_fixed(batch.data(), width, decimals, stride, batch.size(), &text[0]);
+
+      for (size_t i = 0; i < batch.size(); i++)
+      {
+        text[i * stride + width] = '\n';
+      }
+
+      co_yield std::string_view(text.data(), size);
+    }
+  }
+
+  template <typename T, typename F>
+  inline
+  T reduce(generator<value_batch> values, T init, F fn)
+  {
+    for (value_batch batch : values)
+    {
+      for (const dfloat& x : batch)
+      {
+        init = fn(init, x);
+      }
+    }
+
+    return init;
+  }
+
+  inline
+  dfloat sum(generator<value_batch> values)
+  {
+    dfloat total = 0;
+
+    for (value_batch batch : values)
+    {
+      for (const dfloat& x : batch)
+      {
+        total += x;
+      }
+    }
+
+    return total;
+  }
+
+  inline
+  dfloat min(generator<value_batch> values)
+  {
+    dfloat result = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+    for (value_batch batch : values)
+    {
+      for (const dfloat& x : batch)
+      {
+        if (dfloat::isfinite(x) and (not dfloat::isfinite(result) or x < result))
+        {
+          result = x;
+        }
+      }
+    }
+
+    return result;
+  }
+
+  inline
+  dfloat max(generator<value_batch> values)
+  {
+    dfloat result = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+    for (value_batch batch : values)
+    {
+      for (const dfloat& x : batch)
+      {
+        if (dfloat::isfinite(x) and (not dfloat::isfinite(result) or x > result))
+        {
+          result = x;
+        }
+      }
+    }
+
+    return result;
+  }
+
+  inline
+  size_t count(generator<value_batch> values)
+  {
+    size_t n = 0;
+
+    for (value_batch batch : values)
+    {
+      n += batch.size();
+    }
+
+    return n;
+  }
+}
@@ -0,0 +1,178 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_accumulator.h"
+#include "dfloat_column.h"
+#include "dfloat_rounding.h"
+
+namespace xu
+{
+  /**
+    @brief  Discount and tax of a line item
+    */
+  struct line_rule
+  {
+    /**
+      @brief  Fraction of the extended amount taken off, e.g. 0.10
+      */
+    dfloat discount_rate = 0;
+
+    /**
+      @brief  Amount taken off the line after `discount_rate`, with the
+              sign of the line; the discount never exceeds the line
+      */
+    dfloat discount_amount = 0;
+
+    dfloat tax_rate = 0;
+
+    /**
+      @brief  Tax the amount before discount instead of after
+      */
+    bool tax_before_discount = false;
+  };
+
+  struct invoice_policy
+  {
+    /**
+      @brief  Every amount is a multiple of `10^exp`, e.g. -2 for cents
+      */
+    dfloat::pow2_t exp = -2;
+
+    /**
+      @brief  Rounding of the extended amount, discount and tax of each line
+      */
+    rounding_mode line_rounding = rounding_mode::HALF_UP;
+
+    /**
+      @brief  The amount payable is a multiple of this many units, e.g. 5
+              for 0.05 cash rounding; the difference with the total is the
+              rounding adjustment
+      */
+    int64_t increment = 1;
+
+    rounding_mode invoice_rounding = rounding_mode::HALF_UP;
+  };
+
+  /**
+    @brief  Amounts of each line, in input order
+    */
+  struct invoice_lines
+  {
+    /**
+      @brief  `quantity * unit price`
+      */
+    dfloat_column extended;
+
+    dfloat_column discount;
+    dfloat_column tax;
+
+    /**
+      @brief  `extended - discount + tax`
+      */
+    dfloat_column total;
+
+    size_t size() const;
+  };
+
+  /**
+    @brief  Amounts of each invoice, the sums of its lines
+    */
+  struct invoice_totals
+  {
+    dfloat_column net;
+    dfloat_column tax;
+    dfloat_column total;
+
+    /**
+      @brief  `payable - total`
+      */
+    dfloat_column adjustment;
+
+    /**
+      @brief  `total` rounded to the increment of the policy
+      */
+    dfloat_column payable;
+
+    size_t size() const;
+  };
+
+  /**
+    @brief  Prices invoices line by line with a table of discount and tax
+            rules
+    @note   Each line is computed in integer units of the policy from the
+            exact decimal coefficients: the extended amount, the discount
+            and the tax are each rounded once by `line_rounding`, and
+            nothing is truncated before that
+    @note   Invoice totals are a segmented reduction of the lines: invoice
+            `i` is lines [offsets[i], offsets[i + 1]), so invoices are split
+            across `threads` threads and each one sums its own segments in
+            the same pass that prices the lines
+    */
+  class invoice_engine
+  {
+  public:
+    invoice_engine(const std::vector<line_rule>& rules, const invoice_policy& policy);
+
+    /**
+      @brief  Price `num_invoices` invoices, replacing the contents of
+              `lines` and `totals`
+      @note   `rules[i]` is the index of the rule of line `i`
+      @note   A line with a NaN input, an unknown rule, or an amount too
+              large for 64-bit units is NaN, and so are the totals of its
+              invoice
+      @return number of invoices priced without a NaN line
+      */
+    size_t run(const uint64_t* offsets, size_t num_invoices, const dfloat* quantities, const dfloat* prices,
+      const uint32_t* rules, invoice_lines& lines, invoice_totals& totals, size_t threads) const;
+
+  protected:
+    /* a rule with its rates as decimal coefficients and its amount in units */
+    struct rule
+    {
+      int64_t discount_coef;
+      dfloat::pow2_t discount_exp;
+      int64_t discount_units;
+      int64_t tax_coef;
+      dfloat::pow2_t tax_exp;
+      bool tax_before_discount;
+      bool valid;
+    };
+
+    /* amounts of one line in units; false if it cannot be priced */
+    bool _line(const dfloat& quantity, const dfloat& price, const rule& r,
+      int64_t& extended, int64_t& discount, int64_t& tax) const;
+
+    /* `amount * coef * 10^coef_exp` in units, rounded once */
+    bool _apply(int64_t amount, int64_t coef, dfloat::pow2_t coef_exp, int64_t& out) const;
+
+    std::vector<rule> rules_;
+    invoice_policy policy_;
+  };
+}
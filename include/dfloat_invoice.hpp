@@ -0,0 +1,224 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include "dfloat.hpp"
+#include "dfloat_accumulator.hpp"
+#include "dfloat_column.hpp"
+#include "dfloat_rounding.hpp"
+#include "dfloat_invoice.h"
+
+namespace xu
+{
+  inline
+  size_t invoice_lines::size() const
+  {
+    return extended.size();
+  }
+
+  inline
+  size_t invoice_totals::size() const
+  {
+    return total.size();
+  }
+
+  inline
+  invoice_engine::invoice_engine(const std::vector<line_rule>& rules, const invoice_policy& policy)
+    : policy_(policy)
+  {
+    if (policy_.increment < 1)
+    {
+      policy_.increment = 1;
+    }
+
+    rules_.resize(rules.size());
+
+    for (size_t i = 0; i < rules.size(); i++)
+    {
+      const line_rule& in = rules[i];
+      rule& r = rules_[i];
+
+      r.tax_before_discount = in.tax_before_discount;
+      r.valid = in.discount_rate.to_decimal(r.discount_coef, r.discount_exp)
+        and in.tax_rate.to_decimal(r.tax_coef, r.tax_exp)
+        and round_to_units(in.discount_amount, policy_.exp, policy_.line_rounding, r.discount_units);
+    }
+  }
+
+  inline
+  bool invoice_engine::_apply(int64_t amount, int64_t coef, dfloat::pow2_t coef_exp, int64_t& out) const
+  {
+    using wide_t = dfloat_accumulator::wide_t;
+
+    if (coef == 0 or amount == 0)
+    {
+      out = 0;
+      return true;
+    }
+
+    /* both factors are below 2^63, so the product fits */
+    bool ok;
+    wide_t q = round_scaled((wide_t)amount * coef, coef_exp + policy_.exp, policy_.exp, policy_.line_rounding, ok);
+
+    if (not ok or q < INT64_MIN or q > INT64_MAX)
+    {
+      return false;
+    }
+
+    out = (int64_t)q;
+    return true;
+  }
+
+  inline
+  bool invoice_engine::_line(const dfloat& quantity, const dfloat& price, const rule& r,
+    int64_t& extended, int64_t& discount, int64_t& tax) const
+  {
+    int64_t q_coef, p_coef;
+    dfloat::pow2_t q_exp, p_exp;
+
+    if (not quantity.to_decimal(q_coef, q_exp) or not price.to_decimal(p_coef, p_exp)
+      or not _apply(q_coef, p_coef, q_exp + p_exp - policy_.exp, extended))
+    {
+      return false;
+    }
+
+    if (not _apply(extended, r.discount_coef, r.discount_exp, discount))
+    {
+      return false;
+    }
+
+    /* the fixed amount follows the sign of the line, e.g. a return */
+    discount += extended < 0 ? -r.discount_units : r.discount_units;
+
+    if (extended >= 0 ? discount > extended : discount < extended)
+    {
+      discount = extended;
+    }
+
+    return _apply(r.tax_before_discount ? extended : extended - discount, r.tax_coef, r.tax_exp, tax);
+  }
+
+  inline
+  size_t invoice_engine::run(const uint64_t* offsets, size_t num_invoices, const dfloat* quantities,
+    const dfloat* prices, const uint32_t* rules, invoice_lines& lines, invoice_totals& totals, size_t threads) const
+  {
+    using wide_t = dfloat_accumulator::wide_t;
+
+    size_t num_lines = num_invoices > 0 ? offsets[num_invoices] : 0;
+
+    lines.extended.resize(num_lines);
+    lines.discount.resize(num_lines);
+    lines.tax.resize(num_lines);
+    lines.total.resize(num_lines);
+
+    totals.net.resize(num_invoices);
+    totals.tax.resize(num_invoices);
+    totals.total.resize(num_invoices);
+    totals.adjustment.resize(num_invoices);
+    totals.payable.resize(num_invoices);
+
+    const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+    const dfloat::pow2_t exp = policy_.exp;
+    const int64_t increment = policy_.increment;
+
+    std::atomic<size_t> priced(0);
+
+    /* invoices, not lines, are split, so that every segment is reduced by one thread */
+    constexpr size_t INVOICE_BLOCK = 64;
+
+    parallel_blocks(num_invoices, threads, INVOICE_BLOCK,
+      [&](size_t begin, size_t end)
+      {
+        size_t done = 0;
+
+        for (size_t i = begin; i < end; i++)
+        {
+          /* sums of up to 2^64 lines of 64-bit amounts fit */
+          wide_t net = 0;
+          wide_t tax = 0;
+          bool ok = true;
+
+          for (uint64_t l = offsets[i]; l < offsets[i + 1]; l++)
+          {
+            int64_t line_extended, line_discount, line_tax;
+
+            if (rules[l] >= rules_.size() or not rules_[rules[l]].valid
+              or not _line(quantities[l], prices[l], rules_[rules[l]], line_extended, line_discount, line_tax))
+            {
+              lines.extended[l] = NaN;
+              lines.discount[l] = NaN;
+              lines.tax[l] = NaN;
+              lines.total[l] = NaN;
+
+              ok = false;
+              continue;
+            }
+
+            wide_t line_net = (wide_t)line_extended - line_discount;
+            wide_t line_total = line_net + line_tax;
+
+            lines.extended[l] = dfloat::from_scaled(line_extended, exp);
+            lines.discount[l] = dfloat::from_scaled(line_discount, exp);
+            lines.tax[l] = dfloat::from_scaled(line_tax, exp);
+            lines.total[l] = line_total >= INT64_MIN and line_total <= INT64_MAX
+              ? dfloat::from_scaled((int64_t)line_total, exp) : NaN;
+
+            net += line_net;
+            tax += line_tax;
+          }
+
+          wide_t total = net + tax;
+          ok = ok and total >= INT64_MIN and total <= INT64_MAX and net >= INT64_MIN and net <= INT64_MAX
+            and tax >= INT64_MIN and tax <= INT64_MAX;
+
+          if (not ok)
+          {
+            totals.net[i] = NaN;
+            totals.tax[i] = NaN;
+            totals.total[i] = NaN;
+            totals.adjustment[i] = NaN;
+            totals.payable[i] = NaN;
+            continue;
+          }
+
+          wide_t payable = divide_rounded(total, increment, policy_.invoice_rounding) * increment;
+
+          totals.net[i] = dfloat::from_scaled((int64_t)net, exp);
+          totals.tax[i] = dfloat::from_scaled((int64_t)tax, exp);
+          totals.total[i] = dfloat::from_scaled((int64_t)total, exp);
+          totals.adjustment[i] = dfloat::from_scaled((int64_t)(payable - total), exp);
+          totals.payable[i] = dfloat::from_scaled(payable < 0 ? dfloat::Sign::NEG : dfloat::Sign::POS,
+            (dfloat::mant2_t)(payable < 0 ? -payable : payable), exp);
+
+          ++done;
+        }
+
+        priced += done;
+      });
+
+    return priced;
+  }
+}
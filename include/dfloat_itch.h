@@ -0,0 +1,67 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "dfloat.h"
+#include "dfloat_batch.h"
+
+namespace xu
+{
+  /**
+    @brief  Decode an ITCH-style price: a big-endian unsigned integer `T`
+            (uint32_t or uint64_t) with `Decimals` implied decimal places,
+            e.g. Price(4) is `itch_price<uint32_t, 4>`
+    @note   `src` need not be aligned
+    */
+  template <typename T, unsigned Decimals>
+  dfloat itch_price(const char* src);
+
+  /**
+    @brief  Decode `N` prices at once
+            Price `i` is at `src + i * stride`, e.g. `src` points at the
+            price field of the first of `N` messages of the same type
+    @note   The loads and byte swaps of all lanes are done first, in a loop
+            the compiler vectorizes into shuffles; the scale is a template
+            parameter, so the exponent of every result is a constant and only
+            the digit count of each price is computed at run time
+    */
+  template <typename T, unsigned Decimals, size_t N>
+  void itch_decode_prices(const char* src, size_t stride, dfloat* out);
+
+  /**
+    @brief  Decode `count` prices at a fixed stride, `BATCH_LANES` at a time
+    */
+  template <typename T, unsigned Decimals>
+  void itch_decode_prices(const char* src, size_t stride, size_t count, dfloat* out);
+
+  /**
+    @brief  Decode the price at `offset` in each of `count` messages, for
+            streams where messages of one type are not evenly spaced
+    */
+  template <typename T, unsigned Decimals>
+  void itch_decode_prices(const char* const* messages, size_t offset, size_t count, dfloat* out);
+}
@@ -0,0 +1,112 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <type_traits>
+#include "dfloat.hpp"
+#include "dfloat_batch.hpp"
+#include "dfloat_endian.hpp"
+#include "dfloat_itch.h"
+
+namespace xu
+{
+  template <typename T, unsigned Decimals>
+  inline
+  dfloat itch_price(const char* src)
+  {
+    static_assert(std::is_same<T, uint32_t>::value or std::is_same<T, uint64_t>::value,
+      "ITCH prices are uint32_t or uint64_t");
+    static_assert(Decimals <= 19, "too many implied decimals");
+
+    T raw = load<byte_order::BIG, T>(src);
+
+    return dfloat::from_scaled(dfloat::Sign::POS, raw, -(dfloat::pow2_t)Decimals);
+  }
+
+  template <typename T, unsigned Decimals, size_t N>
+  inline
+  void itch_decode_prices(const char* src, size_t stride, dfloat* out)
+  {
+    static_assert(std::is_same<T, uint32_t>::value or std::is_same<T, uint64_t>::value,
+      "ITCH prices are uint32_t or uint64_t");
+    static_assert(Decimals <= 19, "too many implied decimals");
+
+    T raw[N];
+
+    for (size_t l = 0; l < N; l++)
+    {
+      raw[l] = load<byte_order::BIG, T>(src + l * stride);
+    }
+
+    for (size_t l = 0; l < N; l++)
+    {
+      out[l] = dfloat::from_scaled(dfloat::Sign::POS, raw[l], -(dfloat::pow2_t)Decimals);
+    }
+  }
+
+  template <typename T, unsigned Decimals>
+  inline
+  void itch_decode_prices(const char* src, size_t stride, size_t count, dfloat* out)
+  {
+    size_t i = 0;
+
+    for (; i + BATCH_LANES <= count; i += BATCH_LANES)
+    {
+      itch_decode_prices<T, Decimals, BATCH_LANES>(src + i * stride, stride, out + i);
+    }
+
+    for (; i < count; i++)
+    {
+      itch_decode_prices<T, Decimals, 1>(src + i * stride, stride, out + i);
+    }
+  }
+
+  template <typename T, unsigned Decimals>
+  inline
+  void itch_decode_prices(const char* const* messages, size_t offset, size_t count, dfloat* out)
+  {
+    size_t i = 0;
+
+    for (; i + BATCH_LANES <= count; i += BATCH_LANES)
+    {
+      T raw[BATCH_LANES];
+
+      for (size_t l = 0; l < BATCH_LANES; l++)
+      {
+        raw[l] = load<byte_order::BIG, T>(messages[i + l] + offset);
+      }
+
+      for (size_t l = 0; l < BATCH_LANES; l++)
+      {
+        out[i + l] = dfloat::from_scaled(dfloat::Sign::POS, raw[l], -(dfloat::pow2_t)Decimals);
+      }
+    }
+
+    for (; i < count; i++)
+    {
+      out[i] = itch_price<T, Decimals>(messages[i] + offset);
+    }
+  }
+}
@@ -0,0 +1,166 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_record.h"
+
+namespace xu
+{
+  /**
+    @brief  CRC-32C (Castagnoli) of [data, data + size), continuing from
+            `crc`
+    */
+  uint32_t crc32c(const char* data, size_t size, uint32_t crc = 0);
+
+  /**
+    @brief  Append-only binary journal of records, each a 64-bit key (e.g.
+            an account id) and any number of dfloats (e.g. the amounts of a
+            posting)
+    @note   Records are appended to an in-memory block; `sync` writes every
+            pending record as one block and makes it durable with one
+            fdatasync. While one thread syncs, others keep appending, and the
+            next sync covers all of them (group commit)
+    @note   Block layout, little-endian:
+              uint32  magic "DFJ1"
+              uint32  payload size
+              uint64  sequence number of the first record
+              uint32  number of records
+              uint32  CRC-32C of the 20 bytes above and the payload
+              payload: per record, varint key, varint field count, then
+                       each field in the compact encoding
+    @note   When an existing journal is opened, a torn or corrupt tail is
+            cut off and appending continues after the last valid block
+    @note   If the file cannot be opened, `is_open()` is false
+    */
+  class journal_writer
+  {
+  public:
+    explicit journal_writer(const std::string& filepath);
+
+    /**
+      @brief  Makes every appended record durable, then closes the file
+      */
+    ~journal_writer();
+
+    journal_writer(const journal_writer& other) = delete;
+
+    journal_writer& operator=(const journal_writer& other) = delete;
+
+    bool is_open() const;
+
+    /**
+      @brief  Queue a record; safe to call from several threads
+      @note   Not durable until `sync` returns for its sequence number
+      @return its sequence number
+      */
+    uint64_t append(uint64_t key, const dfloat* values, size_t count);
+
+    /**
+      @brief  Return once record `seq` and every record before it are on
+              disk, writing and syncing pending records if no other thread
+              is already doing so
+      @return false if the write or the sync failed
+      */
+    bool sync(uint64_t seq);
+
+    /**
+      @brief  Make every record appended so far durable
+      */
+    bool sync();
+
+    /**
+      @brief  Number of records appended, i.e. the sequence number of the
+              next record
+      */
+    uint64_t size() const;
+
+    /**
+      @brief  Number of blocks written since opening, i.e. of fdatasyncs
+      */
+    uint64_t blocks_written() const;
+
+  protected:
+    int fd_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable synced_;
+
+    /* records waiting for the next sync, after room for the block header */
+    std::vector<char> pending_;
+
+    /* the block being written by the syncing thread */
+    std::vector<char> flushing_;
+    uint64_t pending_first_;
+    uint64_t next_seq_;
+    uint64_t durable_seq_;
+    uint64_t blocks_;
+    bool syncing_;
+    bool failed_;
+  };
+
+  /**
+    @brief  Replays a journal from a read-only memory mapping
+    */
+  class journal_reader
+  {
+  public:
+    explicit journal_reader(const std::string& filepath);
+
+    bool is_open() const;
+
+    /**
+      @brief  Call `fn(seq, key, values, count)` for every record, in order
+      @note   `values` is only valid during the call
+      @return false if replay stopped at a torn or corrupt block before the
+              end of the file
+      */
+    template <typename F>
+    bool replay(F fn);
+
+    /**
+      @brief  Size of the prefix of the file made of valid blocks, known
+              after `replay`
+      */
+    size_t valid_size() const;
+
+    /**
+      @brief  Number of records replayed
+      */
+    uint64_t records() const;
+
+  protected:
+    mapped_file file_;
+    size_t valid_size_;
+    uint64_t records_;
+    std::vector<dfloat> values_;
+  };
+}
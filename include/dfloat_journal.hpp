@@ -0,0 +1,380 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "dfloat.hpp"
+#include "dfloat_compact.hpp"
+#include "dfloat_endian.hpp"
+#include "dfloat_journal.h"
+#include "dfloat_record.hpp"
+
+namespace xu
+{
+  inline
+  uint32_t crc32c(const char* data, size_t size, uint32_t crc)
+  {
+    struct table_t
+    {
+      uint32_t values[256];
+
+      constexpr table_t()
+        : values()
+      {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+          uint32_t c = i;
+          for (int k = 0; k < 8; k++)
+          {
+            c = c & 1 ? (c >> 1) ^ 0x82f63b78u : c >> 1;
+          }
+          values[i] = c;
+        }
+      }
+    };
+
+    static constexpr table_t table;
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+
+    crc = ~crc;
+
+    for (size_t i = 0; i < size; i++)
+    {
+      crc = table.values[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+
+    return ~crc;
+  }
+
+  /* "DFJ1" */
+  constexpr uint32_t JOURNAL_MAGIC = 0x314a4644u;
+
+  constexpr size_t JOURNAL_HEADER_SIZE = 24;
+
+  inline
+  journal_writer::journal_writer(const std::string& filepath)
+    : fd_(-1), pending_first_(0), next_seq_(0), durable_seq_(0), blocks_(0), syncing_(false), failed_(false)
+  {
+    uint64_t records = 0;
+    size_t valid_size = 0;
+
+    {
+      journal_reader reader(filepath);
+
+      if (reader.is_open())
+      {
+        reader.replay([](uint64_t, uint64_t, const dfloat*, size_t) {});
+        records = reader.records();
+        valid_size = reader.valid_size();
+      }
+    }
+
+    int fd = ::open(filepath.c_str(), O_RDWR | O_CREAT, 0644);
+
+    if (fd < 0)
+    {
+      return;
+    }
+
+    /* cut off a torn tail, so that new blocks follow the last valid one */
+    if (::ftruncate(fd, valid_size) != 0 or ::lseek(fd, 0, SEEK_END) < 0)
+    {
+      ::close(fd);
+      return;
+    }
+
+    fd_ = fd;
+    pending_first_ = records;
+    next_seq_ = records;
+    durable_seq_ = records;
+  }
+
+  inline
+  journal_writer::~journal_writer()
+  {
+    if (fd_ >= 0)
+    {
+      sync();
+      ::close(fd_);
+    }
+  }
+
+  inline
+  bool journal_writer::is_open() const
+  {
+    return fd_ >= 0;
+  }
+
+  inline
+  uint64_t journal_writer::append(uint64_t key, const dfloat* values, size_t count)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (pending_.empty())
+    {
+      pending_.resize(JOURNAL_HEADER_SIZE);
+    }
+
+    size_t start = pending_.size();
+    pending_.resize(start + 20 + count * COMPACT_MAX_SIZE);
+
+    char* dst = pending_.data() + start;
+    dst += encode_varint(key, dst);
+    dst += encode_varint(count, dst);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      dst += encode_compact(values[i], dst);
+    }
+
+    pending_.resize(dst - pending_.data());
+
+    return next_seq_++;
+  }
+
+  inline
+  bool journal_writer::sync(uint64_t seq)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (fd_ < 0)
+    {
+      return false;
+    }
+
+    /* records not appended yet cannot be waited for */
+    if (seq >= next_seq_)
+    {
+      if (next_seq_ == 0)
+      {
+        return true;
+      }
+      seq = next_seq_ - 1;
+    }
+
+    while (durable_seq_ <= seq and not failed_)
+    {
+      if (syncing_)
+      {
+        synced_.wait(lock);
+        continue;
+      }
+
+      /* become the syncing thread for everything pending */
+      syncing_ = true;
+
+      flushing_.swap(pending_);
+
+      uint64_t first = pending_first_;
+      uint64_t count = next_seq_ - first;
+      pending_first_ = next_seq_;
+
+      lock.unlock();
+
+      char* header = flushing_.data();
+      store<byte_order::LITTLE>(JOURNAL_MAGIC, header);
+      store<byte_order::LITTLE>((uint32_t)(flushing_.size() - JOURNAL_HEADER_SIZE), header + 4);
+      store<byte_order::LITTLE>(first, header + 8);
+      store<byte_order::LITTLE>((uint32_t)count, header + 16);
+
+      uint32_t crc = crc32c(header, 20);
+      crc = crc32c(header + JOURNAL_HEADER_SIZE, flushing_.size() - JOURNAL_HEADER_SIZE, crc);
+      store<byte_order::LITTLE>(crc, header + 20);
+
+      bool ok = true;
+      size_t written = 0;
+
+      while (ok and written < flushing_.size())
+      {
+        ssize_t n = ::write(fd_, flushing_.data() + written, flushing_.size() - written);
+        ok = n > 0;
+        written += ok ? n : 0;
+      }
+
+      ok = ok and ::fdatasync(fd_) == 0;
+
+      flushing_.clear();
+
+      lock.lock();
+
+      syncing_ = false;
+      blocks_++;
+
+      if (ok)
+      {
+        durable_seq_ = first + count;
+      }
+      else
+      {
+        failed_ = true;
+      }
+
+      synced_.notify_all();
+    }
+
+    return not failed_;
+  }
+
+  inline
+  bool journal_writer::sync()
+  {
+    uint64_t last;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last = next_seq_;
+    }
+
+    return last == 0 ? is_open() : sync(last - 1);
+  }
+
+  inline
+  uint64_t journal_writer::size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_seq_;
+  }
+
+  inline
+  uint64_t journal_writer::blocks_written() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return blocks_;
+  }
+
+  inline
+  journal_reader::journal_reader(const std::string& filepath)
+    : file_(filepath), valid_size_(0), records_(0)
+  {
+  }
+
+  inline
+  bool journal_reader::is_open() const
+  {
+    return file_.is_open();
+  }
+
+  template <typename F>
+  inline
+  bool journal_reader::replay(F fn)
+  {
+    const char* data = file_.data();
+    size_t size = file_.size();
+
+    size_t pos = 0;
+    uint64_t seq = 0;
+
+    valid_size_ = 0;
+    records_ = 0;
+
+    while (size - pos >= JOURNAL_HEADER_SIZE)
+    {
+      const char* header = data + pos;
+
+      uint32_t magic = load<byte_order::LITTLE, uint32_t>(header);
+      uint32_t payload_size = load<byte_order::LITTLE, uint32_t>(header + 4);
+      uint64_t first = load<byte_order::LITTLE, uint64_t>(header + 8);
+      uint32_t count = load<byte_order::LITTLE, uint32_t>(header + 16);
+      uint32_t crc = load<byte_order::LITTLE, uint32_t>(header + 20);
+
+      if (magic != JOURNAL_MAGIC or first != seq or payload_size > size - pos - JOURNAL_HEADER_SIZE)
+      {
+        break;
+      }
+
+      const char* payload = header + JOURNAL_HEADER_SIZE;
+
+      if (crc32c(payload, payload_size, crc32c(header, 20)) != crc)
+      {
+        break;
+      }
+
+      const char* it = payload;
+      const char* end = payload + payload_size;
+      bool bad = false;
+
+      for (uint32_t r = 0; r < count and not bad; r++)
+      {
+        uint64_t key;
+        uint64_t fields;
+
+        size_t n = decode_varint(it, end - it, key);
+        it += n;
+        bad = n == 0;
+
+        n = bad ? 0 : decode_varint(it, end - it, fields);
+        it += n;
+        bad = bad or n == 0 or fields > (size_t)(end - it);
+
+        if (bad)
+        {
+          break;
+        }
+
+        values_.resize(fields);
+
+        for (uint64_t f = 0; f < fields and not bad; f++)
+        {
+          n = decode_compact(it, end - it, values_[f]);
+          it += n;
+          bad = n == 0;
+        }
+
+        if (not bad)
+        {
+          fn(seq, key, values_.data(), (size_t)fields);
+          seq++;
+        }
+      }
+
+      /* the CRC matched, so this only happens if the writer was broken */
+      if (bad or it != end)
+      {
+        break;
+      }
+
+      pos += JOURNAL_HEADER_SIZE + payload_size;
+      valid_size_ = pos;
+      records_ = seq;
+    }
+
+    return valid_size_ == size;
+  }
+
+  inline
+  size_t journal_reader::valid_size() const
+  {
+    return valid_size_;
+  }
+
+  inline
+  uint64_t journal_reader::records() const
+  {
+    return records_;
+  }
+}
@@ -0,0 +1,135 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_accumulator.h"
+#include "dfloat_column.h"
+
+namespace xu
+{
+  /**
+    @brief  Balances of many accounts, changed only by balanced journal
+            entries
+    @note   A journal entry is a set of postings (account, amount), debits
+            positive and credits negative, whose amounts sum to exactly zero.
+            The sum is checked with a `dfloat_accumulator`, and so are the
+            balances, so no posting is ever truncated
+    @note   Accounts are split into `num_shards` contiguous ranges, each
+            owned by one thread while a batch is posted; no account is
+            touched by two threads and there are no locks
+    @note   An entry whose postings all fall in one shard is checked and
+            applied by that shard alone. An entry spanning shards goes
+            through two phases: each shard sums its own legs (prepare),
+            then every shard adds up all the partial sums, reaching the
+            same decision, and applies its legs if they net to zero
+            (commit)
+    */
+  class ledger
+  {
+  public:
+    ledger(size_t num_accounts, size_t num_shards);
+
+    size_t num_accounts() const;
+
+    size_t num_shards() const;
+
+    size_t shard_of(uint32_t account) const;
+
+    /**
+      @brief  Post one entry of `count` postings
+      @return false, and nothing is changed, if the amounts do not sum to
+              zero, any amount is NaN, any account is out of range, or the
+              entry is empty
+      */
+    bool post(const uint32_t* accounts, const dfloat* amounts, size_t count);
+
+    /**
+      @brief  Post `entries` entries; entry `i` is the postings in
+              [offsets[i], offsets[i + 1])
+      @param  accepted  If not nullptr, set to 1 or 0 for each entry
+      @return Number of entries posted; each is accepted or rejected as by
+              the single-entry `post`
+      @note   Runs one thread per shard
+      */
+    size_t post(const size_t* offsets, const uint32_t* accounts, const dfloat* amounts, size_t entries,
+      uint8_t* accepted = nullptr);
+
+    dfloat balance(uint32_t account) const;
+
+    const dfloat_accumulator& exact_balance(uint32_t account) const;
+
+    uint64_t posted_entries() const;
+
+    uint64_t rejected_entries() const;
+
+    /**
+      @brief  Trial balance: true if all balances sum to exactly zero
+      @note   Sums each shard on its own thread, then the shard totals
+      */
+    bool verify() const;
+
+  protected:
+    /* shard of an entry: one shard, several, or rejected before any phase */
+    enum : uint32_t
+    {
+      MULTI_SHARD = UINT32_MAX - 1,
+      INVALID = UINT32_MAX
+    };
+
+    /* sum of the amounts, NaN if any is */
+    static dfloat_accumulator _sum(const dfloat* amounts, size_t count);
+
+    void _apply(const uint32_t* accounts, const dfloat* amounts, size_t count);
+
+    size_t num_shards_;
+    size_t shard_size_;
+
+    std::vector<dfloat_accumulator> balances_;
+
+    uint64_t posted_;
+    uint64_t rejected_;
+
+    /* posting `posting` of the `multi`-th multi-shard entry, entry `entry` of the batch */
+    struct leg
+    {
+      size_t multi;
+      size_t entry;
+      size_t posting;
+    };
+
+    /*
+      Per batch: shard of each entry, single-shard entries and multi-shard
+      legs by shard, and partial sums of multi-shard entries by shard
+    */
+    std::vector<uint32_t> entry_shard_;
+    std::vector<std::vector<size_t>> shard_entries_;
+    std::vector<std::vector<leg>> shard_legs_;
+    std::vector<dfloat_accumulator> partials_;
+  };
+}
@@ -0,0 +1,364 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include "dfloat.hpp"
+#include "dfloat_accumulator.hpp"
+#include "dfloat_column.hpp"
+#include "dfloat_ledger.h"
+
+namespace xu
+{
+  inline
+  ledger::ledger(size_t num_accounts, size_t num_shards)
+    : num_shards_(num_shards > 0 ? num_shards : 1), balances_(num_accounts), posted_(0), rejected_(0)
+  {
+    shard_size_ = (num_accounts + num_shards_ - 1) / num_shards_;
+
+    if (shard_size_ == 0)
+    {
+      shard_size_ = 1;
+    }
+  }
+
+  inline
+  size_t ledger::num_accounts() const
+  {
+    return balances_.size();
+  }
+
+  inline
+  size_t ledger::num_shards() const
+  {
+    return num_shards_;
+  }
+
+  inline
+  size_t ledger::shard_of(uint32_t account) const
+  {
+    return account / shard_size_;
+  }
+
+  inline
+  dfloat_accumulator ledger::_sum(const dfloat* amounts, size_t count)
+  {
+    dfloat_accumulator sum;
+
+    for (size_t k = 0; k < count; k++)
+    {
+      sum.add(amounts[k]);
+    }
+
+    return sum;
+  }
+
+  inline
+  void ledger::_apply(const uint32_t* accounts, const dfloat* amounts, size_t count)
+  {
+    for (size_t k = 0; k < count; k++)
+    {
+      balances_[accounts[k]].add(amounts[k]);
+    }
+  }
+
+  inline
+  bool ledger::post(const uint32_t* accounts, const dfloat* amounts, size_t count)
+  {
+    bool valid = count > 0;
+
+    for (size_t k = 0; k < count and valid; k++)
+    {
+      valid = accounts[k] < balances_.size();
+    }
+
+    dfloat_accumulator sum = _sum(amounts, count);
+
+    if (not valid or sum.isnan() or not sum.is_zero())
+    {
+      ++rejected_;
+      return false;
+    }
+
+    _apply(accounts, amounts, count);
+    ++posted_;
+
+    return true;
+  }
+
+  inline
+  size_t ledger::post(const size_t* offsets, const uint32_t* accounts, const dfloat* amounts, size_t entries,
+    uint8_t* accepted)
+  {
+    /* entries per thread when classifying */
+    constexpr size_t BLOCK = 1024;
+
+    const size_t num_accounts = balances_.size();
+    const size_t S = num_shards_;
+
+    entry_shard_.resize(entries);
+
+    parallel_blocks(entries, S, BLOCK,
+      [&](size_t begin, size_t end)
+      {
+        for (size_t i = begin; i < end; i++)
+        {
+          size_t first = offsets[i];
+          size_t last = offsets[i + 1];
+
+          uint32_t shard = first < last and accounts[first] < num_accounts ? (uint32_t)shard_of(accounts[first]) : INVALID;
+
+          for (size_t k = first; k < last and shard != INVALID; k++)
+          {
+            if (accounts[k] >= num_accounts or not dfloat::isfinite(amounts[k]))
+            {
+              shard = INVALID;
+            }
+            else if (shard_of(accounts[k]) != shard)
+            {
+              shard = MULTI_SHARD;
+            }
+          }
+
+          entry_shard_[i] = shard;
+        }
+      });
+
+    /* bucket entries by shard, and the legs of multi-shard entries by the shard of their account */
+    uint64_t rejected = 0;
+    size_t num_multi = 0;
+
+    shard_entries_.resize(S);
+    shard_legs_.resize(S);
+
+    for (size_t s = 0; s < S; s++)
+    {
+      shard_entries_[s].clear();
+      shard_legs_[s].clear();
+    }
+
+    for (size_t i = 0; i < entries; i++)
+    {
+      uint32_t shard = entry_shard_[i];
+
+      if (shard == INVALID)
+      {
+        ++rejected;
+
+        if (accepted != nullptr)
+        {
+          accepted[i] = 0;
+        }
+      }
+      else if (shard == MULTI_SHARD)
+      {
+        for (size_t k = offsets[i]; k < offsets[i + 1]; k++)
+        {
+          shard_legs_[shard_of(accounts[k])].push_back({num_multi, i, k});
+        }
+        ++num_multi;
+      }
+      else
+      {
+        shard_entries_[shard].push_back(i);
+      }
+    }
+
+    partials_.assign(num_multi * S, dfloat_accumulator());
+
+    std::vector<uint64_t> posted_by_shard(S, 0);
+    std::vector<uint64_t> rejected_by_shard(S, 0);
+
+    /*
+      Phase 1, one thread per shard: apply entries within the shard, and sum
+      the shard's legs of the others
+    */
+    parallel_blocks(S, S, 1,
+      [&](size_t begin, size_t end)
+      {
+        for (size_t s = begin; s < end; s++)
+        {
+          uint64_t posted = 0;
+          uint64_t rejected = 0;
+
+          for (size_t i : shard_entries_[s])
+          {
+            size_t first = offsets[i];
+            size_t count = offsets[i + 1] - first;
+
+            bool balanced = _sum(amounts + first, count).is_zero();
+
+            if (balanced)
+            {
+              _apply(accounts + first, amounts + first, count);
+            }
+
+            posted += balanced;
+            rejected += not balanced;
+
+            if (accepted != nullptr)
+            {
+              accepted[i] = balanced;
+            }
+          }
+
+          for (const leg& l : shard_legs_[s])
+          {
+            partials_[l.multi * S + s].add(amounts[l.posting]);
+          }
+
+          posted_by_shard[s] = posted;
+          rejected_by_shard[s] = rejected;
+        }
+      });
+
+    /*
+      Phase 2, one thread per shard: every shard involved adds up the same
+      partial sums, so all reach the same decision without exchanging it,
+      and applies its legs of the balanced entries. The shard of the first
+      posting reports the outcome
+    */
+    parallel_blocks(S, S, 1,
+      [&](size_t begin, size_t end)
+      {
+        for (size_t s = begin; s < end; s++)
+        {
+          uint64_t posted = 0;
+          uint64_t rejected = 0;
+
+          const std::vector<leg>& legs = shard_legs_[s];
+
+          for (size_t j = 0; j < legs.size();)
+          {
+            size_t m = legs[j].multi;
+            size_t i = legs[j].entry;
+
+            dfloat_accumulator total;
+            for (size_t t = 0; t < S; t++)
+            {
+              total.add(partials_[m * S + t]);
+            }
+
+            bool balanced = total.is_zero();
+
+            /* this shard's legs of the entry are consecutive */
+            for (; j < legs.size() and legs[j].multi == m; j++)
+            {
+              if (balanced)
+              {
+                balances_[accounts[legs[j].posting]].add(amounts[legs[j].posting]);
+              }
+            }
+
+            if (shard_of(accounts[offsets[i]]) == s)
+            {
+              posted += balanced;
+              rejected += not balanced;
+
+              if (accepted != nullptr)
+              {
+                accepted[i] = balanced;
+              }
+            }
+          }
+
+          posted_by_shard[s] += posted;
+          rejected_by_shard[s] += rejected;
+        }
+      });
+
+    uint64_t posted = 0;
+
+    for (size_t s = 0; s < S; s++)
+    {
+      posted += posted_by_shard[s];
+      rejected += rejected_by_shard[s];
+    }
+
+    posted_ += posted;
+    rejected_ += rejected;
+
+    return posted;
+  }
+
+  inline
+  dfloat ledger::balance(uint32_t account) const
+  {
+    return balances_[account].value();
+  }
+
+  inline
+  const dfloat_accumulator& ledger::exact_balance(uint32_t account) const
+  {
+    return balances_[account];
+  }
+
+  inline
+  uint64_t ledger::posted_entries() const
+  {
+    return posted_;
+  }
+
+  inline
+  uint64_t ledger::rejected_entries() const
+  {
+    return rejected_;
+  }
+
+  inline
+  bool ledger::verify() const
+  {
+    const size_t S = num_shards_;
+
+    std::vector<dfloat_accumulator> totals(S);
+
+    parallel_blocks(S, S, 1,
+      [&](size_t begin, size_t end)
+      {
+        for (size_t s = begin; s < end; s++)
+        {
+          size_t first = s * shard_size_;
+          size_t last = first + shard_size_ < balances_.size() ? first + shard_size_ : balances_.size();
+
+          dfloat_accumulator total;
+
+          for (size_t a = first; a < last; a++)
+          {
+            total.add(balances_[a]);
+          }
+
+          totals[s] = total;
+        }
+      });
+
+    dfloat_accumulator total;
+
+    for (const dfloat_accumulator& t : totals)
+    {
+      total.add(t);
+    }
+
+    return not total.isnan() and total.is_zero();
+  }
+}
@@ -0,0 +1,96 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  Describes how numbers are written in a given locale or
+            accounting convention
+    */
+  struct number_format
+  {
+    /**
+      @brief  Character between the integral and fractional parts
+      */
+    char decimal = '.';
+
+    /**
+      @brief  Character between groups of integral digits, or 0 if numbers
+              are not grouped
+      @note   If this is ' ', a space which is not followed by a digit ends
+              the number instead
+      */
+    char group = 0;
+
+    /**
+      @brief  Whether a number in parentheses is negative, e.g. "(1,234.56)"
+      */
+    bool paren_negative = false;
+
+    /**
+      @brief  Optional currency symbol before the number, e.g. "$"
+      @note   May be several bytes, e.g. UTF-8 "€" or "USD"
+      */
+    std::string currency_prefix;
+
+    /**
+      @brief  Optional currency symbol after the number, e.g. "€"
+      */
+    std::string currency_suffix;
+
+    /**
+      @brief  "1,234,567.89", "(1,234.56)", "$1,234.56"
+      */
+    static number_format accounting();
+
+    /**
+      @brief  "1.234.567,89", "1.234,56 €"
+      */
+    static number_format european();
+  };
+
+  /**
+    @brief  Parse [begin, end) as a dfloat written in the given format
+            Accepts, in order:
+              spaces, a sign or '(' and the currency prefix in either order,
+              digits with group separators, optionally a decimal separator
+              followed by digits,
+              spaces, the currency suffix, and ')' if there was a '('
+    @note   Single pass over the input and no allocation
+    @note   Decimal separator must be preceded by and followed by a digit,
+            like `dfloat::parse`. Group separators must be between two digits
+            of the integral part
+    @note   Scientific notation is not accepted
+    @note   Digits past the 19th significant digit are truncated
+    @note   If bad format, result is NaN.
+    */
+  dfloat parse_locale(const char* begin, const char* end, const number_format& fmt);
+
+  dfloat parse_locale(const std::string& str, const number_format& fmt);
+}
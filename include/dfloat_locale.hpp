@@ -0,0 +1,312 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstring>
+#include "dfloat.hpp"
+#include "dfloat_locale.h"
+
+namespace xu
+{
+  inline
+  number_format number_format::accounting()
+  {
+    number_format fmt;
+    fmt.decimal = '.';
+    fmt.group = ',';
+    fmt.paren_negative = true;
+    fmt.currency_prefix = "$";
+    return fmt;
+  }
+
+  inline
+  number_format number_format::european()
+  {
+    number_format fmt;
+    fmt.decimal = ',';
+    fmt.group = '.';
+    fmt.currency_suffix = "€";
+    return fmt;
+  }
+
+  /*
+    State machine
+
+      descr                       next char --> next state
+    state                         space   +-      (       prefix  0-9     group   decimal suffix  )       end     other
+    ------------------------------------------------------------------------------------------------------------------------
+    lead                          lead    lead*   lead*   lead*   whole   fail    fail    fail    fail    fail    fail
+      before the first digit;
+      * each at most once, and
+      only one of +- or (
+    whole                         trail   trail   trail   trail   whole   group   frac1   trail   trail   done    fail
+      in integral part
+    group                         fail    fail    fail    fail    whole   fail    fail    fail    fail    fail    fail
+      parsed a group separator,
+      expecting a digit
+    frac1                         fail    fail    fail    fail    frac2   fail    fail    fail    fail    fail    fail
+      parsed a decimal separator,
+      expecting a digit
+    frac2                         trail   trail   trail   trail   frac2   trail   trail   trail   trail   done    fail
+      in fractional part
+    trail                         trail   fail    fail    fail    fail    fail    fail    trail*  trail*  done    fail
+      after the last digit;
+      * each at most once, suffix
+      only if there was no prefix,
+      ) only if there was a (
+
+    done
+      {return number}, fail if a ( was not closed
+    fail
+      {return nan}
+
+    When the group separator is a space, "whole --space--> group" returns to
+    trail instead of failing if the next character is not a digit.
+  */
+  inline
+  dfloat parse_locale(const char* begin, const char* end, const number_format& fmt)
+  {
+    using Sign = dfloat::Sign;
+    using pow2_t = dfloat::pow2_t;
+
+    /* digits kept exactly, beyond that they are truncated */
+    constexpr int MAX_DIGITS = 19;
+
+    /* exponent beyond which the result is certainly out of range */
+    constexpr int32_t EXP_CAP = 4 * dfloat::MAX_POW;
+
+    bool neg = false;
+    bool sign_seen = false;
+    bool paren_open = false;
+    bool paren_closed = false;
+    bool prefix_seen = false;
+    bool suffix_seen = false;
+
+    uint64_t coef = 0;
+    int sig = 0;
+    int32_t exp = 0;
+
+    const char* it = begin;
+
+    const size_t prefix_size = fmt.currency_prefix.size();
+    const size_t suffix_size = fmt.currency_suffix.size();
+
+parse_locale_lead:
+    if (it == end)
+    {
+      goto parse_locale_fail;
+    }
+
+    if (*it == ' ')
+    {
+      ++it;
+      goto parse_locale_lead;
+    }
+
+    if (*it >= '0' and *it <= '9')
+    {
+      goto parse_locale_whole;
+    }
+
+    if (not sign_seen and (*it == '+' or *it == '-'))
+    {
+      neg = *it == '-';
+      sign_seen = true;
+      ++it;
+      goto parse_locale_lead;
+    }
+
+    if (not sign_seen and fmt.paren_negative and *it == '(')
+    {
+      neg = true;
+      sign_seen = true;
+      paren_open = true;
+      ++it;
+      goto parse_locale_lead;
+    }
+
+    if (not prefix_seen and prefix_size > 0 and (size_t)(end - it) >= prefix_size
+      and std::memcmp(it, fmt.currency_prefix.data(), prefix_size) == 0)
+    {
+      prefix_seen = true;
+      it += prefix_size;
+      goto parse_locale_lead;
+    }
+
+    goto parse_locale_fail;
+
+parse_locale_whole:
+    /* we only transition into whole state after a digit 0-9 */
+    if (sig < MAX_DIGITS)
+    {
+      coef = coef * dfloat::BASE + (*it - '0');
+
+      /* leading zeros are not significant */
+      if (coef != 0)
+      {
+        ++sig;
+      }
+    }
+    else
+    {
+      /* out of precision, the digit is truncated */
+      if (++exp > EXP_CAP)
+      {
+        goto parse_locale_fail;
+      }
+    }
+
+    if (++it == end)
+    {
+      goto parse_locale_done;
+    }
+
+    if (*it >= '0' and *it <= '9')
+    {
+      goto parse_locale_whole;
+    }
+
+    if (fmt.group != 0 and *it == fmt.group)
+    {
+      goto parse_locale_group;
+    }
+
+    if (*it == fmt.decimal)
+    {
+      goto parse_locale_frac1;
+    }
+
+    goto parse_locale_trail;
+
+parse_locale_group:
+    if (++it != end and *it >= '0' and *it <= '9')
+    {
+      goto parse_locale_whole;
+    }
+
+    /* a space separator may also just be the space before a suffix */
+    if (fmt.group == ' ')
+    {
+      goto parse_locale_trail;
+    }
+
+    goto parse_locale_fail;
+
+parse_locale_frac1:
+    if (++it == end)
+    {
+      goto parse_locale_fail;
+    }
+
+    if (*it >= '0' and *it <= '9')
+    {
+      goto parse_locale_frac2;
+    }
+
+    goto parse_locale_fail;
+
+parse_locale_frac2:
+    /* digits past the precision are ignored */
+    if (sig < MAX_DIGITS)
+    {
+      coef = coef * dfloat::BASE + (*it - '0');
+
+      if (coef != 0)
+      {
+        ++sig;
+      }
+
+      /* runs of zeros after the decimal point can only make the result zero */
+      if (exp > -EXP_CAP)
+      {
+        --exp;
+      }
+    }
+
+    if (++it == end)
+    {
+      goto parse_locale_done;
+    }
+
+    if (*it >= '0' and *it <= '9')
+    {
+      goto parse_locale_frac2;
+    }
+
+    goto parse_locale_trail;
+
+parse_locale_trail:
+    if (it == end)
+    {
+      goto parse_locale_done;
+    }
+
+    if (*it == ' ')
+    {
+      ++it;
+      goto parse_locale_trail;
+    }
+
+    if (paren_open and not paren_closed and *it == ')')
+    {
+      paren_closed = true;
+      ++it;
+      goto parse_locale_trail;
+    }
+
+    if (not prefix_seen and not suffix_seen and not paren_closed and suffix_size > 0
+      and (size_t)(end - it) >= suffix_size
+      and std::memcmp(it, fmt.currency_suffix.data(), suffix_size) == 0)
+    {
+      suffix_seen = true;
+      it += suffix_size;
+      goto parse_locale_trail;
+    }
+
+    goto parse_locale_fail;
+
+parse_locale_fail:
+    return dfloat::from_scaled(Sign::_NAN_, 0, 0);
+
+parse_locale_done:
+    if (paren_open and not paren_closed)
+    {
+      goto parse_locale_fail;
+    }
+
+    if (coef == 0 or exp <= -EXP_CAP)
+    {
+      return dfloat(0);
+    }
+
+    return dfloat::from_scaled(neg ? Sign::NEG : Sign::POS, coef, (pow2_t)exp);
+  }
+
+  inline
+  dfloat parse_locale(const std::string& str, const number_format& fmt)
+  {
+    return parse_locale(str.data(), str.data() + str.size(), fmt);
+  }
+}
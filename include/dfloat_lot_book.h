@@ -0,0 +1,180 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_accumulator.h"
+#include "dfloat_column.h"
+
+namespace xu
+{
+  /**
+    @brief  Which open lots a closing fill is matched against
+    */
+  enum class lot_method : uint8_t
+  {
+    FIFO,       // oldest lot first
+    LIFO,       // newest lot first
+    AVERAGE     // one pooled lot at the average cost
+  };
+
+  /**
+    @brief  Open positions and realized P&L of many accounts, matching fills
+            against open lots
+    @note   A fill with a positive quantity buys, negative sells. A fill
+            against the position closes lots until the position is flat,
+            and any remainder opens a lot on the other side
+    @note   Realized P&L and cost basis are `dfloat_accumulator`s: each
+            match adds the exact product `(price - cost) * quantity`, so
+            nothing is truncated until the result is read. With the average cost
+            method, the average is truncated once per match, and the
+            difference is realized exactly when the position goes flat
+    @note   The lots of each account live in one array, used as a queue
+            (FIFO) or a stack (LIFO), with prices and quantities as 64-bit
+            coefficients and exponents. Each fill is converted once;
+            matching then only compares, subtracts and multiplies integers,
+            the products in 128 bits
+    @note   Fills with a NaN or zero quantity, a NaN price, or an account out
+            of range are counted and ignored
+    */
+  class lot_book
+  {
+  public:
+    lot_book(size_t num_accounts, lot_method method);
+
+    size_t num_accounts() const;
+
+    lot_method method() const;
+
+    void add(uint32_t account, const dfloat& price, const dfloat& quantity);
+
+    /**
+      @note   Accounts are split into contiguous ranges across `threads`
+              threads, each scanning all fills for its own range, so every
+              account sees its fills in order without locks
+      */
+    void add(const uint32_t* accounts, const dfloat* prices, const dfloat* quantities,
+      size_t count, size_t threads = 1);
+
+    /**
+      @brief  Signed quantity held, negative if short
+      */
+    dfloat position(uint32_t account) const;
+
+    dfloat realized(uint32_t account) const;
+
+    const dfloat_accumulator& exact_realized(uint32_t account) const;
+
+    /**
+      @brief  Cost of the open position, signed like the position
+      */
+    dfloat cost_basis(uint32_t account) const;
+
+    /**
+      @brief  Cost basis divided by position, truncated once; NaN if flat
+      */
+    dfloat average_cost(uint32_t account) const;
+
+    /**
+      @brief  `mark * position - cost_basis`, truncated once
+      */
+    dfloat unrealized(uint32_t account, const dfloat& mark) const;
+
+    /**
+      @brief  Number of open lots; at most 1 with the average cost method
+      */
+    size_t open_lots(uint32_t account) const;
+
+    uint64_t ignored_fills() const;
+
+  protected:
+    using wide_t = dfloat_accumulator::wide_t;
+    using uwide_t = dfloat_accumulator::uwide_t;
+
+    /* prices and quantities are kept as `coef * 10^exp`, from `to_decimal` */
+    struct lot
+    {
+      int64_t price;
+
+      /* always positive, the side is the sign of the position */
+      int64_t quantity;
+
+      dfloat::pow2_t price_exp;
+      dfloat::pow2_t quantity_exp;
+    };
+
+    struct account
+    {
+      /* open lots in [head, size), oldest first */
+      std::vector<lot> lots;
+      size_t head;
+
+      dfloat_accumulator position;
+      dfloat_accumulator realized;
+
+      /* average cost method only; otherwise the lots are summed when read */
+      dfloat_accumulator cost;
+
+      /* average cost method: `cost / position` as of the last opening fill, 0 if not computed yet */
+      int64_t average;
+      dfloat::pow2_t average_exp;
+    };
+
+    /* returns false if the fill is ignored */
+    bool _add(account& a, const dfloat& price, const dfloat& quantity);
+
+    /*
+      close up to `quantity` (positive) of the position, leaving the rest in
+      `quantity`; returns false, changing nothing, if the position is out of range
+    */
+    bool _close(account& a, int direction, int64_t price, dfloat::pow2_t price_exp,
+      int64_t& quantity, dfloat::pow2_t& quantity_exp);
+
+    void _open(account& a, int direction, int64_t price, dfloat::pow2_t price_exp,
+      int64_t quantity, dfloat::pow2_t quantity_exp);
+
+    /* realize `quantity` of a lot at `cost` against a fill at `price` */
+    static void _match(account& a, int direction, int64_t price, dfloat::pow2_t price_exp,
+      int64_t cost, dfloat::pow2_t cost_exp, int64_t quantity, dfloat::pow2_t quantity_exp);
+
+    dfloat_accumulator _cost(const account& a) const;
+
+    /* exact comparison of two non-negative quantities: -1, 0 or 1 */
+    static int _compare(int64_t a, dfloat::pow2_t a_exp, int64_t b, dfloat::pow2_t b_exp);
+
+    /* `a -= b` for quantities `a >= b >= 0`; truncated only past 18 digits */
+    static void _subtract(int64_t& a, dfloat::pow2_t& a_exp, int64_t b, dfloat::pow2_t b_exp);
+
+    lot_method method_;
+    std::vector<account> accounts_;
+    uint64_t ignored_;
+
+    std::mutex mutex_;
+  };
+}
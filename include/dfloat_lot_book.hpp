@@ -0,0 +1,403 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include "dfloat.hpp"
+#include "dfloat_accumulator.hpp"
+#include "dfloat_column.hpp"
+#include "dfloat_lot_book.h"
+
+namespace xu
+{
+  inline
+  lot_book::lot_book(size_t num_accounts, lot_method method)
+    : method_(method), accounts_(num_accounts), ignored_(0)
+  {
+    for (account& a : accounts_)
+    {
+      a.head = 0;
+      a.average = 0;
+      a.average_exp = 0;
+    }
+  }
+
+  inline
+  size_t lot_book::num_accounts() const
+  {
+    return accounts_.size();
+  }
+
+  inline
+  lot_method lot_book::method() const
+  {
+    return method_;
+  }
+
+  inline
+  void lot_book::add(uint32_t account, const dfloat& price, const dfloat& quantity)
+  {
+    if (account >= accounts_.size() or not _add(accounts_[account], price, quantity))
+    {
+      ++ignored_;
+    }
+  }
+
+  inline
+  void lot_book::add(const uint32_t* accounts, const dfloat* prices, const dfloat* quantities,
+    size_t count, size_t threads)
+  {
+    /* enough accounts per thread that ranges do not share cache lines */
+    constexpr size_t BLOCK = 64;
+
+    size_t num_accounts = accounts_.size();
+
+    parallel_blocks(num_accounts, threads, BLOCK,
+      [&](size_t begin, size_t end)
+      {
+        uint64_t ignored = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+          size_t id = accounts[i];
+
+          if (id >= begin and id < end)
+          {
+            ignored += not _add(accounts_[id], prices[i], quantities[i]);
+          }
+          else if (id >= num_accounts and begin == 0)
+          {
+            /* owned by no range, counted by the first */
+            ++ignored;
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ignored_ += ignored;
+      });
+  }
+
+  inline
+  bool lot_book::_add(account& a, const dfloat& price, const dfloat& quantity)
+  {
+    int64_t p, q;
+    dfloat::pow2_t p_exp, q_exp;
+
+    if (not price.to_decimal(p, p_exp) or not quantity.to_decimal(q, q_exp) or q == 0)
+    {
+      return false;
+    }
+
+    int direction = q > 0 ? 1 : -1;
+    int held = a.position.sign();
+
+    /* at most 18 digits, negation cannot overflow */
+    int64_t rest = q * direction;
+    dfloat::pow2_t rest_exp = q_exp;
+
+    if (held != 0 and held != direction and not _close(a, held, p, p_exp, rest, rest_exp))
+    {
+      return false;
+    }
+
+    if (rest != 0)
+    {
+      _open(a, direction, p, p_exp, rest, rest_exp);
+    }
+
+    a.position.add_scaled(q, q_exp);
+
+    return true;
+  }
+
+  inline
+  void lot_book::_open(account& a, int direction, int64_t price, dfloat::pow2_t price_exp,
+    int64_t quantity, dfloat::pow2_t quantity_exp)
+  {
+    if (method_ == lot_method::AVERAGE)
+    {
+      a.cost.add_scaled((wide_t)price * quantity * direction, price_exp + quantity_exp);
+      a.average = 0;
+    }
+    else
+    {
+      a.lots.push_back({price, quantity, price_exp, quantity_exp});
+    }
+  }
+
+  inline
+  void lot_book::_match(account& a, int direction, int64_t price, dfloat::pow2_t price_exp,
+    int64_t cost, dfloat::pow2_t cost_exp, int64_t quantity, dfloat::pow2_t quantity_exp)
+  {
+    /*
+      Closing `quantity` of a lot at `cost` realizes `(price - cost) * quantity`
+      for a long position, `(cost - price) * quantity` for a short one
+    */
+    if (price_exp == cost_exp)
+    {
+      /* both below 10^18 in magnitude, the difference fits in 64 bits */
+      a.realized.add_scaled((wide_t)(price - cost) * quantity * direction, price_exp + quantity_exp);
+    }
+    else
+    {
+      a.realized.add_scaled((wide_t)price * quantity * direction, price_exp + quantity_exp);
+      a.realized.add_scaled(-(wide_t)cost * quantity * direction, cost_exp + quantity_exp);
+    }
+  }
+
+  inline
+  bool lot_book::_close(account& a, int direction, int64_t price, dfloat::pow2_t price_exp,
+    int64_t& quantity, dfloat::pow2_t& quantity_exp)
+  {
+    if (method_ == lot_method::AVERAGE)
+    {
+      int64_t held;
+      dfloat::pow2_t held_exp;
+
+      /* a position beyond the range of dfloat cannot be matched against */
+      if (not (direction > 0 ? a.position.value() : -a.position.value()).to_decimal(held, held_exp))
+      {
+        return false;
+      }
+
+      if (_compare(quantity, quantity_exp, held, held_exp) >= 0)
+      {
+        /*
+          Going flat: whatever is left of the cost basis is realized, so the
+          truncated averages of earlier matches leave nothing behind
+        */
+        a.realized.add_scaled((wide_t)price * held * direction, price_exp + held_exp);
+        a.realized.subtract(a.cost);
+        a.cost.reset();
+        a.average = 0;
+
+        _subtract(quantity, quantity_exp, held, held_exp);
+        return true;
+      }
+
+      /* divided only after the position grew, the division is the slow part */
+      if (a.average == 0 and not a.cost.divide(a.position).to_decimal(a.average, a.average_exp))
+      {
+        a.average = 0;
+        return false;
+      }
+
+      _match(a, direction, price, price_exp, a.average, a.average_exp, quantity, quantity_exp);
+      a.cost.add_scaled(-(wide_t)a.average * quantity * direction, a.average_exp + quantity_exp);
+
+      quantity = 0;
+      return true;
+    }
+
+    while (quantity != 0 and a.head < a.lots.size())
+    {
+      lot& l = method_ == lot_method::FIFO ? a.lots[a.head] : a.lots.back();
+
+      if (_compare(l.quantity, l.quantity_exp, quantity, quantity_exp) <= 0)
+      {
+        _match(a, direction, price, price_exp, l.price, l.price_exp, l.quantity, l.quantity_exp);
+        _subtract(quantity, quantity_exp, l.quantity, l.quantity_exp);
+
+        if (method_ == lot_method::FIFO)
+        {
+          ++a.head;
+        }
+        else
+        {
+          a.lots.pop_back();
+        }
+      }
+      else
+      {
+        _match(a, direction, price, price_exp, l.price, l.price_exp, quantity, quantity_exp);
+        _subtract(l.quantity, l.quantity_exp, quantity, quantity_exp);
+        quantity = 0;
+      }
+    }
+
+    /* reclaim the consumed front of the queue once it is most of the array */
+    constexpr size_t COMPACT = 32;
+
+    if (a.head == a.lots.size())
+    {
+      a.lots.clear();
+      a.head = 0;
+    }
+    else if (a.head >= COMPACT and a.head * 2 >= a.lots.size())
+    {
+      a.lots.erase(a.lots.begin(), a.lots.begin() + a.head);
+      a.head = 0;
+    }
+
+    return true;
+  }
+
+  inline
+  int lot_book::_compare(int64_t a, dfloat::pow2_t a_exp, int64_t b, dfloat::pow2_t b_exp)
+  {
+    if (a == 0 or b == 0 or a_exp == b_exp)
+    {
+      return a < b ? -1 : a > b ? 1 : 0;
+    }
+
+    /* coefficients are below 10^19: a gap of 19 or more decides alone */
+    int shift = a_exp - b_exp;
+
+    if (shift >= 19)
+    {
+      return 1;
+    }
+    if (shift <= -19)
+    {
+      return -1;
+    }
+
+    uwide_t x = shift > 0 ? (uwide_t)a * dfloat_accumulator::pow10(shift) : (uwide_t)a;
+    uwide_t y = shift < 0 ? (uwide_t)b * dfloat_accumulator::pow10(-shift) : (uwide_t)b;
+
+    return x < y ? -1 : x > y ? 1 : 0;
+  }
+
+  inline
+  void lot_book::_subtract(int64_t& a, dfloat::pow2_t& a_exp, int64_t b, dfloat::pow2_t b_exp)
+  {
+    if (b == 0)
+    {
+      return;
+    }
+
+    if (a_exp == b_exp)
+    {
+      a -= b;
+      return;
+    }
+
+    int shift = a_exp - b_exp;
+
+    /* `b` is below the last digit `a` can hold, as in dfloat subtraction */
+    if (shift >= 19)
+    {
+      return;
+    }
+
+    /* `a >= b`, so if `b` has the larger exponent the gap is small too */
+    uwide_t x = shift > 0 ? (uwide_t)a * dfloat_accumulator::pow10(shift) : (uwide_t)a;
+    uwide_t y = shift < 0 ? (uwide_t)b * dfloat_accumulator::pow10(-shift) : (uwide_t)b;
+    uwide_t d = x - y;
+    dfloat::pow2_t e = shift > 0 ? b_exp : a_exp;
+
+    /* rarely needed: back to 64 bits, dropping trailing digits */
+    while (d > (uwide_t)INT64_MAX)
+    {
+      d /= dfloat::BASE;
+      ++e;
+    }
+
+    a = (int64_t)d;
+    a_exp = d == 0 ? 0 : e;
+  }
+
+  inline
+  dfloat_accumulator lot_book::_cost(const account& a) const
+  {
+    if (method_ == lot_method::AVERAGE)
+    {
+      return a.cost;
+    }
+
+    dfloat_accumulator cost;
+    int direction = a.position.sign();
+
+    for (size_t i = a.head; i < a.lots.size(); i++)
+    {
+      const lot& l = a.lots[i];
+      cost.add_scaled((wide_t)l.price * l.quantity * direction, l.price_exp + l.quantity_exp);
+    }
+
+    return cost;
+  }
+
+  inline
+  dfloat lot_book::position(uint32_t account) const
+  {
+    return accounts_[account].position.value();
+  }
+
+  inline
+  dfloat lot_book::realized(uint32_t account) const
+  {
+    return accounts_[account].realized.value();
+  }
+
+  inline
+  const dfloat_accumulator& lot_book::exact_realized(uint32_t account) const
+  {
+    return accounts_[account].realized;
+  }
+
+  inline
+  dfloat lot_book::cost_basis(uint32_t account) const
+  {
+    return _cost(accounts_[account]).value();
+  }
+
+  inline
+  dfloat lot_book::average_cost(uint32_t account) const
+  {
+    const lot_book::account& a = accounts_[account];
+
+    return _cost(a).divide(a.position);
+  }
+
+  inline
+  dfloat lot_book::unrealized(uint32_t account, const dfloat& mark) const
+  {
+    const lot_book::account& a = accounts_[account];
+
+    dfloat_accumulator result;
+    result.add_product(mark, a.position.value());
+    result.subtract(_cost(a));
+
+    return result.value();
+  }
+
+  inline
+  size_t lot_book::open_lots(uint32_t account) const
+  {
+    const lot_book::account& a = accounts_[account];
+
+    if (method_ == lot_method::AVERAGE)
+    {
+      return a.position.is_zero() ? 0 : 1;
+    }
+
+    return a.lots.size() - a.head;
+  }
+
+  inline
+  uint64_t lot_book::ignored_fills() const
+  {
+    return ignored_;
+  }
+}
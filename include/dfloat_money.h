@@ -0,0 +1,70 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  Amount as whole units plus billionths, as in google.type.Money
+            (without the currency code)
+    @note   The amount is `units + nanos * 10^-9`. `nanos` is in
+            (-10^9, 10^9) and has the same sign as `units` when `units` is
+            nonzero
+    */
+  struct units_nanos
+  {
+    int64_t units;
+    int32_t nanos;
+  };
+
+  /**
+    @brief  Convert to dfloat
+    @note   Exact up to 18 significant digits, truncated beyond that
+    @note   If `nanos` is out of range or its sign disagrees with `units`,
+            result is NaN
+    */
+  dfloat from_units_nanos(const units_nanos& m);
+
+  /**
+    @brief  Convert from dfloat, truncating to a multiple of 10^-9
+    @return false if `d` is nan or its whole part does not fit in `units`
+    */
+  bool to_units_nanos(const dfloat& d, units_nanos& m);
+
+  /**
+    @brief  Convert `count` amounts
+    */
+  void from_units_nanos(const units_nanos* src, size_t count, dfloat* out);
+
+  /**
+    @brief  Convert `count` dfloats
+    @return false if any conversion failed; those amounts are set to zero
+    */
+  bool to_units_nanos(const dfloat* src, size_t count, units_nanos* out);
+}
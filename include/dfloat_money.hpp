@@ -0,0 +1,154 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include "dfloat.hpp"
+#include "dfloat_accumulator.hpp"
+#include "dfloat_money.h"
+
+namespace xu
+{
+  inline
+  dfloat from_units_nanos(const units_nanos& m)
+  {
+    using Sign = dfloat::Sign;
+
+    constexpr int32_t NANOS_PER_UNIT = 1000000000;
+
+    bool bad_nanos = m.nanos <= -NANOS_PER_UNIT or m.nanos >= NANOS_PER_UNIT;
+    bool bad_sign = (m.units > 0 and m.nanos < 0) or (m.units < 0 and m.nanos > 0);
+
+    if (bad_nanos or bad_sign)
+    {
+      return dfloat::from_scaled(Sign::_NAN_, 0, 0);
+    }
+
+    /* signs agree, so the magnitudes add; at most 29 digits */
+    bool neg = m.units < 0 or m.nanos < 0;
+
+    dfloat::mant2_t units_mag = neg ? 0 - (uint64_t)m.units : (uint64_t)m.units;
+    dfloat::mant2_t nanos_mag = neg ? -(int64_t)m.nanos : m.nanos;
+
+    dfloat::mant2_t coef = units_mag * NANOS_PER_UNIT + nanos_mag;
+
+    return dfloat::from_scaled(neg ? Sign::NEG : Sign::POS, coef, -9);
+  }
+
+  inline
+  bool to_units_nanos(const dfloat& d, units_nanos& m)
+  {
+    int64_t coef;
+    dfloat::pow2_t exp;
+
+    if (not d.to_decimal(coef, exp))
+    {
+      return false;
+    }
+
+    /* the value is exactly coef * 10^exp, split it without any rounding */
+    bool neg = coef < 0;
+    uint64_t mag = neg ? -coef : coef;
+
+    uint64_t units;
+    uint64_t nanos;
+
+    if (exp >= 0)
+    {
+      /* coef has at least one digit */
+      if (exp > 18)
+      {
+        return false;
+      }
+
+      uint64_t scale = (uint64_t)dfloat_accumulator::pow10(exp);
+
+      if (mag > (uint64_t)std::numeric_limits<int64_t>::max() / scale)
+      {
+        return false;
+      }
+
+      units = mag * scale;
+      nanos = 0;
+    }
+    else
+    {
+      /* coef has at most 18 digits, so a larger shift leaves no units */
+      uint64_t frac = mag;
+      units = 0;
+
+      if (-exp <= 18)
+      {
+        uint64_t scale = (uint64_t)dfloat_accumulator::pow10(-exp);
+        units = mag / scale;
+        frac = mag % scale;
+      }
+
+      /* frac * 10^exp in nanos */
+      if (-exp <= 9)
+      {
+        nanos = frac * (uint64_t)dfloat_accumulator::pow10(9 + exp);
+      }
+      else if (-exp - 9 <= 18)
+      {
+        nanos = frac / (uint64_t)dfloat_accumulator::pow10(-exp - 9);
+      }
+      else
+      {
+        nanos = 0;
+      }
+    }
+
+    m.units = neg ? -(int64_t)units : (int64_t)units;
+    m.nanos = neg ? -(int32_t)nanos : (int32_t)nanos;
+
+    return true;
+  }
+
+  inline
+  void from_units_nanos(const units_nanos* src, size_t count, dfloat* out)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      out[i] = from_units_nanos(src[i]);
+    }
+  }
+
+  inline
+  bool to_units_nanos(const dfloat* src, size_t count, units_nanos* out)
+  {
+    bool ok = true;
+
+    for (size_t i = 0; i < count; i++)
+    {
+      if (not to_units_nanos(src[i], out[i]))
+      {
+        out[i] = units_nanos{0, 0};
+        ok = false;
+      }
+    }
+
+    return ok;
+  }
+}
@@ -0,0 +1,151 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_accumulator.h"
+#include "dfloat_column.h"
+
+namespace xu
+{
+  /**
+    @brief  Completed bars, one row per bar
+    */
+  struct ohlc_columns
+  {
+    std::vector<uint32_t> instrument;
+
+    /**
+      @brief  Start of the bar's interval
+      */
+    std::vector<int64_t> start;
+
+    dfloat_column open;
+    dfloat_column high;
+    dfloat_column low;
+    dfloat_column close;
+
+    /**
+      @brief  Sum of quantities, exact then truncated once
+      */
+    dfloat_column volume;
+
+    std::vector<uint64_t> trades;
+
+    size_t size() const;
+
+    void clear();
+  };
+
+  /**
+    @brief  Builds open/high/low/close/volume bars of a fixed interval (e.g.
+            1s, 1m, 5m) from the trades of many instruments
+    @note   The state of each instrument's open bar lives in a dense array
+            indexed by instrument id; there is no lookup per trade
+    @note   High and low are kept as `dfloat::to_key` keys, so each trade
+            costs two integer comparisons instead of dfloat comparisons
+    @note   A trade for a later interval closes the instrument's open bar.
+            Trades for an interval before the open bar are late, counted and
+            ignored. Trades with a NaN price are ignored too
+    */
+  class bar_builder
+  {
+  public:
+    /**
+      @param  interval  bar length, in the unit of trade times
+      @param  origin    a time at which a bar starts
+      */
+    bar_builder(size_t num_instruments, int64_t interval, int64_t origin = 0);
+
+    size_t num_instruments() const;
+
+    int64_t interval() const;
+
+    /**
+      @brief  Start of the interval holding `time`
+      */
+    int64_t bar_start(int64_t time) const;
+
+    void add(uint32_t instrument, int64_t time, const dfloat& price, const dfloat& quantity);
+
+    /**
+      @brief  Add `count` trades from columns; ids outside the instrument
+              range are ignored
+      @note   Instruments are split into contiguous ranges across `threads`
+              threads, each scanning all trades for its own range, so every
+              instrument sees its trades in column order without locks
+      */
+    void add(const uint32_t* instruments, const int64_t* times, const dfloat* prices, const dfloat* quantities,
+      size_t count, size_t threads = 1);
+
+    /**
+      @brief  Close every open bar whose interval ended at or before `now`,
+              and move all closed bars into `out`
+      @note   Bars are appended ordered by start, then instrument
+      */
+    void flush(int64_t now, ohlc_columns& out);
+
+    /**
+      @brief  Close every open bar, and move all closed bars into `out`
+      */
+    void flush_all(ohlc_columns& out);
+
+    uint64_t late_trades() const;
+
+  protected:
+    struct bar
+    {
+      int64_t start;
+      uint32_t instrument;
+      uint64_t trades;
+      dfloat open;
+      dfloat close;
+      dfloat::mant2_t high_key;
+      dfloat::mant2_t low_key;
+      dfloat_accumulator volume;
+    };
+
+    /* `closed` collects bars of the instruments this caller owns */
+    void _add(uint32_t instrument, int64_t time, const dfloat& price, const dfloat& quantity,
+      std::vector<bar>& closed, uint64_t& late);
+
+    void _emit(ohlc_columns& out);
+
+    int64_t interval_;
+    int64_t origin_;
+
+    /* open bar of each instrument, `trades == 0` if none */
+    std::vector<bar> open_;
+
+    std::vector<bar> closed_;
+    uint64_t late_;
+
+    std::mutex mutex_;
+  };
+}
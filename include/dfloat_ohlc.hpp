@@ -0,0 +1,245 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include "dfloat.hpp"
+#include "dfloat_accumulator.hpp"
+#include "dfloat_column.hpp"
+#include "dfloat_ohlc.h"
+
+namespace xu
+{
+  inline
+  size_t ohlc_columns::size() const
+  {
+    return instrument.size();
+  }
+
+  inline
+  void ohlc_columns::clear()
+  {
+    instrument.clear();
+    start.clear();
+    open.resize(0);
+    high.resize(0);
+    low.resize(0);
+    close.resize(0);
+    volume.resize(0);
+    trades.clear();
+  }
+
+  inline
+  bar_builder::bar_builder(size_t num_instruments, int64_t interval, int64_t origin)
+    : interval_(interval > 0 ? interval : 1), origin_(origin), open_(num_instruments), late_(0)
+  {
+    for (size_t i = 0; i < num_instruments; i++)
+    {
+      open_[i].instrument = (uint32_t)i;
+      open_[i].trades = 0;
+    }
+  }
+
+  inline
+  size_t bar_builder::num_instruments() const
+  {
+    return open_.size();
+  }
+
+  inline
+  int64_t bar_builder::interval() const
+  {
+    return interval_;
+  }
+
+  inline
+  int64_t bar_builder::bar_start(int64_t time) const
+  {
+    /* floor division, also before the origin */
+    int64_t offset = time - origin_;
+    int64_t index = offset / interval_ - (offset % interval_ < 0 ? 1 : 0);
+
+    return origin_ + index * interval_;
+  }
+
+  inline
+  void bar_builder::_add(uint32_t instrument, int64_t time, const dfloat& price, const dfloat& quantity,
+    std::vector<bar>& closed, uint64_t& late)
+  {
+    dfloat::mant2_t key = price.to_key();
+
+    /* NaN has the largest key */
+    if (key >= dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0).to_key())
+    {
+      return;
+    }
+
+    bar& b = open_[instrument];
+    int64_t start = bar_start(time);
+
+    if (b.trades > 0)
+    {
+      if (start < b.start)
+      {
+        late++;
+        return;
+      }
+
+      if (start > b.start)
+      {
+        closed.push_back(b);
+        b.trades = 0;
+      }
+    }
+
+    if (b.trades == 0)
+    {
+      b.start = start;
+      b.open = price;
+      b.high_key = key;
+      b.low_key = key;
+      b.volume.reset();
+    }
+
+    b.high_key = key > b.high_key ? key : b.high_key;
+    b.low_key = key < b.low_key ? key : b.low_key;
+    b.close = price;
+    b.volume.add(quantity);
+    b.trades++;
+  }
+
+  inline
+  void bar_builder::add(uint32_t instrument, int64_t time, const dfloat& price, const dfloat& quantity)
+  {
+    if (instrument < open_.size())
+    {
+      _add(instrument, time, price, quantity, closed_, late_);
+    }
+  }
+
+  inline
+  void bar_builder::add(const uint32_t* instruments, const int64_t* times, const dfloat* prices, const dfloat* quantities,
+    size_t count, size_t threads)
+  {
+    /* enough instruments per thread that ranges do not share cache lines */
+    constexpr size_t BLOCK = 64;
+
+    parallel_blocks(open_.size(), threads, BLOCK,
+      [&](size_t begin, size_t end)
+      {
+        std::vector<bar> closed;
+        uint64_t late = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+          size_t id = instruments[i];
+
+          if (id >= begin and id < end)
+          {
+            _add((uint32_t)id, times[i], prices[i], quantities[i], closed, late);
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_.insert(closed_.end(), closed.begin(), closed.end());
+        late_ += late;
+      });
+  }
+
+  inline
+  void bar_builder::flush(int64_t now, ohlc_columns& out)
+  {
+    for (bar& b : open_)
+    {
+      if (b.trades > 0 and b.start + interval_ <= now)
+      {
+        closed_.push_back(b);
+        b.trades = 0;
+      }
+    }
+
+    _emit(out);
+  }
+
+  inline
+  void bar_builder::flush_all(ohlc_columns& out)
+  {
+    for (bar& b : open_)
+    {
+      if (b.trades > 0)
+      {
+        closed_.push_back(b);
+        b.trades = 0;
+      }
+    }
+
+    _emit(out);
+  }
+
+  inline
+  uint64_t bar_builder::late_trades() const
+  {
+    return late_;
+  }
+
+  inline
+  void bar_builder::_emit(ohlc_columns& out)
+  {
+    /* threads append in any order, sort to make the output deterministic */
+    std::sort(closed_.begin(), closed_.end(),
+      [](const bar& a, const bar& b)
+      {
+        return a.start < b.start or (a.start == b.start and a.instrument < b.instrument);
+      });
+
+    size_t base = out.size();
+    size_t n = closed_.size();
+
+    out.instrument.resize(base + n);
+    out.start.resize(base + n);
+    out.open.resize(base + n);
+    out.high.resize(base + n);
+    out.low.resize(base + n);
+    out.close.resize(base + n);
+    out.volume.resize(base + n);
+    out.trades.resize(base + n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+      const bar& b = closed_[i];
+
+      out.instrument[base + i] = b.instrument;
+      out.start[base + i] = b.start;
+      out.open[base + i] = b.open;
+      out.high[base + i] = dfloat::from_key(b.high_key);
+      out.low[base + i] = dfloat::from_key(b.low_key);
+      out.close[base + i] = b.close;
+      out.volume[base + i] = b.volume.value();
+      out.trades[base + i] = b.trades;
+    }
+
+    closed_.clear();
+  }
+}
@@ -0,0 +1,99 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  Physical type of a Parquet DECIMAL column
+    */
+  enum class parquet_type : uint8_t
+  {
+    INT64,                  // little-endian two's complement, 8 bytes
+    FIXED_LEN_BYTE_ARRAY    // big-endian two's complement, `type_length` bytes
+  };
+
+  /**
+    @brief  Schema of a Parquet DECIMAL column
+    @note   Each value is the unscaled integer `v`, meaning `v * 10^-scale`
+    */
+  struct parquet_decimal
+  {
+    parquet_type type;
+
+    /**
+      @brief  Bytes per value of a FIXED_LEN_BYTE_ARRAY, in [1, 16]
+      */
+    size_t type_length;
+
+    /**
+      @brief  Maximum number of digits of the unscaled integer, in [1, 38]
+      */
+    int precision;
+
+    int scale;
+  };
+
+  /**
+    @brief  Decode `count` PLAIN-encoded values, e.g. a data page or a
+            dictionary page
+    @note   Only the values section of the page: definition and repetition
+            levels, if any, must be skipped by the caller
+    @note   Unscaled integers with more than 18 digits are truncated
+    @return false if the page is shorter than `count` values
+    */
+  bool parquet_decode_plain(const char* page, size_t size, const parquet_decimal& schema, size_t count, dfloat* out);
+
+  /**
+    @brief  Decode `count` RLE_DICTIONARY-encoded values: a bit width byte
+            followed by RLE / bit-packed runs of indices into `dictionary`
+    @return false if the page is truncated or an index is out of range
+    */
+  bool parquet_decode_dictionary(const char* page, size_t size, const dfloat* dictionary, size_t dictionary_size, size_t count, dfloat* out);
+
+  /**
+    @brief  PLAIN-encode `count` values, appending them to `page`
+    @note   Values are truncated to `scale` decimal places
+    @return false if any value is nan or has more than `precision` digits,
+            in which case `page` is unchanged
+    */
+  bool parquet_encode_plain(const dfloat* src, size_t count, const parquet_decimal& schema, std::vector<char>& page);
+
+  /**
+    @brief  Dictionary-encode `count` values, appending the PLAIN-encoded
+            distinct values to `dictionary_page` and the RLE_DICTIONARY
+            indices to `data_page`
+    @note   Runs of at least 8 equal values are written as RLE runs, the rest
+            bit-packed
+    @return false under the same conditions as `parquet_encode_plain`, in
+            which case neither page is changed
+    */
+  bool parquet_encode_dictionary(const dfloat* src, size_t count, const parquet_decimal& schema, std::vector<char>& dictionary_page, std::vector<char>& data_page);
+}
@@ -0,0 +1,493 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include "dfloat.hpp"
+#include "dfloat_batch.hpp"
+#include "dfloat_endian.hpp"
+#include "dfloat_parquet.h"
+
+namespace xu
+{
+  /* unscaled integers of up to FIXED_LEN_BYTE_ARRAY(16) */
+  using parquet_int_t = __int128_t;
+
+  inline
+  dfloat _parquet_to_dfloat(parquet_int_t v, int scale)
+  {
+    if (v < 0)
+    {
+      return dfloat::from_scaled(dfloat::Sign::NEG, (dfloat::mant2_t)0 - (dfloat::mant2_t)v, -(dfloat::pow2_t)scale);
+    }
+    else
+    {
+      return dfloat::from_scaled(dfloat::Sign::POS, (dfloat::mant2_t)v, -(dfloat::pow2_t)scale);
+    }
+  }
+
+  /**
+    @brief  Unscaled integer of `d` in `schema`, truncated to `scale` places
+    @return false if nan or out of range
+    */
+  inline
+  bool _parquet_from_dfloat(const dfloat& d, const parquet_decimal& schema, parquet_int_t& v)
+  {
+    int64_t coef;
+    dfloat::pow2_t exp;
+
+    if (not d.to_decimal(coef, exp))
+    {
+      return false;
+    }
+
+    size_t bytes = schema.type == parquet_type::INT64 ? 8 : schema.type_length;
+
+    /* 10^38 is the largest power of ten below 2^127 */
+    if (bytes == 0 or bytes > 16 or schema.precision < 1 or schema.precision > 38)
+    {
+      return false;
+    }
+
+    int shift = exp + schema.scale;
+
+    uint64_t small = coef < 0 ? 0 - (uint64_t)coef : (uint64_t)coef;
+
+    /* coef has at most 18 digits, so a larger negative shift leaves nothing */
+    if (shift < -18)
+    {
+      small = 0;
+      shift = 0;
+    }
+
+    for (; shift < 0; shift++)
+    {
+      small /= 10;
+    }
+
+    dfloat::mant2_t mag = small;
+
+    dfloat::mant2_t cap = 1;
+    for (int i = 0; i < schema.precision; i++)
+    {
+      cap *= 10;
+    }
+
+    /* stop before `mag * 10` reaches the cap, so that it cannot wrap either */
+    for (; shift > 0; shift--)
+    {
+      if (mag > (cap - 1) / 10)
+      {
+        return false;
+      }
+      mag *= 10;
+    }
+
+    if (mag >= cap)
+    {
+      return false;
+    }
+
+    /* the digits may still not fit in the physical type */
+    if (bytes < 16 and mag >= (dfloat::mant2_t)1 << (8 * bytes - 1))
+    {
+      return false;
+    }
+
+    v = coef < 0 ? -(parquet_int_t)mag : (parquet_int_t)mag;
+
+    return true;
+  }
+
+  inline
+  void _parquet_put(parquet_int_t v, const parquet_decimal& schema, std::vector<char>& page)
+  {
+    if (schema.type == parquet_type::INT64)
+    {
+      char buf[8];
+      store<byte_order::LITTLE>((int64_t)v, buf);
+      page.insert(page.end(), buf, buf + 8);
+    }
+    else
+    {
+      __uint128_t u = (__uint128_t)v;
+
+      for (size_t i = 0; i < schema.type_length; i++)
+      {
+        page.push_back((char)(uint8_t)(u >> (8 * (schema.type_length - 1 - i))));
+      }
+    }
+  }
+
+  inline
+  void _parquet_put_uleb128(uint64_t x, std::vector<char>& page)
+  {
+    while (x >= 0x80)
+    {
+      page.push_back((char)(uint8_t)(x | 0x80));
+      x >>= 7;
+    }
+    page.push_back((char)(uint8_t)x);
+  }
+
+  inline
+  bool parquet_decode_plain(const char* page, size_t size, const parquet_decimal& schema, size_t count, dfloat* out)
+  {
+    if (schema.type == parquet_type::INT64)
+    {
+      if (size / 8 < count)
+      {
+        return false;
+      }
+
+      size_t i = 0;
+
+      for (; i + BATCH_LANES <= count; i += BATCH_LANES)
+      {
+        int64_t raw[BATCH_LANES];
+
+        for (size_t l = 0; l < BATCH_LANES; l++)
+        {
+          raw[l] = load<byte_order::LITTLE, int64_t>(page + (i + l) * 8);
+        }
+
+        for (size_t l = 0; l < BATCH_LANES; l++)
+        {
+          out[i + l] = dfloat::from_scaled(raw[l], -(dfloat::pow2_t)schema.scale);
+        }
+      }
+
+      for (; i < count; i++)
+      {
+        out[i] = dfloat::from_scaled(load<byte_order::LITTLE, int64_t>(page + i * 8), -(dfloat::pow2_t)schema.scale);
+      }
+
+      return true;
+    }
+
+    size_t len = schema.type_length;
+
+    if (len == 0 or len > 16 or size / len < count)
+    {
+      return false;
+    }
+
+    /* bits above the value, set when sign extending */
+    __uint128_t extend = len < 16 ? ~(__uint128_t)0 << (8 * len) : 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+      const uint8_t* p = reinterpret_cast<const uint8_t*>(page + i * len);
+
+      __uint128_t u = 0;
+
+      for (size_t b = 0; b < len; b++)
+      {
+        u = (u << 8) | p[b];
+      }
+
+      if (p[0] & 0x80)
+      {
+        u |= extend;
+      }
+
+      out[i] = _parquet_to_dfloat((parquet_int_t)u, schema.scale);
+    }
+
+    return true;
+  }
+
+  inline
+  bool parquet_decode_dictionary(const char* page, size_t size, const dfloat* dictionary, size_t dictionary_size, size_t count, dfloat* out)
+  {
+    if (count == 0)
+    {
+      return true;
+    }
+
+    if (size < 1)
+    {
+      return false;
+    }
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(page);
+    const uint8_t* end = p + size;
+
+    uint32_t bit_width = *p++;
+
+    if (bit_width > 32)
+    {
+      return false;
+    }
+
+    uint64_t mask = ((uint64_t)1 << bit_width) - 1;
+    size_t value_bytes = (bit_width + 7) / 8;
+
+    size_t i = 0;
+
+    while (i < count)
+    {
+      /* run header */
+      uint64_t header = 0;
+
+      for (int shift = 0; ; shift += 7)
+      {
+        if (p == end or shift > 63)
+        {
+          return false;
+        }
+
+        uint8_t byte = *p++;
+        header |= (uint64_t)(byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0)
+        {
+          break;
+        }
+      }
+
+      if (header & 1)
+      {
+        /* bit-packed: groups of 8 indices in `bit_width` bytes each */
+        uint64_t groups = header >> 1;
+
+        if (groups > (size_t)(end - p) / (bit_width > 0 ? bit_width : 1))
+        {
+          return false;
+        }
+
+        for (uint64_t g = 0; g < groups; g++)
+        {
+          /* padded so that every lane can load 8 bytes */
+          uint8_t buf[32 + 8] = {};
+          std::memcpy(buf, p, bit_width);
+          p += bit_width;
+
+          uint32_t idx[BATCH_LANES];
+
+          for (size_t l = 0; l < BATCH_LANES; l++)
+          {
+            size_t bit = l * bit_width;
+            idx[l] = (uint32_t)((load<byte_order::LITTLE, uint64_t>((const char*)buf + bit / 8) >> (bit % 8)) & mask);
+          }
+
+          /* the last group may be padded past the end of the page */
+          for (size_t l = 0; l < BATCH_LANES and i < count; l++, i++)
+          {
+            if (idx[l] >= dictionary_size)
+            {
+              return false;
+            }
+            out[i] = dictionary[idx[l]];
+          }
+        }
+      }
+      else
+      {
+        /* RLE: one index repeated */
+        uint64_t run = header >> 1;
+
+        if ((size_t)(end - p) < value_bytes)
+        {
+          return false;
+        }
+
+        uint32_t idx = 0;
+        for (size_t b = 0; b < value_bytes; b++)
+        {
+          idx |= (uint32_t)p[b] << (8 * b);
+        }
+        p += value_bytes;
+
+        if (idx >= dictionary_size)
+        {
+          return false;
+        }
+
+        for (; run > 0 and i < count; run--, i++)
+        {
+          out[i] = dictionary[idx];
+        }
+      }
+    }
+
+    return true;
+  }
+
+  inline
+  bool parquet_encode_plain(const dfloat* src, size_t count, const parquet_decimal& schema, std::vector<char>& page)
+  {
+    size_t bytes = schema.type == parquet_type::INT64 ? 8 : schema.type_length;
+    size_t start = page.size();
+
+    page.reserve(start + count * bytes);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      parquet_int_t v;
+
+      if (not _parquet_from_dfloat(src[i], schema, v))
+      {
+        page.resize(start);
+        return false;
+      }
+
+      _parquet_put(v, schema, page);
+    }
+
+    return true;
+  }
+
+  inline
+  bool parquet_encode_dictionary(const dfloat* src, size_t count, const parquet_decimal& schema, std::vector<char>& dictionary_page, std::vector<char>& data_page)
+  {
+    struct int_hash
+    {
+      size_t operator()(parquet_int_t v) const
+      {
+        __uint128_t u = (__uint128_t)v;
+        return std::hash<uint64_t>()((uint64_t)u ^ (uint64_t)(u >> 64) * 0x9e3779b97f4a7c15ull);
+      }
+    };
+
+    std::unordered_map<parquet_int_t, uint32_t, int_hash> ids;
+    std::vector<parquet_int_t> values;
+    std::vector<uint32_t> indices(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      parquet_int_t v;
+
+      if (not _parquet_from_dfloat(src[i], schema, v))
+      {
+        return false;
+      }
+
+      auto it = ids.find(v);
+
+      if (it == ids.end())
+      {
+        it = ids.emplace(v, (uint32_t)values.size()).first;
+        values.push_back(v);
+      }
+
+      indices[i] = it->second;
+    }
+
+    for (parquet_int_t v : values)
+    {
+      _parquet_put(v, schema, dictionary_page);
+    }
+
+    uint32_t bit_width = 0;
+    while (bit_width < 32 and values.size() > ((size_t)1 << bit_width))
+    {
+      bit_width++;
+    }
+
+    data_page.push_back((char)bit_width);
+
+    /* indices waiting to be bit-packed, always flushed in whole groups */
+    std::vector<uint32_t> pending;
+
+    auto flush = [&]()
+    {
+      if (pending.empty())
+      {
+        return;
+      }
+
+      while (pending.size() % BATCH_LANES != 0)
+      {
+        pending.push_back(0);
+      }
+
+      size_t groups = pending.size() / BATCH_LANES;
+
+      _parquet_put_uleb128((groups << 1) | 1, data_page);
+
+      for (size_t g = 0; g < groups; g++)
+      {
+        uint8_t buf[32 + 8] = {};
+
+        for (size_t l = 0; l < BATCH_LANES; l++)
+        {
+          uint64_t v = pending[g * BATCH_LANES + l];
+          size_t bit = l * bit_width;
+
+          for (size_t b = 0; b < bit_width; b++, bit++)
+          {
+            buf[bit / 8] |= (uint8_t)(((v >> b) & 1) << (bit % 8));
+          }
+        }
+
+        data_page.insert(data_page.end(), buf, buf + bit_width);
+      }
+
+      pending.clear();
+    };
+
+    size_t i = 0;
+
+    while (i < count)
+    {
+      size_t run = 1;
+      while (i + run < count and indices[i + run] == indices[i])
+      {
+        run++;
+      }
+
+      /* a run may only start where the pending indices fill whole groups */
+      size_t pad = (BATCH_LANES - pending.size() % BATCH_LANES) % BATCH_LANES;
+
+      if (run >= BATCH_LANES + pad)
+      {
+        pending.insert(pending.end(), pad, indices[i]);
+        i += pad;
+        run -= pad;
+
+        flush();
+
+        _parquet_put_uleb128((uint64_t)run << 1, data_page);
+
+        for (size_t b = 0; b < (bit_width + 7) / 8; b++)
+        {
+          data_page.push_back((char)(uint8_t)(indices[i] >> (8 * b)));
+        }
+
+        i += run;
+      }
+      else
+      {
+        pending.push_back(indices[i]);
+        i++;
+      }
+    }
+
+    flush();
+
+    return true;
+  }
+}
@@ -0,0 +1,149 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_locale.h"
+
+namespace xu
+{
+  /**
+    @brief  Shape of a `run_pipeline` run
+    @note   Each of the parse, compute and format steps runs on its own
+            group of threads. A thread count of 0 folds the step into the
+            previous stage instead, e.g. all three at 0 (and no separate
+            writer) runs everything on one thread
+    */
+  struct pipeline_options
+  {
+    /**
+      @brief  Number of input lines per batch
+      */
+    size_t batch_lines = 4096;
+
+    /**
+      @brief  Number of batches each queue between two threads can hold
+      */
+    size_t queue_depth = 4;
+
+    size_t parse_threads = 1;
+
+    size_t compute_threads = 1;
+
+    size_t format_threads = 1;
+
+    /**
+      @brief  Whether writing the output gets its own thread; it always does
+              if the stage before it has several threads
+      */
+    bool separate_writer = true;
+
+    /**
+      @brief  Format of input numbers (see `parse_locale`)
+      */
+    number_format input_format;
+
+    /**
+      @brief  Output field width and decimal places (see `format_fixed`)
+      */
+    size_t width = 24;
+
+    size_t decimals = 2;
+  };
+
+  /**
+    @brief  Result of a `run_pipeline` run
+    */
+  struct pipeline_stats
+  {
+    /**
+      @brief  false if a file could not be opened or written
+      */
+    bool ok = false;
+
+    uint64_t lines = 0;
+
+    /**
+      @brief  Lines which did not parse, written as "nan"
+      */
+    uint64_t invalid = 0;
+
+    uint64_t batches = 0;
+
+    uint64_t bytes_read = 0;
+
+    uint64_t bytes_written = 0;
+
+    /**
+      @brief  Number of thread groups the steps were split into
+      */
+    size_t stages = 0;
+
+    size_t threads = 0;
+  };
+
+  /**
+    @brief  Unit of work passed between pipeline stages
+    @note   A fixed pool of batches circulates from the reader to the writer
+            and back, so buffers are reused instead of allocated per batch
+    */
+  struct pipeline_batch
+  {
+    uint64_t sequence = 0;
+
+    /**
+      @brief  Lines of the batch, in the memory-mapped input
+      */
+    const char* input = nullptr;
+    size_t input_size = 0;
+    size_t lines = 0;
+
+    std::vector<dfloat> values;
+    uint64_t invalid = 0;
+
+    std::vector<char> output;
+  };
+
+  /**
+    @brief  Convert a file with one number per line into a file of
+            fixed-width formatted numbers, through the steps
+              read -> parse -> compute(values, count) -> format -> write
+    @note   Each stage runs on its own thread or group of threads. Stages
+            are connected by bounded lock-free single-producer
+            single-consumer queues of batches: a group of P threads feeding
+            a group of C threads uses P * C queues, batch `k` going from
+            thread `k % P` to thread `k % C`, so output order is preserved
+            without any lock or reorder buffer
+    @note   A full queue blocks its producer, so memory use is bounded by
+            the batch pool whatever the relative speed of the stages
+    @note   `compute` is called concurrently from `compute_threads` threads
+    */
+  template <typename F>
+  pipeline_stats run_pipeline(const std::string& input_path, const std::string& output_path, const pipeline_options& options, F compute);
+}
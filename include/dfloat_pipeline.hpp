@@ -0,0 +1,322 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <thread>
+#include <unistd.h>
+#include "dfloat.hpp"
+#include "dfloat_batch.hpp"
+#include "dfloat_locale.hpp"
+#include "dfloat_pipeline.h"
+#include "dfloat_record.hpp"
+#include "dfloat_spsc_queue.hpp"
+
+namespace xu
+{
+  /* take up to `lines` lines starting at `pos`, return the end of the batch */
+  inline
+  const char* _pipeline_read(pipeline_batch& batch, const char* pos, const char* end, size_t lines)
+  {
+    batch.input = pos;
+    batch.lines = 0;
+
+    while (pos != end and batch.lines < lines)
+    {
+      const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+      pos = newline != nullptr ? newline + 1 : end;
+      batch.lines++;
+    }
+
+    batch.input_size = pos - batch.input;
+
+    return pos;
+  }
+
+  inline
+  void _pipeline_parse(pipeline_batch& batch, const number_format& fmt)
+  {
+    batch.values.resize(batch.lines);
+    batch.invalid = 0;
+
+    const char* pos = batch.input;
+    const char* end = batch.input + batch.input_size;
+
+    for (size_t i = 0; i < batch.lines; i++)
+    {
+      const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+      const char* stop = newline != nullptr ? newline : end;
+
+      if (stop != pos and *(stop - 1) == '\r')
+      {
+        --stop;
+      }
+
+      batch.values[i] = parse_locale(pos, stop, fmt);
+      batch.invalid += dfloat::isfinite(batch.values[i]) ? 0 : 1;
+
+      pos = newline != nullptr ? newline + 1 : end;
+    }
+  }
+
+  inline
+  void _pipeline_format(pipeline_batch& batch, size_t width, size_t decimals)
+  {
+    const size_t stride = width + 1;
+
+    batch.output.resize(batch.lines * stride);
+
+    format_fixed(batch.values.data(), width, decimals, stride, batch.lines, batch.output.data());
+
+    for (size_t i = 0; i < batch.lines; i++)
+    {
+      batch.output[i * stride + width] = '\n';
+    }
+  }
+
+  inline
+  bool _pipeline_write(int fd, const pipeline_batch& batch)
+  {
+    const char* data = batch.output.data();
+    size_t left = batch.output.size();
+
+    while (left > 0)
+    {
+      ssize_t n = ::write(fd, data, left);
+
+      if (n <= 0)
+      {
+        return false;
+      }
+
+      data += n;
+      left -= n;
+    }
+
+    return true;
+  }
+
+  template <typename F>
+  inline
+  pipeline_stats run_pipeline(const std::string& input_path, const std::string& output_path, const pipeline_options& options, F compute)
+  {
+    enum step { READ, PARSE, COMPUTE, FORMAT, WRITE, STEPS };
+
+    pipeline_stats stats;
+
+    mapped_file input(input_path);
+
+    /* an empty file cannot be mapped but is still valid input */
+    if (not input.is_open() and ::access(input_path.c_str(), R_OK) != 0)
+    {
+      return stats;
+    }
+
+    int fd = ::open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+    {
+      return stats;
+    }
+
+    /* group consecutive steps into stages, each with its thread count */
+    struct stage
+    {
+      size_t first;
+      size_t last;
+      size_t threads;
+    };
+
+    const size_t threads[STEPS] = {
+      1, options.parse_threads, options.compute_threads, options.format_threads, options.separate_writer ? 1u : 0u
+    };
+
+    std::vector<stage> stages;
+
+    for (size_t s = READ; s < STEPS; s++)
+    {
+      bool own = s == READ or threads[s] > 0;
+
+      /* output must be written in order, by a single thread */
+      if (s == WRITE and stages.back().threads > 1)
+      {
+        own = true;
+      }
+
+      if (own)
+      {
+        stages.push_back({s, s, std::max<size_t>(threads[s], 1)});
+      }
+      else
+      {
+        stages.back().last = s;
+      }
+    }
+
+    const size_t num_stages = stages.size();
+    const size_t depth = std::max<size_t>(options.queue_depth, 1);
+    const size_t batch_lines = std::max<size_t>(options.batch_lines, 1);
+
+    /* queues[s][p * threads of s + c] links thread p of stage s - 1 to thread c of stage s */
+    std::vector<std::vector<std::unique_ptr<spsc_queue<pipeline_batch*>>>> queues(num_stages);
+
+    size_t total_threads = 0;
+
+    for (size_t s = 0; s < num_stages; s++)
+    {
+      total_threads += stages[s].threads;
+
+      if (s > 0)
+      {
+        for (size_t q = 0; q < stages[s - 1].threads * stages[s].threads; q++)
+        {
+          queues[s].emplace_back(new spsc_queue<pipeline_batch*>(depth));
+        }
+      }
+    }
+
+    /* batches come back from the last stage to the reader */
+    const size_t pool_size = depth * total_threads;
+
+    std::vector<pipeline_batch> pool(pool_size);
+    spsc_queue<pipeline_batch*> free_batches(pool_size);
+
+    for (pipeline_batch& batch : pool)
+    {
+      free_batches.push(&batch);
+    }
+
+    const char* begin = input.data();
+    const char* end = begin + input.size();
+
+    std::atomic<bool> write_failed(false);
+
+    auto worker = [&](size_t s, size_t w)
+    {
+      const stage& st = stages[s];
+      const size_t upstream = s > 0 ? stages[s - 1].threads : 1;
+      const size_t downstream = s + 1 < num_stages ? stages[s + 1].threads : 1;
+
+      const char* pos = begin;
+
+      for (uint64_t k = w; ; k += st.threads)
+      {
+        pipeline_batch* batch = nullptr;
+
+        if (s == 0)
+        {
+          if (pos != end)
+          {
+            free_batches.pop(batch);
+            batch->sequence = k;
+            pos = _pipeline_read(*batch, pos, end, batch_lines);
+          }
+        }
+        else
+        {
+          queues[s][(k % upstream) * st.threads + w]->pop(batch);
+        }
+
+        /* end of input: pass it on to every thread downstream */
+        if (batch == nullptr)
+        {
+          if (s + 1 < num_stages)
+          {
+            for (size_t c = 0; c < downstream; c++)
+            {
+              queues[s + 1][w * downstream + c]->push(nullptr);
+            }
+          }
+          return;
+        }
+
+        for (size_t step = std::max<size_t>(st.first, PARSE); step <= st.last; step++)
+        {
+          switch (step)
+          {
+            case PARSE:
+              _pipeline_parse(*batch, options.input_format);
+              break;
+            case COMPUTE:
+              compute(batch->values.data(), batch->lines);
+              break;
+            case FORMAT:
+              _pipeline_format(*batch, options.width, options.decimals);
+              break;
+            case WRITE:
+              if (not write_failed.load(std::memory_order_relaxed) and not _pipeline_write(fd, *batch))
+              {
+                write_failed.store(true, std::memory_order_relaxed);
+              }
+              break;
+            default:
+              break;
+          }
+        }
+
+        if (s + 1 < num_stages)
+        {
+          queues[s + 1][w * downstream + k % downstream]->push(batch);
+        }
+        else
+        {
+          /* single thread, no other writer to the stats */
+          stats.lines += batch->lines;
+          stats.invalid += batch->invalid;
+          stats.batches++;
+          stats.bytes_written += batch->output.size();
+
+          free_batches.push(batch);
+        }
+      }
+    };
+
+    std::vector<std::thread> pool_threads;
+
+    for (size_t s = 0; s < num_stages; s++)
+    {
+      for (size_t w = 0; w < stages[s].threads; w++)
+      {
+        pool_threads.emplace_back(worker, s, w);
+      }
+    }
+
+    for (std::thread& th : pool_threads)
+    {
+      th.join();
+    }
+
+    stats.ok = not write_failed.load() and ::close(fd) == 0;
+    stats.bytes_read = input.size();
+    stats.stages = num_stages;
+    stats.threads = total_threads;
+
+    return stats;
+  }
+}
@@ -0,0 +1,216 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_accumulator.h"
+#include "dfloat_column.h"
+
+namespace xu
+{
+  enum class recon_side : uint8_t
+  {
+    LEFT,
+    RIGHT
+  };
+
+  /**
+    @brief  Kind of difference found between the two sides
+    */
+  enum class recon_kind : uint8_t
+  {
+    MISSING_LEFT,       // key only on the right
+    MISSING_RIGHT,      // key only on the left
+    MISMATCH,           // values differ, within the tolerance
+    OUT_OF_TOLERANCE,   // values differ by more than the tolerance, or only one is NaN
+    DUPLICATE           // key seen again on one side; `column` is the side
+  };
+
+  struct recon_options
+  {
+    /**
+      @brief  Number of value columns of each row
+      */
+    size_t num_columns = 1;
+
+    /**
+      @brief  Largest absolute difference reported as MISMATCH rather than
+              OUT_OF_TOLERANCE
+      */
+    dfloat tolerance = 0;
+
+    /**
+      @brief  Number of hash partitions; rounded up to a power of two
+      */
+    size_t partitions = 64;
+
+    size_t threads = 1;
+
+    /**
+      @brief  Bytes of encoded rows kept in memory before they are spilled
+              to disk
+      */
+    size_t memory_budget = (size_t)256 << 20;
+
+    /**
+      @brief  Directory of the spill files, which are removed by the
+              destructor
+      */
+    std::string spill_dir = "/tmp";
+  };
+
+  /**
+    @brief  Differences found by `reconciler::run`, one row per difference,
+            ordered by key, then kind, then column
+    */
+  struct recon_result
+  {
+    std::vector<uint64_t> key;
+    std::vector<recon_kind> kind;
+    std::vector<uint32_t> column;
+
+    /**
+      @brief  Values of the column on each side; for a missing or duplicate
+              key, the first value of the row and NaN for the other side
+      */
+    dfloat_column left;
+    dfloat_column right;
+
+    /**
+      @brief  `left - right`, exact then truncated once; NaN if either is
+      */
+    dfloat_column difference;
+
+    /**
+      @brief  Number of keys found on both sides, whether they differ or not
+      */
+    uint64_t matched = 0;
+
+    size_t size() const;
+
+    void clear();
+  };
+
+  /**
+    @brief  Joins the rows of two sides by a 64-bit key and reports the
+            keys missing on either side and the values that differ
+    @note   Rows are encoded as they are added (varint key, then each value
+            in the compact encoding) into one buffer per side and hash
+            partition. When the buffers outgrow `memory_budget`, they are
+            appended to one spill file per side and partition
+    @note   `run` diffs the partitions on `threads` threads, one partition
+            at a time per thread: the left rows are loaded into an open
+            addressing table, then the right rows probe it
+    @note   Values are first compared by `dfloat::to_key`, so equal values
+            cost one integer comparison; only differing values are
+            subtracted, exactly, with a `dfloat_accumulator`
+    @note   NaN equals NaN here, as missing in both systems
+    */
+  class reconciler
+  {
+  public:
+    explicit reconciler(const recon_options& options);
+
+    ~reconciler();
+
+    reconciler(const reconciler& other) = delete;
+
+    reconciler& operator=(const reconciler& other) = delete;
+
+    /**
+      @brief  Add `count` rows to one side; `columns[c][i]` is value `c` of
+              row `i`
+      */
+    void add(recon_side side, const uint64_t* keys, const dfloat* const* columns, size_t count);
+
+    /**
+      @brief  Diff every row added so far, appending the differences to
+              `out`
+      @return false if a spill file could not be written or read
+      */
+    bool run(recon_result& out);
+
+    /**
+      @brief  Total bytes written to spill files
+      */
+    uint64_t spilled_bytes() const;
+
+  protected:
+    struct diff_row
+    {
+      uint64_t key;
+      recon_kind kind;
+      uint32_t column;
+      dfloat left;
+      dfloat right;
+      dfloat difference;
+    };
+
+    /* a decoded row: key, then `num_columns` values at `values + row * num_columns` */
+    struct rows
+    {
+      std::vector<uint64_t> keys;
+      std::vector<dfloat> values;
+    };
+
+    size_t _partition(uint64_t key) const;
+
+    std::string _spill_path(recon_side side, size_t partition) const;
+
+    /* append every buffer to its spill file and clear it */
+    bool _spill();
+
+    /* spilled and buffered rows of one side and partition */
+    bool _load(recon_side side, size_t partition, rows& out) const;
+
+    void _diff(const rows& left, const rows& right, std::vector<diff_row>& out, uint64_t& matched) const;
+
+    /* compare one value of a matched key */
+    void _compare(uint64_t key, uint32_t column, const dfloat& left, const dfloat& right,
+      std::vector<diff_row>& out) const;
+
+    recon_options options_;
+    size_t partition_bits_;
+
+    /* the tolerance and its negation, to compare exact differences */
+    dfloat_accumulator upper_;
+    dfloat_accumulator lower_;
+
+    /* encoded rows by side, then partition */
+    std::vector<std::vector<char>> buffers_[2];
+    size_t buffered_;
+
+    std::vector<bool> spilled_[2];
+    uint64_t spilled_bytes_;
+    bool failed_;
+
+    std::mutex mutex_;
+  };
+}
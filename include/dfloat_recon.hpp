@@ -0,0 +1,484 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include "dfloat.hpp"
+#include "dfloat_accumulator.hpp"
+#include "dfloat_column.hpp"
+#include "dfloat_compact.hpp"
+#include "dfloat_record.hpp"
+#include "dfloat_recon.h"
+
+namespace xu
+{
+  inline
+  size_t recon_result::size() const
+  {
+    return key.size();
+  }
+
+  inline
+  void recon_result::clear()
+  {
+    key.clear();
+    kind.clear();
+    column.clear();
+    left.resize(0);
+    right.resize(0);
+    difference.resize(0);
+    matched = 0;
+  }
+
+  inline
+  reconciler::reconciler(const recon_options& options)
+    : options_(options), partition_bits_(0), buffered_(0), spilled_bytes_(0), failed_(false)
+  {
+    while (((size_t)1 << partition_bits_) < options_.partitions)
+    {
+      ++partition_bits_;
+    }
+
+    size_t partitions = (size_t)1 << partition_bits_;
+
+    for (int side = 0; side < 2; side++)
+    {
+      buffers_[side].resize(partitions);
+      spilled_[side].assign(partitions, false);
+    }
+
+    if (dfloat::isfinite(options_.tolerance))
+    {
+      upper_.add(options_.tolerance);
+      lower_.subtract(options_.tolerance);
+    }
+  }
+
+  inline
+  reconciler::~reconciler()
+  {
+    for (int side = 0; side < 2; side++)
+    {
+      for (size_t p = 0; p < spilled_[side].size(); p++)
+      {
+        if (spilled_[side][p])
+        {
+          std::remove(_spill_path((recon_side)side, p).c_str());
+        }
+      }
+    }
+  }
+
+  inline
+  size_t reconciler::_partition(uint64_t key) const
+  {
+    /* Fibonacci hashing, the top bits are the best mixed */
+    uint64_t h = key * 0x9E3779B97F4A7C15ull;
+
+    return partition_bits_ == 0 ? 0 : (size_t)(h >> (64 - partition_bits_));
+  }
+
+  inline
+  std::string reconciler::_spill_path(recon_side side, size_t partition) const
+  {
+    return options_.spill_dir + "/dfloat_recon_" + std::to_string(::getpid()) + "_"
+      + std::to_string((uintptr_t)this) + (side == recon_side::LEFT ? "_l" : "_r") + std::to_string(partition);
+  }
+
+  inline
+  void reconciler::add(recon_side side, const uint64_t* keys, const dfloat* const* columns, size_t count)
+  {
+    const size_t num_columns = options_.num_columns;
+    const size_t max_row = 10 + num_columns * COMPACT_MAX_SIZE;
+
+    std::vector<std::vector<char>>& buffers = buffers_[(int)side];
+
+    for (size_t i = 0; i < count; i++)
+    {
+      std::vector<char>& buffer = buffers[_partition(keys[i])];
+
+      size_t begin = buffer.size();
+      buffer.resize(begin + max_row);
+
+      char* dst = buffer.data() + begin;
+      dst += encode_varint(keys[i], dst);
+
+      for (size_t c = 0; c < num_columns; c++)
+      {
+        dst += encode_compact(columns[c][i], dst);
+      }
+
+      size_t end = dst - buffer.data();
+      buffer.resize(end);
+
+      buffered_ += end - begin;
+
+      /* checked per row, one large batch must not outgrow the budget */
+      if (buffered_ > options_.memory_budget)
+      {
+        failed_ = not _spill() or failed_;
+      }
+    }
+  }
+
+  inline
+  bool reconciler::_spill()
+  {
+    bool ok = true;
+
+    for (int side = 0; side < 2; side++)
+    {
+      for (size_t p = 0; p < buffers_[side].size(); p++)
+      {
+        std::vector<char>& buffer = buffers_[side][p];
+
+        if (buffer.empty())
+        {
+          continue;
+        }
+
+        int flags = O_WRONLY | O_CREAT | O_APPEND | (spilled_[side][p] ? 0 : O_TRUNC);
+        int fd = ::open(_spill_path((recon_side)side, p).c_str(), flags, 0600);
+
+        if (fd < 0)
+        {
+          ok = false;
+          continue;
+        }
+
+        spilled_[side][p] = true;
+
+        size_t written = 0;
+        while (written < buffer.size())
+        {
+          ssize_t n = ::write(fd, buffer.data() + written, buffer.size() - written);
+
+          if (n <= 0)
+          {
+            ok = false;
+            break;
+          }
+
+          written += n;
+        }
+
+        ::close(fd);
+
+        spilled_bytes_ += written;
+        buffer.clear();
+      }
+    }
+
+    buffered_ = 0;
+
+    return ok;
+  }
+
+  inline
+  bool reconciler::_load(recon_side side, size_t partition, rows& out) const
+  {
+    const size_t num_columns = options_.num_columns;
+
+    out.keys.clear();
+    out.values.clear();
+
+    auto decode = [&](const char* data, size_t size)
+    {
+      const char* end = data + size;
+
+      while (data != end)
+      {
+        uint64_t key;
+        size_t n = decode_varint(data, end - data, key);
+
+        if (n == 0)
+        {
+          return false;
+        }
+        data += n;
+
+        out.keys.push_back(key);
+
+        for (size_t c = 0; c < num_columns; c++)
+        {
+          dfloat value;
+          n = decode_compact(data, end - data, value);
+
+          if (n == 0)
+          {
+            return false;
+          }
+          data += n;
+
+          out.values.push_back(value);
+        }
+      }
+
+      return true;
+    };
+
+    if (spilled_[(int)side][partition])
+    {
+      mapped_file file(_spill_path(side, partition));
+
+      if (not file.is_open() or not decode(file.data(), file.size()))
+      {
+        return false;
+      }
+    }
+
+    const std::vector<char>& buffer = buffers_[(int)side][partition];
+
+    return decode(buffer.data(), buffer.size());
+  }
+
+  inline
+  void reconciler::_compare(uint64_t key, uint32_t column, const dfloat& left, const dfloat& right,
+    std::vector<diff_row>& out) const
+  {
+    /* equal values have equal keys: one integer comparison in the common case */
+    if (left.to_key() == right.to_key())
+    {
+      return;
+    }
+
+    dfloat_accumulator diff(left);
+    diff.subtract(right);
+
+    if (diff.isnan())
+    {
+      out.push_back({key, recon_kind::OUT_OF_TOLERANCE, column, left, right, diff.value()});
+      return;
+    }
+
+    bool within = diff.compare(upper_) <= 0 and diff.compare(lower_) >= 0;
+
+    out.push_back({key, within ? recon_kind::MISMATCH : recon_kind::OUT_OF_TOLERANCE, column, left, right, diff.value()});
+  }
+
+  inline
+  void reconciler::_diff(const rows& left, const rows& right, std::vector<diff_row>& out, uint64_t& matched) const
+  {
+    const size_t num_columns = options_.num_columns;
+    const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+    auto first_value = [&](const rows& r, size_t i)
+    {
+      return num_columns > 0 ? r.values[i * num_columns] : NaN;
+    };
+
+    /* open addressing on the left keys, at most half full; slots hold row + 1 */
+    size_t bits = 1;
+    while (((size_t)1 << bits) < 2 * left.keys.size())
+    {
+      ++bits;
+    }
+
+    size_t mask = ((size_t)1 << bits) - 1;
+    std::vector<uint32_t> slots((size_t)1 << bits, 0);
+
+    /* of each left row: 0 a duplicate, 1 not matched yet, 2 matched */
+    std::vector<uint8_t> state(left.keys.size(), 0);
+
+    /* a different multiplier than the partitions', whose top bits are all equal here */
+    auto slot_of = [&](uint64_t key)
+    {
+      return (size_t)((key * 0xC2B2AE3D27D4EB4Full) >> (64 - bits));
+    };
+
+    for (size_t i = 0; i < left.keys.size(); i++)
+    {
+      size_t s = slot_of(left.keys[i]);
+
+      while (slots[s] != 0 and left.keys[slots[s] - 1] != left.keys[i])
+      {
+        s = (s + 1) & mask;
+      }
+
+      if (slots[s] != 0)
+      {
+        out.push_back({left.keys[i], recon_kind::DUPLICATE, (uint32_t)recon_side::LEFT, first_value(left, i), NaN, NaN});
+        continue;
+      }
+
+      slots[s] = (uint32_t)(i + 1);
+      state[i] = 1;
+    }
+
+    std::vector<size_t> missing;
+
+    for (size_t j = 0; j < right.keys.size(); j++)
+    {
+      uint64_t key = right.keys[j];
+      size_t s = slot_of(key);
+
+      while (slots[s] != 0 and left.keys[slots[s] - 1] != key)
+      {
+        s = (s + 1) & mask;
+      }
+
+      if (slots[s] == 0)
+      {
+        missing.push_back(j);
+        continue;
+      }
+
+      size_t i = slots[s] - 1;
+
+      if (state[i] == 2)
+      {
+        out.push_back({key, recon_kind::DUPLICATE, (uint32_t)recon_side::RIGHT, NaN, first_value(right, j), NaN});
+        continue;
+      }
+
+      state[i] = 2;
+      ++matched;
+
+      for (size_t c = 0; c < num_columns; c++)
+      {
+        _compare(key, (uint32_t)c, left.values[i * num_columns + c], right.values[j * num_columns + c], out);
+      }
+    }
+
+    /* right rows without a match: the first of each key is missing, the others duplicates */
+    std::stable_sort(missing.begin(), missing.end(),
+      [&](size_t a, size_t b)
+      {
+        return right.keys[a] < right.keys[b];
+      });
+
+    for (size_t k = 0; k < missing.size(); k++)
+    {
+      size_t j = missing[k];
+      bool again = k > 0 and right.keys[missing[k - 1]] == right.keys[j];
+
+      out.push_back({right.keys[j], again ? recon_kind::DUPLICATE : recon_kind::MISSING_LEFT,
+        again ? (uint32_t)recon_side::RIGHT : 0, NaN, first_value(right, j), NaN});
+    }
+
+    for (size_t i = 0; i < left.keys.size(); i++)
+    {
+      if (state[i] == 1)
+      {
+        out.push_back({left.keys[i], recon_kind::MISSING_RIGHT, 0, first_value(left, i), NaN, NaN});
+      }
+    }
+  }
+
+  inline
+  bool reconciler::run(recon_result& out)
+  {
+    if (failed_)
+    {
+      return false;
+    }
+
+    size_t partitions = (size_t)1 << partition_bits_;
+
+    std::vector<diff_row> differences;
+    uint64_t matched = 0;
+    bool ok = true;
+
+    parallel_blocks(partitions, options_.threads, 1,
+      [&](size_t begin, size_t end)
+      {
+        rows left;
+        rows right;
+        std::vector<diff_row> local;
+        uint64_t local_matched = 0;
+        bool local_ok = true;
+
+        for (size_t p = begin; p < end and local_ok; p++)
+        {
+          local_ok = _load(recon_side::LEFT, p, left) and _load(recon_side::RIGHT, p, right);
+
+          if (local_ok)
+          {
+            _diff(left, right, local, local_matched);
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        differences.insert(differences.end(), local.begin(), local.end());
+        matched += local_matched;
+        ok = ok and local_ok;
+      });
+
+    if (not ok)
+    {
+      return false;
+    }
+
+    /* partitions finish in any order, sort to make the output deterministic */
+    std::stable_sort(differences.begin(), differences.end(),
+      [](const diff_row& a, const diff_row& b)
+      {
+        if (a.key != b.key)
+        {
+          return a.key < b.key;
+        }
+        if (a.kind != b.kind)
+        {
+          return a.kind < b.kind;
+        }
+        return a.column < b.column;
+      });
+
+    size_t base = out.size();
+    size_t n = differences.size();
+
+    out.key.resize(base + n);
+    out.kind.resize(base + n);
+    out.column.resize(base + n);
+    out.left.resize(base + n);
+    out.right.resize(base + n);
+    out.difference.resize(base + n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+      const diff_row& d = differences[i];
+
+      out.key[base + i] = d.key;
+      out.kind[base + i] = d.kind;
+      out.column[base + i] = d.column;
+      out.left[base + i] = d.left;
+      out.right[base + i] = d.right;
+      out.difference[base + i] = d.difference;
+    }
+
+    out.matched += matched;
+
+    return true;
+  }
+
+  inline
+  uint64_t reconciler::spilled_bytes() const
+  {
+    return spilled_bytes_;
+  }
+}
@@ -0,0 +1,128 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_column.h"
+
+namespace xu
+{
+  /**
+    @brief  Read-only memory mapping of a whole file
+    @note   If the file cannot be opened or mapped, `data()` is nullptr and
+            `size()` is 0
+    */
+  class mapped_file
+  {
+  public:
+    explicit mapped_file(const std::string& filepath);
+
+    ~mapped_file();
+
+    mapped_file(const mapped_file& other) = delete;
+
+    mapped_file& operator=(const mapped_file& other) = delete;
+
+    bool is_open() const;
+
+    const char* data() const;
+
+    size_t size() const;
+
+  private:
+    const char* data_;
+    size_t size_;
+  };
+
+  /**
+    @brief  How the sign of a numeric field is written
+    */
+  enum class field_sign : uint8_t
+  {
+    NONE,         // always positive, e.g. "00012345"
+    LEADING,      // optional '+' or '-' before the digits, e.g. " -123.45"
+    TRAILING,     // optional '+' or '-' after the digits, e.g. "123.45- "
+    OVERPUNCH     // sign encoded in the last digit (zoned decimal), e.g. "0001234J" for -12341
+  };
+
+  /**
+    @brief  Position and format of one numeric field in a record
+    */
+  struct field_layout
+  {
+    /**
+      @brief  Column of the first character, from the start of the record
+      */
+    size_t offset;
+
+    /**
+      @brief  Number of characters, including padding and sign
+      */
+    size_t width;
+
+    /**
+      @brief  Number of implied decimal places, e.g. 2 if "0012345" means
+              123.45
+      @note   Applied in addition to an explicit decimal point, if any
+      */
+    dfloat::pow2_t scale;
+
+    field_sign sign;
+  };
+
+  /**
+    @brief  Layout of a fixed-width record
+    */
+  struct record_layout
+  {
+    /**
+      @brief  Distance between the starts of consecutive records, including
+              any line terminator
+      */
+    size_t record_size;
+
+    std::vector<field_layout> fields;
+  };
+
+  /**
+    @brief  Decode one numeric field
+    @note   Spaces around the field are ignored. Digits may contain one
+            decimal point
+    @note   If bad format (including a blank field), result is NaN.
+    */
+  dfloat decode_field(const char* field, const field_layout& layout);
+
+  /**
+    @brief  Decode every numeric field of every record in [data, data + size)
+            into one column per field of the layout
+    @note   A partial record at the end is ignored
+    @note   Records are split into contiguous ranges across `threads`
+            threads; no intermediate strings are created
+    */
+  std::vector<dfloat_column> decode_records(const char* data, size_t size, const record_layout& layout, size_t threads);
+}
@@ -0,0 +1,301 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "dfloat.hpp"
+#include "dfloat_column.hpp"
+#include "dfloat_record.h"
+
+namespace xu
+{
+  inline
+  mapped_file::mapped_file(const std::string& filepath)
+    : data_(nullptr), size_(0)
+  {
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+      return;
+    }
+
+    struct stat st;
+
+    if (::fstat(fd, &st) == 0 and st.st_size > 0)
+    {
+      void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (addr != MAP_FAILED)
+      {
+        ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+        data_ = static_cast<const char*>(addr);
+        size_ = st.st_size;
+      }
+    }
+
+    /* the mapping stays valid after the descriptor is closed */
+    ::close(fd);
+  }
+
+  inline
+  mapped_file::~mapped_file()
+  {
+    if (data_ != nullptr)
+    {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  inline
+  bool mapped_file::is_open() const
+  {
+    return data_ != nullptr;
+  }
+
+  inline
+  const char* mapped_file::data() const
+  {
+    return data_;
+  }
+
+  inline
+  size_t mapped_file::size() const
+  {
+    return size_;
+  }
+
+  inline
+  dfloat decode_field(const char* field, const field_layout& layout)
+  {
+    using Sign = dfloat::Sign;
+
+    const dfloat NaN = dfloat::from_scaled(Sign::_NAN_, 0, 0);
+
+    const char* it = field;
+    const char* end = field + layout.width;
+
+    while (it != end and *it == ' ')
+    {
+      ++it;
+    }
+    while (end != it and *(end - 1) == ' ')
+    {
+      --end;
+    }
+
+    if (it == end)
+    {
+      return NaN;
+    }
+
+    bool neg = false;
+
+    /* the sign, if any, is removed so that only digits remain */
+    switch (layout.sign)
+    {
+      case field_sign::LEADING:
+      {
+        if (*it == '+' or *it == '-')
+        {
+          neg = *it == '-';
+          ++it;
+        }
+        break;
+      }
+      case field_sign::TRAILING:
+      {
+        if (*(end - 1) == '+' or *(end - 1) == '-')
+        {
+          neg = *(end - 1) == '-';
+          --end;
+        }
+        break;
+      }
+      case field_sign::NONE:
+      case field_sign::OVERPUNCH:
+      default:
+        break;
+    }
+
+    /*
+      Overpunch: the last character is a digit with the sign folded in
+        '{' 'A'-'I'   +0 to +9
+        '}' 'J'-'R'   -0 to -9
+    */
+    char last = 0;
+
+    if (layout.sign == field_sign::OVERPUNCH)
+    {
+      char c = *(end - 1);
+
+      if (c >= '0' and c <= '9')
+      {
+        last = c;
+      }
+      else if (c == '{')
+      {
+        last = '0';
+      }
+      else if (c >= 'A' and c <= 'I')
+      {
+        last = '1' + (c - 'A');
+      }
+      else if (c == '}')
+      {
+        last = '0';
+        neg = true;
+      }
+      else if (c >= 'J' and c <= 'R')
+      {
+        last = '1' + (c - 'J');
+        neg = true;
+      }
+      else
+      {
+        return NaN;
+      }
+
+      --end;
+    }
+
+    /* digits kept exactly, beyond that they are truncated */
+    constexpr int MAX_DIGITS = 19;
+
+    uint64_t coef = 0;
+    int sig = 0;
+    int32_t exp = -layout.scale;
+    bool dot = false;
+    bool any_digit = false;
+
+    auto append = [&](char c)
+    {
+      if (c == '.' and not dot)
+      {
+        dot = true;
+        return true;
+      }
+
+      if (c < '0' or c > '9')
+      {
+        return false;
+      }
+
+      any_digit = true;
+
+      if (sig < MAX_DIGITS)
+      {
+        coef = coef * dfloat::BASE + (c - '0');
+
+        /* leading zeros are not significant */
+        if (coef != 0)
+        {
+          ++sig;
+        }
+
+        if (dot)
+        {
+          --exp;
+        }
+      }
+      else if (not dot)
+      {
+        /* out of precision, the digit is truncated */
+        ++exp;
+      }
+
+      return true;
+    };
+
+    for (; it != end; ++it)
+    {
+      if (not append(*it))
+      {
+        return NaN;
+      }
+    }
+
+    /* the overpunched digit comes after all others */
+    if (last != 0)
+    {
+      append(last);
+    }
+
+    if (not any_digit)
+    {
+      return NaN;
+    }
+
+    return dfloat::from_scaled(neg ? Sign::NEG : Sign::POS, coef, (dfloat::pow2_t)exp);
+  }
+
+  inline
+  std::vector<dfloat_column> decode_records(const char* data, size_t size, const record_layout& layout, size_t threads)
+  {
+    size_t count = layout.record_size > 0 ? size / layout.record_size : 0;
+    size_t num_fields = layout.fields.size();
+
+    std::vector<dfloat_column> columns(num_fields);
+
+    std::vector<dfloat*> out(num_fields);
+    for (size_t k = 0; k < num_fields; k++)
+    {
+      columns[k].resize(count);
+      out[k] = columns[k].data();
+    }
+
+    const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+    parallel_blocks(count, threads, dfloat_column::BLOCK_SIZE,
+      [&](size_t begin, size_t end)
+      {
+        for (size_t r = begin; r < end; r++)
+        {
+          const char* record = data + r * layout.record_size;
+
+          for (size_t k = 0; k < num_fields; k++)
+          {
+            const field_layout& field = layout.fields[k];
+
+            /* a field outside the record would read the next one */
+            if (field.offset + field.width > layout.record_size)
+            {
+              out[k][r] = NaN;
+            }
+            else
+            {
+              out[k][r] = decode_field(record + field.offset, field);
+            }
+          }
+        }
+      });
+
+    return columns;
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "dfloat.h"
+#include "dfloat_accumulator.h"
+
+namespace xu
+{
+  /**
+    @brief  How a value is rounded to a multiple of a power of ten
+    */
+  enum class rounding_mode : uint8_t
+  {
+    DOWN,         // toward zero, i.e. truncate
+    UP,           // away from zero
+    HALF_UP,      // to nearest, ties away from zero
+    HALF_EVEN,    // to nearest, ties to the even neighbour (banker's rounding)
+    FLOOR,        // toward negative infinity
+    CEILING       // toward positive infinity
+  };
+
+  /**
+    @brief  `num / den` rounded to an integer by `mode`
+    @note   `den` must be positive
+    @note   Divides in 64 bits when both operands fit
+    */
+  dfloat_accumulator::wide_t divide_rounded(dfloat_accumulator::wide_t num, dfloat_accumulator::wide_t den,
+    rounding_mode mode);
+
+  /**
+    @brief  Round to a multiple of `10^exp`, e.g. `exp = -2` for cents
+    @note   If the result needs more than 18 digits, it is truncated as by
+            `dfloat::from_scaled`. NaN stays NaN
+    */
+  dfloat round_to(const dfloat& x, dfloat::pow2_t exp, rounding_mode mode);
+
+  /**
+    @brief  Round an exact sum to a multiple of `10^exp`, so that it is
+            rounded once instead of truncated and then rounded
+    */
+  dfloat round_to(const dfloat_accumulator& x, dfloat::pow2_t exp, rounding_mode mode);
+
+  /**
+    @brief  Round `coef * 10^coef_exp` to a multiple of `10^exp`
+    @return the multiple, i.e. the result is `return value * 10^exp`
+    @note   `ok` is set to false if the multiple does not fit in 128 bits
+    */
+  dfloat_accumulator::wide_t round_scaled(dfloat_accumulator::wide_t coef, dfloat::pow2_t coef_exp,
+    dfloat::pow2_t exp, rounding_mode mode, bool& ok);
+
+  /**
+    @brief  `x` as an integer multiple of `10^exp`, rounded by `mode`, e.g.
+            a number of cents
+    @return false if NaN or the multiple does not fit in 64 bits
+    */
+  bool round_to_units(const dfloat& x, dfloat::pow2_t exp, rounding_mode mode, int64_t& units);
+}
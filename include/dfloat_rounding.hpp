@@ -0,0 +1,186 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include "dfloat.hpp"
+#include "dfloat_accumulator.hpp"
+#include "dfloat_rounding.h"
+
+namespace xu
+{
+  inline
+  dfloat_accumulator::wide_t divide_rounded(dfloat_accumulator::wide_t num, dfloat_accumulator::wide_t den,
+    rounding_mode mode)
+  {
+    using wide_t = dfloat_accumulator::wide_t;
+
+    wide_t q;
+    wide_t r;
+
+    /* 128-bit division is a library call, most amounts do not need it */
+    if (num >= INT64_MIN and num <= INT64_MAX and den <= INT64_MAX)
+    {
+      q = (int64_t)num / (int64_t)den;
+      r = (int64_t)num % (int64_t)den;
+    }
+    else
+    {
+      q = num / den;
+      r = num % den;
+    }
+
+    if (r == 0)
+    {
+      return q;
+    }
+
+    /* the remainder has the sign of `num`; `q` was truncated toward zero */
+    int sign = num < 0 ? -1 : 1;
+    wide_t twice = r < 0 ? -r : r;
+    twice *= 2;
+
+    switch (mode)
+    {
+      case rounding_mode::UP:
+        return q + sign;
+      case rounding_mode::HALF_UP:
+        return twice >= den ? q + sign : q;
+      case rounding_mode::HALF_EVEN:
+        return twice > den or (twice == den and q % 2 != 0) ? q + sign : q;
+      case rounding_mode::FLOOR:
+        return sign < 0 ? q - 1 : q;
+      case rounding_mode::CEILING:
+        return sign > 0 ? q + 1 : q;
+      case rounding_mode::DOWN:
+      default:
+        return q;
+    }
+  }
+
+  inline
+  dfloat_accumulator::wide_t round_scaled(dfloat_accumulator::wide_t coef, dfloat::pow2_t coef_exp,
+    dfloat::pow2_t exp, rounding_mode mode, bool& ok)
+  {
+    using wide_t = dfloat_accumulator::wide_t;
+
+    ok = true;
+
+    if (coef == 0)
+    {
+      return 0;
+    }
+
+    /* already a multiple: scale up */
+    if (coef_exp >= exp)
+    {
+      wide_t result = coef;
+
+      for (int32_t i = exp; i < coef_exp and ok; i++)
+      {
+        ok = not __builtin_mul_overflow(result, (wide_t)dfloat::BASE, &result);
+      }
+
+      return result;
+    }
+
+    int32_t shift = exp - coef_exp;
+
+    /* |coef| < 10^39 is below half of 10^shift: only the direction matters */
+    if (shift > 38)
+    {
+      return divide_rounded(coef < 0 ? -1 : 1, 3, mode);
+    }
+
+    return divide_rounded(coef, (wide_t)dfloat_accumulator::pow10(shift), mode);
+  }
+
+  inline
+  bool round_to_units(const dfloat& x, dfloat::pow2_t exp, rounding_mode mode, int64_t& units)
+  {
+    int64_t coef;
+    dfloat::pow2_t coef_exp;
+
+    if (not x.to_decimal(coef, coef_exp))
+    {
+      return false;
+    }
+
+    bool ok;
+    dfloat_accumulator::wide_t q = round_scaled(coef, coef_exp, exp, mode, ok);
+
+    if (not ok or q < INT64_MIN or q > INT64_MAX)
+    {
+      return false;
+    }
+
+    units = (int64_t)q;
+    return true;
+  }
+
+  inline
+  dfloat round_to(const dfloat& x, dfloat::pow2_t exp, rounding_mode mode)
+  {
+    int64_t coef;
+    dfloat::pow2_t coef_exp;
+
+    /* NaN, or already a multiple of 10^exp */
+    if (not x.to_decimal(coef, coef_exp) or coef_exp >= exp)
+    {
+      return x;
+    }
+
+    bool ok;
+    dfloat_accumulator::wide_t q = round_scaled(coef, coef_exp, exp, mode, ok);
+
+    if (not ok)
+    {
+      return dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+    }
+
+    /* from 18 digits, rounding up adds at most one */
+    return dfloat::from_scaled(q < 0 ? dfloat::Sign::NEG : dfloat::Sign::POS,
+      (dfloat::mant2_t)(q < 0 ? -q : q), exp);
+  }
+
+  inline
+  dfloat round_to(const dfloat_accumulator& x, dfloat::pow2_t exp, rounding_mode mode)
+  {
+    if (x.isnan())
+    {
+      return x.value();
+    }
+
+    bool ok;
+    dfloat_accumulator::wide_t q = round_scaled(x.coef(), x.exp(), exp, mode, ok);
+
+    if (not ok)
+    {
+      return dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+    }
+
+    return dfloat::from_scaled(q < 0 ? dfloat::Sign::NEG : dfloat::Sign::POS,
+      (dfloat::mant2_t)(q < 0 ? -q : q), exp);
+  }
+}
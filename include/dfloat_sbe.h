@@ -0,0 +1,133 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  SBE decimal composite with the exponent on the wire:
+            int64 mantissa followed by int8 exponent, little-endian, 9 bytes
+    @tparam Nullable    if true, a mantissa equal to `NullValue` is null and
+                        decodes to nan, and nan encodes to null
+    @tparam NullValue   SBE uses the minimum int64 by default, some schemas
+                        (e.g. CME) override it with the maximum
+    */
+  template <
+    bool Nullable = false,
+    int64_t NullValue = std::numeric_limits<int64_t>::min()>
+  struct sbe_decimal
+  {
+    static constexpr size_t ENCODED_LENGTH = 9;
+
+    /**
+      @brief  Read the composite at `src`, which need not be aligned
+      */
+    static dfloat decode(const char* src);
+
+    /**
+      @brief  Write `d` exactly, as the shortest mantissa
+      @return false if `d` is nan and the type is not nullable, in which
+              case nothing is written
+      */
+    static bool encode(const dfloat& d, char* dst);
+  };
+
+  /**
+    @brief  SBE decimal composite with a constant exponent: only the int64
+            mantissa is on the wire, little-endian, 8 bytes
+    @note   E.g. `PRICE9` is `sbe_fixed_decimal<-9>`
+    */
+  template <
+    int8_t Exponent,
+    bool Nullable = false,
+    int64_t NullValue = std::numeric_limits<int64_t>::min()>
+  struct sbe_fixed_decimal
+  {
+    static constexpr size_t ENCODED_LENGTH = 8;
+
+    static dfloat decode(const char* src);
+
+    /**
+      @brief  Write `d` truncated to a multiple of 10^Exponent
+      @return false if `d` does not fit in the mantissa (the null value
+              included), or is nan and the type is not nullable, in which
+              case nothing is written
+      */
+    static bool encode(const dfloat& d, char* dst);
+  };
+
+  using sbe_decimal_null = sbe_decimal<true>;
+
+  using sbe_price9 = sbe_fixed_decimal<-9>;
+
+  using sbe_price_null9 = sbe_fixed_decimal<-9, true>;
+
+  /**
+    @brief  Repeating group of fixed-size entries in an SBE message
+    */
+  struct sbe_group
+  {
+    /**
+      @brief  First byte of the first entry
+      */
+    const char* entries;
+
+    /**
+      @brief  Size of each entry, from the group header; may be larger than
+              the entry in the schema this code was built against
+      */
+    size_t block_length;
+
+    size_t count;
+
+    /**
+      @brief  First byte after the group, e.g. the next group header
+      @note   Only valid if the entries have no nested groups or var data
+      */
+    const char* end() const;
+  };
+
+  /**
+    @brief  Read a group header (uint16 blockLength, then `NumInGroup`
+            numInGroup) at `src`
+    @note   The standard `groupSizeEncoding` uses uint16 for numInGroup,
+            some schemas use uint8
+    */
+  template <typename NumInGroup = uint16_t>
+  sbe_group sbe_read_group(const char* src);
+
+  /**
+    @brief  Decode the decimal field at `offset` in every entry of `group`
+            into `out[0, group.count)`
+    @tparam Codec   one of the decimal composites above
+    */
+  template <typename Codec>
+  void sbe_decode_group(const sbe_group& group, size_t offset, dfloat* out);
+}
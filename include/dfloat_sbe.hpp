@@ -0,0 +1,144 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include "dfloat.hpp"
+#include "dfloat_endian.hpp"
+#include "dfloat_sbe.h"
+
+namespace xu
+{
+  template <bool Nullable, int64_t NullValue>
+  inline
+  dfloat sbe_decimal<Nullable, NullValue>::decode(const char* src)
+  {
+    int64_t mantissa = load<byte_order::LITTLE, int64_t>(src);
+    int8_t exponent = load<byte_order::LITTLE, int8_t>(src + 8);
+
+    if (Nullable and mantissa == NullValue)
+    {
+      return dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+    }
+
+    return dfloat::from_scaled(mantissa, exponent);
+  }
+
+  template <bool Nullable, int64_t NullValue>
+  inline
+  bool sbe_decimal<Nullable, NullValue>::encode(const dfloat& d, char* dst)
+  {
+    int64_t mantissa;
+    dfloat::pow2_t exponent;
+
+    if (not d.to_decimal(mantissa, exponent))
+    {
+      if (not Nullable)
+      {
+        return false;
+      }
+
+      /* the exponent of a null decimal is unspecified, use its own null */
+      mantissa = NullValue;
+      exponent = std::numeric_limits<int8_t>::min();
+    }
+
+    /* at most 18 digits and exponent in [-117, 100], so always fits */
+    store<byte_order::LITTLE>(mantissa, dst);
+    store<byte_order::LITTLE>((int8_t)exponent, dst + 8);
+
+    return true;
+  }
+
+  template <int8_t Exponent, bool Nullable, int64_t NullValue>
+  inline
+  dfloat sbe_fixed_decimal<Exponent, Nullable, NullValue>::decode(const char* src)
+  {
+    int64_t mantissa = load<byte_order::LITTLE, int64_t>(src);
+
+    if (Nullable and mantissa == NullValue)
+    {
+      return dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+    }
+
+    return dfloat::from_scaled(mantissa, Exponent);
+  }
+
+  template <int8_t Exponent, bool Nullable, int64_t NullValue>
+  inline
+  bool sbe_fixed_decimal<Exponent, Nullable, NullValue>::encode(const dfloat& d, char* dst)
+  {
+    int64_t mantissa;
+
+    if (not dfloat::isfinite(d))
+    {
+      if (not Nullable)
+      {
+        return false;
+      }
+
+      mantissa = NullValue;
+    }
+    else if (not d.to_scaled(mantissa, Exponent) or (Nullable and mantissa == NullValue))
+    {
+      return false;
+    }
+
+    store<byte_order::LITTLE>(mantissa, dst);
+
+    return true;
+  }
+
+  inline
+  const char* sbe_group::end() const
+  {
+    return entries + block_length * count;
+  }
+
+  template <typename NumInGroup>
+  inline
+  sbe_group sbe_read_group(const char* src)
+  {
+    sbe_group group;
+
+    group.block_length = load<byte_order::LITTLE, uint16_t>(src);
+    group.count = load<byte_order::LITTLE, NumInGroup>(src + sizeof(uint16_t));
+    group.entries = src + sizeof(uint16_t) + sizeof(NumInGroup);
+
+    return group;
+  }
+
+  template <typename Codec>
+  inline
+  void sbe_decode_group(const sbe_group& group, size_t offset, dfloat* out)
+  {
+    const char* src = group.entries + offset;
+
+    for (size_t i = 0; i < group.count; i++)
+    {
+      out[i] = Codec::decode(src);
+      src += group.block_length;
+    }
+  }
+}
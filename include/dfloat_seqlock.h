@@ -0,0 +1,88 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  `N` dfloat fields (e.g. bid, ask, bid size, ask size) that one
+            writer thread updates together and any number of reader threads
+            see consistently, without locks
+    @note   A sequence counter is odd while the writer is storing. A reader
+            copies the fields and accepts the copy only if the counter was
+            even and unchanged throughout; otherwise it retries. Readers never
+            write to shared memory, so they do not slow each other down
+    @note   Each dfloat is held as two relaxed 64-bit atomics, so a copy torn
+            by a concurrent store is detected rather than undefined
+    @note   Aligned to a cache line so that neighbouring snapshots do not
+            share one
+    */
+  template <size_t N>
+  class alignas(64) seqlock_snapshot
+  {
+  public:
+    seqlock_snapshot();
+
+    /**
+      @brief  Replace all fields; only one thread may write
+      */
+    void store(const dfloat* values);
+
+    void store(const std::array<dfloat, N>& values);
+
+    /**
+      @brief  Replace field `i`, keeping the others
+      */
+    void store(size_t i, const dfloat& value);
+
+    /**
+      @brief  Copy all fields in one attempt, without waiting
+      @return false if a store was in progress; `out` is then unspecified
+      */
+    bool try_load(dfloat* out) const;
+
+    /**
+      @brief  Copy all fields, retrying until no store interferes
+      */
+    void load(dfloat* out) const;
+
+    std::array<dfloat, N> load() const;
+
+    /**
+      @brief  Number of completed stores
+      */
+    uint64_t version() const;
+
+  protected:
+    std::atomic<uint64_t> seq_;
+    std::atomic<uint64_t> words_[2 * N];
+  };
+}
@@ -0,0 +1,154 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include "dfloat.hpp"
+#include "dfloat_seqlock.h"
+#include "dfloat_view.hpp"
+
+namespace xu
+{
+  template <size_t N>
+  inline
+  seqlock_snapshot<N>::seqlock_snapshot()
+    : seq_(0)
+  {
+    uint64_t mant;
+    uint64_t meta;
+    split_words(dfloat::from_scaled(0, 0), mant, meta);
+
+    for (size_t i = 0; i < N; i++)
+    {
+      words_[2 * i].store(mant, std::memory_order_relaxed);
+      words_[2 * i + 1].store(meta, std::memory_order_relaxed);
+    }
+  }
+
+  template <size_t N>
+  inline
+  void seqlock_snapshot<N>::store(const dfloat* values)
+  {
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < N; i++)
+    {
+      uint64_t mant;
+      uint64_t meta;
+      split_words(values[i], mant, meta);
+
+      words_[2 * i].store(mant, std::memory_order_relaxed);
+      words_[2 * i + 1].store(meta, std::memory_order_relaxed);
+    }
+
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  template <size_t N>
+  inline
+  void seqlock_snapshot<N>::store(const std::array<dfloat, N>& values)
+  {
+    store(values.data());
+  }
+
+  template <size_t N>
+  inline
+  void seqlock_snapshot<N>::store(size_t i, const dfloat& value)
+  {
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint64_t mant;
+    uint64_t meta;
+    split_words(value, mant, meta);
+
+    words_[2 * i].store(mant, std::memory_order_relaxed);
+    words_[2 * i + 1].store(meta, std::memory_order_relaxed);
+
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  template <size_t N>
+  inline
+  bool seqlock_snapshot<N>::try_load(dfloat* out) const
+  {
+    uint64_t before = seq_.load(std::memory_order_acquire);
+
+    if (before & 1)
+    {
+      return false;
+    }
+
+    uint64_t words[2 * N];
+
+    for (size_t w = 0; w < 2 * N; w++)
+    {
+      words[w] = words_[w].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (seq_.load(std::memory_order_relaxed) != before)
+    {
+      return false;
+    }
+
+    for (size_t i = 0; i < N; i++)
+    {
+      out[i] = join_words(words[2 * i], words[2 * i + 1]);
+    }
+
+    return true;
+  }
+
+  template <size_t N>
+  inline
+  void seqlock_snapshot<N>::load(dfloat* out) const
+  {
+    while (not try_load(out))
+    {
+    }
+  }
+
+  template <size_t N>
+  inline
+  std::array<dfloat, N> seqlock_snapshot<N>::load() const
+  {
+    std::array<dfloat, N> out;
+    load(out.data());
+    return out;
+  }
+
+  template <size_t N>
+  inline
+  uint64_t seqlock_snapshot<N>::version() const
+  {
+    return seq_.load(std::memory_order_acquire) / 2;
+  }
+}
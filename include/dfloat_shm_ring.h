@@ -0,0 +1,168 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "dfloat.h"
+
+namespace xu
+{
+  /**
+    @brief  Outcome of reading one record from a `shm_ring`
+    */
+  enum class ring_read : uint8_t
+  {
+    OK,           // record copied out
+    NOT_READY,    // not published yet
+    OVERWRITTEN   // the writer has lapped the reader, the record is gone
+  };
+
+  /**
+    @brief  Single-producer, multi-consumer ring of fixed-layout records in
+            a POSIX shared memory object, for passing dfloats between
+            processes without serialization
+    @note   A record is a sequence number, a 64-bit key chosen by the writer
+            (e.g. an instrument id or a timestamp) and `fields` dfloats.
+            Each dfloat takes two words, the mantissa then the sign and
+            power, in native order since the ring never leaves the machine
+    @note   The writer never waits: it overwrites the oldest slot. Every
+            reader keeps its own position, and a read is a bounded number of
+            steps (wait-free): a per-slot sequence number, written before and
+            after the payload, tells the reader whether it got a consistent
+            copy
+    @note   If the object cannot be created, opened or mapped, `is_open()`
+            is false
+    */
+  class shm_ring
+  {
+  public:
+    /**
+      @brief  Create (or replace) the shared memory object `name`, e.g.
+              "/md_prices", with room for `capacity` records, rounded up to a
+              power of two
+      @note   A replaced object is unlinked, not truncated: readers that still
+              map it keep the old records and must reopen to see new ones
+      */
+    shm_ring(const std::string& name, size_t capacity, size_t fields);
+
+    /**
+      @brief  Open an existing ring created by another process
+      */
+    explicit shm_ring(const std::string& name);
+
+    ~shm_ring();
+
+    shm_ring(const shm_ring& other) = delete;
+
+    shm_ring& operator=(const shm_ring& other) = delete;
+
+    /**
+      @brief  Remove the shared memory object; mappings stay valid
+      */
+    static bool unlink(const std::string& name);
+
+    bool is_open() const;
+
+    size_t capacity() const;
+
+    size_t fields() const;
+
+    /**
+      @brief  Number of records published so far, i.e. the sequence number
+              of the next record
+      */
+    uint64_t head() const;
+
+    /**
+      @brief  Publish a record; only one process may write
+      @return its sequence number
+      */
+    uint64_t publish(uint64_t key, const dfloat* values);
+
+    /**
+      @brief  Copy record `seq` into `key` and `values[0, fields())`
+      */
+    ring_read try_read(uint64_t seq, uint64_t& key, dfloat* values) const;
+
+  protected:
+    struct header_t;
+
+    void _attach(int fd, size_t size);
+
+    std::atomic<uint64_t>* _slot(uint64_t seq) const;
+
+    void* base_;
+    size_t size_;
+    header_t* header_;
+    char* slots_;
+    size_t slot_words_;
+    size_t slot_size_;
+  };
+
+  /**
+    @brief  Reader position in a `shm_ring`
+    */
+  class shm_ring_reader
+  {
+  public:
+    /**
+      @brief  Start at the next record to be published
+      */
+    explicit shm_ring_reader(const shm_ring& ring);
+
+    /**
+      @brief  Start at record `position`, e.g. 0 to read from the beginning
+              if nothing has been overwritten yet
+      */
+    shm_ring_reader(const shm_ring& ring, uint64_t position);
+
+    /**
+      @brief  Read the next record
+      @note   If records were overwritten before they could be read, skips
+              to the oldest record still in the ring and counts the rest as
+              missed
+      @return OK, or NOT_READY if there is nothing new
+      */
+    ring_read poll(uint64_t& key, dfloat* values);
+
+    /**
+      @brief  Sequence number of the next record to read
+      */
+    uint64_t position() const;
+
+    /**
+      @brief  Number of records skipped because they were overwritten
+      */
+    uint64_t missed() const;
+
+  protected:
+    const shm_ring& ring_;
+    uint64_t next_;
+    uint64_t missed_;
+  };
+}
@@ -0,0 +1,332 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "dfloat.hpp"
+#include "dfloat_shm_ring.h"
+#include "dfloat_view.hpp"
+
+namespace xu
+{
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shm_ring needs address-free 64-bit atomics");
+
+  struct shm_ring::header_t
+  {
+    /* written last by the creator, so an opener never sees a partial header */
+    std::atomic<uint64_t> magic;
+    uint64_t capacity;
+    uint64_t fields;
+
+    /* number of records published, on its own cache line */
+    alignas(64) std::atomic<uint64_t> head;
+  };
+
+  /* "dfloatR1" in little-endian byte order */
+  constexpr uint64_t SHM_RING_MAGIC = 0x315274616f6c6664ull;
+
+  inline
+  shm_ring::shm_ring(const std::string& name, size_t capacity, size_t fields)
+    : base_(nullptr), size_(0), header_(nullptr), slots_(nullptr), slot_words_(0), slot_size_(0)
+  {
+    size_t cap = 1;
+    while (cap < capacity)
+    {
+      cap <<= 1;
+    }
+
+    /* sequence, key, then two words per field, padded to whole cache lines */
+    size_t slot_size = ((2 + 2 * fields) * sizeof(uint64_t) + 63) / 64 * 64;
+    size_t size = sizeof(header_t) + cap * slot_size;
+
+    /*
+      Truncating an object in place would fault readers that still map it;
+      unlinked, it lives on for them while the new one is created
+    */
+    ::shm_unlink(name.c_str());
+
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (fd < 0)
+    {
+      return;
+    }
+
+    if (::ftruncate(fd, size) != 0)
+    {
+      ::close(fd);
+      return;
+    }
+
+    void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    /* the mapping stays valid after the descriptor is closed */
+    ::close(fd);
+
+    if (addr == MAP_FAILED)
+    {
+      return;
+    }
+
+    base_ = addr;
+    size_ = size;
+    header_ = static_cast<header_t*>(addr);
+    slots_ = static_cast<char*>(addr) + sizeof(header_t);
+    slot_words_ = 2 + 2 * fields;
+    slot_size_ = slot_size;
+
+    /* the new object is zero-filled, so every slot reads as never written */
+    header_->capacity = cap;
+    header_->fields = fields;
+    header_->head.store(0, std::memory_order_relaxed);
+    header_->magic.store(SHM_RING_MAGIC, std::memory_order_release);
+  }
+
+  inline
+  shm_ring::shm_ring(const std::string& name)
+    : base_(nullptr), size_(0), header_(nullptr), slots_(nullptr), slot_words_(0), slot_size_(0)
+  {
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+
+    if (fd < 0)
+    {
+      return;
+    }
+
+    struct stat st;
+
+    if (::fstat(fd, &st) != 0 or (size_t)st.st_size < sizeof(header_t))
+    {
+      ::close(fd);
+      return;
+    }
+
+    void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    ::close(fd);
+
+    if (addr == MAP_FAILED)
+    {
+      return;
+    }
+
+    header_t* header = static_cast<header_t*>(addr);
+
+    /* the rest of the header is only complete once the magic is seen */
+    if (header->magic.load(std::memory_order_acquire) != SHM_RING_MAGIC)
+    {
+      ::munmap(addr, st.st_size);
+      return;
+    }
+
+    uint64_t cap = header->capacity;
+    uint64_t fields = header->fields;
+    size_t slot_size = ((2 + 2 * fields) * sizeof(uint64_t) + 63) / 64 * 64;
+
+    if (cap == 0 or (cap & (cap - 1)) != 0 or sizeof(header_t) + cap * slot_size != (size_t)st.st_size)
+    {
+      ::munmap(addr, st.st_size);
+      return;
+    }
+
+    base_ = addr;
+    size_ = st.st_size;
+    header_ = header;
+    slots_ = static_cast<char*>(addr) + sizeof(header_t);
+    slot_words_ = 2 + 2 * fields;
+    slot_size_ = slot_size;
+  }
+
+  inline
+  shm_ring::~shm_ring()
+  {
+    if (base_ != nullptr)
+    {
+      ::munmap(base_, size_);
+    }
+  }
+
+  inline
+  bool shm_ring::unlink(const std::string& name)
+  {
+    return ::shm_unlink(name.c_str()) == 0;
+  }
+
+  inline
+  bool shm_ring::is_open() const
+  {
+    return base_ != nullptr;
+  }
+
+  inline
+  size_t shm_ring::capacity() const
+  {
+    return header_ != nullptr ? header_->capacity : 0;
+  }
+
+  inline
+  size_t shm_ring::fields() const
+  {
+    return header_ != nullptr ? header_->fields : 0;
+  }
+
+  inline
+  uint64_t shm_ring::head() const
+  {
+    return header_->head.load(std::memory_order_acquire);
+  }
+
+  inline
+  std::atomic<uint64_t>* shm_ring::_slot(uint64_t seq) const
+  {
+    char* slot = slots_ + (seq & (header_->capacity - 1)) * slot_size_;
+
+    return reinterpret_cast<std::atomic<uint64_t>*>(slot);
+  }
+
+  inline
+  uint64_t shm_ring::publish(uint64_t key, const dfloat* values)
+  {
+    uint64_t seq = header_->head.load(std::memory_order_relaxed);
+
+    std::atomic<uint64_t>* slot = _slot(seq);
+
+    /* odd while the payload is being written */
+    slot[0].store(2 * seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot[1].store(key, std::memory_order_relaxed);
+
+    for (size_t f = 0; f < header_->fields; f++)
+    {
+      uint64_t mant;
+      uint64_t meta;
+      split_words(values[f], mant, meta);
+
+      slot[2 + 2 * f].store(mant, std::memory_order_relaxed);
+      slot[3 + 2 * f].store(meta, std::memory_order_relaxed);
+    }
+
+    slot[0].store(2 * seq + 2, std::memory_order_release);
+    header_->head.store(seq + 1, std::memory_order_release);
+
+    return seq;
+  }
+
+  inline
+  ring_read shm_ring::try_read(uint64_t seq, uint64_t& key, dfloat* values) const
+  {
+    std::atomic<uint64_t>* slot = _slot(seq);
+
+    uint64_t before = slot[0].load(std::memory_order_acquire);
+
+    if (before < 2 * seq + 2)
+    {
+      return ring_read::NOT_READY;
+    }
+
+    if (before > 2 * seq + 2)
+    {
+      return ring_read::OVERWRITTEN;
+    }
+
+    key = slot[1].load(std::memory_order_relaxed);
+
+    for (size_t f = 0; f < header_->fields; f++)
+    {
+      uint64_t mant = slot[2 + 2 * f].load(std::memory_order_relaxed);
+      uint64_t meta = slot[3 + 2 * f].load(std::memory_order_relaxed);
+
+      values[f] = join_words(mant, meta);
+    }
+
+    /* if the writer started on this slot meanwhile, the copy may be torn */
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (slot[0].load(std::memory_order_relaxed) != before)
+    {
+      return ring_read::OVERWRITTEN;
+    }
+
+    return ring_read::OK;
+  }
+
+  inline
+  shm_ring_reader::shm_ring_reader(const shm_ring& ring)
+    : ring_(ring), next_(ring.head()), missed_(0)
+  {
+  }
+
+  inline
+  shm_ring_reader::shm_ring_reader(const shm_ring& ring, uint64_t position)
+    : ring_(ring), next_(position), missed_(0)
+  {
+  }
+
+  inline
+  ring_read shm_ring_reader::poll(uint64_t& key, dfloat* values)
+  {
+    ring_read r = ring_.try_read(next_, key, values);
+
+    if (r == ring_read::OVERWRITTEN)
+    {
+      /* one slot of margin, the writer may already be on the oldest */
+      uint64_t head = ring_.head();
+      uint64_t oldest = head > ring_.capacity() ? head - ring_.capacity() + 1 : 0;
+
+      if (oldest > next_)
+      {
+        missed_ += oldest - next_;
+        next_ = oldest;
+      }
+
+      r = ring_.try_read(next_, key, values);
+    }
+
+    if (r != ring_read::OK)
+    {
+      return ring_read::NOT_READY;
+    }
+
+    next_++;
+
+    return ring_read::OK;
+  }
+
+  inline
+  uint64_t shm_ring_reader::position() const
+  {
+    return next_;
+  }
+
+  inline
+  uint64_t shm_ring_reader::missed() const
+  {
+    return missed_;
+  }
+}
@@ -0,0 +1,100 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace xu
+{
+  /**
+    @brief  Bounded lock-free queue between exactly one producer thread and
+            one consumer thread
+    @note   The producer only writes `tail_` and the consumer only writes
+            `head_`, each on its own cache line. Each side keeps a private
+            copy of the other's index and reloads it only when the queue
+            looks full (or empty), so most operations touch no shared line
+    @note   `push` and `pop` wait while the queue is full or empty, which
+            is how a slow consumer holds back its producer
+    */
+  template <typename T>
+  class spsc_queue
+  {
+  public:
+    /**
+      @brief  Queue holding up to `capacity` elements, rounded up to a power
+              of two
+      */
+    explicit spsc_queue(size_t capacity);
+
+    spsc_queue(const spsc_queue& other) = delete;
+
+    spsc_queue& operator=(const spsc_queue& other) = delete;
+
+    size_t capacity() const;
+
+    /**
+      @brief  Append `value` unless the queue is full; producer only
+      */
+    bool try_push(const T& value);
+
+    /**
+      @brief  Remove the oldest element unless the queue is empty; consumer
+              only
+      */
+    bool try_pop(T& value);
+
+    /**
+      @brief  Append `value`, waiting while the queue is full
+      */
+    void push(const T& value);
+
+    /**
+      @brief  Remove the oldest element, waiting while the queue is empty
+      */
+    void pop(T& value);
+
+  protected:
+    /* spin briefly, then give the core away; stages often outnumber cores */
+    static void _backoff(unsigned& spins);
+
+    std::vector<T> slots_;
+    size_t mask_;
+
+    /* padding rather than alignas, which C++14 `new` does not honour */
+    char pad0_[64];
+
+    std::atomic<size_t> head_;
+    size_t tail_cache_;
+
+    char pad1_[64];
+
+    std::atomic<size_t> tail_;
+    size_t head_cache_;
+
+    char pad2_[64];
+  };
+}
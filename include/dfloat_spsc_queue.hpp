@@ -0,0 +1,135 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <thread>
+#include "dfloat_spsc_queue.h"
+
+namespace xu
+{
+  template <typename T>
+  inline
+  spsc_queue<T>::spsc_queue(size_t capacity)
+    : mask_(0), head_(0), tail_cache_(0), tail_(0), head_cache_(0)
+  {
+    size_t size = 1;
+    while (size < capacity)
+    {
+      size <<= 1;
+    }
+
+    slots_.resize(size);
+    mask_ = size - 1;
+  }
+
+  template <typename T>
+  inline
+  size_t spsc_queue<T>::capacity() const
+  {
+    return slots_.size();
+  }
+
+  template <typename T>
+  inline
+  bool spsc_queue<T>::try_push(const T& value)
+  {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+
+    if (tail - head_cache_ == slots_.size())
+    {
+      head_cache_ = head_.load(std::memory_order_acquire);
+
+      if (tail - head_cache_ == slots_.size())
+      {
+        return false;
+      }
+    }
+
+    slots_[tail & mask_] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  template <typename T>
+  inline
+  bool spsc_queue<T>::try_pop(T& value)
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+
+    if (head == tail_cache_)
+    {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+
+      if (head == tail_cache_)
+      {
+        return false;
+      }
+    }
+
+    value = slots_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  template <typename T>
+  inline
+  void spsc_queue<T>::push(const T& value)
+  {
+    unsigned spins = 0;
+
+    while (not try_push(value))
+    {
+      _backoff(spins);
+    }
+  }
+
+  template <typename T>
+  inline
+  void spsc_queue<T>::pop(T& value)
+  {
+    unsigned spins = 0;
+
+    while (not try_pop(value))
+    {
+      _backoff(spins);
+    }
+  }
+
+  template <typename T>
+  inline
+  void spsc_queue<T>::_backoff(unsigned& spins)
+  {
+    if (spins < 64)
+    {
+      spins++;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+}
@@ -0,0 +1,194 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include "dfloat.h"
+#include "dfloat_endian.h"
+
+namespace xu
+{
+  /**
+    @brief  Read-only view of a dfloat stored as 10 bytes at any address:
+            sign (1 byte), mantissa (8 bytes, in `Order`), power (1 byte)
+    @note   This is the layout of `dfloat` itself, so a native-order view can
+            point into an array of `dfloat`. `write` produces the same layout
+    @note   Fields are read in place on access; the whole value is only
+            assembled into a `dfloat` when it takes part in arithmetic or
+            comparison
+    @note   The bytes are assumed to hold a valid dfloat
+    */
+  template <byte_order Order>
+  class dfloat_view
+  {
+  public:
+    static constexpr size_t SIZE = 10;
+    static constexpr size_t SIGN_OFFSET = 0;
+    static constexpr size_t MANT_OFFSET = 1;
+    static constexpr size_t POW_OFFSET = 9;
+
+    explicit dfloat_view(const char* ptr);
+
+    /**
+      @brief  Write `d` in this layout to `dst`, which need not be aligned
+      */
+    static void write(const dfloat& d, char* dst);
+
+    const char* data() const;
+
+    dfloat::Sign sign() const;
+
+    /**
+      @note   Not defined if the sign is ZERO or NAN
+      */
+    dfloat::mant_t mant() const;
+
+    /**
+      @note   Not defined if the sign is ZERO or NAN
+      */
+    dfloat::pow_t pow() const;
+
+    dfloat get() const;
+
+    operator dfloat() const;
+
+  protected:
+    const char* ptr_;
+  };
+
+  /**
+    @brief  Read-only view of `count` dfloats stored `stride` bytes apart,
+            e.g. one field of an array of packed records
+    */
+  template <byte_order Order>
+  class dfloat_span_view
+  {
+  public:
+    class iterator
+    {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = dfloat_view<Order>;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = dfloat_view<Order>;
+
+      iterator(const char* ptr, size_t stride);
+
+      dfloat_view<Order> operator*() const;
+
+      iterator& operator++();
+
+      iterator operator++(int);
+
+      bool operator==(const iterator& other) const;
+
+      bool operator!=(const iterator& other) const;
+
+    protected:
+      const char* ptr_;
+      size_t stride_;
+    };
+
+    dfloat_span_view(const char* ptr, size_t count, size_t stride);
+
+    size_t size() const;
+
+    dfloat_view<Order> operator[](size_t i) const;
+
+    iterator begin() const;
+
+    iterator end() const;
+
+    /**
+      @brief  Convert every element into `out[0, size())`
+      */
+    void copy_to(dfloat* out) const;
+
+  protected:
+    const char* ptr_;
+    size_t count_;
+    size_t stride_;
+  };
+
+  /**
+    @brief  Split `d` into two words, the mantissa then the sign and power,
+            e.g. to store it in a pair of `std::atomic<uint64_t>`
+    */
+  void split_words(const dfloat& d, uint64_t& mant, uint64_t& meta);
+
+  /**
+    @brief  Inverse of `split_words`
+    */
+  dfloat join_words(uint64_t mant, uint64_t meta);
+
+  template <typename T>
+  struct is_dfloat_view : std::false_type {};
+
+  template <byte_order Order>
+  struct is_dfloat_view<dfloat_view<Order>> : std::true_type {};
+
+  /**
+    @brief  Operands of the view operators: at least one view, the other a
+            view, a dfloat or an arithmetic type
+    */
+  template <typename L, typename R>
+  using enable_if_view_operands_t = std::enable_if_t<
+    (is_dfloat_view<L>::value and (is_dfloat_view<R>::value or std::is_same<R, dfloat>::value or std::is_arithmetic<R>::value)) or
+    (is_dfloat_view<R>::value and (std::is_same<L, dfloat>::value or std::is_arithmetic<L>::value)),
+    bool>;
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  dfloat operator+(const L& l, const R& r);
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  dfloat operator-(const L& l, const R& r);
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  dfloat operator*(const L& l, const R& r);
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  dfloat operator/(const L& l, const R& r);
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  bool operator==(const L& l, const R& r);
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  bool operator!=(const L& l, const R& r);
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  bool operator>(const L& l, const R& r);
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  bool operator<(const L& l, const R& r);
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  bool operator>=(const L& l, const R& r);
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R> = true>
+  bool operator<=(const L& l, const R& r);
+}
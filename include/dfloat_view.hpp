@@ -0,0 +1,317 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstring>
+#include "dfloat.hpp"
+#include "dfloat_endian.hpp"
+#include "dfloat_view.h"
+
+namespace xu
+{
+  static_assert(sizeof(dfloat) == 10, "dfloat_view assumes the packed dfloat layout");
+  static_assert(std::is_trivially_copyable<dfloat>::value, "dfloat_view copies dfloat bytes");
+
+  template <byte_order Order>
+  inline
+  dfloat_view<Order>::dfloat_view(const char* ptr)
+    : ptr_(ptr)
+  {
+  }
+
+  template <byte_order Order>
+  inline
+  void dfloat_view<Order>::write(const dfloat& d, char* dst)
+  {
+    char bytes[SIZE];
+    std::memcpy(bytes, &d, SIZE);
+
+    /* the in-memory layout has the mantissa in native order */
+    uint64_t m;
+    std::memcpy(&m, bytes + MANT_OFFSET, sizeof(m));
+    store<Order>(m, bytes + MANT_OFFSET);
+
+    std::memcpy(dst, bytes, SIZE);
+  }
+
+  template <byte_order Order>
+  inline
+  const char* dfloat_view<Order>::data() const
+  {
+    return ptr_;
+  }
+
+  template <byte_order Order>
+  inline
+  dfloat::Sign dfloat_view<Order>::sign() const
+  {
+    return (dfloat::Sign)ptr_[SIGN_OFFSET];
+  }
+
+  template <byte_order Order>
+  inline
+  dfloat::mant_t dfloat_view<Order>::mant() const
+  {
+    return load<Order, dfloat::mant_t>(ptr_ + MANT_OFFSET);
+  }
+
+  template <byte_order Order>
+  inline
+  dfloat::pow_t dfloat_view<Order>::pow() const
+  {
+    return (dfloat::pow_t)ptr_[POW_OFFSET];
+  }
+
+  template <byte_order Order>
+  inline
+  dfloat dfloat_view<Order>::get() const
+  {
+    char bytes[SIZE];
+    std::memcpy(bytes, ptr_, SIZE);
+
+    uint64_t m = load<Order, uint64_t>(ptr_ + MANT_OFFSET);
+    std::memcpy(bytes + MANT_OFFSET, &m, sizeof(m));
+
+    dfloat d;
+    std::memcpy(&d, bytes, SIZE);
+
+    return d;
+  }
+
+  template <byte_order Order>
+  inline
+  dfloat_view<Order>::operator dfloat() const
+  {
+    return get();
+  }
+
+  template <byte_order Order>
+  inline
+  dfloat_span_view<Order>::iterator::iterator(const char* ptr, size_t stride)
+    : ptr_(ptr), stride_(stride)
+  {
+  }
+
+  template <byte_order Order>
+  inline
+  dfloat_view<Order> dfloat_span_view<Order>::iterator::operator*() const
+  {
+    return dfloat_view<Order>(ptr_);
+  }
+
+  template <byte_order Order>
+  inline
+  typename dfloat_span_view<Order>::iterator& dfloat_span_view<Order>::iterator::operator++()
+  {
+    ptr_ += stride_;
+    return *this;
+  }
+
+  template <byte_order Order>
+  inline
+  typename dfloat_span_view<Order>::iterator dfloat_span_view<Order>::iterator::operator++(int)
+  {
+    iterator old = *this;
+    ptr_ += stride_;
+    return old;
+  }
+
+  template <byte_order Order>
+  inline
+  bool dfloat_span_view<Order>::iterator::operator==(const iterator& other) const
+  {
+    return ptr_ == other.ptr_;
+  }
+
+  template <byte_order Order>
+  inline
+  bool dfloat_span_view<Order>::iterator::operator!=(const iterator& other) const
+  {
+    return ptr_ != other.ptr_;
+  }
+
+  template <byte_order Order>
+  inline
+  dfloat_span_view<Order>::dfloat_span_view(const char* ptr, size_t count, size_t stride)
+    : ptr_(ptr), count_(count), stride_(stride)
+  {
+  }
+
+  template <byte_order Order>
+  inline
+  size_t dfloat_span_view<Order>::size() const
+  {
+    return count_;
+  }
+
+  template <byte_order Order>
+  inline
+  dfloat_view<Order> dfloat_span_view<Order>::operator[](size_t i) const
+  {
+    return dfloat_view<Order>(ptr_ + i * stride_);
+  }
+
+  template <byte_order Order>
+  inline
+  typename dfloat_span_view<Order>::iterator dfloat_span_view<Order>::begin() const
+  {
+    return iterator(ptr_, stride_);
+  }
+
+  template <byte_order Order>
+  inline
+  typename dfloat_span_view<Order>::iterator dfloat_span_view<Order>::end() const
+  {
+    return iterator(ptr_ + count_ * stride_, stride_);
+  }
+
+  template <byte_order Order>
+  inline
+  void dfloat_span_view<Order>::copy_to(dfloat* out) const
+  {
+    const char* src = ptr_;
+
+    for (size_t i = 0; i < count_; i++)
+    {
+      out[i] = dfloat_view<Order>(src).get();
+      src += stride_;
+    }
+  }
+
+  inline
+  void split_words(const dfloat& d, uint64_t& mant, uint64_t& meta)
+  {
+    dfloat_view<NATIVE_ORDER> v(reinterpret_cast<const char*>(&d));
+
+    mant = v.mant();
+    meta = (uint8_t)v.sign() | (uint64_t)(uint8_t)v.pow() << 8;
+  }
+
+  inline
+  dfloat join_words(uint64_t mant, uint64_t meta)
+  {
+    using view = dfloat_view<NATIVE_ORDER>;
+
+    char bytes[view::SIZE];
+    bytes[view::SIGN_OFFSET] = (char)(meta & 0xff);
+    store<NATIVE_ORDER>(mant, bytes + view::MANT_OFFSET);
+    bytes[view::POW_OFFSET] = (char)(meta >> 8);
+
+    return view(bytes).get();
+  }
+
+  /**
+    @brief  Value of an operand of the view operators
+    */
+  template <byte_order Order>
+  inline
+  dfloat _view_value(const dfloat_view<Order>& v)
+  {
+    return v.get();
+  }
+
+  inline
+  const dfloat& _view_value(const dfloat& d)
+  {
+    return d;
+  }
+
+  template <typename T, typename std::enable_if_t<std::is_arithmetic<T>::value, bool> = true>
+  inline
+  dfloat _view_value(T x)
+  {
+    return dfloat(x);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  dfloat operator+(const L& l, const R& r)
+  {
+    return _view_value(l) + _view_value(r);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  dfloat operator-(const L& l, const R& r)
+  {
+    return _view_value(l) - _view_value(r);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  dfloat operator*(const L& l, const R& r)
+  {
+    return _view_value(l) * _view_value(r);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  dfloat operator/(const L& l, const R& r)
+  {
+    return _view_value(l) / _view_value(r);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  bool operator==(const L& l, const R& r)
+  {
+    return _view_value(l) == _view_value(r);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  bool operator!=(const L& l, const R& r)
+  {
+    return _view_value(l) != _view_value(r);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  bool operator>(const L& l, const R& r)
+  {
+    return _view_value(l) > _view_value(r);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  bool operator<(const L& l, const R& r)
+  {
+    return _view_value(l) < _view_value(r);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  bool operator>=(const L& l, const R& r)
+  {
+    return _view_value(l) >= _view_value(r);
+  }
+
+  template <typename L, typename R, enable_if_view_operands_t<L, R>>
+  inline
+  bool operator<=(const L& l, const R& r)
+  {
+    return _view_value(l) <= _view_value(r);
+  }
+}
@@ -0,0 +1,228 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "dfloat.h"
+#include "dfloat_accumulator.h"
+
+namespace xu
+{
+  /**
+    @brief  Volume-weighted average price, sum(price * quantity) / sum(quantity)
+    @note   Notional and volume are kept exactly (see `dfloat_accumulator`),
+            so the only truncation is the division in `value`, whatever the
+            number of trades
+    */
+  class vwap
+  {
+  public:
+    vwap();
+
+    void add(const dfloat& price, const dfloat& quantity);
+
+    /**
+      @brief  Add `count` trades from price and quantity columns
+      */
+    void add(const dfloat* prices, const dfloat* quantities, size_t count);
+
+    /**
+      @brief  Take back a trade added earlier; exact, so nothing drifts
+      */
+    void remove(const dfloat& price, const dfloat& quantity);
+
+    /**
+      @brief  Add all trades of `other`, e.g. a partial result from another
+              thread
+      */
+    void merge(const vwap& other);
+
+    void reset();
+
+    /**
+      @brief  NaN if there is no volume
+      */
+    dfloat value() const;
+
+    /**
+      @brief  sum(price * quantity), truncated
+      */
+    dfloat notional() const;
+
+    /**
+      @brief  sum(quantity), truncated
+      */
+    dfloat volume() const;
+
+    uint64_t trades() const;
+
+    const dfloat_accumulator& exact_notional() const;
+
+    const dfloat_accumulator& exact_volume() const;
+
+  protected:
+    dfloat_accumulator notional_;
+    dfloat_accumulator volume_;
+    uint64_t trades_;
+  };
+
+  /**
+    @brief  A trade with its time, in any unit (e.g. nanoseconds since
+            midnight)
+    */
+  struct timed_trade
+  {
+    int64_t time;
+    dfloat price;
+    dfloat quantity;
+  };
+
+  /**
+    @brief  VWAP of the trades in the last `window` time units
+    @note   Trades leaving the window are subtracted exactly, so the result
+            equals a VWAP recomputed from scratch over the window
+    @note   A NaN cannot be subtracted: once the last NaN trade has left, the
+            sum is rebuilt from the trades still in the window
+    */
+  class rolling_vwap
+  {
+  public:
+    explicit rolling_vwap(int64_t window);
+
+    /**
+      @brief  Add a trade and drop those older than `time - window`
+      @note   Times must not decrease
+      */
+    void add(int64_t time, const dfloat& price, const dfloat& quantity);
+
+    /**
+      @brief  Drop trades at or before `now - window`
+      */
+    void advance(int64_t now);
+
+    dfloat value() const;
+
+    const vwap& window_sum() const;
+
+    size_t size() const;
+
+  protected:
+    /* sum again over `trades_`, after a NaN has left the window */
+    void _rebuild();
+
+    int64_t window_;
+    std::deque<timed_trade> trades_;
+    vwap sum_;
+
+    /* trades in the window with a NaN price or quantity */
+    size_t nan_trades_;
+  };
+
+  /**
+    @brief  One time bucket of a `bucketed_vwap`, covering
+            [start, start + width)
+    */
+  struct vwap_bucket
+  {
+    int64_t start;
+    vwap sum;
+  };
+
+  /**
+    @brief  VWAP per fixed-width time bucket, e.g. per minute
+    @note   Trades may arrive out of order; late ones are added to their own
+            bucket
+    */
+  class bucketed_vwap
+  {
+  public:
+    explicit bucketed_vwap(int64_t width, int64_t origin = 0);
+
+    void add(int64_t time, const dfloat& price, const dfloat& quantity);
+
+    /**
+      @brief  Start of the bucket holding `time`
+      */
+    int64_t bucket_start(int64_t time) const;
+
+    /**
+      @brief  Buckets with at least one trade, by increasing start
+      */
+    const std::vector<vwap_bucket>& buckets() const;
+
+    void clear();
+
+  protected:
+    int64_t width_;
+    int64_t origin_;
+    std::vector<vwap_bucket> buckets_;
+  };
+
+  /**
+    @brief  Time-weighted average price: each price counts for the time
+            until the next update
+    @note   The weighted sum is exact, like `vwap`
+    */
+  class twap
+  {
+  public:
+    twap();
+
+    /**
+      @brief  Price in effect from `time` on
+      @note   Times must not decrease
+      */
+    void update(int64_t time, const dfloat& price);
+
+    /**
+      @brief  Average over [first update, now]
+      @note   The last price if no time has elapsed, NaN if no update yet
+      */
+    dfloat value(int64_t now) const;
+
+    void reset();
+
+  protected:
+    dfloat_accumulator weighted_;
+    int64_t elapsed_;
+    int64_t last_time_;
+    dfloat last_price_;
+    bool started_;
+  };
+
+  /**
+    @brief  Add trade `i` to `instruments[ids[i]]` for every trade of the
+            columns; ids outside [0, num_instruments) are ignored
+    @note   Instruments are split into contiguous ranges across `threads`
+            threads, and each thread scans all trades for its own range, so
+            no two threads touch the same instrument and no locks are
+            needed. Each instrument sees its trades in column order
+    */
+  void vwap_update(vwap* instruments, size_t num_instruments, const uint32_t* ids,
+    const dfloat* prices, const dfloat* quantities, size_t count, size_t threads);
+}
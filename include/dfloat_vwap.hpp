@@ -0,0 +1,327 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include "dfloat.hpp"
+#include "dfloat_accumulator.hpp"
+#include "dfloat_column.hpp"
+#include "dfloat_vwap.h"
+
+namespace xu
+{
+  inline
+  vwap::vwap()
+    : trades_(0)
+  {
+  }
+
+  inline
+  void vwap::add(const dfloat& price, const dfloat& quantity)
+  {
+    notional_.add_product(price, quantity);
+    volume_.add(quantity);
+    trades_++;
+  }
+
+  inline
+  void vwap::add(const dfloat* prices, const dfloat* quantities, size_t count)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      notional_.add_product(prices[i], quantities[i]);
+      volume_.add(quantities[i]);
+    }
+
+    trades_ += count;
+  }
+
+  inline
+  void vwap::remove(const dfloat& price, const dfloat& quantity)
+  {
+    notional_.subtract_product(price, quantity);
+    volume_.subtract(quantity);
+    trades_--;
+  }
+
+  inline
+  void vwap::merge(const vwap& other)
+  {
+    notional_.add(other.notional_);
+    volume_.add(other.volume_);
+    trades_ += other.trades_;
+  }
+
+  inline
+  void vwap::reset()
+  {
+    notional_.reset();
+    volume_.reset();
+    trades_ = 0;
+  }
+
+  inline
+  dfloat vwap::value() const
+  {
+    return notional_.divide(volume_);
+  }
+
+  inline
+  dfloat vwap::notional() const
+  {
+    return notional_.value();
+  }
+
+  inline
+  dfloat vwap::volume() const
+  {
+    return volume_.value();
+  }
+
+  inline
+  uint64_t vwap::trades() const
+  {
+    return trades_;
+  }
+
+  inline
+  const dfloat_accumulator& vwap::exact_notional() const
+  {
+    return notional_;
+  }
+
+  inline
+  const dfloat_accumulator& vwap::exact_volume() const
+  {
+    return volume_;
+  }
+
+  inline
+  rolling_vwap::rolling_vwap(int64_t window)
+    : window_(window), nan_trades_(0)
+  {
+  }
+
+  inline
+  void rolling_vwap::add(int64_t time, const dfloat& price, const dfloat& quantity)
+  {
+    advance(time);
+
+    trades_.push_back({time, price, quantity});
+    sum_.add(price, quantity);
+    nan_trades_ += not dfloat::isfinite(price) or not dfloat::isfinite(quantity);
+  }
+
+  inline
+  void rolling_vwap::advance(int64_t now)
+  {
+    bool removed = false;
+
+    while (not trades_.empty() and trades_.front().time <= now - window_)
+    {
+      const timed_trade& oldest = trades_.front();
+      sum_.remove(oldest.price, oldest.quantity);
+      nan_trades_ -= not dfloat::isfinite(oldest.price) or not dfloat::isfinite(oldest.quantity);
+      trades_.pop_front();
+      removed = true;
+    }
+
+    /*
+      Subtracting cannot bring a NaN sum back, whether a NaN trade or an
+      overflow put it there; with no NaN trade left, sum the window again
+    */
+    if (removed and nan_trades_ == 0
+      and (sum_.exact_notional().isnan() or sum_.exact_volume().isnan()))
+    {
+      _rebuild();
+    }
+    else if (trades_.empty())
+    {
+      /* start again from exactly zero */
+      sum_.reset();
+    }
+  }
+
+  inline
+  void rolling_vwap::_rebuild()
+  {
+    sum_.reset();
+
+    for (const timed_trade& t : trades_)
+    {
+      sum_.add(t.price, t.quantity);
+    }
+  }
+
+  inline
+  dfloat rolling_vwap::value() const
+  {
+    return sum_.value();
+  }
+
+  inline
+  const vwap& rolling_vwap::window_sum() const
+  {
+    return sum_;
+  }
+
+  inline
+  size_t rolling_vwap::size() const
+  {
+    return trades_.size();
+  }
+
+  inline
+  bucketed_vwap::bucketed_vwap(int64_t width, int64_t origin)
+    : width_(width > 0 ? width : 1), origin_(origin)
+  {
+  }
+
+  inline
+  int64_t bucketed_vwap::bucket_start(int64_t time) const
+  {
+    /* floor division, also before the origin */
+    int64_t offset = time - origin_;
+    int64_t index = offset / width_ - (offset % width_ < 0 ? 1 : 0);
+
+    return origin_ + index * width_;
+  }
+
+  inline
+  void bucketed_vwap::add(int64_t time, const dfloat& price, const dfloat& quantity)
+  {
+    int64_t start = bucket_start(time);
+
+    /* in order, the trade belongs to the last bucket or a new one */
+    if (buckets_.empty() or buckets_.back().start < start)
+    {
+      buckets_.push_back({start, vwap()});
+      buckets_.back().sum.add(price, quantity);
+      return;
+    }
+
+    auto it = std::lower_bound(buckets_.begin(), buckets_.end(), start,
+      [](const vwap_bucket& bucket, int64_t s) { return bucket.start < s; });
+
+    if (it == buckets_.end() or it->start != start)
+    {
+      it = buckets_.insert(it, {start, vwap()});
+    }
+
+    it->sum.add(price, quantity);
+  }
+
+  inline
+  const std::vector<vwap_bucket>& bucketed_vwap::buckets() const
+  {
+    return buckets_;
+  }
+
+  inline
+  void bucketed_vwap::clear()
+  {
+    buckets_.clear();
+  }
+
+  inline
+  twap::twap()
+    : elapsed_(0), last_time_(0), last_price_(0), started_(false)
+  {
+  }
+
+  inline
+  void twap::update(int64_t time, const dfloat& price)
+  {
+    if (started_ and time > last_time_)
+    {
+      weighted_.add_product(last_price_, dfloat::from_scaled(time - last_time_, 0));
+      elapsed_ += time - last_time_;
+    }
+
+    if (not started_ or time > last_time_)
+    {
+      last_time_ = time;
+    }
+
+    last_price_ = price;
+    started_ = true;
+  }
+
+  inline
+  dfloat twap::value(int64_t now) const
+  {
+    if (not started_)
+    {
+      return dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+    }
+
+    int64_t tail = now > last_time_ ? now - last_time_ : 0;
+
+    if (elapsed_ + tail == 0)
+    {
+      return last_price_;
+    }
+
+    dfloat_accumulator weighted = weighted_;
+    weighted.add_product(last_price_, dfloat::from_scaled(tail, 0));
+
+    dfloat_accumulator duration;
+    duration.add_scaled(elapsed_ + tail, 0);
+
+    return weighted.divide(duration);
+  }
+
+  inline
+  void twap::reset()
+  {
+    weighted_.reset();
+    elapsed_ = 0;
+    last_time_ = 0;
+    last_price_ = 0;
+    started_ = false;
+  }
+
+  inline
+  void vwap_update(vwap* instruments, size_t num_instruments, const uint32_t* ids,
+    const dfloat* prices, const dfloat* quantities, size_t count, size_t threads)
+  {
+    /* a block of instruments per cache-friendly range */
+    constexpr size_t BLOCK = 64;
+
+    parallel_blocks(num_instruments, threads, BLOCK,
+      [&](size_t begin, size_t end)
+      {
+        for (size_t i = 0; i < count; i++)
+        {
+          size_t id = ids[i];
+
+          if (id >= begin and id < end)
+          {
+            instruments[id].add(prices[i], quantities[i]);
+          }
+        }
+      });
+  }
+}
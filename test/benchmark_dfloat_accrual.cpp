@@ -0,0 +1,127 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_accrual -I../include -pthread benchmark_dfloat_accrual.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "dfloat_accumulator.hpp"
+#include "dfloat_accrual.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+using xu::day_count;
+
+void report(const char* name, size_t count, double seconds, const std::vector<dfloat>& out)
+{
+  xu::dfloat_accumulator total;
+  for (const dfloat& d : out)
+  {
+    total.add(d);
+  }
+
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " positions/s\t";
+  std::cout << "total " << total.value() << std::endl;
+}
+
+/*
+  What we used to do: the year fraction as a dfloat quotient, then dfloat
+  `*` for the notional and the rate, truncating at every step
+  */
+void step_by_step(const std::vector<int32_t>& starts, const std::vector<int32_t>& ends,
+  const std::vector<dfloat>& notionals, const std::vector<dfloat>& rates, day_count convention,
+  std::vector<dfloat>& out)
+{
+  for (size_t i = 0; i < starts.size(); i++)
+  {
+    int64_t num, den;
+
+    if (not xu::year_fraction(starts[i], ends[i], convention, num, den))
+    {
+      out[i] = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+      continue;
+    }
+
+    dfloat fraction = dfloat(num) / dfloat(den);
+    out[i] = notionals[i] * rates[i] * fraction;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+  size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+
+  std::vector<int32_t> starts(count);
+  std::vector<int32_t> ends(count);
+  std::vector<dfloat> notionals(count);
+  std::vector<dfloat> rates(count);
+
+  /* notionals of 1,000.00 to 10,000,000.00, rates of 0.001% to 9.999%, up to two years */
+  int32_t base = xu::days_from_civil(2020, 1, 1);
+
+  uint64_t seed = 1;
+  for (size_t i = 0; i < count; i++)
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    uint64_t r = seed >> 16;
+
+    starts[i] = base + (int32_t)(r % 1500);
+    ends[i] = starts[i] + (int32_t)((r >> 12) % 730);
+    notionals[i] = dfloat::from_scaled((int64_t)(100000 + (r >> 24) % 999900000), -2);
+    rates[i] = dfloat::from_scaled((int64_t)(1 + (r >> 30) % 9999), -5);
+  }
+
+  std::cout << count << " positions" << std::endl;
+
+  std::vector<dfloat> out(count);
+
+  Timer t;
+
+  for (day_count convention : {day_count::ACT_360, day_count::THIRTY_360, day_count::ACT_ACT})
+  {
+    const char* names[] = {"act/360", "act/365", "30/360", "act/act"};
+    std::cout << names[(int)convention] << std::endl;
+
+    t.start();
+    step_by_step(starts, ends, notionals, rates, convention, out);
+    report("step by step", count, t.stop(), out);
+
+    for (size_t n : {(size_t)1, threads})
+    {
+      t.start();
+      xu::accrue(starts.data(), ends.data(), notionals.data(), rates.data(), count, convention, out.data(), n);
+      double seconds = t.stop();
+
+      std::cout << "threads " << n << '\t';
+      report("exact", count, seconds, out);
+    }
+  }
+}
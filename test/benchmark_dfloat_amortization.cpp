@@ -0,0 +1,154 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_amortization -I../include -pthread benchmark_dfloat_amortization.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "dfloat_accumulator.hpp"
+#include "dfloat_amortization.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+void report(const char* name, size_t count, double seconds, const dfloat& paid)
+{
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " loans/s\t";
+  std::cout << "interest " << paid << std::endl;
+}
+
+dfloat total(const xu::dfloat_column& column)
+{
+  xu::dfloat_accumulator acc;
+  for (size_t r = 0; r < column.size(); r++)
+  {
+    acc.add(column[r]);
+  }
+  return acc.value();
+}
+
+/*
+  What we used to do: one loan at a time, dfloat `*`, `/` and `-` for each
+  period with the periodic rate truncated, rounded with `round_to`
+  */
+void one_by_one(const std::vector<dfloat>& principals, const std::vector<dfloat>& rates,
+  const std::vector<uint32_t>& terms, xu::amortization_schedule& out)
+{
+  using xu::rounding_mode;
+
+  size_t rows = 0;
+  for (uint32_t term : terms)
+  {
+    rows += term;
+  }
+
+  out.loan.resize(rows);
+  out.period.resize(rows);
+  out.payment.resize(rows);
+  out.interest.resize(rows);
+  out.principal.resize(rows);
+  out.balance.resize(rows);
+
+  size_t row = 0;
+
+  for (size_t i = 0; i < principals.size(); i++)
+  {
+    dfloat r = rates[i] / 12;
+
+    dfloat growth = 1;
+    for (uint32_t k = 0; k < terms[i]; k++)
+    {
+      growth *= 1 + r;
+    }
+
+    dfloat payment = xu::round_to(principals[i] * r * growth / (growth - 1), -2, rounding_mode::HALF_UP);
+    dfloat balance = principals[i];
+
+    for (uint32_t k = 0; k < terms[i]; k++)
+    {
+      dfloat interest = xu::round_to(balance * r, -2, rounding_mode::HALF_UP);
+      dfloat principal = k + 1 == terms[i] ? balance : payment - interest;
+
+      balance -= principal;
+
+      out.loan[row] = (uint32_t)i;
+      out.period[row] = k + 1;
+      out.payment[row] = interest + principal;
+      out.interest[row] = interest;
+      out.principal[row] = principal;
+      out.balance[row] = balance;
+      ++row;
+    }
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+
+  std::vector<dfloat> principals(count);
+  std::vector<dfloat> rates(count);
+  std::vector<uint32_t> terms(count);
+
+  /* 10,000.00 to 1,000,000.00 at 2% to 9.99%, for 5 to 30 years */
+  uint64_t seed = 1;
+  for (size_t i = 0; i < count; i++)
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    uint64_t r = seed >> 16;
+
+    principals[i] = dfloat::from_scaled((int64_t)(1000000 + r % 99000000), -2);
+    rates[i] = dfloat::from_scaled((int64_t)(200 + (r >> 32) % 800), -4);
+    terms[i] = (uint32_t)(60 * (1 + (r >> 40) % 6));
+  }
+
+  std::cout << count << " loans" << std::endl;
+
+  Timer t;
+
+  {
+    xu::amortization_schedule out;
+
+    t.start();
+    one_by_one(principals, rates, terms, out);
+    report("one by one", count, t.stop(), total(out.interest));
+  }
+
+  for (size_t n : {(size_t)1, threads})
+  {
+    xu::amortization_schedule out;
+
+    t.start();
+    xu::amortize(principals.data(), rates.data(), terms.data(), count, xu::amortization_policy(), out, n);
+    double seconds = t.stop();
+
+    std::cout << "threads " << n << '\t';
+    report("columns", count, seconds, total(out.interest));
+  }
+}
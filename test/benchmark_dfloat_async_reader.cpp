@@ -0,0 +1,143 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_async_reader -I../include -pthread benchmark_dfloat_async_reader.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include "dfloat.hpp"
+#include "dfloat_async_reader.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+void report(const char* name, size_t count, double seconds, dfloat sum)
+{
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " numbers/s" << '\t';
+  std::cout << sum << std::endl;
+}
+
+/*
+  The loader of benchmark_dfloat.cpp: one ifstream read per number, then
+  the sum once everything is in memory
+  */
+void ifstream_then_sum(const std::string& path)
+{
+  Timer t;
+  t.start();
+
+  std::ifstream file(path, std::ios::in | std::ios::ate | std::ios::binary);
+
+  size_t count = (size_t)file.tellg() / sizeof(long long);
+  file.seekg(0);
+
+  long long* arr = new long long[count];
+
+  for (size_t i = 0; i < count; i++)
+  {
+    file.read((char*)&arr[i], sizeof(long long));
+  }
+
+  dfloat sum = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    sum += dfloat(arr[i]);
+  }
+
+  delete[] arr;
+
+  report("ifstream", count, t.stop(), sum);
+}
+
+/*
+  Parse and sum each chunk as soon as its read completes
+  */
+void async_sum(const char* name, const std::string& path, bool allow_io_uring, size_t threads, size_t chunk_size, size_t depth)
+{
+  Timer t;
+  t.start();
+
+  xu::async_file_reader reader(path, chunk_size, depth, allow_io_uring);
+
+  std::mutex mutex;
+  dfloat sum = 0;
+
+  xu::for_each_chunk(reader, threads,
+    [&](const xu::file_chunk& chunk)
+    {
+      size_t n = chunk.size / sizeof(long long);
+
+      dfloat partial = 0;
+      for (size_t i = 0; i < n; i++)
+      {
+        long long x;
+        std::memcpy(&x, chunk.data + i * sizeof(long long), sizeof(long long));
+        partial += dfloat(x);
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      sum += partial;
+    });
+
+  size_t count = reader.file_size() / sizeof(long long);
+
+  report(name, count, t.stop(), sum);
+
+  if (allow_io_uring and not reader.uses_io_uring())
+  {
+    std::cout << "  io_uring unavailable, used pread" << std::endl;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: benchmark_dfloat_async_reader <filepath> [threads] [chunk KiB] [depth]" << std::endl;
+    abort();
+  }
+
+  std::string path = argv[1];
+  size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+  size_t chunk_size = (argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1024) * 1024;
+  size_t depth = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 8;
+
+  /* whole numbers per chunk */
+  chunk_size -= chunk_size % sizeof(long long);
+
+  std::cout << threads << " parser threads, " << chunk_size / 1024 << " KiB chunks, depth " << depth << std::endl;
+
+  ifstream_then_sum(path);
+
+  async_sum("pread", path, false, threads, chunk_size, depth);
+
+  async_sum("io_uring", path, true, threads, chunk_size, depth);
+}
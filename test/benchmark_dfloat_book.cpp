@@ -0,0 +1,184 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_book -I../include benchmark_dfloat_book.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include "dfloat_book.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+using xu::book_side;
+
+void report(const char* name, size_t count, double seconds, const dfloat& best_bid)
+{
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " updates/s\t";
+  std::cout << "best bid " << best_bid << std::endl;
+}
+
+/*
+  What we used to do: a map per side from price to venue sizes, dfloat
+  comparisons per lookup
+  */
+dfloat map_book(const std::vector<xu::book_update>& updates, size_t num_venues)
+{
+  std::map<dfloat, std::vector<dfloat>> sides[2];
+
+  for (const auto& u : updates)
+  {
+    auto& side = sides[(int)u.side];
+    auto it = side.find(u.price);
+
+    if (it == side.end())
+    {
+      if (not (u.size > 0))
+      {
+        continue;
+      }
+      it = side.emplace(u.price, std::vector<dfloat>(num_venues, dfloat(0))).first;
+    }
+
+    it->second[u.venue] = u.size > 0 ? u.size : dfloat(0);
+
+    bool any = false;
+    for (const dfloat& s : it->second)
+    {
+      any = any or s > 0;
+    }
+    if (not any)
+    {
+      side.erase(it);
+    }
+  }
+
+  auto& bids = sides[(int)book_side::BID];
+  return bids.empty() ? dfloat(0) : bids.rbegin()->first;
+}
+
+void run(const std::vector<xu::book_update>& updates, size_t num_venues, size_t batch)
+{
+  size_t count = updates.size();
+
+  Timer t;
+
+  t.start();
+  dfloat best = map_book(updates, num_venues);
+  report("map", count, t.stop(), best);
+
+  xu::book_level level;
+
+  {
+    xu::consolidated_book book(num_venues);
+
+    t.start();
+    for (const auto& u : updates)
+    {
+      book.apply(u);
+    }
+    double seconds = t.stop();
+
+    book.best(book_side::BID, level);
+    report("book", count, seconds, level.price);
+  }
+
+  {
+    xu::consolidated_book book(num_venues);
+
+    t.start();
+    for (size_t begin = 0; begin < count; begin += batch)
+    {
+      book.apply(updates.data() + begin, std::min(batch, count - begin));
+    }
+    double seconds = t.stop();
+
+    book.best(book_side::BID, level);
+    std::string name = "batch " + std::to_string(batch);
+    report(name.c_str(), count, seconds, level.price);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  size_t num_venues = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8;
+  size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+  size_t levels = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 500;
+
+  std::vector<xu::book_update> updates(count);
+
+  /* incremental updates: most land near the top of the book, a quarter remove */
+  uint64_t seed = 1;
+  for (size_t i = 0; i < count; i++)
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    uint64_t r = seed >> 16;
+
+    xu::book_update& u = updates[i];
+    u.venue = (uint16_t)(r % num_venues);
+    u.side = (r >> 8) % 2 ? book_side::BID : book_side::ASK;
+
+    size_t a = (r >> 9) % levels;
+    size_t b = (r >> 19) % levels;
+    size_t c = (r >> 29) % levels;
+    int64_t offset = (int64_t)(a * b / levels * c / levels);
+
+    int64_t ticks = u.side == book_side::BID ? 100000 - offset : 100001 + offset;
+    u.price = dfloat::from_scaled(ticks, -3);
+    u.size = (r >> 41) % 4 == 0 ? dfloat(0) : dfloat((int)((r >> 43) % 50 + 1) * 100);
+  }
+
+  std::cout << num_venues << " venues, " << count << " incremental updates, " << levels << " levels per side" << std::endl;
+
+  run(updates, num_venues, 64);
+
+  /* snapshots: every venue resends both sides in full, prices in no order */
+  updates.clear();
+  for (size_t n = 0; updates.size() < count; n++)
+  {
+    uint16_t venue = (uint16_t)(n % num_venues);
+
+    for (size_t k = 0; k < 2 * levels; k++)
+    {
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      uint64_t r = seed >> 16;
+
+      size_t i = k * 7919 % (2 * levels);
+      book_side side = i < levels ? book_side::BID : book_side::ASK;
+      int64_t offset = (int64_t)(i % levels) * 3 + (int64_t)(venue % 3);
+
+      int64_t ticks = side == book_side::BID ? 100000 - offset : 100001 + offset;
+      updates.push_back({venue, side, dfloat::from_scaled(ticks, -3), dfloat((int)(r % 50 + 1) * 100)});
+    }
+  }
+
+  std::cout << updates.size() / (2 * levels) << " snapshots of " << 2 * levels << " levels" << std::endl;
+
+  run(updates, num_venues, 2 * levels);
+}
@@ -0,0 +1,125 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -std=c++20 -O2 -o bin/benchmark_dfloat_generator -I../include benchmark_dfloat_generator.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "dfloat_generator.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+/*
+  Hand-written loop: parse a batch into a buffer, keep the positive values,
+  double them and add them up
+  */
+dfloat direct(const std::string& records, size_t count, size_t batch)
+{
+  std::vector<dfloat> values(batch);
+  dfloat total = 0;
+
+  for (size_t i = 0; i < count; i += batch)
+  {
+    size_t n = std::min(batch, count - i);
+
+    xu::parse_fixed(records.data() + i * 9, 8, 9, n, values.data());
+
+    for (size_t k = 0; k < n; k++)
+    {
+      if (values[k] > 0)
+      {
+        total += values[k] * 2;
+      }
+    }
+  }
+
+  return total;
+}
+
+/*
+  The same as four chained coroutine stages
+  */
+dfloat pipeline(const std::string& records, size_t count, size_t batch)
+{
+  auto positive = [](const dfloat& x) { return x > 0; };
+  auto twice = [](const dfloat& x) { return x * 2; };
+
+  return xu::sum(xu::transform(xu::filter(xu::parse_fields(records.data(), 8, 9, count, batch), positive), twice));
+}
+
+int main(int argc, char* argv[])
+{
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+
+  std::string records;
+  records.reserve(count * 9);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    std::string field = std::to_string((long)(i * 7919 % 199999) - 99999) + "." + std::to_string(i % 10);
+    records += std::string(8 - field.size(), ' ') + field + "\n";
+  }
+
+  std::cout << count << " fields" << std::endl;
+  std::cout << "batch\tdirect\t\tpipeline\toverhead ns/batch\tns/value" << std::endl;
+
+  for (size_t batch : {1, 8, 64, 512, 4096})
+  {
+    /* best of several runs, the difference is small next to the noise */
+    double direct_seconds = 1e9;
+    double pipeline_seconds = 1e9;
+
+    for (int run = 0; run < 5; run++)
+    {
+      Timer t;
+
+      t.start();
+      dfloat a = direct(records, count, batch);
+      direct_seconds = std::min(direct_seconds, t.stop());
+
+      t.start();
+      dfloat b = pipeline(records, count, batch);
+      pipeline_seconds = std::min(pipeline_seconds, t.stop());
+
+      if (a != b)
+      {
+        std::cerr << "Mismatch: " << a << " " << b << std::endl;
+        abort();
+      }
+    }
+
+    size_t batches = (count + batch - 1) / batch;
+
+    std::cout << batch << '\t';
+    std::cout << std::setw(8) << std::left << direct_seconds << '\t';
+    std::cout << std::setw(8) << std::left << pipeline_seconds << '\t';
+    std::cout << std::setw(12) << std::left << (pipeline_seconds - direct_seconds) / batches * 1e9 << '\t';
+    std::cout << (pipeline_seconds - direct_seconds) / count * 1e9 << std::endl;
+  }
+}
@@ -0,0 +1,182 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_invoice -I../include -pthread benchmark_dfloat_invoice.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "dfloat_accumulator.hpp"
+#include "dfloat_invoice.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+void report(const char* name, size_t count, double seconds, const xu::dfloat_column& payable)
+{
+  xu::dfloat_accumulator total;
+  for (size_t i = 0; i < payable.size(); i++)
+  {
+    total.add(payable[i]);
+  }
+
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " lines/s\t";
+  std::cout << "payable " << total.value() << std::endl;
+}
+
+/* half-up to cents through the decimal string */
+dfloat round_string(const dfloat& d)
+{
+  std::string s = dfloat::to_string(d);
+
+  /* round the magnitude, so that ties go away from zero */
+  bool neg = s[0] == '-';
+  if (neg)
+  {
+    s.erase(0, 1);
+  }
+
+  size_t dot = s.find('.');
+
+  if (dot == std::string::npos or s.size() - dot <= 3)
+  {
+    return d;
+  }
+
+  dfloat rounded = dfloat::parse(s.substr(0, dot + 3));
+
+  if (s[dot + 3] >= '5')
+  {
+    rounded += dfloat::parse("0.01");
+  }
+
+  return neg ? -rounded : rounded;
+}
+
+/*
+  What we used to do: dfloat `*` for each amount, rounded by a string
+  round trip, and `+` into the invoice totals
+  */
+void chained(const std::vector<uint64_t>& offsets, const std::vector<dfloat>& quantities,
+  const std::vector<dfloat>& prices, const std::vector<uint32_t>& rules, const std::vector<xu::line_rule>& table,
+  xu::invoice_totals& totals)
+{
+  size_t num_invoices = offsets.size() - 1;
+
+  totals.total.resize(num_invoices);
+  totals.payable.resize(num_invoices);
+
+  for (size_t i = 0; i < num_invoices; i++)
+  {
+    dfloat total = 0;
+
+    for (uint64_t l = offsets[i]; l < offsets[i + 1]; l++)
+    {
+      const xu::line_rule& rule = table[rules[l]];
+
+      dfloat extended = round_string(quantities[l] * prices[l]);
+      dfloat discount = round_string(extended * rule.discount_rate);
+      dfloat net = extended - discount;
+      dfloat tax = round_string(net * rule.tax_rate);
+
+      total += net + tax;
+    }
+
+    totals.total[i] = total;
+    totals.payable[i] = total;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  size_t num_invoices = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+  size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+
+  std::vector<xu::line_rule> table(4);
+  table[1].tax_rate = dfloat::parse("0.0825");
+  table[2].discount_rate = dfloat::parse("0.15");
+  table[2].tax_rate = dfloat::parse("0.0825");
+  table[3].discount_rate = dfloat::parse("0.05");
+  table[3].tax_rate = dfloat::parse("0.2");
+
+  std::vector<uint64_t> offsets(num_invoices + 1);
+  std::vector<dfloat> quantities;
+  std::vector<dfloat> prices;
+  std::vector<uint32_t> rules;
+
+  /* 1 to 20 lines of 1 to 12 units at 0.01 to 999.99 */
+  uint64_t seed = 1;
+  offsets[0] = 0;
+  for (size_t i = 0; i < num_invoices; i++)
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    size_t count = 1 + (seed >> 16) % 20;
+
+    for (size_t k = 0; k < count; k++)
+    {
+      seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+      uint64_t r = seed >> 16;
+
+      quantities.push_back(dfloat((int64_t)(1 + r % 12)));
+      prices.push_back(dfloat::from_scaled((int64_t)(1 + (r >> 8) % 99999), -2));
+      rules.push_back((uint32_t)((r >> 32) % table.size()));
+    }
+
+    offsets[i + 1] = quantities.size();
+  }
+
+  size_t count = quantities.size();
+
+  std::cout << num_invoices << " invoices, " << count << " lines" << std::endl;
+
+  Timer t;
+
+  {
+    xu::invoice_totals totals;
+
+    t.start();
+    chained(offsets, quantities, prices, rules, table, totals);
+    report("chained", count, t.stop(), totals.payable);
+  }
+
+  xu::invoice_engine engine(table, xu::invoice_policy());
+
+  for (size_t n : {(size_t)1, threads})
+  {
+    xu::invoice_lines lines;
+    xu::invoice_totals totals;
+
+    t.start();
+    engine.run(offsets.data(), num_invoices, quantities.data(), prices.data(), rules.data(), lines, totals, n);
+    double seconds = t.stop();
+
+    std::cout << "threads " << n << '\t';
+    report("engine", count, seconds, totals.payable);
+  }
+}
@@ -0,0 +1,117 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_itch -I../include benchmark_dfloat_itch.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "dfloat_itch.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+/* ITCH 5.0 Add Order: price is a Price(4) at offset 32 of a 36 byte message */
+constexpr size_t ADD_ORDER_SIZE = 36;
+constexpr size_t ADD_ORDER_PRICE = 32;
+
+/*
+  What we used to do: assemble the integer byte by byte, construct a dfloat
+  from it, then divide by the scale
+  */
+dfloat naive_price(const char* src)
+{
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(src);
+
+  uint32_t raw = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+
+  return dfloat((int64_t)raw) / 10000;
+}
+
+void report(const char* name, double seconds, size_t count, const dfloat& sum)
+{
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << std::setw(12) << std::left << (size_t)(count / seconds) << " msgs/s" << '\t';
+  std::cout << sum << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<uint32_t> dist(1, 2000000000u);
+
+  std::vector<char> buffer(count * ADD_ORDER_SIZE, 0);
+  for (size_t i = 0; i < count; i++)
+  {
+    char* message = buffer.data() + i * ADD_ORDER_SIZE;
+    message[0] = 'A';
+    xu::store<xu::byte_order::BIG>(dist(gen), message + ADD_ORDER_PRICE);
+  }
+
+  std::vector<dfloat> out(count);
+
+  std::cout << "Generated " << count << " Add Order messages" << std::endl;
+
+  {
+    Timer t;
+    t.start();
+
+    for (size_t i = 0; i < count; i++)
+    {
+      out[i] = naive_price(buffer.data() + i * ADD_ORDER_SIZE + ADD_ORDER_PRICE);
+    }
+
+    double seconds = t.stop();
+
+    dfloat sum = 0;
+    for (const dfloat& d : out)
+    {
+      sum += d;
+    }
+
+    report("naive", seconds, count, sum);
+  }
+
+  {
+    Timer t;
+    t.start();
+
+    xu::itch_decode_prices<uint32_t, 4>(buffer.data() + ADD_ORDER_PRICE, ADD_ORDER_SIZE, count, out.data());
+
+    double seconds = t.stop();
+
+    dfloat sum = 0;
+    for (const dfloat& d : out)
+    {
+      sum += d;
+    }
+
+    report("batch", seconds, count, sum);
+  }
+}
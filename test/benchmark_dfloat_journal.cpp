@@ -0,0 +1,144 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_journal -I../include -pthread benchmark_dfloat_journal.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "dfloat_journal.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+void report(const char* name, size_t count, double seconds)
+{
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " postings/s" << std::endl;
+}
+
+/*
+  What we used to do: print each posting and fsync before acknowledging it
+  */
+void text_fsync(const std::string& path, size_t count)
+{
+  std::remove(path.c_str());
+  FILE* file = std::fopen(path.c_str(), "w");
+
+  Timer t;
+  t.start();
+
+  for (size_t i = 0; i < count; i++)
+  {
+    dfloat amount = dfloat::from_scaled((int64_t)(i * 7919 % 1000000), -2);
+
+    std::fprintf(file, "%zu %s %s\n", i, dfloat::to_string(amount).c_str(), dfloat::to_string(-amount).c_str());
+    std::fflush(file);
+    ::fdatasync(::fileno(file));
+  }
+
+  report("text + fsync", count, t.stop());
+
+  std::fclose(file);
+}
+
+void journal(const std::string& path, size_t count, size_t threads)
+{
+  std::remove(path.c_str());
+
+  xu::journal_writer writer(path);
+
+  Timer t;
+  t.start();
+
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < threads; w++)
+  {
+    workers.emplace_back([&, w]()
+    {
+      for (size_t i = w; i < count; i += threads)
+      {
+        dfloat amount = dfloat::from_scaled((int64_t)(i * 7919 % 1000000), -2);
+        dfloat values[2] = {amount, -amount};
+
+        /* each posting is acknowledged only once durable */
+        writer.sync(writer.append(i, values, 2));
+      }
+    });
+  }
+
+  for (std::thread& th : workers)
+  {
+    th.join();
+  }
+
+  double seconds = t.stop();
+
+  report("journal", count, seconds);
+  std::cout << "  " << writer.blocks_written() << " fsyncs, "
+            << (double)count / writer.blocks_written() << " postings per block" << std::endl;
+}
+
+void replay(const std::string& path)
+{
+  xu::journal_reader reader(path);
+
+  Timer t;
+  t.start();
+
+  dfloat sum = 0;
+  reader.replay([&](uint64_t, uint64_t, const dfloat* values, size_t count)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      sum += values[i];
+    }
+  });
+
+  report("replay", reader.records(), t.stop());
+  std::cout << "  " << reader.valid_size() << " bytes, sum " << sum << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64;
+  std::string path = argc > 3 ? argv[3] : "/tmp/benchmark_dfloat_journal.wal";
+
+  std::cout << count << " postings, " << threads << " committing threads, " << path << std::endl;
+
+  text_fsync(path + ".txt", count / 100);
+
+  journal(path, count, threads);
+
+  replay(path);
+
+  std::remove((path + ".txt").c_str());
+  std::remove(path.c_str());
+}
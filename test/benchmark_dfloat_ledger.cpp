@@ -0,0 +1,156 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_ledger -I../include -pthread benchmark_dfloat_ledger.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include "dfloat_ledger.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+void report(const char* name, size_t count, double seconds, size_t posted)
+{
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " postings/s\t";
+  std::cout << posted << " entries posted" << std::endl;
+}
+
+/*
+  What we used to do: balances as dfloat, entry checked with dfloat `+`
+  */
+size_t dfloat_ledger(const std::vector<size_t>& offsets, const std::vector<uint32_t>& accounts,
+  const std::vector<dfloat>& amounts, size_t num_accounts)
+{
+  std::vector<dfloat> balances(num_accounts, dfloat(0));
+  size_t posted = 0;
+
+  for (size_t i = 0; i + 1 < offsets.size(); i++)
+  {
+    dfloat sum = 0;
+    for (size_t k = offsets[i]; k < offsets[i + 1]; k++)
+    {
+      sum += amounts[k];
+    }
+
+    if (sum != 0)
+    {
+      continue;
+    }
+
+    for (size_t k = offsets[i]; k < offsets[i + 1]; k++)
+    {
+      balances[accounts[k]] += amounts[k];
+    }
+    ++posted;
+  }
+
+  return posted;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t num_accounts = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  size_t entries = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+  size_t remote = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10;
+
+  std::vector<size_t> offsets(1, 0);
+  std::vector<uint32_t> accounts;
+  std::vector<dfloat> amounts;
+
+  /* 2 to 4 postings; `remote` percent of entries reach accounts anywhere, the rest stay close together */
+  uint64_t seed = 1;
+  auto next = [&]()
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return seed >> 20;
+  };
+
+  for (size_t i = 0; i < entries; i++)
+  {
+    size_t legs = 2 + next() % 3;
+    uint64_t base = next() % num_accounts;
+    bool far = next() % 100 < remote;
+
+    int64_t sum = 0;
+
+    for (size_t k = 0; k < legs; k++)
+    {
+      uint64_t account = far ? next() % num_accounts : (base + k * 7) % num_accounts;
+      int64_t cents = k + 1 < legs ? (int64_t)(next() % 2000000) - 1000000 : -sum;
+
+      sum += cents;
+
+      accounts.push_back((uint32_t)account);
+      amounts.push_back(dfloat::from_scaled(cents, -2));
+    }
+
+    offsets.push_back(accounts.size());
+  }
+
+  size_t postings = accounts.size();
+
+  std::cout << num_accounts << " accounts, " << entries << " entries, " << postings << " postings, "
+    << remote << "% spread" << std::endl;
+
+  Timer t;
+
+  t.start();
+  size_t posted = dfloat_ledger(offsets, accounts, amounts, num_accounts);
+  report("dfloat", postings, t.stop(), posted);
+
+  {
+    xu::ledger book(num_accounts, 1);
+
+    t.start();
+    for (size_t i = 0; i < entries; i++)
+    {
+      book.post(accounts.data() + offsets[i], amounts.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    double seconds = t.stop();
+
+    report("entry", postings, seconds, book.posted_entries());
+  }
+
+  for (size_t shards : {1, 2, 4, 8})
+  {
+    xu::ledger book(num_accounts, shards);
+
+    const size_t batch = 65536;
+
+    t.start();
+    for (size_t begin = 0; begin < entries; begin += batch)
+    {
+      book.post(offsets.data() + begin, accounts.data(), amounts.data(), std::min(batch, entries - begin));
+    }
+    double seconds = t.stop();
+
+    std::string name = "shards " + std::to_string(shards);
+    report(name.c_str(), postings, seconds, book.posted_entries());
+  }
+}
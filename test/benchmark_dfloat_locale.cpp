@@ -0,0 +1,144 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_locale -I../include benchmark_dfloat_locale.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+#include "dfloat_locale.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+/*
+  Write `cents` as e.g. "(1.234.567,89 €)"
+  */
+std::string make_european(int64_t cents)
+{
+  bool neg = cents < 0;
+  uint64_t mag = neg ? -cents : cents;
+
+  std::string whole = std::to_string(mag / 100);
+  std::string grouped;
+
+  for (size_t i = 0; i < whole.size(); i++)
+  {
+    if (i > 0 and (whole.size() - i) % 3 == 0)
+    {
+      grouped += '.';
+    }
+    grouped += whole[i];
+  }
+
+  std::string frac = std::to_string(mag % 100 + 100).substr(1);
+  std::string body = grouped + ',' + frac + " €";
+
+  return neg ? "(" + body + ")" : body;
+}
+
+/*
+  What we used to do: rewrite the string into something `dfloat::parse`
+  accepts, then parse it
+  */
+dfloat preprocess_and_parse(const std::string& str)
+{
+  static const std::regex strip("\\.|\\s|€");
+  static const std::regex paren("^\\((.*)\\)$");
+
+  std::string s = std::regex_replace(str, strip, "");
+
+  bool neg = false;
+  std::smatch m;
+  if (std::regex_match(s, m, paren))
+  {
+    neg = true;
+    s = m[1];
+  }
+
+  for (char& c : s)
+  {
+    if (c == ',')
+    {
+      c = '.';
+    }
+  }
+
+  return neg ? -dfloat::parse(s) : dfloat::parse(s);
+}
+
+int main(int argc, char* argv[])
+{
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<int64_t> dist(-1000000000000ll, 1000000000000ll);
+
+  std::vector<std::string> strings(count);
+  for (std::string& s : strings)
+  {
+    s = make_european(dist(gen));
+  }
+
+  std::cout << "Generated " << count << " strings, e.g. " << strings[0] << std::endl;
+
+  xu::number_format fmt = xu::number_format::european();
+  fmt.paren_negative = true;
+
+  {
+    dfloat sum = 0;
+
+    Timer t;
+    t.start();
+
+    for (const std::string& s : strings)
+    {
+      sum += preprocess_and_parse(s);
+    }
+
+    std::cout << "regex + parse" << '\t';
+    std::cout << std::setw(8) << std::left << t.stop() << '\t';
+    std::cout << sum << std::endl;
+  }
+
+  {
+    dfloat sum = 0;
+
+    Timer t;
+    t.start();
+
+    for (const std::string& s : strings)
+    {
+      sum += xu::parse_locale(s, fmt);
+    }
+
+    std::cout << "parse_locale" << '\t';
+    std::cout << std::setw(8) << std::left << t.stop() << '\t';
+    std::cout << sum << std::endl;
+  }
+}
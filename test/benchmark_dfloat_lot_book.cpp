@@ -0,0 +1,162 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_lot_book -I../include -pthread benchmark_dfloat_lot_book.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include "dfloat_lot_book.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+using xu::lot_method;
+
+void report(const char* name, size_t count, double seconds, const dfloat& realized)
+{
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " fills/s\t";
+  std::cout << "realized " << realized << std::endl;
+}
+
+/*
+  What we used to do: a deque of lots per account, dfloat `*` and `-` per
+  match, FIFO only
+  */
+dfloat deque_fifo(const std::vector<uint32_t>& accounts, const std::vector<dfloat>& prices,
+  const std::vector<dfloat>& quantities, size_t num_accounts)
+{
+  struct lot
+  {
+    dfloat price;
+    dfloat quantity;
+  };
+
+  std::vector<std::deque<lot>> lots(num_accounts);
+  std::vector<dfloat> position(num_accounts, dfloat(0));
+  std::vector<dfloat> realized(num_accounts, dfloat(0));
+
+  for (size_t i = 0; i < accounts.size(); i++)
+  {
+    uint32_t a = accounts[i];
+    dfloat quantity = quantities[i];
+
+    bool buy = quantity > 0;
+    dfloat remaining = buy ? quantity : -quantity;
+
+    if (position[a] != 0 and (position[a] > 0) != buy)
+    {
+      while (remaining > 0 and not lots[a].empty())
+      {
+        lot& l = lots[a].front();
+        dfloat m = l.quantity < remaining ? l.quantity : remaining;
+
+        dfloat pnl = (prices[i] - l.price) * m;
+        realized[a] += buy ? -pnl : pnl;
+
+        l.quantity -= m;
+        remaining -= m;
+
+        if (l.quantity == 0)
+        {
+          lots[a].pop_front();
+        }
+      }
+    }
+
+    if (remaining > 0)
+    {
+      lots[a].push_back({prices[i], remaining});
+    }
+
+    position[a] += quantity;
+  }
+
+  dfloat total = 0;
+  for (const dfloat& r : realized)
+  {
+    total += r;
+  }
+  return total;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t num_accounts = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+  size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+  size_t threads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4;
+
+  std::vector<uint32_t> accounts(count);
+  std::vector<dfloat> prices(count);
+  std::vector<dfloat> quantities(count);
+
+  /* prices drift around 100.00, fills of -20 to 20 lots of 100 */
+  uint64_t seed = 1;
+  for (size_t i = 0; i < count; i++)
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    uint64_t r = seed >> 16;
+
+    int64_t lots = (int64_t)(r % 41) - 20;
+
+    accounts[i] = (uint32_t)((r >> 8) % num_accounts);
+    prices[i] = dfloat::from_scaled((int64_t)(10000 + (r >> 20) % 500), -2);
+    quantities[i] = dfloat(lots == 0 ? 100 : lots * 100);
+  }
+
+  std::cout << num_accounts << " accounts, " << count << " fills" << std::endl;
+
+  Timer t;
+
+  t.start();
+  dfloat realized = deque_fifo(accounts, prices, quantities, num_accounts);
+  report("deque fifo", count, t.stop(), realized);
+
+  for (lot_method method : {lot_method::FIFO, lot_method::LIFO, lot_method::AVERAGE})
+  {
+    const char* names[] = {"fifo", "lifo", "average"};
+
+    for (size_t n : {(size_t)1, threads})
+    {
+      xu::lot_book book(num_accounts, method);
+
+      t.start();
+      book.add(accounts.data(), prices.data(), quantities.data(), count, n);
+      double seconds = t.stop();
+
+      xu::dfloat_accumulator total;
+      for (uint32_t a = 0; a < num_accounts; a++)
+      {
+        total.add(book.exact_realized(a));
+      }
+
+      std::string name = std::string(names[(int)method]) + " x" + std::to_string(n);
+      report(name.c_str(), count, seconds, total.value());
+    }
+  }
+}
@@ -0,0 +1,145 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_ohlc -I../include -pthread benchmark_dfloat_ohlc.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include "dfloat_ohlc.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+void report(const char* name, size_t count, double seconds, size_t bars)
+{
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " trades/s\t";
+  std::cout << bars << " bars" << std::endl;
+}
+
+/*
+  What we used to do: state in a map, dfloat comparisons per trade
+  */
+size_t map_bars(const std::vector<uint32_t>& ids, const std::vector<int64_t>& times,
+  const std::vector<dfloat>& prices, const std::vector<dfloat>& quantities, int64_t interval)
+{
+  struct state
+  {
+    int64_t start;
+    dfloat open, high, low, close, volume;
+  };
+
+  std::map<uint32_t, state> open;
+  std::vector<state> closed;
+
+  for (size_t i = 0; i < ids.size(); i++)
+  {
+    int64_t start = times[i] / interval * interval;
+
+    auto it = open.find(ids[i]);
+
+    if (it != open.end() and it->second.start != start)
+    {
+      closed.push_back(it->second);
+      open.erase(it);
+      it = open.end();
+    }
+
+    if (it == open.end())
+    {
+      open[ids[i]] = {start, prices[i], prices[i], prices[i], prices[i], quantities[i]};
+    }
+    else
+    {
+      state& s = it->second;
+      if (prices[i] > s.high)
+      {
+        s.high = prices[i];
+      }
+      if (prices[i] < s.low)
+      {
+        s.low = prices[i];
+      }
+      s.close = prices[i];
+      s.volume += quantities[i];
+    }
+  }
+
+  return closed.size() + open.size();
+}
+
+int main(int argc, char* argv[])
+{
+  size_t num_instruments = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000;
+  size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+  size_t threads = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4;
+
+  std::vector<uint32_t> ids(count);
+  std::vector<int64_t> times(count);
+  std::vector<dfloat> prices(count);
+  std::vector<dfloat> quantities(count);
+
+  /* 1000 trades per millisecond */
+  for (size_t i = 0; i < count; i++)
+  {
+    ids[i] = (uint32_t)(i * 7919 % num_instruments);
+    times[i] = (int64_t)(i / 1000);
+    prices[i] = dfloat::from_scaled((int64_t)(100000 + i * 104729 % 20000), -3);
+    quantities[i] = dfloat((int)(i % 9 + 1) * 100);
+  }
+
+  std::cout << num_instruments << " instruments, " << count << " trades, 1s bars" << std::endl;
+
+  Timer t;
+
+  t.start();
+  size_t bars = map_bars(ids, times, prices, quantities, 1000);
+  report("map", count, t.stop(), bars);
+
+  for (size_t n : {(size_t)1, threads})
+  {
+    xu::bar_builder builder(num_instruments, 1000);
+    xu::ohlc_columns out;
+
+    const size_t batch = 65536;
+
+    t.start();
+
+    for (size_t begin = 0; begin < count; begin += batch)
+    {
+      size_t m = std::min(batch, count - begin);
+      builder.add(ids.data() + begin, times.data() + begin, prices.data() + begin, quantities.data() + begin, m, n);
+    }
+    builder.flush_all(out);
+
+    double seconds = t.stop();
+
+    std::string name = "builder x" + std::to_string(n);
+    report(name.c_str(), count, seconds, out.size());
+  }
+}
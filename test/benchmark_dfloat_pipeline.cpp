@@ -0,0 +1,114 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_pipeline -I../include -pthread benchmark_dfloat_pipeline.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include "dfloat_pipeline.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+void generate(const std::string& path, size_t lines)
+{
+  FILE* file = std::fopen(path.c_str(), "w");
+
+  for (size_t i = 0; i < lines; i++)
+  {
+    std::fprintf(file, "%s%zu.%02zu\n", i % 3 ? "" : "-", i * 7919 % 10000000, i % 100);
+  }
+
+  std::fclose(file);
+}
+
+void run(const char* name, const std::string& input, const std::string& output,
+  size_t parse, size_t compute, size_t format, bool writer)
+{
+  xu::pipeline_options options;
+  options.parse_threads = parse;
+  options.compute_threads = compute;
+  options.format_threads = format;
+  options.separate_writer = writer;
+  options.width = 20;
+  options.decimals = 4;
+
+  const dfloat rate = dfloat::parse("1.0825");
+  const dfloat fee = dfloat::parse("0.35");
+
+  auto convert = [&](dfloat* values, size_t n)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      values[i] = dfloat::fma(values[i], rate, fee);
+    }
+  };
+
+  Timer t;
+  t.start();
+
+  xu::pipeline_stats stats = xu::run_pipeline(input, output, options, convert);
+
+  double seconds = t.stop();
+
+  if (not stats.ok)
+  {
+    std::cerr << "Pipeline failed" << std::endl;
+    abort();
+  }
+
+  std::cout << name << '\t';
+  std::cout << stats.stages << " stages, " << stats.threads << " threads\t";
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(stats.bytes_read / seconds / 1e6) << " MB/s\t";
+  std::cout << (size_t)(stats.lines / seconds) << " lines/s" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t lines = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  std::string input = argc > 2 ? argv[2] : "/tmp/benchmark_dfloat_pipeline.in";
+  std::string output = input + ".out";
+
+  generate(input, lines);
+
+  std::cout << lines << " lines, " << std::thread::hardware_concurrency() << " cores" << std::endl;
+
+  run("serial", input, output, 0, 0, 0, false);
+
+  run("io split", input, output, 0, 0, 0, true);
+
+  run("stages", input, output, 1, 1, 1, true);
+
+  run("groups", input, output, 2, 1, 2, true);
+
+  run("groups", input, output, 4, 2, 4, true);
+
+  std::remove(input.c_str());
+  std::remove(output.c_str());
+}
@@ -0,0 +1,162 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_recon -I../include -pthread benchmark_dfloat_recon.cpp
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include "dfloat_recon.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+using xu::recon_side;
+
+void report(const char* name, size_t count, double seconds, size_t differences, uint64_t spilled)
+{
+  std::cout << name << '\t';
+  std::cout << std::setw(8) << std::left << seconds << '\t';
+  std::cout << (size_t)(count / seconds) << " rows/s\t";
+  std::cout << differences << " differences\t";
+  std::cout << (spilled >> 20) << " MiB spilled" << std::endl;
+}
+
+/*
+  What we used to do: both sides as text, joined on the key text, amounts
+  parsed back and compared with dfloat `-`
+  */
+size_t text_join(const std::vector<uint64_t>& left_keys, const std::vector<dfloat>& left_values,
+  const std::vector<uint64_t>& right_keys, const std::vector<dfloat>& right_values)
+{
+  std::unordered_map<std::string, std::string> left;
+  left.reserve(left_keys.size());
+
+  for (size_t i = 0; i < left_keys.size(); i++)
+  {
+    left.emplace(std::to_string(left_keys[i]), dfloat::to_string(left_values[i]));
+  }
+
+  size_t differences = 0;
+
+  for (size_t j = 0; j < right_keys.size(); j++)
+  {
+    auto it = left.find(std::to_string(right_keys[j]));
+
+    if (it == left.end())
+    {
+      ++differences;
+      continue;
+    }
+
+    dfloat diff = dfloat::parse(it->second) - dfloat::parse(dfloat::to_string(right_values[j]));
+    differences += diff != 0;
+
+    left.erase(it);
+  }
+
+  return differences + left.size();
+}
+
+int main(int argc, char* argv[])
+{
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+  size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+  std::string spill_dir = argc > 3 ? argv[3] : "/tmp";
+
+  std::vector<uint64_t> left_keys, right_keys;
+  std::vector<dfloat> left_values, right_values;
+
+  left_keys.reserve(count);
+  right_keys.reserve(count);
+
+  /* 1% missing on each side, 1% differing */
+  for (size_t i = 0; i < count; i++)
+  {
+    uint64_t key = i * 2654435761u + 12345;
+    dfloat value = dfloat::from_scaled((int64_t)(i * 104729 % 100000000), -2);
+
+    if (i % 100 != 1)
+    {
+      left_keys.push_back(key);
+      left_values.push_back(value);
+    }
+    if (i % 100 != 2)
+    {
+      right_keys.push_back((i * 7 + 3) % count * 2654435761u + 12345);
+      right_values.push_back(dfloat::from_scaled((int64_t)((i * 7 + 3) % count * 104729 % 100000000 + (i % 100 == 3)), -2));
+    }
+  }
+
+  size_t rows = left_keys.size() + right_keys.size();
+
+  std::cout << rows << " rows" << std::endl;
+
+  Timer t;
+
+  t.start();
+  size_t differences = text_join(left_keys, left_values, right_keys, right_values);
+  report("text", rows, t.stop(), differences, 0);
+
+  for (size_t budget : {(size_t)1 << 32, (size_t)64 << 20})
+  {
+    for (size_t n : {(size_t)1, threads})
+    {
+      xu::recon_options options;
+      options.tolerance = dfloat::parse("0.01");
+      options.partitions = 256;
+      options.threads = n;
+      options.memory_budget = budget;
+      options.spill_dir = spill_dir;
+
+      xu::reconciler recon(options);
+      xu::recon_result out;
+
+      t.start();
+
+      const size_t batch = 65536;
+
+      for (size_t begin = 0; begin < left_keys.size(); begin += batch)
+      {
+        const dfloat* columns[] = {left_values.data() + begin};
+        recon.add(recon_side::LEFT, left_keys.data() + begin, columns, std::min(batch, left_keys.size() - begin));
+      }
+      for (size_t begin = 0; begin < right_keys.size(); begin += batch)
+      {
+        const dfloat* columns[] = {right_values.data() + begin};
+        recon.add(recon_side::RIGHT, right_keys.data() + begin, columns, std::min(batch, right_keys.size() - begin));
+      }
+
+      recon.run(out);
+
+      double seconds = t.stop();
+
+      std::string name = std::string(budget > ((size_t)1 << 31) ? "memory" : "spill") + " x" + std::to_string(n);
+      report(name.c_str(), rows, seconds, out.size(), recon.spilled_bytes());
+    }
+  }
+}
@@ -0,0 +1,143 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_seqlock -I../include -pthread benchmark_dfloat_seqlock.cpp
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "dfloat_seqlock.hpp"
+#include "Timer.hpp"
+
+typedef xu::dfloat dfloat;
+
+/*
+  What we used to do: guard the fields with a mutex
+  */
+struct mutex_snapshot
+{
+  void store(const std::array<dfloat, 4>& values)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    fields = values;
+  }
+
+  std::array<dfloat, 4> load()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fields;
+  }
+
+  std::mutex mutex;
+  std::array<dfloat, 4> fields;
+};
+
+std::array<dfloat, 4> make_top(int64_t i)
+{
+  dfloat bid = dfloat::from_scaled(1000000 + i % 1000, -4);
+  return {bid, bid + dfloat::from_scaled(1, -4), dfloat(100 + i % 7), dfloat(200 + i % 11)};
+}
+
+template <typename Snapshot>
+void run(const char* name, Snapshot& snapshot, size_t readers, double seconds)
+{
+  std::atomic<bool> done(false);
+  std::vector<size_t> reads(readers, 0);
+  size_t writes = 0;
+
+  std::vector<std::thread> threads;
+  for (size_t r = 0; r < readers; r++)
+  {
+    threads.emplace_back([&, r]()
+    {
+      size_t n = 0;
+      dfloat spread = 0;
+
+      while (not done.load(std::memory_order_relaxed))
+      {
+        std::array<dfloat, 4> top = snapshot.load();
+        spread += top[1] - top[0];
+        n++;
+      }
+
+      reads[r] = n;
+    });
+  }
+
+  Timer t;
+  t.start();
+
+  while (t.stop() < seconds)
+  {
+    for (int i = 0; i < 1000; i++, writes++)
+    {
+      snapshot.store(make_top(writes));
+    }
+  }
+
+  done = true;
+  for (std::thread& th : threads)
+  {
+    th.join();
+  }
+
+  double elapsed = t.stop();
+
+  size_t total = 0;
+  for (size_t n : reads)
+  {
+    total += n;
+  }
+
+  std::cout << name << '\t';
+  std::cout << std::setw(12) << std::left << (size_t)(writes / elapsed) << " writes/s" << '\t';
+  std::cout << std::setw(12) << std::left << (size_t)(total / elapsed) << " reads/s" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t readers = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::thread::hardware_concurrency() - 1;
+  double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+
+  readers = readers > 0 ? readers : 1;
+
+  std::cout << "1 writer, " << readers << " readers, " << seconds << " s each" << std::endl;
+
+  {
+    mutex_snapshot snapshot;
+    snapshot.store(make_top(0));
+    run("mutex", snapshot, readers, seconds);
+  }
+
+  {
+    xu::seqlock_snapshot<4> snapshot;
+    snapshot.store(make_top(0));
+    run("seqlock", snapshot, readers, seconds);
+  }
+}
@@ -0,0 +1,210 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -O2 -o bin/benchmark_dfloat_shm_ring -I../include benchmark_dfloat_shm_ring.cpp -lrt
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "dfloat_shm_ring.hpp"
+
+typedef xu::dfloat dfloat;
+
+const std::string NAME = "/benchmark_dfloat_shm_ring";
+
+/* steady_clock is CLOCK_MONOTONIC, which is shared between processes */
+uint64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void report(const char* name, size_t received, size_t missed, double seconds, std::vector<uint64_t>& latencies)
+{
+  std::sort(latencies.begin(), latencies.end());
+
+  auto percentile = [&](double p)
+  {
+    return latencies.empty() ? 0 : latencies[(size_t)(p * (latencies.size() - 1))];
+  };
+
+  std::cout << name << '\t';
+  std::cout << std::setw(12) << std::left << (size_t)(received / seconds) << " msgs/s" << '\t';
+  std::cout << "p50 " << std::setw(8) << percentile(0.5) << " ns" << '\t';
+  std::cout << "p99 " << std::setw(8) << percentile(0.99) << " ns" << '\t';
+  std::cout << "missed " << missed << std::endl;
+}
+
+/*
+  What we used to do: print the prices as text into a pipe and parse them
+  again on the other side
+  */
+void pipe_text(size_t count)
+{
+  int fds[2];
+  if (::pipe(fds) != 0)
+  {
+    std::perror("pipe");
+    std::exit(1);
+  }
+
+  pid_t pid = ::fork();
+
+  if (pid == 0)
+  {
+    ::close(fds[1]);
+    FILE* in = ::fdopen(fds[0], "r");
+
+    std::vector<uint64_t> latencies;
+    latencies.reserve(count);
+
+    char line[128];
+    char bid[64];
+    char ask[64];
+    unsigned long long key;
+    size_t received = 0;
+    dfloat sum = 0;
+
+    uint64_t start = 0;
+
+    while (std::fgets(line, sizeof(line), in) != nullptr)
+    {
+      if (std::sscanf(line, "%llu %63s %63s", &key, bid, ask) != 3)
+      {
+        continue;
+      }
+
+      sum += dfloat::parse(ask) - dfloat::parse(bid);
+
+      uint64_t t = now_ns();
+      start = received == 0 ? t : start;
+      latencies.push_back(t - key);
+      received++;
+    }
+
+    report("pipe + parse", received, count - received, (now_ns() - start) * 1e-9, latencies);
+    ::_exit(0);
+  }
+
+  ::close(fds[0]);
+  FILE* out = ::fdopen(fds[1], "w");
+
+  for (size_t i = 0; i < count; i++)
+  {
+    dfloat bid = dfloat::from_scaled((int64_t)(1000000 + i % 1000), -4);
+    dfloat ask = bid + dfloat::from_scaled(1, -4);
+
+    std::fprintf(out, "%llu %s %s\n", (unsigned long long)now_ns(),
+      dfloat::to_string(bid).c_str(), dfloat::to_string(ask).c_str());
+  }
+
+  std::fclose(out);
+  ::waitpid(pid, nullptr, 0);
+}
+
+void shm_ring(size_t count)
+{
+  xu::shm_ring writer(NAME, 1 << 16, 2);
+
+  if (not writer.is_open())
+  {
+    std::perror("shm_open");
+    std::exit(1);
+  }
+
+  pid_t pid = ::fork();
+
+  if (pid == 0)
+  {
+    xu::shm_ring ring(NAME);
+    xu::shm_ring_reader reader(ring, 0);
+
+    std::vector<uint64_t> latencies;
+    latencies.reserve(count);
+
+    uint64_t key;
+    dfloat values[2];
+    dfloat sum = 0;
+    uint64_t start = 0;
+    size_t received = 0;
+
+    /* the writer publishes one extra record with key 0 to say it is done */
+    while (true)
+    {
+      if (reader.poll(key, values) != xu::ring_read::OK)
+      {
+        /* let the writer run if both share a core */
+        ::sched_yield();
+        continue;
+      }
+
+      if (key == 0)
+      {
+        break;
+      }
+
+      sum += values[1] - values[0];
+
+      uint64_t t = now_ns();
+      start = received == 0 ? t : start;
+      latencies.push_back(t - key);
+      received++;
+    }
+
+    report("shm ring", received, reader.missed(), (now_ns() - start) * 1e-9, latencies);
+    ::_exit(0);
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    dfloat values[2];
+    values[0] = dfloat::from_scaled((int64_t)(1000000 + i % 1000), -4);
+    values[1] = values[0] + dfloat::from_scaled(1, -4);
+
+    writer.publish(now_ns(), values);
+  }
+
+  dfloat done[2] = {0, 0};
+  writer.publish(0, done);
+
+  ::waitpid(pid, nullptr, 0);
+  xu::shm_ring::unlink(NAME);
+}
+
+int main(int argc, char* argv[])
+{
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+  std::cout << "Sending " << count << " quotes between two processes" << std::endl;
+
+  pipe_text(count);
+
+  shm_ring(count);
+}
@@ -0,0 +1,64 @@
+
+import argparse
+import random
+from decimal import Decimal, ROUND_DOWN, getcontext
+
+getcontext().prec = 100
+
+NANOS = 10**9
+INT64_MAX = 2**63 - 1
+
+def truncate_18(value):
+  '''Truncate to 18 significant digits, written as "<coef>e<exp>"'''
+  if value == 0:
+    return '0'
+  sign, digits, exp = value.normalize().as_tuple()
+  coef = int(''.join(map(str, digits)))
+  while coef >= 10**18:
+    coef //= 10
+    exp += 1
+  return ('-' if sign else '') + '%de%d' % (coef, exp)
+
+def random_units_nanos(rng):
+  units = rng.choice([0, rng.randint(1, 999), rng.randint(1, 10**12), rng.randint(1, INT64_MAX)])
+  nanos = rng.choice([0, rng.randint(1, NANOS - 1), rng.randint(1, 999) * 10**6])
+  if rng.random() < 0.5:
+    units, nanos = -units, -nanos
+  return units, nanos
+
+def random_decimal(rng):
+  '''Up to 18 significant digits, scaled anywhere from 10^-20 to 10^18'''
+  digits = rng.randint(1, 18)
+  coef = rng.randint(10**(digits - 1), 10**digits - 1)
+  exp = rng.randint(-20 - digits, 18 - digits)
+  if rng.random() < 0.5:
+    coef = -coef
+  return Decimal(coef).scaleb(exp)
+
+def main(args):
+  rng = random.Random(args.seed)
+  with open(args.outfile, 'w') as f:
+    # units nanos -> value
+    for _ in range(args.n):
+      units, nanos = random_units_nanos(rng)
+      value = Decimal(units) + Decimal(nanos) / NANOS
+      f.write('M %d %d %s\n' % (units, nanos, truncate_18(value)))
+    for units, nanos in [(1, -1), (-1, 1), (0, NANOS), (0, -NANOS)]:
+      f.write('M %d %d nan\n' % (units, nanos))
+    # value -> units nanos, truncated towards zero
+    for _ in range(args.n):
+      value = random_decimal(rng)
+      scaled = (value * NANOS).to_integral_value(rounding=ROUND_DOWN)
+      units = int(scaled / NANOS)
+      nanos = int(scaled - units * NANOS)
+      f.write('D %s %d %d\n' % (truncate_18(value), units, nanos))
+  return
+
+if __name__ == '__main__':
+  parser = argparse.ArgumentParser()
+  parser.add_argument('n', type=int, help='How many fixtures of each direction to generate')
+  parser.add_argument('outfile', type=str, help='Where to save the fixtures (text, one per line)')
+  parser.add_argument('--seed', type=int, default=1, help='Random seed')
+  args = parser.parse_args()
+
+  main(args)
@@ -278,6 +278,76 @@ void conversions()
     assert(f == dfloat::parse("18446744073709551600"));  // f gets truncated
     assert(i == 18446744073709551600ull);  // so, remainder should be equal
   }
+
+  assert(dfloat::from_scaled(12345, -2) == dfloat::parse("123.45"));
+  assert(dfloat::from_scaled(-12345, 3) == dfloat::parse("-12345000"));
+  assert(dfloat::from_scaled(0, 5) == dfloat(0));
+  assert(dfloat::from_scaled(-1-9223372036854775807ll, 0) == dfloat::parse("-9223372036854775800"));
+  assert(dfloat::from_scaled(dfloat::Sign::POS, 5, -3) == dfloat::parse("0.005"));
+  assert(dfloat::from_scaled(dfloat::Sign::ZERO, 5, 0) == dfloat(0));
+  assert_false(dfloat::isfinite(dfloat::from_scaled(dfloat::Sign::_NAN_, 5, 0)));
+  assert_false(dfloat::isfinite(dfloat::from_scaled(1, 101)));
+  assert(dfloat::from_scaled(1, -120) == dfloat(0));
+  assert(dfloat::to_string(dfloat::from_scaled(1, -101)) == "0.1e-100");
+
+  {
+    int64_t coef;
+
+    assert(dfloat::parse("123.456").to_scaled(coef, -2) && coef == 12345);
+    assert(dfloat::parse("-123.456").to_scaled(coef, -2) && coef == -12345);
+    assert(dfloat::parse("123.456").to_scaled(coef, 1) && coef == 12);
+    assert(dfloat::parse("0.001").to_scaled(coef, -2) && coef == 0);
+    assert(dfloat(0).to_scaled(coef, -2) && coef == 0);
+    assert(dfloat::parse("1e-100").to_scaled(coef, 0) && coef == 0);
+    assert(dfloat::parse("-9223372036854775800").to_scaled(coef, 0) && coef == -9223372036854775800ll);
+    assert(dfloat::parse("922337203685477580").to_scaled(coef, -1) && coef == 9223372036854775800ll);
+    assert_false(dfloat::parse("922337203685477580").to_scaled(coef, -2));
+    assert_false(dfloat::parse("1e50").to_scaled(coef, 0));
+    assert_false(dfloat::parse("nan").to_scaled(coef, 0));
+  }
+
+  {
+    int64_t coef;
+    dfloat::pow2_t exp;
+
+    assert(dfloat::parse("123.45").to_decimal(coef, exp) && coef == 12345 && exp == -2);
+    assert(dfloat::parse("-1200").to_decimal(coef, exp) && coef == -12 && exp == 2);
+    assert(dfloat::parse("123456789012345678").to_decimal(coef, exp) && coef == 123456789012345678ll && exp == 0);
+    assert(dfloat(0).to_decimal(coef, exp) && coef == 0 && exp == 0);
+    assert(dfloat::parse("1e-100").to_decimal(coef, exp) && coef == 1 && exp == -100);
+    assert(dfloat::parse("1e100").to_decimal(coef, exp) && coef == 1 && exp == 100);
+    assert_false(dfloat::parse("nan").to_decimal(coef, exp));
+  }
+
+  // to_key, from_key
+  {
+    const dfloat values[] = {
+      dfloat::parse("-1e100"), dfloat::parse("-123.45"), dfloat::parse("-123.44"), dfloat::parse("-1"),
+      dfloat::parse("-0.999999999999999999"), dfloat::from_scaled(-1, -101), dfloat(0),
+      dfloat::from_scaled(1, -101), dfloat::parse("1e-100"), dfloat::parse("0.5"), dfloat::parse("1"),
+      dfloat::parse("1.000000000000000001"), dfloat::parse("99"), dfloat::parse("100"), dfloat::parse("1e100"),
+    };
+
+    const size_t n = sizeof(values) / sizeof(values[0]);
+
+    for (size_t i = 0; i < n; i++)
+    {
+      assert(values[i].to_key() != 0);
+      assert(dfloat::from_key(values[i].to_key()) == values[i]);
+
+      for (size_t j = 0; j < n; j++)
+      {
+        assert((values[i] < values[j]) == (values[i].to_key() < values[j].to_key()));
+        assert((values[i] == values[j]) == (values[i].to_key() == values[j].to_key()));
+      }
+
+      assert(values[i].to_key() < dfloat::parse("nan").to_key());
+    }
+
+    assert(dfloat::parse("1.50").to_key() == dfloat::parse("1.5").to_key());
+    assert(dfloat::parse("-0").to_key() == dfloat(0).to_key());
+    assert_false(dfloat::isfinite(dfloat::from_key(dfloat::parse("nan").to_key())));
+  }
 }
 
 void to_from_strings()
@@ -390,6 +460,16 @@ void to_from_strings()
     assert(dfloat::to_string(f) == "1");
   }
 
+  {
+    dfloat f = dfloat::parse("0.00");
+    assert(dfloat::to_string(f) == "0");
+  }
+
+  {
+    dfloat f = dfloat::parse("-0.0e5");
+    assert(dfloat::to_string(f) == "0");
+  }
+
   {
     dfloat f = dfloat::parse("-001");
     assert(dfloat::to_string(f) == "-1");
@@ -957,6 +1037,55 @@ void arithmetic()
   }
 }
 
+void fused()
+{
+  assert(dfloat::fma(dfloat(2), dfloat(3), dfloat(4)) == dfloat(10));
+  assert(dfloat::fma(dfloat(2), dfloat(3), dfloat(-6)) == dfloat(0));
+  assert(dfloat::fma(dfloat(-2), dfloat(3), dfloat(4)) == dfloat(-2));
+  assert(dfloat::fma(dfloat(0), dfloat(3), dfloat(4)) == dfloat(4));
+  assert(dfloat::fma(dfloat(2), dfloat(3), dfloat(0)) == dfloat(6));
+  assert(dfloat::fma(dfloat(0), dfloat(0), dfloat(0)) == dfloat(0));
+
+  // the product is not truncated before the addition
+  {
+    dfloat a = dfloat::parse("1.00000000000000001");
+    dfloat b = dfloat::parse("1.00000000000000001");
+    dfloat c = dfloat(-1);
+    assert(a * b + c == dfloat::parse("2e-17"));
+    assert(dfloat::to_string(dfloat::fma(a, b, c)) == "2.00000000000000001e-17");
+  }
+
+  // cancellation with an addend of different magnitude
+  {
+    dfloat a = dfloat::parse("0.333333333333333333");
+    dfloat b = dfloat(3);
+    dfloat c = dfloat::parse("-0.999999999999999998");
+    assert(dfloat::to_string(dfloat::fma(a, b, c)) == "1.0e-18");
+  }
+
+  // truncation is towards zero, including when the addend is far smaller
+  {
+    dfloat a = dfloat(1);
+    dfloat b = dfloat(1);
+    dfloat c = dfloat::parse("-1e-30");
+    assert(dfloat::to_string(dfloat::fma(a, b, c)) == "0.999999999999999999");
+    assert(dfloat::fma(a, b, -c) == dfloat(1));
+  }
+
+  // same results as separate operations when nothing is lost
+  {
+    dfloat a = dfloat::parse("12.5");
+    dfloat b = dfloat::parse("-0.04");
+    dfloat c = dfloat::parse("100.25");
+    assert(dfloat::fma(a, b, c) == a * b + c);
+  }
+
+  assert_false(dfloat::isfinite(dfloat::fma(dfloat::parse("nan"), dfloat(1), dfloat(1))));
+  assert_false(dfloat::isfinite(dfloat::fma(dfloat(1), dfloat(1), dfloat::parse("nan"))));
+  assert_false(dfloat::isfinite(dfloat::fma(dfloat::parse("1e100"), dfloat(10), dfloat(1))));
+  assert(dfloat::fma(dfloat::parse("1e-60"), dfloat::parse("1e-60"), dfloat(0)) == dfloat(0));
+}
+
 void not_a_number()
 {
   {
@@ -1267,6 +1396,8 @@ int main()
 
   arithmetic();
 
+  fused();
+
   not_a_number();
 
   near_limits();
@@ -0,0 +1,205 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_accrual -I../include -Wfatal-errors -Wall -pthread test_dfloat_accrual.cpp
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "dfloat_accrual.hpp"
+
+typedef xu::dfloat dfloat;
+
+using xu::day_count;
+using xu::days_from_civil;
+
+#define assert_false(expr) assert((expr)==false)
+
+void dates()
+{
+  assert(days_from_civil(1970, 1, 1) == 0);
+  assert(days_from_civil(1969, 12, 31) == -1);
+  assert(days_from_civil(2000, 3, 1) == 11017);
+  assert(days_from_civil(2024, 3, 1) - days_from_civil(2024, 2, 28) == 2);
+  assert(days_from_civil(2100, 3, 1) - days_from_civil(2100, 2, 28) == 1);
+
+  for (int32_t days = -800000; days < 800000; days += 7)
+  {
+    int32_t year;
+    uint32_t month, day;
+
+    xu::civil_from_days(days, year, month, day);
+    assert(month >= 1 and month <= 12);
+    assert(day >= 1 and day <= 31);
+    assert(days_from_civil(year, month, day) == days);
+    assert(xu::_year_of(days) == year);
+  }
+}
+
+void fractions()
+{
+  int64_t num, den;
+
+  int32_t jan1 = days_from_civil(2024, 1, 1);
+  int32_t apr1 = days_from_civil(2024, 4, 1);
+
+  assert(xu::year_fraction(jan1, apr1, day_count::ACT_360, num, den));
+  assert(num == 91 and den == 360);
+
+  assert(xu::year_fraction(jan1, apr1, day_count::ACT_365, num, den));
+  assert(num == 91 and den == 365);
+
+  assert(xu::year_fraction(jan1, apr1, day_count::THIRTY_360, num, den));
+  assert(num == 90 and den == 360);
+
+  /* the 31st counts as the 30th, at the end only if the start is the 30th or 31st */
+  assert(xu::year_fraction(days_from_civil(2024, 1, 31), days_from_civil(2024, 3, 31), day_count::THIRTY_360, num, den));
+  assert(num == 60);
+  assert(xu::year_fraction(days_from_civil(2024, 2, 28), days_from_civil(2024, 3, 31), day_count::THIRTY_360, num, den));
+  assert(num == 33);
+
+  /* 61 days of 2023 over 365, 60 days of 2024 over 366 */
+  assert(xu::year_fraction(days_from_civil(2023, 11, 1), days_from_civil(2024, 3, 1), day_count::ACT_ACT, num, den));
+  assert(den == 365 * 366);
+  assert(num == 61 * 366 + 60 * 365);
+
+  assert(xu::year_fraction(days_from_civil(2020, 1, 1), days_from_civil(2023, 1, 1), day_count::ACT_ACT, num, den));
+  assert(num == 3 * den);
+
+  assert(xu::year_fraction(jan1, jan1, day_count::ACT_ACT, num, den));
+  assert(num == 0);
+
+  assert_false(xu::year_fraction(apr1, jan1, day_count::ACT_360, num, den));
+}
+
+void interest()
+{
+  using xu::accrued_interest;
+
+  int32_t start = days_from_civil(2024, 1, 1);
+  int32_t end = start + 90;
+
+  assert(accrued_interest(1000000, dfloat::parse("0.05"), start, end, day_count::ACT_360) == dfloat(12500));
+  assert(accrued_interest(-1000000, dfloat::parse("0.05"), start, end, day_count::ACT_360) == dfloat(-12500));
+  assert(accrued_interest(1000000, dfloat::parse("-0.005"), start, end, day_count::ACT_360) == dfloat(-1250));
+
+  /* 4500000 / 365, truncated once at 18 digits */
+  assert(accrued_interest(1000000, dfloat::parse("0.05"), start, end, day_count::ACT_365)
+    == dfloat::parse("12328.7671232876712"));
+  assert(accrued_interest(-1000000, dfloat::parse("0.05"), start, end, day_count::ACT_365)
+    == dfloat::parse("-12328.7671232876712"));
+
+  /* product of two 18-digit coefficients */
+  assert(accrued_interest(dfloat::parse("123456789012345678"), dfloat::parse("0.123456789012345678"),
+    start, start + 100, day_count::ACT_365) == dfloat::parse("4175775000887352.47"));
+
+  /* one day of a common year under ACT/ACT */
+  assert(accrued_interest(1, dfloat::parse("0.01"), days_from_civil(2023, 6, 1), days_from_civil(2023, 6, 2),
+    day_count::ACT_ACT) == dfloat::parse("0.0000273972602739726027"));
+  assert(accrued_interest(1, dfloat::parse("0.01"), days_from_civil(2024, 6, 1), days_from_civil(2024, 6, 2),
+    day_count::ACT_ACT) == dfloat::parse("0.0000273224043715846994"));
+
+  assert(accrued_interest(0, dfloat::parse("0.05"), start, end, day_count::ACT_360) == dfloat(0));
+  assert(accrued_interest(1000000, dfloat::parse("0.05"), start, start, day_count::ACT_360) == dfloat(0));
+  assert_false(dfloat::isfinite(accrued_interest(1000000, dfloat::parse("0.05"), end, start, day_count::ACT_360)));
+  assert_false(dfloat::isfinite(accrued_interest(dfloat::parse("nan"), dfloat::parse("0.05"), start, end,
+    day_count::ACT_360)));
+}
+
+void batches()
+{
+  const size_t count = 10007;
+
+  std::vector<int32_t> starts(count);
+  std::vector<int32_t> ends(count);
+  std::vector<dfloat> notionals(count);
+  std::vector<dfloat> rates(count);
+
+  int32_t base = days_from_civil(2020, 1, 1);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    starts[i] = base + (int32_t)(i % 1000);
+    ends[i] = starts[i] + (int32_t)(i % 800);
+    notionals[i] = dfloat::from_scaled((int64_t)(i * 7919 % 100000000) * (i % 3 ? 1 : -1), -2);
+    rates[i] = dfloat::from_scaled((int64_t)(i % 1000), -5);
+  }
+
+  ends[17] = starts[17] - 1;
+
+  for (day_count convention : {day_count::ACT_360, day_count::ACT_365, day_count::THIRTY_360, day_count::ACT_ACT})
+  {
+    std::vector<dfloat> serial(count);
+    xu::accrue(starts.data(), ends.data(), notionals.data(), rates.data(), count, convention, serial.data(), 1);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      dfloat expected = xu::accrued_interest(notionals[i], rates[i], starts[i], ends[i], convention);
+      assert(serial[i].to_key() == expected.to_key());
+    }
+
+    assert_false(dfloat::isfinite(serial[17]));
+
+    std::vector<dfloat> parallel(count);
+    xu::accrue(starts.data(), ends.data(), notionals.data(), rates.data(), count, convention, parallel.data(), 4);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      assert(parallel[i].to_key() == serial[i].to_key());
+    }
+  }
+
+  /* ACT/360 against dfloat `*` and `/`: the same digits, one more of them */
+  for (size_t i = 0; i < count; i += 97)
+  {
+    int64_t days = ends[i] - starts[i];
+
+    if (days < 0)
+    {
+      continue;
+    }
+
+    dfloat expected = notionals[i] * rates[i] * dfloat(days) / dfloat(360);
+    dfloat got = xu::accrued_interest(notionals[i], rates[i], starts[i], ends[i], day_count::ACT_360);
+
+    dfloat diff = got - expected;
+    dfloat magnitude = got < 0 ? -got : got;
+
+    assert(diff * got >= 0);
+    assert((diff < 0 ? -diff : diff) * dfloat::parse("1e16") <= magnitude);
+  }
+}
+
+int main()
+{
+  dates();
+
+  fractions();
+
+  interest();
+
+  batches();
+
+  std::cout << "Completed without errors" << std::endl;
+}
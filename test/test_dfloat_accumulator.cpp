@@ -0,0 +1,191 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_accumulator -I../include -Wfatal-errors -Wall test_dfloat_accumulator.cpp
+
+#include <cassert>
+#include <iostream>
+#include "dfloat_accumulator.hpp"
+
+typedef xu::dfloat dfloat;
+typedef xu::dfloat_accumulator dfloat_accumulator;
+
+#define assert_false(expr) assert((expr)==false)
+
+dfloat P(const char* str)
+{
+  return dfloat::parse(str);
+}
+
+void sums()
+{
+  dfloat_accumulator acc;
+  assert(acc.is_zero());
+  assert(acc.sign() == 0);
+  assert(acc.value() == dfloat(0));
+
+  /* 0.1 added ten million times is exactly one million */
+  for (int i = 0; i < 10000000; i++)
+  {
+    acc.add(P("0.1"));
+  }
+  assert(acc.value() == dfloat(1000000));
+  assert(acc.coef() == 10000000);
+  assert(acc.exp() == -1);
+
+  /* a small value next to a large one is kept, not truncated */
+  dfloat_accumulator wide;
+  wide.add(P("1e30"));
+  wide.add(P("1e-5"));
+  wide.subtract(P("1e30"));
+  assert(wide.value() == P("1e-5"));
+
+  dfloat naive = P("1e30") + P("1e-5") - P("1e30");
+  assert(naive == dfloat(0));
+
+  wide.reset();
+  wide.add(P("-2.5"));
+  wide.add(P("2.5"));
+  assert(wide.is_zero());
+
+  /* trailing zeros are dropped to line up far-apart operands */
+  dfloat_accumulator far;
+  far.add(P("1e90"));
+  far.add(P("1e60"));
+  assert_false(far.isnan());
+  assert(far.value() == P("1e90"));
+
+  /* but an exact sum needing more than 38 digits is NaN */
+  far.add(P("1e-60"));
+  assert(far.isnan());
+  assert_false(dfloat::isfinite(far.value()));
+
+  dfloat_accumulator nan;
+  nan.add(dfloat::parse("x"));
+  assert(nan.isnan());
+  nan.add(dfloat(1));
+  assert(nan.isnan());
+
+  dfloat_accumulator merged;
+  merged.add(acc);
+  merged.subtract(acc);
+  assert(merged.is_zero());
+  merged.add(nan);
+  assert(merged.isnan());
+}
+
+void products()
+{
+  dfloat_accumulator acc;
+
+  /* 18 digits times 18 digits, all 36 kept */
+  dfloat a = P("123456789012345678");
+  dfloat b = P("0.987654321098765432");
+  acc.add_product(a, b);
+
+  dfloat_accumulator back = acc;
+  back.subtract_product(a, b);
+  assert(back.is_zero());
+
+  assert(acc.value() == a * b);
+  assert(acc.coef() == (dfloat_accumulator::wide_t)123456789012345678 * 987654321098765432);
+  assert(acc.exp() == -18);
+
+  acc.reset();
+  acc.add_product(P("-1.5"), P("2"));
+  assert(acc.value() == dfloat(-3));
+  assert(acc.sign() == -1);
+}
+
+void division()
+{
+  dfloat_accumulator one(dfloat(1));
+  dfloat_accumulator three(dfloat(3));
+  dfloat_accumulator zero;
+
+  /* all 18 digits, `operator/` keeps 17 */
+  assert(one.divide(three) == P("0.333333333333333333"));
+  assert(three.divide(one) == dfloat(3));
+  assert(zero.divide(three) == dfloat(0));
+  assert_false(dfloat::isfinite(one.divide(zero)));
+
+  dfloat_accumulator minus_two(dfloat(-2));
+  assert(minus_two.divide(three) == P("-0.666666666666666666"));
+
+  /* 36-digit operands: the quotient is truncated once, not after each
+     operand is rounded to 18 digits */
+  dfloat_accumulator n;
+  n.add_scaled(1, 35);
+  dfloat_accumulator d;
+  d.add_scaled((dfloat_accumulator::wide_t)100000000000000000 * 1000000000000000000 + 999999999999999999, 0);
+
+  /* 1e35 / (1e35 + 999999999999999999) = 0.99999999999999999000... */
+  assert(n.divide(d) == P("0.99999999999999999"));
+  assert(n.divide(d) != dfloat(1));
+  assert(n.value() / d.value() == dfloat(1));
+
+  /* huge divisor, where 10 * remainder would not fit in 128 bits */
+  dfloat_accumulator big;
+  big.add_scaled((dfloat_accumulator::wide_t)((((unsigned __int128)1 << 127) - 1) / 3), 0);
+  dfloat_accumulator bigger;
+  bigger.add_scaled((dfloat_accumulator::wide_t)((((unsigned __int128)1 << 127) - 1) / 2), 0);
+  assert(big.divide(bigger) == P("0.666666666666666666"));
+}
+
+void comparison()
+{
+  dfloat_accumulator a(P("1.5"));
+  dfloat_accumulator b(P("1.50"));
+  dfloat_accumulator c(P("-2"));
+
+  assert(a == b);
+  assert(a.compare(c) == 1);
+  assert(c.compare(a) == -1);
+
+  dfloat_accumulator huge(P("1e90"));
+  dfloat_accumulator tiny;
+  tiny.add_scaled(123456789, -90);
+  assert(huge.compare(tiny) == 1);
+  assert(tiny.compare(huge) == -1);
+
+  dfloat_accumulator neg_huge(P("-1e90"));
+  assert(neg_huge.compare(tiny) == -1);
+
+  dfloat_accumulator nan(dfloat::parse("x"));
+  assert(nan != nan);
+  assert(nan.compare(a) == 0);
+}
+
+int main()
+{
+  sums();
+
+  products();
+
+  division();
+
+  comparison();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,216 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_amortization -I../include -Wfatal-errors -Wall -pthread test_dfloat_amortization.cpp
+
+#include <cassert>
+#include <iostream>
+#include "dfloat_accumulator.hpp"
+#include "dfloat_amortization.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void payments()
+{
+  xu::amortization_policy policy;
+
+  assert(xu::level_payment(100000, dfloat::parse("0.06"), 360, policy) == dfloat::parse("599.55"));
+  assert(xu::level_payment(1000, dfloat::parse("0.12"), 12, policy) == dfloat::parse("88.85"));
+  assert(xu::level_payment(1000, 0, 3, policy) == dfloat::parse("333.33"));
+
+  policy.payment_rounding = xu::rounding_mode::UP;
+  assert(xu::level_payment(1000, 0, 3, policy) == dfloat::parse("333.34"));
+
+  /* yearly payments, in whole units */
+  policy.periods_per_year = 1;
+  policy.exp = 0;
+  assert(xu::level_payment(1000, dfloat::parse("0.1"), 2, policy) == dfloat(577));
+
+  assert_false(dfloat::isfinite(xu::level_payment(1000, dfloat::parse("0.1"), 0, policy)));
+  assert_false(dfloat::isfinite(xu::level_payment(1000, dfloat::parse("-0.1"), 2, policy)));
+  assert_false(dfloat::isfinite(xu::level_payment(-1000, dfloat::parse("0.1"), 2, policy)));
+  assert_false(dfloat::isfinite(xu::level_payment(dfloat::parse("nan"), dfloat::parse("0.1"), 2, policy)));
+}
+
+void schedule()
+{
+  xu::amortization_policy policy;
+  xu::amortization_schedule out;
+
+  dfloat principal = 1000;
+  dfloat rate = dfloat::parse("0.12");
+  uint32_t term = 12;
+
+  assert(xu::amortize(&principal, &rate, &term, 1, policy, out, 1) == 1);
+  assert(out.size() == 12);
+
+  assert(out.loan[0] == 0);
+  assert(out.period[0] == 1);
+  assert(out.payment[0] == dfloat::parse("88.85"));
+  assert(out.interest[0] == dfloat::parse("10.00"));
+  assert(out.principal[0] == dfloat::parse("78.85"));
+  assert(out.balance[0] == dfloat::parse("921.15"));
+
+  /* 921.15 * 0.01 = 9.2115 */
+  assert(out.interest[1] == dfloat::parse("9.21"));
+  assert(out.principal[1] == dfloat::parse("79.64"));
+  assert(out.balance[1] == dfloat::parse("841.51"));
+
+  assert(out.period[11] == 12);
+  assert(out.balance[11] == 0);
+
+  xu::dfloat_accumulator repaid;
+  for (size_t r = 0; r < out.size(); r++)
+  {
+    assert(out.payment[r] == out.interest[r] + out.principal[r]);
+    repaid.add(out.principal[r]);
+  }
+  assert(repaid.value() == principal);
+
+  /* the last payment absorbs the rounding of the others */
+  assert(out.payment[11] != out.payment[10]);
+  assert(out.payment[11] == out.interest[11] + out.balance[10]);
+}
+
+void rounding()
+{
+  /* a balance of 50 at 1% per period: each interest is 0.5 units */
+  xu::amortization_policy policy;
+  policy.exp = 0;
+  policy.periods_per_year = 1;
+
+  dfloat principal = 50;
+  dfloat rate = dfloat::parse("0.01");
+  uint32_t term = 1;
+
+  xu::amortization_schedule out;
+
+  policy.interest_rounding = xu::rounding_mode::HALF_UP;
+  xu::amortize(&principal, &rate, &term, 1, policy, out, 1);
+  assert(out.interest[0] == dfloat(1));
+  assert(out.payment[0] == dfloat(51));
+
+  policy.interest_rounding = xu::rounding_mode::HALF_EVEN;
+  xu::amortize(&principal, &rate, &term, 1, policy, out, 1);
+  assert(out.interest[0] == dfloat(0));
+  assert(out.payment[0] == dfloat(50));
+
+  /* the rate is exact: 7% / 12 is not rounded before it is applied */
+  policy = xu::amortization_policy();
+  policy.interest_rounding = xu::rounding_mode::DOWN;
+  principal = dfloat::parse("1200.00");
+  rate = dfloat::parse("0.07");
+  term = 2;
+  xu::amortize(&principal, &rate, &term, 1, policy, out, 1);
+  assert(out.interest[0] == dfloat(7));
+}
+
+void loans()
+{
+  const size_t count = 1000;
+
+  std::vector<dfloat> principals(count);
+  std::vector<dfloat> rates(count);
+  std::vector<uint32_t> terms(count);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    principals[i] = dfloat::from_scaled((int64_t)(100000 + i * 12345), -2);
+    rates[i] = dfloat::from_scaled((int64_t)(i % 97) * 25, -4);
+    terms[i] = 1 + i % 61;
+  }
+
+  /* invalid loans keep their rows */
+  principals[3] = dfloat::parse("nan");
+  rates[5] = dfloat::parse("-0.01");
+  terms[7] = 0;
+
+  xu::amortization_policy policy;
+
+  xu::amortization_schedule serial;
+  assert(xu::amortize(principals.data(), rates.data(), terms.data(), count, policy, serial, 1) == count - 3);
+
+  size_t rows = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    rows += terms[i];
+  }
+  assert(serial.size() == rows);
+
+  size_t r = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    bool valid = i != 3 and i != 5;
+
+    for (uint32_t k = 0; k < terms[i]; k++, r++)
+    {
+      assert(serial.loan[r] == i);
+      assert(serial.period[r] == k + 1);
+      assert(dfloat::isfinite(serial.balance[r]) == valid);
+    }
+
+    if (valid and terms[i] != 0)
+    {
+      assert(serial.balance[r - 1] == 0);
+      assert(serial.payment[r - terms[i]] == xu::level_payment(principals[i], rates[i], terms[i], policy)
+        or terms[i] == 1);
+    }
+  }
+
+  for (size_t threads : {2, 4})
+  {
+    xu::amortization_schedule parallel;
+    assert(xu::amortize(principals.data(), rates.data(), terms.data(), count, policy, parallel, threads) == count - 3);
+    assert(parallel.size() == rows);
+
+    for (size_t r = 0; r < rows; r++)
+    {
+      assert(parallel.loan[r] == serial.loan[r]);
+      assert(parallel.period[r] == serial.period[r]);
+      assert(parallel.payment[r].to_key() == serial.payment[r].to_key());
+      assert(parallel.interest[r].to_key() == serial.interest[r].to_key());
+      assert(parallel.principal[r].to_key() == serial.principal[r].to_key());
+      assert(parallel.balance[r].to_key() == serial.balance[r].to_key());
+    }
+  }
+
+  serial.clear();
+  assert(serial.size() == 0);
+  assert(serial.balance.size() == 0);
+}
+
+int main()
+{
+  payments();
+
+  schedule();
+
+  rounding();
+
+  loans();
+
+  std::cout << "Completed without errors" << std::endl;
+}
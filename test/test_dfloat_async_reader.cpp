@@ -0,0 +1,164 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_async_reader -I../include -Wfatal-errors -Wall -pthread test_dfloat_async_reader.cpp
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include "dfloat_async_reader.hpp"
+
+#define assert_false(expr) assert((expr)==false)
+
+static char pattern(uint64_t offset)
+{
+  return (char)(offset * 2654435761u >> 13);
+}
+
+void write_file(const std::string& path, size_t size)
+{
+  std::ofstream file(path, std::ios::binary);
+
+  for (size_t i = 0; i < size; i++)
+  {
+    file.put(pattern(i));
+  }
+}
+
+void whole_file(bool allow_io_uring)
+{
+  std::string path = "/tmp/test_dfloat_async_reader.dat";
+
+  /* not a multiple of the chunk size, so the last chunk is short */
+  const size_t size = 1000003;
+  const size_t chunk_size = 4096;
+  const size_t chunks = (size + chunk_size - 1) / chunk_size;
+
+  write_file(path, size);
+
+  for (size_t threads : {1, 3})
+  {
+    for (size_t depth : {1, 4})
+    {
+      xu::async_file_reader reader(path, chunk_size, depth, allow_io_uring);
+
+      assert(reader.is_open());
+      assert(reader.file_size() == size);
+      if (not allow_io_uring)
+      {
+        assert_false(reader.uses_io_uring());
+      }
+
+      std::mutex mutex;
+      std::vector<bool> seen(chunks, false);
+      size_t total = 0;
+      bool content_ok = true;
+
+      bool ok = xu::for_each_chunk(reader, threads,
+        [&](const xu::file_chunk& chunk)
+        {
+          bool same = true;
+          for (size_t i = 0; i < chunk.size; i++)
+          {
+            same = same and chunk.data[i] == pattern(chunk.offset + i);
+          }
+
+          std::lock_guard<std::mutex> lock(mutex);
+
+          content_ok = content_ok and same;
+          content_ok = content_ok and chunk.offset % chunk_size == 0;
+          content_ok = content_ok and chunk.size == std::min(chunk_size, size - chunk.offset);
+          content_ok = content_ok and not seen[chunk.offset / chunk_size];
+
+          seen[chunk.offset / chunk_size] = true;
+          total += chunk.size;
+        });
+
+      assert(ok);
+      assert_false(reader.failed());
+      assert(content_ok);
+      assert(total == size);
+
+      /* exhausted */
+      xu::file_chunk chunk;
+      assert_false(reader.next(chunk));
+    }
+  }
+
+  /* stopping early leaves no read writing into freed buffers */
+  {
+    xu::async_file_reader reader(path, chunk_size, 8, allow_io_uring);
+
+    xu::file_chunk chunk;
+    assert(reader.next(chunk));
+    assert(chunk.data[0] == pattern(chunk.offset));
+  }
+
+  std::remove(path.c_str());
+}
+
+void edge_cases()
+{
+  std::string path = "/tmp/test_dfloat_async_reader_empty.dat";
+
+  write_file(path, 0);
+
+  for (bool allow_io_uring : {true, false})
+  {
+    xu::async_file_reader reader(path, 4096, 4, allow_io_uring);
+
+    assert(reader.is_open());
+    assert(reader.file_size() == 0);
+
+    xu::file_chunk chunk;
+    assert_false(reader.next(chunk));
+    assert_false(reader.failed());
+  }
+
+  std::remove(path.c_str());
+
+  xu::async_file_reader missing(path);
+  assert_false(missing.is_open());
+
+  xu::file_chunk chunk;
+  assert_false(missing.next(chunk));
+}
+
+int main()
+{
+  {
+    xu::async_file_reader probe("/proc/self/exe");
+    std::cout << "io_uring " << (probe.uses_io_uring() ? "available" : "unavailable, testing fallback only") << std::endl;
+  }
+
+  whole_file(true);
+
+  whole_file(false);
+
+  edge_cases();
+
+  std::cout << "Completed without errors" << std::endl;
+}
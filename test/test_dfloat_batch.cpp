@@ -0,0 +1,257 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_batch -I../include -Wfatal-errors -Wall test_dfloat_batch.cpp
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "dfloat_batch.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+/*
+  Lay out fields right-aligned in a buffer of fixed-width fields
+  */
+std::string make_fields(const std::vector<std::string>& fields, size_t width)
+{
+  std::string buf;
+
+  for (const std::string& field : fields)
+  {
+    buf += std::string(width - field.size(), ' ') + field;
+  }
+
+  return buf;
+}
+
+void parse_fixed()
+{
+  const size_t width = 12;
+
+  {
+    std::vector<std::string> fields = {
+      "0", "1", "-1", "+1", "123.45", "-0.001", "000012.5000", "99999999999"
+    };
+    std::string buf = make_fields(fields, width);
+
+    dfloat out[8];
+    assert(xu::parse_fixed<8>(buf.data(), width, width, out) == 0);
+
+    for (size_t i = 0; i < fields.size(); i++)
+    {
+      assert(out[i] == dfloat::parse(fields[i]));
+    }
+  }
+
+  // padding on either side, all without the fallback
+  {
+    std::string buf = "  12.5      " "-7          " "        -0.0";
+    dfloat out[3];
+    assert(xu::parse_fixed<3>(buf.data(), width, width, out) == 0);
+
+    assert(out[0] == dfloat::parse("12.5"));
+    assert(out[1] == dfloat(-7));
+    assert(out[2] == dfloat(0));
+
+    std::string aligned = "-1234.56    " "  -1234.56  " "    -1234.56";
+    assert(xu::parse_fixed<3>(aligned.data(), width, width, out) == 0);
+
+    for (size_t i = 0; i < 3; i++)
+    {
+      assert(out[i] == dfloat::parse("-1234.56"));
+    }
+  }
+
+  // irregular fields fall back to dfloat::parse
+  {
+    std::vector<std::string> fields = {
+      "1.5e3", "12.", ".5", "1 2", "1-", "abc", "", "1..2"
+    };
+    std::string buf = make_fields(fields, width);
+
+    dfloat out[8];
+    assert(xu::parse_fixed<8>(buf.data(), width, width, out) == 8);
+
+    assert(out[0] == dfloat(1500));
+    for (size_t i = 1; i < fields.size(); i++)
+    {
+      assert_false(dfloat::isfinite(out[i]));
+    }
+  }
+
+  // more than 19 significant digits
+  {
+    std::string buf = "123456789012345678901.5";
+    dfloat out;
+    xu::parse_fixed<1>(buf.data(), buf.size(), buf.size(), &out);
+
+    assert(out == dfloat::parse(buf));
+  }
+
+  // stride larger than width, count not a multiple of the lanes
+  {
+    const size_t stride = 16;
+    std::vector<std::string> fields;
+    std::string buf;
+
+    for (size_t i = 0; i < 21; i++)
+    {
+      std::string field = std::to_string((i + 1) * 7919) + "." + std::to_string(i % 10);
+      if (i % 3 == 0)
+      {
+        field = "-" + field;
+      }
+
+      /* right-aligned, left-aligned and centred in turn */
+      size_t left = i % 3 == 0 ? width - field.size() : i % 3 == 1 ? 0 : (width - field.size()) / 2;
+
+      fields.push_back(field);
+      buf += std::string(left, ' ') + field + std::string(width - field.size() - left, ' ') + "|||\n";
+    }
+
+    std::vector<dfloat> out(fields.size());
+    assert(xu::parse_fixed(buf.data(), width, stride, fields.size(), out.data()) == 0);
+
+    for (size_t i = 0; i < fields.size(); i++)
+    {
+      assert(out[i] == dfloat::parse(fields[i]));
+    }
+  }
+}
+
+void format_fixed()
+{
+  {
+    dfloat values[8] = {
+      dfloat(0),
+      dfloat(1),
+      dfloat::parse("-1.5"),
+      dfloat::parse("1234.567"),
+      dfloat::parse("-0.001"),
+      dfloat::parse("0.09"),
+      dfloat::parse("99999999.99"),
+      dfloat::parse("nan")
+    };
+
+    std::string buf(8 * 12, '|');
+    xu::format_fixed<8>(values, 12, 2, 12, &buf[0]);
+
+    assert(buf ==
+      "        0.00"
+      "        1.00"
+      "       -1.50"
+      "     1234.56"
+      "        0.00"
+      "        0.09"
+      " 99999999.99"
+      "         nan");
+  }
+
+  // no decimal point, overflow of the field width
+  {
+    dfloat values[3] = {dfloat(42), dfloat::parse("-123.9"), dfloat(123456)};
+
+    std::string buf(3 * 5, '|');
+    xu::format_fixed<3>(values, 4, 0, 5, &buf[0]);
+
+    assert(buf == "  42|" "-123|" "****|");
+  }
+
+  // outside the range of the scaled integer
+  {
+    dfloat values[2] = {dfloat::parse("1e30"), dfloat::parse("-9223372036854775800")};
+
+    std::string buf(2 * 24, '|');
+    xu::format_fixed<2>(values, 24, 0, 24, &buf[0]);
+
+    assert(buf == std::string(24, '*') + "    -9223372036854775800");
+  }
+
+  // round trip through the batch parser
+  {
+    const size_t count = 1000;
+    const size_t width = 16;
+    const size_t stride = width + 1;
+
+    std::vector<dfloat> values(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      values[i] = dfloat::from_scaled((int64_t)(i * i * 104729) * (i % 2 ? -1 : 1), -4);
+    }
+
+    std::string buf(count * stride, '\n');
+    xu::format_fixed(values.data(), width, 4, stride, count, &buf[0]);
+
+    std::vector<dfloat> parsed(count);
+    xu::parse_fixed(buf.data(), width, stride, count, parsed.data());
+
+    for (size_t i = 0; i < count; i++)
+    {
+      assert(parsed[i] == values[i]);
+      assert(buf[i * stride + width] == '\n');
+    }
+  }
+
+  // leftover lanes are formatted exactly like a batch
+  {
+    const size_t count = 2 * xu::BATCH_LANES - 1;
+    const size_t width = 8;
+
+    std::vector<dfloat> values(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      values[i] = dfloat::from_scaled((int64_t)(i * i * i * 7919) * (i % 3 ? 1 : -1), -3);
+    }
+    values[count - 1] = dfloat::parse("nan");
+    values[count - 2] = dfloat::parse("-0.5");
+    values[count - 3] = dfloat::parse("0");
+
+    for (size_t decimals : {0, 2})
+    {
+      std::string many(count * width, '|');
+      xu::format_fixed(values.data(), width, decimals, width, count, &many[0]);
+
+      std::string one(count * width, '|');
+      for (size_t i = 0; i < count; i++)
+      {
+        xu::format_fixed<1>(&values[i], width, decimals, width, &one[i * width]);
+      }
+
+      assert(many == one);
+    }
+  }
+}
+
+int main()
+{
+  parse_fixed();
+
+  format_fixed();
+
+  std::cout << "Completed without errors" << std::endl;
+}
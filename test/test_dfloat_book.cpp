@@ -0,0 +1,254 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_book -I../include -Wfatal-errors -Wall test_dfloat_book.cpp
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <map>
+#include "dfloat_book.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+using xu::book_side;
+
+/*
+  Reference: venue sizes per price, in a map ordered by dfloat
+  */
+struct reference_book
+{
+  std::map<dfloat, std::vector<dfloat>> sides[2];
+  size_t num_venues;
+
+  void apply(const xu::book_update& u)
+  {
+    if (u.venue >= num_venues or not dfloat::isfinite(u.price))
+    {
+      return;
+    }
+
+    auto& side = sides[(int)u.side];
+    bool positive = dfloat::isfinite(u.size) and u.size > 0;
+
+    auto it = side.find(u.price);
+
+    if (it == side.end())
+    {
+      if (not positive)
+      {
+        return;
+      }
+      it = side.emplace(u.price, std::vector<dfloat>(num_venues, dfloat(0))).first;
+    }
+
+    it->second[u.venue] = positive ? u.size : dfloat(0);
+
+    bool any = false;
+    for (const dfloat& s : it->second)
+    {
+      any = any or s > 0;
+    }
+    if (not any)
+    {
+      side.erase(it);
+    }
+  }
+};
+
+void check(const xu::consolidated_book& book, const reference_book& ref)
+{
+  for (book_side s : {book_side::BID, book_side::ASK})
+  {
+    const auto& side = ref.sides[(int)s];
+
+    assert(book.depth(s) == side.size());
+
+    std::vector<const std::pair<const dfloat, std::vector<dfloat>>*> order;
+    for (const auto& kv : side)
+    {
+      order.push_back(&kv);
+    }
+    if (s == book_side::BID)
+    {
+      std::reverse(order.begin(), order.end());
+    }
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+      xu::book_level level = book.level(s, i);
+
+      dfloat total = 0;
+      uint16_t venues = 0;
+      for (size_t v = 0; v < ref.num_venues; v++)
+      {
+        total += order[i]->second[v];
+        venues += order[i]->second[v] > 0;
+
+        assert(book.venue_size(s, order[i]->first, v) == order[i]->second[v]);
+      }
+
+      assert(level.price == order[i]->first);
+      assert(level.size == total);
+      assert(level.venues == venues);
+    }
+  }
+}
+
+void basics()
+{
+  xu::consolidated_book book(3);
+
+  assert(book.num_venues() == 3);
+
+  xu::book_level level;
+  assert_false(book.best(book_side::BID, level));
+  assert_false(book.best(book_side::ASK, level));
+
+  book.apply({0, book_side::BID, dfloat::parse("99.5"), dfloat(100)});
+  book.apply({1, book_side::BID, dfloat::parse("99.5"), dfloat(50)});
+  book.apply({2, book_side::BID, dfloat::parse("99.4"), dfloat(70)});
+  book.apply({0, book_side::ASK, dfloat::parse("99.6"), dfloat(10)});
+  book.apply({1, book_side::ASK, dfloat::parse("99.7"), dfloat(20)});
+  book.apply({2, book_side::ASK, dfloat::parse("-1"), dfloat(30)});
+
+  assert(book.best(book_side::BID, level));
+  assert(level.price == dfloat::parse("99.5"));
+  assert(level.size == dfloat(150));
+  assert(level.venues == 2);
+
+  /* negative prices order correctly too */
+  assert(book.best(book_side::ASK, level));
+  assert(level.price == dfloat(-1));
+  assert(book.level(book_side::ASK, 1).price == dfloat::parse("99.6"));
+  assert(book.level(book_side::ASK, 2).price == dfloat::parse("99.7"));
+
+  assert(book.depth(book_side::BID) == 2);
+  assert(book.depth(book_side::ASK) == 3);
+
+  assert(book.venue_size(book_side::BID, dfloat::parse("99.5"), 1) == dfloat(50));
+  assert(book.venue_size(book_side::BID, dfloat::parse("99.5"), 2) == dfloat(0));
+  assert(book.venue_size(book_side::BID, dfloat::parse("98"), 0) == dfloat(0));
+
+  /* replace, then remove */
+  book.apply({0, book_side::BID, dfloat::parse("99.5"), dfloat(30)});
+  assert(book.level(book_side::BID, 0).size == dfloat(80));
+
+  book.apply({0, book_side::BID, dfloat::parse("99.5"), dfloat(0)});
+  book.apply({1, book_side::BID, dfloat::parse("99.5"), dfloat(-5)});
+  assert(book.depth(book_side::BID) == 1);
+  assert(book.level(book_side::BID, 0).price == dfloat::parse("99.4"));
+
+  /* ignored */
+  book.apply({3, book_side::BID, dfloat(100), dfloat(1)});
+  book.apply({0, book_side::BID, dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0), dfloat(1)});
+  book.apply({0, book_side::BID, dfloat(98), dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0)});
+  assert(book.depth(book_side::BID) == 1);
+
+  book.clear_venue(2);
+  assert(book.depth(book_side::BID) == 0);
+  assert(book.depth(book_side::ASK) == 2);
+
+  book.clear();
+  assert(book.depth(book_side::ASK) == 0);
+}
+
+std::vector<xu::book_update> random_updates(size_t count, size_t num_venues, uint64_t& seed)
+{
+  std::vector<xu::book_update> updates(count);
+
+  for (auto& u : updates)
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    uint32_t r = (uint32_t)(seed >> 33);
+
+    u.venue = (uint16_t)(r % (num_venues + 1));
+    u.side = (r >> 4) % 2 ? book_side::BID : book_side::ASK;
+
+    /* bids below 100, asks above, with some crossing */
+    int64_t offset = (int64_t)((r >> 5) % 200);
+    int64_t ticks = u.side == book_side::BID ? 10010 - offset : 9990 + offset;
+    u.price = dfloat::from_scaled(ticks, -2);
+
+    int64_t size = (int64_t)((r >> 13) % 40) - 10;
+    u.size = dfloat(size * 100);
+  }
+
+  return updates;
+}
+
+void against_reference()
+{
+  const size_t num_venues = 5;
+  uint64_t seed = 42;
+
+  for (size_t batch : {1, 7, 64, 1000})
+  {
+    xu::consolidated_book book(num_venues);
+    reference_book ref;
+    ref.num_venues = num_venues;
+
+    for (int round = 0; round < 20; round++)
+    {
+      std::vector<xu::book_update> updates = random_updates(batch, num_venues, seed);
+
+      book.apply(updates.data(), updates.size());
+
+      for (const auto& u : updates)
+      {
+        ref.apply(u);
+      }
+
+      check(book, ref);
+    }
+
+    book.clear_venue(1);
+    for (auto& side : ref.sides)
+    {
+      for (auto it = side.begin(); it != side.end();)
+      {
+        it->second[1] = 0;
+
+        bool any = false;
+        for (const dfloat& s : it->second)
+        {
+          any = any or s > 0;
+        }
+        it = any ? std::next(it) : side.erase(it);
+      }
+    }
+    check(book, ref);
+  }
+}
+
+int main()
+{
+  basics();
+
+  against_reference();
+
+  std::cout << "Completed without errors" << std::endl;
+}
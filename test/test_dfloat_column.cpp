@@ -0,0 +1,158 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_column -I../include -Wfatal-errors -Wall -pthread test_dfloat_column.cpp
+
+#include <cassert>
+#include <iostream>
+#include <type_traits>
+#include "dfloat_column.hpp"
+
+typedef xu::dfloat dfloat;
+typedef xu::dfloat_column dfloat_column;
+
+void expressions()
+{
+  dfloat_column a = {dfloat(1), dfloat(2), dfloat(3)};
+  dfloat_column b = {dfloat(4), dfloat(5), dfloat(6)};
+
+  {
+    dfloat_column out = a + b;
+    assert(out.size() == 3);
+    assert(out[0] == 5);
+    assert(out[1] == 7);
+    assert(out[2] == 9);
+  }
+
+  {
+    dfloat_column out = a - b * dfloat(2) / a;
+    assert(out[0] == -7);
+    assert(out[1] == -3);
+    assert(out[2] == -1);
+  }
+
+  {
+    dfloat_column out = -a + dfloat(10);
+    assert(out[0] == 9);
+    assert(out[2] == 7);
+  }
+
+  // nothing is evaluated until assignment
+  {
+    auto expr = a * b;
+    a[0] = dfloat(10);
+    dfloat_column out = expr;
+    assert(out[0] == 40);
+    a[0] = dfloat(1);
+  }
+
+  // the output column may also be an operand
+  {
+    dfloat_column out = a;
+    out = out * out + b;
+    assert(out[0] == 5);
+    assert(out[1] == 9);
+    assert(out[2] == 15);
+  }
+}
+
+void fused()
+{
+  dfloat_column a = {dfloat(2), dfloat::parse("1.00000000000000001")};
+  dfloat_column b = {dfloat(3), dfloat::parse("1.00000000000000001")};
+  dfloat_column c = {dfloat(4), dfloat(-1)};
+  dfloat_column d = {dfloat(5), dfloat(0)};
+  dfloat_column e = {dfloat(1), dfloat(0)};
+
+  /* products next to a sum or difference are fused */
+  static_assert(std::is_same<decltype(a * b + c), xu::fma_expr<dfloat_column, dfloat_column, dfloat_column>>::value, "a * b + c");
+  static_assert(std::is_same<decltype(c + a * b), xu::fma_expr<dfloat_column, dfloat_column, dfloat_column>>::value, "c + a * b");
+  static_assert(std::is_same<decltype(a * b - c), xu::fma_expr<dfloat_column, dfloat_column, xu::negate_expr<dfloat_column>>>::value, "a * b - c");
+  static_assert(std::is_same<decltype(c - a * b), xu::fma_expr<xu::negate_expr<dfloat_column>, dfloat_column, dfloat_column>>::value, "c - a * b");
+
+  {
+    dfloat_column out = a * b + c;
+    assert(out[0] == 10);
+    assert(out[1] == dfloat::fma(a[1], b[1], c[1]));
+    assert(out[1] != a[1] * b[1] + c[1]);
+  }
+
+  {
+    dfloat_column out = c - a * b;
+    assert(out[0] == -2);
+    assert(out[1] == -dfloat::fma(a[1], b[1], -c[1]));
+  }
+
+  {
+    dfloat_column out = a * b + c * d - e;
+    assert(out[0] == 25);
+    assert(out[1] == dfloat::fma(a[1], b[1], c[1] * d[1]) - e[1]);
+  }
+
+  {
+    dfloat_column out = a * b - c * d;
+    assert(out[0] == -14);
+  }
+}
+
+void parallel()
+{
+  size_t count = 3 * dfloat_column::BLOCK_SIZE + 7;
+
+  dfloat_column a(count);
+  dfloat_column b(count, dfloat::parse("0.5"));
+
+  for (size_t i = 0; i < count; i++)
+  {
+    a[i] = dfloat(i);
+  }
+
+  dfloat_column serial = a * b + a;
+
+  for (size_t threads : {0, 1, 2, 3, 8})
+  {
+    dfloat_column out;
+    out.assign(a * b + a, threads);
+
+    assert(out.size() == count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      assert(out[i] == serial[i]);
+    }
+  }
+
+  assert(serial[count - 1] == dfloat(count - 1) * dfloat::parse("1.5"));
+}
+
+int main()
+{
+  expressions();
+
+  fused();
+
+  parallel();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,107 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_compact -I../include -Wfatal-errors -Wall test_dfloat_compact.cpp
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include "dfloat_compact.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void varints()
+{
+  char buf[10];
+  uint64_t x;
+
+  assert(xu::encode_varint(0, buf) == 1 and buf[0] == 0);
+  assert(xu::encode_varint(300, buf) == 2 and (uint8_t)buf[0] == 0xac and buf[1] == 0x02);
+  assert(xu::decode_varint(buf, 2, x) == 2 and x == 300);
+  assert(xu::decode_varint(buf, 1, x) == 0);
+
+  assert(xu::encode_varint(UINT64_MAX, buf) == 10);
+  assert(xu::decode_varint(buf, 10, x) == 10 and x == UINT64_MAX);
+
+  // overlong
+  const char overlong[2] = {(char)0x80, 0x00};
+  assert(xu::decode_varint(overlong, 2, x) == 0);
+}
+
+void compact()
+{
+  char buf[xu::COMPACT_MAX_SIZE];
+  dfloat d;
+
+  const unsigned char expected[4] = {0xfe, 0xf2, 0xc0, 0x01};
+  assert(xu::encode_compact(dfloat::parse("123.45"), buf) == 4);
+  assert(std::memcmp(buf, expected, 4) == 0);
+  assert(xu::decode_compact(buf, 4, d) == 4 and d == dfloat::parse("123.45"));
+  assert(xu::decode_compact(buf, 3, d) == 0);
+
+  // equal values, equal bytes
+  char other[xu::COMPACT_MAX_SIZE];
+  assert(xu::encode_compact(dfloat::parse("123.4500") * 1, other) == 4);
+  assert(std::memcmp(buf, other, 4) == 0);
+
+  assert(xu::encode_compact(dfloat(0), buf) == 2);
+  assert(xu::decode_compact(buf, 2, d) == 2 and d == 0);
+
+  assert(xu::encode_compact(dfloat::parse("nan"), buf) == 1);
+  assert(xu::decode_compact(buf, 1, d) == 1 and not dfloat::isfinite(d));
+
+  assert(xu::encode_compact(dfloat::parse("-999999999999999999e82"), buf) == xu::COMPACT_MAX_SIZE);
+
+  // not canonical: trailing zero, zero with an exponent, value out of range
+  const char trailing_zero[2] = {0x00, 20};
+  assert(xu::decode_compact(trailing_zero, 2, d) == 0);
+  const char zero_exp[2] = {0x01, 0x00};
+  assert(xu::decode_compact(zero_exp, 2, d) == 0);
+  const char too_big[2] = {100, 22};
+  assert(xu::decode_compact(too_big, 2, d) == 0);
+
+  std::mt19937_64 gen(3);
+  std::uniform_int_distribution<int64_t> coef(-999999999999999999ll, 999999999999999999ll);
+  std::uniform_int_distribution<int> exp(-110, 80);
+
+  for (int i = 0; i < 100000; i++)
+  {
+    dfloat v = dfloat::from_scaled(coef(gen), exp(gen));
+    size_t n = xu::encode_compact(v, buf);
+    assert(xu::decode_compact(buf, n, d) == n);
+    assert(d == v);
+  }
+}
+
+int main()
+{
+  varints();
+
+  compact();
+
+  std::cout << "Completed without errors" << std::endl;
+}
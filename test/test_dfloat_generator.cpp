@@ -0,0 +1,335 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -std=c++20 -o bin/test_dfloat_generator -I../include -Wfatal-errors -Wall test_dfloat_generator.cpp
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include "dfloat_generator.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+  allocations++;
+  void* ptr = std::malloc(size > 0 ? size : 1);
+  if (ptr == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void lines()
+{
+  const std::string text = "1.5\n-2\r\n3\n\nabc\n4";
+
+  std::vector<size_t> sizes;
+  std::vector<std::string> all;
+
+  for (xu::line_batch batch : xu::split_lines(text.data(), text.size(), 4))
+  {
+    sizes.push_back(batch.size());
+    for (std::string_view line : batch)
+    {
+      all.emplace_back(line);
+    }
+  }
+
+  assert((sizes == std::vector<size_t>{4, 2}));
+  assert((all == std::vector<std::string>{"1.5", "-2", "3", "", "abc", "4"}));
+
+  std::istringstream in(text);
+  all.clear();
+
+  for (xu::line_batch batch : xu::read_lines(in, 4))
+  {
+    for (std::string_view line : batch)
+    {
+      all.emplace_back(line);
+    }
+  }
+
+  assert((all == std::vector<std::string>{"1.5", "-2", "3", "", "abc", "4"}));
+
+  /* nothing to split */
+  for (xu::line_batch batch : xu::split_lines(text.data(), 0, 4))
+  {
+    (void)batch;
+    assert(false);
+  }
+}
+
+void stages()
+{
+  const std::string text = "1.5\n-2\r\n3\n\nabc\n4\n";
+
+  auto values = [&]()
+  {
+    return xu::parse_lines(xu::split_lines(text.data(), text.size(), 2));
+  };
+
+  auto finite = [](const dfloat& x) { return dfloat::isfinite(x); };
+
+  assert_false(dfloat::isfinite(xu::sum(values())));
+  assert(xu::count(values()) == 6);
+
+  assert(xu::sum(xu::filter(values(), finite)) == dfloat::parse("6.5"));
+  assert(xu::count(xu::filter(values(), finite)) == 4);
+  assert(xu::min(values()) == dfloat(-2));
+  assert(xu::max(values()) == dfloat(4));
+
+  /* batches left empty are dropped */
+  size_t batches = 0;
+  for (xu::value_batch batch : xu::filter(xu::parse_lines(xu::split_lines(text.data(), text.size(), 1)), finite))
+  {
+    assert(batch.size() == 1);
+    batches++;
+  }
+  assert(batches == 4);
+
+  auto twice = [](const dfloat& x) { return x * 2; };
+  assert(xu::sum(xu::transform(xu::filter(values(), finite), twice)) == dfloat(13));
+
+  size_t big = xu::reduce(values(), (size_t)0,
+    [](size_t n, const dfloat& x) { return n + (x > 1 ? 1 : 0); });
+  assert(big == 3);
+
+  /* empty input */
+  assert(xu::sum(xu::parse_lines(xu::split_lines(text.data(), 0, 2))) == dfloat(0));
+  assert_false(dfloat::isfinite(xu::min(xu::parse_lines(xu::split_lines(text.data(), 0, 2)))));
+
+  /* locale */
+  const std::string eu = "1.234,5\n-0,5\n";
+  assert(xu::sum(xu::parse_lines(xu::split_lines(eu.data(), eu.size(), 8), xu::number_format::european())) == dfloat(1234));
+}
+
+void fields()
+{
+  /* 8-character fields with a separator */
+  const size_t count = 1000;
+  std::string records;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    std::string field = std::to_string((int)i - 500) + ".25";
+    records += std::string(8 - field.size(), ' ') + field + "|";
+  }
+
+  std::vector<dfloat> expected(count);
+  xu::parse_fixed(records.data(), 8, 9, count, expected.data());
+
+  for (size_t batch : {1, 7, 64, 5000})
+  {
+    size_t i = 0;
+    for (xu::value_batch values : xu::parse_fields(records.data(), 8, 9, count, batch))
+    {
+      assert(values.size() <= batch);
+      for (const dfloat& x : values)
+      {
+        assert(x == expected[i++]);
+      }
+    }
+    assert(i == count);
+  }
+
+  assert(xu::sum(xu::parse_fields(records.data(), 8, 9, count, 64)) == dfloat(-500));
+
+  std::string text;
+  for (std::string_view block : xu::format_lines(xu::parse_fields(records.data(), 8, 9, 3, 2), 9, 1))
+  {
+    text += block;
+  }
+  assert(text == "   -500.2\n   -499.2\n   -498.2\n");
+}
+
+void allocation()
+{
+  auto run = [](size_t count)
+  {
+    std::string text;
+    for (size_t i = 0; i < count; i++)
+    {
+      text += std::to_string(i % 1000) + ".5\n";
+    }
+
+    size_t before = allocations;
+
+    auto positive = [](const dfloat& x) { return x > 0; };
+    dfloat total = xu::sum(xu::filter(xu::parse_lines(xu::split_lines(text.data(), text.size(), 256)), positive));
+
+    assert(dfloat::isfinite(total));
+
+    return allocations - before;
+  };
+
+  /* frames and batch buffers only, nothing per element */
+  size_t small = run(1000);
+  size_t large = run(100000);
+
+  assert(small == large);
+  assert(small < 16);
+}
+
+xu::async_generator<xu::value_batch> async_source(std::vector<dfloat> values, size_t batch)
+{
+  for (size_t i = 0; i < values.size(); i += batch)
+  {
+    co_yield xu::value_batch(values.data() + i, std::min(batch, values.size() - i));
+  }
+}
+
+xu::async_generator<xu::value_batch> async_negatives(xu::async_generator<xu::value_batch> source)
+{
+  std::vector<dfloat> out;
+
+  while (const xu::value_batch* batch = co_await source.next())
+  {
+    out.clear();
+    for (const dfloat& x : *batch)
+    {
+      if (x < 0)
+      {
+        out.push_back(x);
+      }
+    }
+    if (not out.empty())
+    {
+      co_yield xu::value_batch(out);
+    }
+  }
+}
+
+xu::task<dfloat> async_sum(xu::async_generator<xu::value_batch> source)
+{
+  dfloat total = 0;
+
+  while (const xu::value_batch* batch = co_await source.next())
+  {
+    for (const dfloat& x : *batch)
+    {
+      total += x;
+    }
+  }
+
+  co_return total;
+}
+
+xu::task<dfloat> async_pipeline(std::vector<dfloat> values)
+{
+  dfloat all = co_await async_sum(async_source(values, 3));
+  dfloat negatives = co_await async_sum(async_negatives(async_source(values, 3)));
+
+  co_return all - negatives;
+}
+
+xu::async_generator<xu::value_batch> async_throwing()
+{
+  std::vector<dfloat> values = {1, 2};
+  co_yield xu::value_batch(values);
+  throw std::runtime_error("source failed");
+}
+
+xu::generator<xu::value_batch> throwing()
+{
+  std::vector<dfloat> values = {1, 2};
+  co_yield xu::value_batch(values);
+  throw std::runtime_error("source failed");
+}
+
+void async()
+{
+  std::vector<dfloat> values;
+  for (int i = -10; i <= 20; i++)
+  {
+    values.push_back(dfloat(i));
+  }
+
+  assert(xu::sync_wait(async_sum(async_source(values, 4))) == dfloat(155));
+  assert(xu::sync_wait(async_sum(async_negatives(async_source(values, 4)))) == dfloat(-55));
+  assert(xu::sync_wait(async_pipeline(values)) == dfloat(210));
+  assert(xu::sync_wait(async_sum(async_source({}, 4))) == dfloat(0));
+
+  bool thrown = false;
+  try
+  {
+    xu::sync_wait(async_sum(async_throwing()));
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+
+  thrown = false;
+  try
+  {
+    xu::sum(throwing());
+  }
+  catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  assert(thrown);
+
+  /* leaving early destroys every suspended stage */
+  for (xu::value_batch batch : xu::parse_lines(xu::split_lines("1\n2\n3\n", 6, 1)))
+  {
+    assert(batch[0] == dfloat(1));
+    break;
+  }
+}
+
+int main()
+{
+  lines();
+
+  stages();
+
+  fields();
+
+  allocation();
+
+  async();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,249 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_invoice -I../include -Wfatal-errors -Wall -pthread test_dfloat_invoice.cpp
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "dfloat_invoice.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+std::vector<xu::line_rule> make_rules()
+{
+  std::vector<xu::line_rule> rules(3);
+
+  /* 10% off, 8.25% tax */
+  rules[1].discount_rate = dfloat::parse("0.10");
+  rules[1].tax_rate = dfloat::parse("0.0825");
+
+  /* 5.00 off, 20% tax on the amount before discount */
+  rules[2].discount_amount = dfloat::parse("5.00");
+  rules[2].tax_rate = dfloat::parse("0.20");
+  rules[2].tax_before_discount = true;
+
+  return rules;
+}
+
+void lines()
+{
+  xu::invoice_engine engine(make_rules(), xu::invoice_policy());
+
+  std::vector<uint64_t> offsets = {0, 2, 4, 4, 5};
+  std::vector<dfloat> quantities = {3, dfloat::parse("0.5"), 1, -2, 1};
+  std::vector<dfloat> prices = {dfloat::parse("19.99"), dfloat::parse("3.335"), dfloat::parse("4.00"),
+    dfloat::parse("10.00"), dfloat::parse("1.00")};
+  std::vector<uint32_t> rules = {1, 0, 2, 2, 99};
+
+  xu::invoice_lines out;
+  xu::invoice_totals totals;
+
+  assert(engine.run(offsets.data(), 4, quantities.data(), prices.data(), rules.data(), out, totals, 1) == 3);
+  assert(out.size() == 5);
+  assert(totals.size() == 4);
+
+  /* 59.97, 5.997 off, 4.452525 tax */
+  assert(out.extended[0] == dfloat::parse("59.97"));
+  assert(out.discount[0] == dfloat::parse("6.00"));
+  assert(out.tax[0] == dfloat::parse("4.45"));
+  assert(out.total[0] == dfloat::parse("58.42"));
+
+  /* 1.6675 */
+  assert(out.extended[1] == dfloat::parse("1.67"));
+  assert(out.discount[1] == 0);
+  assert(out.tax[1] == 0);
+  assert(out.total[1] == dfloat::parse("1.67"));
+
+  /* the discount is capped at the line, the tax is on the amount before it */
+  assert(out.extended[2] == dfloat::parse("4.00"));
+  assert(out.discount[2] == dfloat::parse("4.00"));
+  assert(out.tax[2] == dfloat::parse("0.80"));
+  assert(out.total[2] == dfloat::parse("0.80"));
+
+  /* a return: the fixed discount takes the sign of the line */
+  assert(out.extended[3] == dfloat::parse("-20.00"));
+  assert(out.discount[3] == dfloat::parse("-5.00"));
+  assert(out.tax[3] == dfloat::parse("-4.00"));
+  assert(out.total[3] == dfloat::parse("-19.00"));
+
+  assert_false(dfloat::isfinite(out.total[4]));
+
+  assert(totals.net[0] == dfloat::parse("55.64"));
+  assert(totals.tax[0] == dfloat::parse("4.45"));
+  assert(totals.total[0] == dfloat::parse("60.09"));
+  assert(totals.adjustment[0] == 0);
+  assert(totals.payable[0] == dfloat::parse("60.09"));
+
+  assert(totals.net[1] == dfloat::parse("-15.00"));
+  assert(totals.tax[1] == dfloat::parse("-3.20"));
+  assert(totals.total[1] == dfloat::parse("-18.20"));
+
+  assert(totals.total[2] == 0);
+  assert(totals.payable[2] == 0);
+
+  assert_false(dfloat::isfinite(totals.total[3]));
+  assert_false(dfloat::isfinite(totals.payable[3]));
+}
+
+void rounding()
+{
+  std::vector<uint64_t> offsets = {0, 1, 2};
+  std::vector<dfloat> quantities = {1, 1};
+  std::vector<dfloat> prices = {dfloat::parse("0.125"), dfloat::parse("-60.08")};
+  std::vector<uint32_t> rules = {0, 0};
+
+  xu::invoice_lines out;
+  xu::invoice_totals totals;
+
+  xu::invoice_policy policy;
+
+  xu::invoice_engine half_up(make_rules(), policy);
+  half_up.run(offsets.data(), 2, quantities.data(), prices.data(), rules.data(), out, totals, 1);
+  assert(out.extended[0] == dfloat::parse("0.13"));
+
+  policy.line_rounding = xu::rounding_mode::HALF_EVEN;
+  xu::invoice_engine half_even(make_rules(), policy);
+  half_even.run(offsets.data(), 2, quantities.data(), prices.data(), rules.data(), out, totals, 1);
+  assert(out.extended[0] == dfloat::parse("0.12"));
+
+  /* cash rounding to 0.05 */
+  policy.increment = 5;
+  xu::invoice_engine cash(make_rules(), policy);
+  cash.run(offsets.data(), 2, quantities.data(), prices.data(), rules.data(), out, totals, 1);
+  assert(totals.total[0] == dfloat::parse("0.12"));
+  assert(totals.payable[0] == dfloat::parse("0.10"));
+  assert(totals.adjustment[0] == dfloat::parse("-0.02"));
+  assert(totals.payable[1] == dfloat::parse("-60.10"));
+  assert(totals.adjustment[1] == dfloat::parse("-0.02"));
+}
+
+void exact()
+{
+  /* products of 18-digit coefficients, rounded once per amount */
+  std::vector<xu::line_rule> rules(1);
+  rules[0].discount_rate = dfloat::parse("0.333333333333333333");
+  rules[0].tax_rate = dfloat::parse("0.0725");
+
+  xu::invoice_engine engine(rules, xu::invoice_policy());
+
+  std::vector<uint64_t> offsets = {0, 1};
+  std::vector<dfloat> quantities = {dfloat::parse("123456.789")};
+  std::vector<dfloat> prices = {dfloat::parse("98765.4321")};
+  std::vector<uint32_t> line_rules = {0};
+
+  xu::invoice_lines out;
+  xu::invoice_totals totals;
+  engine.run(offsets.data(), 1, quantities.data(), prices.data(), line_rules.data(), out, totals, 1);
+
+  /* 12193263111.2635269, then 4064421037.0866..., then 589341050.377325 */
+  assert(out.extended[0] == dfloat::parse("12193263111.26"));
+  assert(out.discount[0] == dfloat::parse("4064421037.09"));
+  assert(out.tax[0] == dfloat::parse("589341050.38"));
+  assert(totals.total[0] == dfloat::parse("8718183124.55"));
+}
+
+void invoices()
+{
+  const size_t num_invoices = 2000;
+
+  std::vector<uint64_t> offsets(num_invoices + 1);
+  std::vector<dfloat> quantities;
+  std::vector<dfloat> prices;
+  std::vector<uint32_t> rules;
+
+  offsets[0] = 0;
+  for (size_t i = 0; i < num_invoices; i++)
+  {
+    size_t count = i % 13;
+
+    for (size_t k = 0; k < count; k++)
+    {
+      size_t n = quantities.size();
+      quantities.push_back(dfloat((int64_t)(n % 7) - 1));
+      prices.push_back(dfloat::from_scaled((int64_t)(n * 7919 % 100000), -3));
+      rules.push_back((uint32_t)(n % 3));
+    }
+
+    offsets[i + 1] = quantities.size();
+  }
+
+  xu::invoice_policy policy;
+  policy.increment = 5;
+
+  xu::invoice_engine engine(make_rules(), policy);
+
+  xu::invoice_lines serial_lines;
+  xu::invoice_totals serial;
+  assert(engine.run(offsets.data(), num_invoices, quantities.data(), prices.data(), rules.data(),
+    serial_lines, serial, 1) == num_invoices);
+
+  /* totals are the sums of the lines */
+  for (size_t i = 0; i < num_invoices; i++)
+  {
+    xu::dfloat_accumulator total;
+    for (uint64_t l = offsets[i]; l < offsets[i + 1]; l++)
+    {
+      assert(serial_lines.total[l] == serial_lines.extended[l] - serial_lines.discount[l] + serial_lines.tax[l]);
+      total.add(serial_lines.total[l]);
+    }
+
+    assert(serial.total[i] == total.value());
+    assert(serial.total[i] == serial.net[i] + serial.tax[i]);
+    assert(serial.payable[i] == serial.total[i] + serial.adjustment[i]);
+  }
+
+  for (size_t threads : {2, 4})
+  {
+    xu::invoice_lines parallel_lines;
+    xu::invoice_totals parallel;
+    assert(engine.run(offsets.data(), num_invoices, quantities.data(), prices.data(), rules.data(),
+      parallel_lines, parallel, threads) == num_invoices);
+
+    for (size_t l = 0; l < quantities.size(); l++)
+    {
+      assert(parallel_lines.total[l].to_key() == serial_lines.total[l].to_key());
+    }
+
+    for (size_t i = 0; i < num_invoices; i++)
+    {
+      assert(parallel.payable[i].to_key() == serial.payable[i].to_key());
+    }
+  }
+}
+
+int main()
+{
+  lines();
+
+  rounding();
+
+  exact();
+
+  invoices();
+
+  std::cout << "Completed without errors" << std::endl;
+}
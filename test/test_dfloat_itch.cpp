@@ -0,0 +1,99 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_itch -I../include -Wfatal-errors -Wall test_dfloat_itch.cpp
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "dfloat_itch.hpp"
+
+typedef xu::dfloat dfloat;
+
+/* ITCH 5.0 Add Order: price is a Price(4) at offset 32 of a 36 byte message */
+constexpr size_t ADD_ORDER_SIZE = 36;
+constexpr size_t ADD_ORDER_PRICE = 32;
+
+void single()
+{
+  char buf[8] = {0x00, 0x01, (char)0xe2, 0x40};
+
+  assert((xu::itch_price<uint32_t, 4>(buf)) == dfloat::parse("12.3456"));
+  assert((xu::itch_price<uint32_t, 0>(buf)) == dfloat(123456));
+
+  char zero[4] = {};
+  assert((xu::itch_price<uint32_t, 4>(zero)) == dfloat(0));
+
+  char max32[4] = {(char)0xff, (char)0xff, (char)0xff, (char)0xff};
+  assert((xu::itch_price<uint32_t, 4>(max32)) == dfloat::parse("429496.7295"));
+
+  // Price(8), e.g. MWCB decline levels
+  xu::store<xu::byte_order::BIG>((uint64_t)123456789012ll, buf);
+  assert((xu::itch_price<uint64_t, 8>(buf)) == dfloat::parse("1234.56789012"));
+
+  // beyond 18 digits the price is truncated
+  xu::store<xu::byte_order::BIG>((uint64_t)18446744073709551615ull, buf);
+  assert((xu::itch_price<uint64_t, 8>(buf)) == dfloat::parse("184467440737.09551610"));
+}
+
+void batch()
+{
+  const size_t count = 1003;
+
+  std::vector<char> buffer(count * ADD_ORDER_SIZE, 'x');
+  std::vector<const char*> messages(count);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    char* message = buffer.data() + i * ADD_ORDER_SIZE;
+    message[0] = 'A';
+    xu::store<xu::byte_order::BIG>((uint32_t)(i * 10007), message + ADD_ORDER_PRICE);
+
+    /* gathered in reverse, as if interleaved with other message types */
+    messages[count - 1 - i] = message;
+  }
+
+  std::vector<dfloat> strided(count);
+  std::vector<dfloat> gathered(count);
+
+  xu::itch_decode_prices<uint32_t, 4>(buffer.data() + ADD_ORDER_PRICE, ADD_ORDER_SIZE, count, strided.data());
+  xu::itch_decode_prices<uint32_t, 4>(messages.data(), ADD_ORDER_PRICE, count, gathered.data());
+
+  for (size_t i = 0; i < count; i++)
+  {
+    dfloat expected = dfloat::from_scaled((int64_t)(i * 10007), -4);
+
+    assert(strided[i] == expected);
+    assert(gathered[count - 1 - i] == expected);
+  }
+}
+
+int main()
+{
+  single();
+
+  batch();
+
+  std::cout << "Completed without errors" << std::endl;
+}
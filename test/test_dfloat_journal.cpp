@@ -0,0 +1,216 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_journal -I../include -Wfatal-errors -Wall -pthread test_dfloat_journal.cpp
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "dfloat_journal.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+const std::string PATH = "/tmp/test_dfloat_journal.wal";
+
+void crc()
+{
+  assert(xu::crc32c("123456789", 9) == 0xe3069283u);
+  assert(xu::crc32c("6789", 4, xu::crc32c("12345", 5)) == 0xe3069283u);
+}
+
+/* posting i: debit and credit of the same amount */
+void check_posting(uint64_t seq, uint64_t key, const dfloat* values, size_t count)
+{
+  dfloat amount = dfloat::from_scaled((int64_t)key * 7, -2);
+
+  assert(count == 2);
+  assert(values[0] == amount);
+  assert(values[1] == -amount);
+  (void)seq;
+}
+
+void write_and_replay()
+{
+  std::remove(PATH.c_str());
+
+  {
+    xu::journal_writer journal(PATH);
+    assert(journal.is_open());
+    assert(journal.size() == 0);
+    assert(journal.sync());
+
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < 4; t++)
+    {
+      threads.emplace_back([&, t]()
+      {
+        for (uint64_t i = 0; i < 1000; i++)
+        {
+          uint64_t key = t * 1000 + i;
+          dfloat amount = dfloat::from_scaled((int64_t)key * 7, -2);
+          dfloat values[2] = {amount, -amount};
+
+          uint64_t seq = journal.append(key, values, 2);
+          assert(journal.sync(seq));
+        }
+      });
+    }
+
+    for (std::thread& th : threads)
+    {
+      th.join();
+    }
+
+    assert(journal.size() == 4000);
+    assert(journal.blocks_written() <= 4000);
+  }
+
+  {
+    xu::journal_reader reader(PATH);
+    assert(reader.is_open());
+
+    std::vector<bool> seen(4000, false);
+    uint64_t expected_seq = 0;
+
+    assert(reader.replay([&](uint64_t seq, uint64_t key, const dfloat* values, size_t count)
+    {
+      assert(seq == expected_seq++);
+      check_posting(seq, key, values, count);
+      seen[key] = true;
+    }));
+
+    assert(reader.records() == 4000);
+    for (bool b : seen)
+    {
+      assert(b);
+    }
+  }
+
+  // reopen and keep appending, with nan and an empty record
+  {
+    xu::journal_writer journal(PATH);
+    assert(journal.size() == 4000);
+
+    dfloat values[3] = {dfloat::parse("nan"), dfloat(0), dfloat::parse("1e-100")};
+    assert(journal.append(77, values, 3) == 4000);
+    assert(journal.append(78, nullptr, 0) == 4001);
+    /* synced by the destructor */
+  }
+
+  {
+    xu::journal_reader reader(PATH);
+
+    std::vector<uint64_t> keys;
+    assert(reader.replay([&](uint64_t seq, uint64_t key, const dfloat* values, size_t count)
+    {
+      if (seq == 4000)
+      {
+        assert(count == 3);
+        assert_false(dfloat::isfinite(values[0]));
+        assert(values[1] == 0);
+        assert(values[2] == dfloat::parse("1e-100"));
+      }
+      if (seq == 4001)
+      {
+        assert(count == 0);
+      }
+      keys.push_back(key);
+    }));
+
+    assert(keys.size() == 4002);
+    assert(keys[4001] == 78);
+  }
+}
+
+void torn_tail()
+{
+  size_t good_size;
+
+  {
+    xu::journal_reader reader(PATH);
+    reader.replay([](uint64_t, uint64_t, const dfloat*, size_t) {});
+    good_size = reader.valid_size();
+  }
+
+  // a partial block at the end, as after a crash mid-write
+  {
+    std::ofstream file(PATH, std::ios::binary | std::ios::app);
+    file << "DFJ1 and then nothing useful";
+  }
+
+  {
+    xu::journal_reader reader(PATH);
+    assert_false(reader.replay([](uint64_t, uint64_t, const dfloat*, size_t) {}));
+    assert(reader.valid_size() == good_size);
+    assert(reader.records() == 4002);
+  }
+
+  // reopening cuts the tail off and continues
+  {
+    xu::journal_writer journal(PATH);
+    assert(journal.size() == 4002);
+
+    dfloat one = 1;
+    uint64_t seq = journal.append(1, &one, 1);
+    assert(journal.sync(seq));
+  }
+
+  {
+    xu::journal_reader reader(PATH);
+    assert(reader.replay([](uint64_t, uint64_t, const dfloat*, size_t) {}));
+    assert(reader.records() == 4003);
+  }
+
+  // a flipped bit in the middle stops replay at that block
+  {
+    std::fstream file(PATH, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(good_size - 3);
+    file.put('\x55');
+  }
+
+  {
+    xu::journal_reader reader(PATH);
+    assert_false(reader.replay([](uint64_t, uint64_t, const dfloat*, size_t) {}));
+    assert(reader.records() < 4002);
+  }
+
+  std::remove(PATH.c_str());
+}
+
+int main()
+{
+  crc();
+
+  write_and_replay();
+
+  torn_tail();
+
+  std::cout << "Completed without errors" << std::endl;
+}
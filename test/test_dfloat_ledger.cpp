@@ -0,0 +1,216 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_ledger -I../include -Wfatal-errors -Wall -pthread test_dfloat_ledger.cpp
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include "dfloat_ledger.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+dfloat d(const char* s)
+{
+  return dfloat::parse(s);
+}
+
+void single()
+{
+  const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+  xu::ledger book(10, 3);
+
+  assert(book.num_accounts() == 10);
+  assert(book.num_shards() == 3);
+  assert(book.shard_of(0) == 0);
+  assert(book.shard_of(3) == 0);
+  assert(book.shard_of(4) == 1);
+  assert(book.shard_of(9) == 2);
+
+  {
+    uint32_t accounts[] = {0, 5, 9};
+    dfloat amounts[] = {d("100.10"), d("-60"), d("-40.1")};
+    assert(book.post(accounts, amounts, 3));
+  }
+
+  assert(book.balance(0) == d("100.1"));
+  assert(book.balance(5) == dfloat(-60));
+  assert(book.balance(9) == d("-40.1"));
+  assert(book.verify());
+
+  /* more digits than a dfloat holds, still exact */
+  {
+    uint32_t accounts[] = {1, 2, 3, 3};
+    dfloat amounts[] = {d("123456789012345678"), d("-0.000000000000000001"), d("-123456789012345677"), d("-0.999999999999999999")};
+    assert(book.post(accounts, amounts, 4));
+
+    assert(book.exact_balance(1).coef() == 123456789012345678);
+    assert(book.exact_balance(2).coef() == -1);
+    assert(book.exact_balance(2).exp() == -18);
+    assert(book.exact_balance(3).coef() == -((__int128)123456789012345677 * 1000000000000000000 + 999999999999999999));
+    assert(book.verify());
+  }
+
+  /* rejected, and nothing changes */
+  {
+    uint32_t accounts[] = {0, 5, 10};
+    dfloat amounts[] = {d("1"), d("-0.5"), d("-0.5")};
+
+    dfloat unbalanced[] = {d("1"), d("-0.5"), d("-0.4999999999999999999")};
+    dfloat nan[] = {d("1"), NaN, d("-1")};
+    uint32_t in_range[] = {0, 5, 9};
+
+    assert_false(book.post(accounts, amounts, 3));
+    assert_false(book.post(in_range, unbalanced, 3));
+    assert_false(book.post(in_range, nan, 3));
+    assert_false(book.post(in_range, amounts, 0));
+  }
+
+  assert(book.balance(0) == d("100.1"));
+  assert(book.balance(5) == dfloat(-60));
+  assert(book.posted_entries() == 2);
+  assert(book.rejected_entries() == 4);
+  assert(book.verify());
+}
+
+/* entries of 2 to 5 postings, every 10th unbalanced, some with bad accounts or NaN */
+void make_entries(size_t entries, size_t num_accounts, std::vector<size_t>& offsets,
+  std::vector<uint32_t>& accounts, std::vector<dfloat>& amounts)
+{
+  offsets.assign(1, 0);
+  accounts.clear();
+  amounts.clear();
+
+  uint64_t seed = 7;
+  auto next = [&]()
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return seed >> 20;
+  };
+
+  for (size_t i = 0; i < entries; i++)
+  {
+    size_t legs = 2 + next() % 4;
+
+    /* half of the entries stay near one account, likely within a shard */
+    uint64_t base = next() % num_accounts;
+    bool local = i % 2 == 0;
+
+    int64_t sum = 0;
+
+    for (size_t k = 0; k < legs; k++)
+    {
+      uint64_t account = local ? (base + k) % num_accounts : next() % num_accounts;
+      int64_t cents = k + 1 < legs ? (int64_t)(next() % 2000000) - 1000000 : -sum;
+
+      sum += cents;
+
+      accounts.push_back((uint32_t)account);
+      amounts.push_back(dfloat::from_scaled(cents, -2));
+    }
+
+    if (i % 10 == 3)
+    {
+      amounts.back() = amounts.back() + d("0.001");
+    }
+    if (i % 97 == 5)
+    {
+      accounts.back() = (uint32_t)num_accounts;
+    }
+    if (i % 89 == 7)
+    {
+      amounts.back() = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+    }
+    if (i % 101 == 9)
+    {
+      accounts.resize(offsets.back());
+      amounts.resize(offsets.back());
+    }
+
+    offsets.push_back(accounts.size());
+  }
+}
+
+void batches()
+{
+  const size_t num_accounts = 1000;
+  const size_t entries = 20000;
+
+  std::vector<size_t> offsets;
+  std::vector<uint32_t> accounts;
+  std::vector<dfloat> amounts;
+
+  make_entries(entries, num_accounts, offsets, accounts, amounts);
+
+  /* reference: one entry at a time */
+  xu::ledger reference(num_accounts, 1);
+  std::vector<uint8_t> expected(entries);
+
+  for (size_t i = 0; i < entries; i++)
+  {
+    expected[i] = reference.post(accounts.data() + offsets[i], amounts.data() + offsets[i], offsets[i + 1] - offsets[i]);
+  }
+
+  assert(reference.rejected_entries() > entries / 10);
+  assert(reference.verify());
+
+  for (size_t shards : {1, 2, 3, 8})
+  {
+    xu::ledger book(num_accounts, shards);
+    std::vector<uint8_t> accepted(entries, 2);
+
+    /* in uneven batches */
+    size_t posted = 0;
+    for (size_t begin = 0; begin < entries;)
+    {
+      size_t n = std::min(entries - begin, (size_t)(1 + begin % 4999));
+      posted += book.post(offsets.data() + begin, accounts.data(), amounts.data(), n, accepted.data() + begin);
+      begin += n;
+    }
+
+    assert(posted == reference.posted_entries());
+    assert(book.posted_entries() == reference.posted_entries());
+    assert(book.rejected_entries() == reference.rejected_entries());
+    assert(accepted == expected);
+
+    for (uint32_t a = 0; a < num_accounts; a++)
+    {
+      assert(book.exact_balance(a) == reference.exact_balance(a));
+    }
+
+    assert(book.verify());
+  }
+}
+
+int main()
+{
+  single();
+
+  batches();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,118 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_locale -I../include -Wfatal-errors -Wall test_dfloat_locale.cpp
+
+#include <cassert>
+#include <iostream>
+#include "dfloat_locale.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void plain()
+{
+  xu::number_format fmt;
+
+  assert(xu::parse_locale("0", fmt) == dfloat(0));
+  assert(xu::parse_locale("123.45", fmt) == dfloat::parse("123.45"));
+  assert(xu::parse_locale("-123.45", fmt) == dfloat::parse("-123.45"));
+  assert(xu::parse_locale("+0.001", fmt) == dfloat::parse("0.001"));
+  assert(xu::parse_locale("  42  ", fmt) == dfloat(42));
+  assert(xu::parse_locale("0.0", fmt) == dfloat(0));
+
+  assert_false(dfloat::isfinite(xu::parse_locale("", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("   ", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale(".5", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("5.", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("1,234", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("(1)", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("1e5", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("--1", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("1 2", fmt)));
+
+  // truncated after 19 significant digits
+  assert(xu::parse_locale("12345678901234567890123", fmt) == dfloat::parse("12345678901234567890123"));
+  assert(xu::parse_locale("0.000000000000000000001234567890123456789", fmt) == dfloat::parse("1.23456789012345678e-21"));
+}
+
+void accounting()
+{
+  xu::number_format fmt = xu::number_format::accounting();
+
+  assert(xu::parse_locale("1,234,567.89", fmt) == dfloat::parse("1234567.89"));
+  assert(xu::parse_locale("(1,234.56)", fmt) == dfloat::parse("-1234.56"));
+  assert(xu::parse_locale("$1,234.56", fmt) == dfloat::parse("1234.56"));
+  assert(xu::parse_locale("-$1,234.56", fmt) == dfloat::parse("-1234.56"));
+  assert(xu::parse_locale("$-1,234.56", fmt) == dfloat::parse("-1234.56"));
+  assert(xu::parse_locale("($ 1,234.56)", fmt) == dfloat::parse("-1234.56"));
+  assert(xu::parse_locale(" ( 12 ) ", fmt) == dfloat(-12));
+
+  assert_false(dfloat::isfinite(xu::parse_locale("(1,234.56", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("1,234.56)", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("-(1.00)", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("1,,234", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("1,234,", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale(",234", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("1.234,5", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("$$1", fmt)));
+}
+
+void european()
+{
+  xu::number_format fmt = xu::number_format::european();
+
+  assert(xu::parse_locale("1.234.567,89", fmt) == dfloat::parse("1234567.89"));
+  assert(xu::parse_locale("1.234,56 €", fmt) == dfloat::parse("1234.56"));
+  assert(xu::parse_locale("-0,5€", fmt) == dfloat::parse("-0.5"));
+
+  assert_false(dfloat::isfinite(xu::parse_locale("1,234.56", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("1,2,3", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("€ 1,5", fmt)));
+  assert_false(dfloat::isfinite(xu::parse_locale("1,5 € €", fmt)));
+
+  // grouping with spaces
+  fmt.group = ' ';
+  assert(xu::parse_locale("1 234 567,89", fmt) == dfloat::parse("1234567.89"));
+  assert(xu::parse_locale("1 234 €", fmt) == dfloat(1234));
+  assert(xu::parse_locale("1 234 ", fmt) == dfloat(1234));
+
+  // multi-byte prefix
+  fmt.currency_prefix = "EUR";
+  fmt.currency_suffix = "";
+  assert(xu::parse_locale("EUR 12,5", fmt) == dfloat::parse("12.5"));
+  assert_false(dfloat::isfinite(xu::parse_locale("EU 12,5", fmt)));
+}
+
+int main()
+{
+  plain();
+
+  accounting();
+
+  european();
+
+  std::cout << "Completed without errors" << std::endl;
+}
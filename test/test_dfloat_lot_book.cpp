@@ -0,0 +1,251 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_lot_book -I../include -Wfatal-errors -Wall -pthread test_dfloat_lot_book.cpp
+
+#include <cassert>
+#include <iostream>
+#include "dfloat_lot_book.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+using xu::lot_method;
+
+dfloat d(const char* s)
+{
+  return dfloat::parse(s);
+}
+
+void fifo_lifo()
+{
+  for (lot_method method : {lot_method::FIFO, lot_method::LIFO})
+  {
+    xu::lot_book book(2, method);
+    bool fifo = method == lot_method::FIFO;
+
+    assert(book.num_accounts() == 2);
+    assert(book.method() == method);
+
+    book.add(0, d("10.00"), d("100"));
+    book.add(0, d("12.50"), d("50"));
+    book.add(0, d("11.00"), d("30"));
+
+    assert(book.position(0) == dfloat(180));
+    assert(book.cost_basis(0) == d("1955"));
+    assert(book.open_lots(0) == 3);
+    assert(book.realized(0) == dfloat(0));
+
+    /* FIFO: 100 @ 10 and 20 @ 12.5; LIFO: 30 @ 11, 50 @ 12.5, 40 @ 10 */
+    book.add(0, d("13.00"), d("-120"));
+
+    assert(book.position(0) == dfloat(60));
+    assert(book.open_lots(0) == (fifo ? 2 : 1));
+    assert(book.realized(0) == (fifo ? d("310") : d("205")));
+    assert(book.cost_basis(0) == (fifo ? d("705") : d("600")));
+    assert(book.unrealized(0, d("13.00")) == (fifo ? d("75") : d("180")));
+
+    /* sell through flat, 40 short @ 9 remains */
+    book.add(0, d("9.00"), d("-100"));
+
+    assert(book.position(0) == dfloat(-40));
+    assert(book.open_lots(0) == 1);
+    assert(book.cost_basis(0) == d("-360"));
+    assert(book.average_cost(0) == d("9"));
+    assert(book.realized(0) == (fifo ? d("310") - d("165") : d("205") - d("60")));
+
+    /* buy back the short at a loss */
+    book.add(0, d("9.25"), d("40"));
+
+    assert(book.position(0) == dfloat(0));
+    assert(book.open_lots(0) == 0);
+    assert(book.cost_basis(0) == dfloat(0));
+    assert_false(dfloat::isfinite(book.average_cost(0)));
+
+    /* flat: realized is the net cash flow, whatever the method */
+    assert(book.realized(0) == d("-1955") + d("1560") + d("900") - d("370"));
+
+    /* other account untouched */
+    assert(book.position(1) == dfloat(0));
+    assert(book.realized(1) == dfloat(0));
+  }
+}
+
+void average()
+{
+  xu::lot_book book(1, lot_method::AVERAGE);
+
+  book.add(0, d("10"), d("1"));
+  book.add(0, d("10"), d("1"));
+  book.add(0, d("11"), d("1"));
+
+  assert(book.open_lots(0) == 1);
+  assert(book.average_cost(0) == d("10.3333333333333333"));
+
+  /* realized against the truncated average */
+  book.add(0, d("12"), d("-1"));
+  assert(book.realized(0) == d("1.6666666666666667"));
+  assert(book.position(0) == dfloat(2));
+
+  /* going flat realizes what the truncation left in the cost basis */
+  book.add(0, d("12"), d("-2"));
+  assert(book.realized(0) == dfloat(5));
+  assert(book.cost_basis(0) == dfloat(0));
+  assert(book.open_lots(0) == 0);
+
+  /* short side */
+  book.add(0, d("20"), d("-3"));
+  book.add(0, d("17"), d("1"));
+  assert(book.realized(0) == dfloat(8));
+  assert(book.average_cost(0) == dfloat(20));
+  book.add(0, d("21"), d("4"));
+  assert(book.realized(0) == dfloat(6));
+  assert(book.position(0) == dfloat(2));
+  assert(book.cost_basis(0) == dfloat(42));
+}
+
+void exactness()
+{
+  /* products and sums which a dfloat would truncate */
+  xu::lot_book book(1, lot_method::FIFO);
+
+  book.add(0, d("1.23456789012345678"), d("9876543.21"));
+  book.add(0, d("1.23456789012345679"), d("-9876543.21"));
+
+  assert(book.position(0) == dfloat(0));
+  assert(book.exact_realized(0).coef() == 987654321);
+  assert(book.exact_realized(0).exp() == -19);
+  assert(book.realized(0) == d("0.0000000000987654321"));
+}
+
+void ignored()
+{
+  const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+  xu::lot_book book(2, lot_method::FIFO);
+
+  book.add(0, NaN, d("1"));
+  book.add(0, d("1"), NaN);
+  book.add(0, d("1"), dfloat(0));
+  book.add(2, d("1"), d("1"));
+  assert(book.ignored_fills() == 4);
+  assert(book.position(0) == dfloat(0));
+
+  uint32_t accounts[] = {0, 5, 1};
+  dfloat prices[] = {d("1"), d("1"), NaN};
+  dfloat quantities[] = {d("1"), d("1"), d("1")};
+
+  book.add(accounts, prices, quantities, 3, 2);
+  assert(book.ignored_fills() == 6);
+  assert(book.position(0) == dfloat(1));
+  assert(book.position(1) == dfloat(0));
+
+  /* a position beyond the range of dfloat cannot be closed against */
+  xu::lot_book average(1, lot_method::AVERAGE);
+  const dfloat huge = d("9e100");
+
+  average.add(0, d("1"), huge);
+  average.add(0, d("1"), huge);
+  assert(not dfloat::isfinite(average.position(0)));
+  average.add(0, d("1"), -huge);
+  assert(average.ignored_fills() == 1);
+}
+
+void batches()
+{
+  const size_t num_accounts = 300;
+  const size_t count = 20000;
+
+  std::vector<uint32_t> accounts(count);
+  std::vector<dfloat> prices(count);
+  std::vector<dfloat> quantities(count);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    accounts[i] = (uint32_t)(i * 7919 % num_accounts);
+    prices[i] = dfloat::from_scaled((int64_t)(10000 + i * 104729 % 997), -2);
+    quantities[i] = dfloat::from_scaled((int64_t)(i * 31 % 41) - 20, 0);
+  }
+
+  for (lot_method method : {lot_method::FIFO, lot_method::LIFO, lot_method::AVERAGE})
+  {
+    xu::lot_book one(num_accounts, method);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      one.add(accounts[i], prices[i], quantities[i]);
+    }
+
+    for (size_t threads : {1, 4})
+    {
+      xu::lot_book many(num_accounts, method);
+      many.add(accounts.data(), prices.data(), quantities.data(), count, threads);
+
+      assert(many.ignored_fills() == one.ignored_fills());
+
+      for (uint32_t a = 0; a < num_accounts; a++)
+      {
+        assert(many.exact_realized(a) == one.exact_realized(a));
+        assert(many.position(a) == one.position(a));
+        assert(many.cost_basis(a) == one.cost_basis(a));
+        assert(many.open_lots(a) == one.open_lots(a));
+      }
+    }
+
+    /* close every position: realized is then the net cash flow */
+    std::vector<xu::dfloat_accumulator> cash(num_accounts);
+    for (size_t i = 0; i < count; i++)
+    {
+      cash[accounts[i]].subtract_product(prices[i], quantities[i]);
+    }
+
+    for (uint32_t a = 0; a < num_accounts; a++)
+    {
+      dfloat held = one.position(a);
+
+      one.add(a, dfloat(100), -held);
+      cash[a].add_product(dfloat(100), held);
+
+      assert(one.position(a) == dfloat(0));
+      assert(one.open_lots(a) == 0);
+      assert(one.exact_realized(a) == cash[a]);
+    }
+  }
+}
+
+int main()
+{
+  fifo_lifo();
+
+  average();
+
+  exactness();
+
+  ignored();
+
+  batches();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,130 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_money -I../include -Wfatal-errors -Wall test_dfloat_money.cpp
+// Fixtures are generated with: python3 gen_money_fixtures.py 500 money_fixtures.txt
+
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "dfloat_money.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void basic()
+{
+  xu::units_nanos m;
+
+  assert(xu::from_units_nanos({12, 340000000}) == dfloat::parse("12.34"));
+  assert(xu::from_units_nanos({-12, -340000000}) == dfloat::parse("-12.34"));
+  assert(xu::from_units_nanos({0, -1}) == dfloat::parse("-0.000000001"));
+  assert(xu::from_units_nanos({0, 0}) == dfloat(0));
+  assert(xu::from_units_nanos({-1-9223372036854775807ll, -999999999}) == dfloat::parse("-9223372036854775808.999999999"));
+
+  assert_false(dfloat::isfinite(xu::from_units_nanos({1, -1})));
+  assert_false(dfloat::isfinite(xu::from_units_nanos({-1, 1})));
+  assert_false(dfloat::isfinite(xu::from_units_nanos({0, 1000000000})));
+
+  assert(xu::to_units_nanos(dfloat::parse("12.34"), m) and m.units == 12 and m.nanos == 340000000);
+  assert(xu::to_units_nanos(dfloat::parse("-0.0000000019"), m) and m.units == 0 and m.nanos == -1);
+  assert(xu::to_units_nanos(dfloat::parse("1e-50"), m) and m.units == 0 and m.nanos == 0);
+  assert(xu::to_units_nanos(dfloat::parse("-9223372036854775800"), m) and m.units == -9223372036854775800ll and m.nanos == 0);
+  assert(xu::to_units_nanos(dfloat(0), m) and m.units == 0 and m.nanos == 0);
+  assert_false(xu::to_units_nanos(dfloat::parse("1e19"), m));
+  assert_false(xu::to_units_nanos(dfloat::parse("nan"), m));
+}
+
+void fixtures(const std::string& path)
+{
+  std::ifstream file(path);
+  assert(file.is_open());
+
+  std::vector<xu::units_nanos> amounts;
+  std::vector<dfloat> values;
+  std::vector<xu::units_nanos> expected_amounts;
+  std::vector<dfloat> expected_values;
+
+  std::string line;
+  while (std::getline(file, line))
+  {
+    std::istringstream ss(line);
+    std::string kind, value;
+    xu::units_nanos m;
+
+    ss >> kind;
+
+    if (kind == "M")
+    {
+      ss >> m.units >> m.nanos >> value;
+      amounts.push_back(m);
+      expected_values.push_back(dfloat::parse(value));
+    }
+    else if (kind == "D")
+    {
+      ss >> value >> m.units >> m.nanos;
+      values.push_back(dfloat::parse(value));
+      expected_amounts.push_back(m);
+    }
+  }
+
+  assert(amounts.size() > 0 and values.size() > 0);
+
+  std::vector<dfloat> decoded(amounts.size());
+  xu::from_units_nanos(amounts.data(), amounts.size(), decoded.data());
+
+  for (size_t i = 0; i < amounts.size(); i++)
+  {
+    if (dfloat::isfinite(expected_values[i]))
+    {
+      assert(decoded[i] == expected_values[i]);
+    }
+    else
+    {
+      assert_false(dfloat::isfinite(decoded[i]));
+    }
+  }
+
+  std::vector<xu::units_nanos> encoded(values.size());
+  assert(xu::to_units_nanos(values.data(), values.size(), encoded.data()));
+
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    assert(encoded[i].units == expected_amounts[i].units);
+    assert(encoded[i].nanos == expected_amounts[i].nanos);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  basic();
+
+  fixtures(argc > 1 ? argv[1] : "money_fixtures.txt");
+
+  std::cout << "Completed without errors" << std::endl;
+}
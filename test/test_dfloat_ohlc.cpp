@@ -0,0 +1,173 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_ohlc -I../include -Wfatal-errors -Wall -pthread test_dfloat_ohlc.cpp
+
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <utility>
+#include "dfloat_ohlc.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void single()
+{
+  xu::bar_builder builder(3, 60);
+  xu::ohlc_columns out;
+
+  builder.add(1, 5, dfloat(10), dfloat(1));
+  builder.add(1, 20, dfloat(12), dfloat(2));
+  builder.add(1, 30, dfloat(9), dfloat(3));
+  builder.add(1, 59, dfloat(11), dfloat::parse("0.5"));
+  builder.add(0, 61, dfloat(-5), dfloat(1));
+  builder.add(1, 65, dfloat(13), dfloat(1));    // closes the first bar of 1
+  builder.add(1, 40, dfloat(100), dfloat(1));   // late
+  builder.add(2, 70, dfloat::parse("x"), dfloat(1));
+  builder.add(7, 70, dfloat(1), dfloat(1));     // no such instrument
+
+  assert(builder.late_trades() == 1);
+
+  builder.flush(100, out);
+  assert(out.size() == 1);
+  assert(out.instrument[0] == 1 and out.start[0] == 0);
+  assert(out.open[0] == dfloat(10));
+  assert(out.high[0] == dfloat(12));
+  assert(out.low[0] == dfloat(9));
+  assert(out.close[0] == dfloat(11));
+  assert(out.volume[0] == dfloat::parse("6.5"));
+  assert(out.trades[0] == 4);
+
+  builder.flush(120, out);
+  assert(out.size() == 3);
+  assert(out.instrument[1] == 0 and out.start[1] == 60 and out.open[1] == dfloat(-5) and out.close[1] == dfloat(-5));
+  assert(out.instrument[2] == 1 and out.start[2] == 60 and out.high[2] == dfloat(13));
+
+  builder.flush_all(out);
+  assert(out.size() == 3);
+
+  assert(builder.bar_start(-1) == -60);
+  assert(builder.bar_start(0) == 0);
+
+  out.clear();
+  assert(out.size() == 0 and out.high.size() == 0);
+}
+
+void many(int64_t interval)
+{
+  const size_t num_instruments = 500;
+  const size_t count = 50000;
+
+  std::vector<uint32_t> ids(count);
+  std::vector<int64_t> times(count);
+  std::vector<dfloat> prices(count);
+  std::vector<dfloat> quantities(count);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    ids[i] = (uint32_t)(i * 7919 % num_instruments);
+    times[i] = (int64_t)(i * 3);
+    prices[i] = dfloat::from_scaled((int64_t)(i * 104729 % 20001) - 10000, -2);
+    quantities[i] = dfloat::from_scaled((int64_t)(i % 17 + 1), -1);
+  }
+
+  /* reference: map keyed by (start, instrument), dfloat comparisons */
+  struct state
+  {
+    dfloat open, high, low, close, volume;
+    uint64_t trades;
+  };
+
+  std::map<std::pair<int64_t, uint32_t>, state> expected;
+
+  xu::bar_builder probe(1, interval);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    std::pair<int64_t, uint32_t> key(probe.bar_start(times[i]), ids[i]);
+
+    auto it = expected.find(key);
+    if (it == expected.end())
+    {
+      expected[key] = {prices[i], prices[i], prices[i], prices[i], quantities[i], 1};
+    }
+    else
+    {
+      state& s = it->second;
+      s.high = prices[i] > s.high ? prices[i] : s.high;
+      s.low = prices[i] < s.low ? prices[i] : s.low;
+      s.close = prices[i];
+      s.volume += quantities[i];
+      s.trades++;
+    }
+  }
+
+  for (size_t threads : {1, 3, 8})
+  {
+    xu::bar_builder builder(num_instruments, interval);
+    xu::ohlc_columns out;
+
+    /* in several batches, flushing in between */
+    for (size_t begin = 0; begin < count; begin += 9999)
+    {
+      size_t n = std::min<size_t>(9999, count - begin);
+      builder.add(ids.data() + begin, times.data() + begin, prices.data() + begin, quantities.data() + begin, n, threads);
+      builder.flush(times[begin + n - 1], out);
+    }
+    builder.flush_all(out);
+
+    assert(builder.late_trades() == 0);
+    assert(out.size() == expected.size());
+
+    size_t row = 0;
+    for (const auto& entry : expected)
+    {
+      assert(out.start[row] == entry.first.first);
+      assert(out.instrument[row] == entry.first.second);
+      assert(out.open[row] == entry.second.open);
+      assert(out.high[row] == entry.second.high);
+      assert(out.low[row] == entry.second.low);
+      assert(out.close[row] == entry.second.close);
+      assert(out.volume[row] == entry.second.volume);
+      assert(out.trades[row] == entry.second.trades);
+      row++;
+    }
+  }
+}
+
+int main()
+{
+  single();
+
+  /* 1s, 1m and 5m bars over millisecond times */
+  many(1000);
+
+  many(60000);
+
+  many(300000);
+
+  std::cout << "Completed without errors" << std::endl;
+}
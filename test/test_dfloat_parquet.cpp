@@ -0,0 +1,272 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_parquet -I../include -Wfatal-errors -Wall test_dfloat_parquet.cpp
+
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "dfloat_parquet.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void plain()
+{
+  // INT64, DECIMAL(10, 2): 123.45, -0.01, 0
+  {
+    const unsigned char page[] = {
+      0x39, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    xu::parquet_decimal schema = {xu::parquet_type::INT64, 0, 10, 2};
+
+    dfloat out[3];
+    assert(xu::parquet_decode_plain((const char*)page, sizeof(page), schema, 3, out));
+    assert(out[0] == dfloat::parse("123.45"));
+    assert(out[1] == dfloat::parse("-0.01"));
+    assert(out[2] == dfloat(0));
+
+    assert_false(xu::parquet_decode_plain((const char*)page, sizeof(page), schema, 4, out));
+
+    std::vector<char> encoded;
+    assert(xu::parquet_encode_plain(out, 3, schema, encoded));
+    assert(encoded == std::vector<char>(page, page + sizeof(page)));
+  }
+
+  // FIXED_LEN_BYTE_ARRAY(5), DECIMAL(12, 3): -1234.567, 0.001
+  {
+    const unsigned char page[] = {
+      0xff, 0xff, 0xed, 0x29, 0x79,
+      0x00, 0x00, 0x00, 0x00, 0x01,
+    };
+    xu::parquet_decimal schema = {xu::parquet_type::FIXED_LEN_BYTE_ARRAY, 5, 12, 3};
+
+    dfloat out[2];
+    assert(xu::parquet_decode_plain((const char*)page, sizeof(page), schema, 2, out));
+    assert(out[0] == dfloat::parse("-1234.567"));
+    assert(out[1] == dfloat::parse("0.001"));
+
+    std::vector<char> encoded;
+    assert(xu::parquet_encode_plain(out, 2, schema, encoded));
+    assert(encoded == std::vector<char>(page, page + sizeof(page)));
+  }
+
+  // FIXED_LEN_BYTE_ARRAY(16), DECIMAL(38, 5): more digits than a dfloat
+  {
+    xu::parquet_decimal schema = {xu::parquet_type::FIXED_LEN_BYTE_ARRAY, 16, 38, 5};
+
+    dfloat in[2] = {dfloat::parse("-1.23456789012345678e30"), dfloat::parse("1e32")};
+    std::vector<char> encoded;
+    assert(xu::parquet_encode_plain(in, 2, schema, encoded));
+    assert(encoded.size() == 32);
+
+    dfloat out[2];
+    assert(xu::parquet_decode_plain(encoded.data(), encoded.size(), schema, 2, out));
+    assert(out[0] == in[0]);
+    assert(out[1] == in[1]);
+  }
+
+  // out of range, truncated, nan
+  {
+    xu::parquet_decimal schema = {xu::parquet_type::INT64, 0, 6, 2};
+
+    std::vector<char> encoded = {'x'};
+
+    dfloat ok[2] = {dfloat::parse("9999.999"), dfloat::parse("-9999.99")};
+    assert(xu::parquet_encode_plain(ok, 2, schema, encoded));
+    assert(encoded.size() == 17);
+
+    dfloat too_big[2] = {dfloat(1), dfloat(10000)};
+    assert_false(xu::parquet_encode_plain(too_big, 2, schema, encoded));
+    assert(encoded.size() == 17);
+
+    dfloat nan[1] = {dfloat::parse("nan")};
+    assert_false(xu::parquet_encode_plain(nan, 1, schema, encoded));
+
+    dfloat out[2];
+    assert(xu::parquet_decode_plain(encoded.data() + 1, 16, schema, 2, out));
+    assert(out[0] == dfloat::parse("9999.99"));
+    assert(out[1] == dfloat::parse("-9999.99"));
+  }
+}
+
+void dictionary()
+{
+  // dictionary page: INT64, DECIMAL(10, 2): 1.00, 2.50, -0.05
+  const unsigned char dictionary_page[] = {
+    0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xfa, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xfb, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  };
+  xu::parquet_decimal schema = {xu::parquet_type::INT64, 0, 10, 2};
+
+  dfloat dict[3];
+  assert(xu::parquet_decode_plain((const char*)dictionary_page, sizeof(dictionary_page), schema, 3, dict));
+
+  /*
+    bit width 2
+    RLE run of 3 x index 0
+    1 bit-packed group: 1 2 0 1 2 0 1 2
+    */
+  const unsigned char data_page[] = {0x02, 0x06, 0x00, 0x03, 0x49, 0x92};
+
+  dfloat out[11];
+  assert(xu::parquet_decode_dictionary((const char*)data_page, sizeof(data_page), dict, 3, 11, out));
+
+  const char* expected[11] = {"1", "1", "1", "2.5", "-0.05", "1", "2.5", "-0.05", "1", "2.5", "-0.05"};
+  for (size_t i = 0; i < 11; i++)
+  {
+    assert(out[i] == dfloat::parse(expected[i]));
+  }
+
+  // fewer values than the last group holds
+  assert(xu::parquet_decode_dictionary((const char*)data_page, sizeof(data_page), dict, 3, 5, out));
+  assert(out[4] == dfloat::parse("-0.05"));
+
+  // truncated, or more values than the runs hold
+  assert_false(xu::parquet_decode_dictionary((const char*)data_page, 5, dict, 3, 11, out));
+  assert_false(xu::parquet_decode_dictionary((const char*)data_page, sizeof(data_page), dict, 3, 12, out));
+
+  // index out of range
+  assert_false(xu::parquet_decode_dictionary((const char*)data_page, sizeof(data_page), dict, 2, 11, out));
+
+  // encoder writes the same runs
+  std::vector<char> encoded_dictionary;
+  std::vector<char> encoded_data;
+  dfloat in[3 + 8 + 20];
+  for (size_t i = 0; i < 11; i++)
+  {
+    in[i] = out[i];
+  }
+  for (size_t i = 11; i < 31; i++)
+  {
+    in[i] = dict[2];
+  }
+  assert(xu::parquet_encode_dictionary(in, 31, schema, encoded_dictionary, encoded_data));
+  assert(encoded_dictionary == std::vector<char>(dictionary_page, dictionary_page + sizeof(dictionary_page)));
+
+  /*
+    the run of 3 is too short for RLE, so 2 groups are bit-packed, the first
+    6 values of the run of 21 included, then an RLE run of the other 15
+    */
+  assert(encoded_data.size() == 1 + 1 + 2 * 2 + 1 + 1);
+  assert(encoded_data[1] == 0x05);
+  assert(encoded_data[6] == 15 << 1 and encoded_data[7] == 2);
+
+  dfloat decoded[31];
+  assert(xu::parquet_decode_dictionary(encoded_data.data(), encoded_data.size(), dict, 3, 31, decoded));
+  for (size_t i = 0; i < 31; i++)
+  {
+    assert(decoded[i] == in[i]);
+  }
+}
+
+void round_trip()
+{
+  std::mt19937_64 gen(7);
+  std::uniform_int_distribution<int64_t> dist(-999999999999ll, 999999999999ll);
+  std::uniform_int_distribution<int64_t> pick(0, 299);
+
+  const size_t count = 5000;
+
+  std::vector<dfloat> distinct(300);
+  for (dfloat& d : distinct)
+  {
+    d = dfloat::from_scaled(dist(gen), -4);
+  }
+
+  std::vector<dfloat> in(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    /* long runs mixed with random picks */
+    in[i] = (i / 100) % 2 ? distinct[0] : distinct[pick(gen)];
+  }
+
+  for (xu::parquet_decimal schema : {
+    xu::parquet_decimal{xu::parquet_type::INT64, 0, 18, 4},
+    xu::parquet_decimal{xu::parquet_type::FIXED_LEN_BYTE_ARRAY, 6, 14, 4}})
+  {
+    std::vector<char> page;
+    assert(xu::parquet_encode_plain(in.data(), count, schema, page));
+
+    std::vector<dfloat> out(count);
+    assert(xu::parquet_decode_plain(page.data(), page.size(), schema, count, out.data()));
+    assert(out == in);
+
+    std::vector<char> dictionary_page;
+    std::vector<char> data_page;
+    assert(xu::parquet_encode_dictionary(in.data(), count, schema, dictionary_page, data_page));
+    assert(data_page[0] == 9);
+
+    size_t bytes = schema.type == xu::parquet_type::INT64 ? 8 : schema.type_length;
+    size_t dictionary_size = dictionary_page.size() / bytes;
+
+    std::vector<dfloat> dict(dictionary_size);
+    assert(xu::parquet_decode_plain(dictionary_page.data(), dictionary_page.size(), schema, dictionary_size, dict.data()));
+
+    std::vector<dfloat> decoded(count);
+    assert(xu::parquet_decode_dictionary(data_page.data(), data_page.size(), dict.data(), dictionary_size, count, decoded.data()));
+    assert(decoded == in);
+  }
+}
+
+void precision()
+{
+  xu::parquet_decimal schema{xu::parquet_type::FIXED_LEN_BYTE_ARRAY, 16, 38, 18};
+
+  /* 20 digits scaled by 10^18 is 38 digits */
+  dfloat max = dfloat::parse("99999999999999999900");
+  std::vector<char> page;
+  assert(xu::parquet_encode_plain(&max, 1, schema, page));
+
+  dfloat out;
+  assert(xu::parquet_decode_plain(page.data(), page.size(), schema, 1, &out));
+  assert(out == max);
+
+  /* 39 digits would wrap while scaling up */
+  dfloat over = dfloat::parse("4e20");
+  page.clear();
+  assert_false(xu::parquet_encode_plain(&over, 1, schema, page));
+  assert(page.empty());
+
+  schema.precision = 39;
+  assert_false(xu::parquet_encode_plain(&max, 1, schema, page));
+}
+
+int main()
+{
+  plain();
+
+  dictionary();
+
+  round_trip();
+
+  precision();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,172 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_pipeline -I../include -Wfatal-errors -Wall -pthread test_dfloat_pipeline.cpp
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "dfloat_pipeline.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+std::string read_file(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+void convert()
+{
+  std::string input_path = "/tmp/test_dfloat_pipeline.in";
+  std::string output_path = "/tmp/test_dfloat_pipeline.out";
+
+  const size_t count = 20011;
+  const size_t width = 14;
+  const size_t decimals = 3;
+
+  std::string expected;
+
+  {
+    std::ofstream file(input_path, std::ios::binary);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      std::string line;
+
+      if (i % 1000 == 7)
+      {
+        line = "bad";
+      }
+      else
+      {
+        line = (i % 3 ? "-" : "") + std::to_string(i * 37) + "." + std::to_string(i % 100);
+      }
+
+      /* some CRLF, and no newline at the very end */
+      file << line << (i + 1 == count ? "" : i % 5 ? "\n" : "\r\n");
+
+      dfloat value = xu::parse_locale(line, xu::number_format()) * dfloat::parse("1.5");
+
+      char field[width + 1];
+      xu::format_fixed(&value, width, decimals, width + 1, 1, field);
+      field[width] = '\n';
+      expected.append(field, width + 1);
+    }
+  }
+
+  auto scale = [](dfloat* values, size_t n)
+  {
+    for (size_t i = 0; i < n; i++)
+    {
+      values[i] *= dfloat::parse("1.5");
+    }
+  };
+
+  struct shape
+  {
+    size_t parse, compute, format;
+    bool writer;
+    size_t batch_lines, depth, stages, threads;
+  };
+
+  const shape shapes[] = {
+    {0, 0, 0, false, 4096, 4, 1, 1},  // serial
+    {0, 0, 0, true, 100, 1, 2, 2},
+    {1, 1, 1, true, 4096, 4, 5, 5},
+    {1, 1, 1, true, 1, 1, 5, 5},
+    {2, 3, 2, true, 7, 2, 5, 9},
+    {3, 0, 0, false, 500, 3, 3, 5},  // writer forced onto its own thread
+  };
+
+  for (const shape& sh : shapes)
+  {
+    xu::pipeline_options options;
+    options.parse_threads = sh.parse;
+    options.compute_threads = sh.compute;
+    options.format_threads = sh.format;
+    options.separate_writer = sh.writer;
+    options.batch_lines = sh.batch_lines;
+    options.queue_depth = sh.depth;
+    options.width = width;
+    options.decimals = decimals;
+
+    std::remove(output_path.c_str());
+
+    xu::pipeline_stats stats = xu::run_pipeline(input_path, output_path, options, scale);
+
+    assert(stats.ok);
+    assert(stats.lines == count);
+    assert(stats.invalid == 21);
+    assert(stats.batches == (count + sh.batch_lines - 1) / sh.batch_lines);
+    assert(stats.bytes_written == expected.size());
+    assert(stats.stages == sh.stages);
+    assert(stats.threads == sh.threads);
+
+    assert(read_file(output_path) == expected);
+  }
+
+  std::remove(input_path.c_str());
+  std::remove(output_path.c_str());
+}
+
+void edge_cases()
+{
+  std::string input_path = "/tmp/test_dfloat_pipeline_empty.in";
+  std::string output_path = "/tmp/test_dfloat_pipeline_empty.out";
+
+  auto noop = [](dfloat*, size_t) {};
+
+  {
+    std::ofstream file(input_path);
+  }
+
+  xu::pipeline_stats stats = xu::run_pipeline(input_path, output_path, xu::pipeline_options(), noop);
+  assert(stats.ok);
+  assert(stats.lines == 0);
+  assert(stats.batches == 0);
+  assert(read_file(output_path).empty());
+
+  std::remove(input_path.c_str());
+
+  stats = xu::run_pipeline(input_path, output_path, xu::pipeline_options(), noop);
+  assert_false(stats.ok);
+
+  std::remove(output_path.c_str());
+}
+
+int main()
+{
+  convert();
+
+  edge_cases();
+
+  std::cout << "Completed without errors" << std::endl;
+}
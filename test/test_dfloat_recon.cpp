@@ -0,0 +1,277 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_recon -I../include -Wfatal-errors -Wall -pthread test_dfloat_recon.cpp
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <map>
+#include "dfloat_recon.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+using xu::recon_kind;
+using xu::recon_side;
+
+dfloat d(const char* s)
+{
+  return dfloat::parse(s);
+}
+
+void small()
+{
+  const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+  xu::recon_options options;
+  options.num_columns = 2;
+  options.tolerance = d("0.01");
+  options.partitions = 4;
+
+  xu::reconciler recon(options);
+
+  uint64_t left_keys[] = {1, 2, 3, 4, 5, 7, 7};
+  dfloat left_a[] = {d("10.00"), d("20"), d("30"), d("40"), NaN, d("70"), d("71")};
+  dfloat left_b[] = {d("1"), d("2"), d("3"), d("4"), d("5"), d("7"), d("7")};
+
+  uint64_t right_keys[] = {6, 5, 4, 3, 2, 1, 6};
+  dfloat right_a[] = {d("60"), NaN, d("40.011"), d("30.01"), d("20"), d("10"), d("61")};
+  dfloat right_b[] = {d("6"), d("5"), d("4"), d("3"), d("2.00000000000000001"), d("1"), d("6")};
+
+  const dfloat* left_columns[] = {left_a, left_b};
+  const dfloat* right_columns[] = {right_a, right_b};
+
+  recon.add(recon_side::LEFT, left_keys, left_columns, 7);
+  recon.add(recon_side::RIGHT, right_keys, right_columns, 7);
+
+  xu::recon_result out;
+  assert(recon.run(out));
+
+  assert(out.matched == 5);
+  assert(recon.spilled_bytes() == 0);
+
+  /* ordered by key, kind, column; NaN matches NaN for key 5 */
+  assert(out.size() == 7);
+
+  assert(out.key[0] == 2);
+  assert(out.kind[0] == recon_kind::MISMATCH);
+  assert(out.column[0] == 1);
+  assert(out.difference[0] == d("-0.00000000000000001"));
+
+  assert(out.key[1] == 3);
+  assert(out.kind[1] == recon_kind::MISMATCH);
+  assert(out.column[1] == 0);
+  assert(out.left[1] == dfloat(30));
+  assert(out.right[1] == d("30.01"));
+  assert(out.difference[1] == d("-0.01"));
+
+  assert(out.key[2] == 4);
+  assert(out.kind[2] == recon_kind::OUT_OF_TOLERANCE);
+  assert(out.difference[2] == d("-0.011"));
+
+  assert(out.key[3] == 6);
+  assert(out.kind[3] == recon_kind::MISSING_LEFT);
+  assert_false(dfloat::isfinite(out.left[3]));
+  assert(out.right[3] == dfloat(60));
+
+  assert(out.key[4] == 6);
+  assert(out.kind[4] == recon_kind::DUPLICATE);
+  assert(out.column[4] == (uint32_t)recon_side::RIGHT);
+  assert(out.right[4] == dfloat(61));
+
+  assert(out.key[5] == 7);
+  assert(out.kind[5] == recon_kind::MISSING_RIGHT);
+  assert(out.left[5] == dfloat(70));
+
+  /* the second left 7 is a duplicate, not missing again */
+  assert(out.key[6] == 7);
+  assert(out.kind[6] == recon_kind::DUPLICATE);
+  assert(out.column[6] == (uint32_t)recon_side::LEFT);
+  assert(out.left[6] == dfloat(71));
+
+  xu::recon_result again;
+  assert(recon.run(again));
+  assert(again.size() == 7);
+}
+
+void exact()
+{
+  xu::recon_options options;
+  options.tolerance = d("0.000000000000000001");
+
+  xu::reconciler recon(options);
+
+  /* a dfloat subtraction would lose the small part */
+  uint64_t keys[] = {1, 2};
+  dfloat left[] = {d("123456789012345678"), d("123456789012345678")};
+  dfloat right[] = {d("123456789012345678.5"), d("0.000000000000000001")};
+  const dfloat* left_columns[] = {left};
+  const dfloat* right_columns[] = {right};
+
+  recon.add(recon_side::LEFT, keys, left_columns, 2);
+  recon.add(recon_side::RIGHT, keys, right_columns, 2);
+
+  xu::recon_result out;
+  assert(recon.run(out));
+
+  assert(out.size() == 1);
+  assert(out.key[0] == 2);
+  assert(out.kind[0] == recon_kind::OUT_OF_TOLERANCE);
+  assert(out.difference[0] == d("123456789012345677.999999999999999999"));
+}
+
+void large()
+{
+  const size_t count = 50000;
+
+  std::vector<uint64_t> left_keys, right_keys;
+  std::vector<dfloat> left_values, right_values;
+
+  /* reference */
+  std::map<uint64_t, recon_kind> expected;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    uint64_t key = i * 2654435761u;
+    dfloat value = dfloat::from_scaled((int64_t)(i * 7919 % 1000000), -2);
+
+    if (i % 100 == 1)
+    {
+      left_keys.push_back(key);
+      left_values.push_back(value);
+      expected[key] = recon_kind::MISSING_RIGHT;
+    }
+    else if (i % 100 == 2)
+    {
+      right_keys.push_back(key);
+      right_values.push_back(value);
+      expected[key] = recon_kind::MISSING_LEFT;
+    }
+    else
+    {
+      left_keys.push_back(key);
+      left_values.push_back(value);
+      right_keys.push_back(key);
+
+      if (i % 100 == 3)
+      {
+        right_values.push_back(value + d("0.001"));
+        expected[key] = recon_kind::MISMATCH;
+      }
+      else if (i % 100 == 4)
+      {
+        right_values.push_back(value - d("0.5"));
+        expected[key] = recon_kind::OUT_OF_TOLERANCE;
+      }
+      else
+      {
+        right_values.push_back(value);
+      }
+    }
+  }
+
+  /* the right side arrives in another order */
+  for (size_t i = 0; i < right_keys.size(); i++)
+  {
+    size_t j = i * 7 % right_keys.size();
+    std::swap(right_keys[i], right_keys[j]);
+    std::swap(right_values[i], right_values[j]);
+  }
+
+  for (size_t budget : {(size_t)1 << 30, (size_t)4096})
+  {
+    for (size_t threads : {1, 4})
+    {
+      xu::recon_options options;
+      options.tolerance = d("0.01");
+      options.partitions = 16;
+      options.threads = threads;
+      options.memory_budget = budget;
+
+      xu::reconciler recon(options);
+
+      /* in chunks, so that spills happen in between */
+      for (size_t begin = 0; begin < left_keys.size(); begin += 1000)
+      {
+        size_t n = std::min((size_t)1000, left_keys.size() - begin);
+        const dfloat* columns[] = {left_values.data() + begin};
+        recon.add(recon_side::LEFT, left_keys.data() + begin, columns, n);
+      }
+      for (size_t begin = 0; begin < right_keys.size(); begin += 1000)
+      {
+        size_t n = std::min((size_t)1000, right_keys.size() - begin);
+        const dfloat* columns[] = {right_values.data() + begin};
+        recon.add(recon_side::RIGHT, right_keys.data() + begin, columns, n);
+      }
+
+      xu::recon_result out;
+      assert(recon.run(out));
+
+      assert((recon.spilled_bytes() > 0) == (budget == 4096));
+      assert(out.matched == count - count / 50);
+      assert(out.size() == expected.size());
+
+      size_t i = 0;
+      for (const auto& kv : expected)
+      {
+        assert(out.key[i] == kv.first);
+        assert(out.kind[i] == kv.second);
+        ++i;
+      }
+    }
+  }
+
+  /* a single large batch spills as it goes, leaving at most the budget buffered */
+  {
+    const dfloat* columns[] = {left_values.data()};
+
+    xu::recon_options options;
+    options.partitions = 16;
+
+    options.memory_budget = 0;
+    xu::reconciler all(options);
+    all.add(recon_side::LEFT, left_keys.data(), columns, left_keys.size());
+
+    options.memory_budget = 4096;
+    xu::reconciler recon(options);
+    recon.add(recon_side::LEFT, left_keys.data(), columns, left_keys.size());
+
+    assert(recon.spilled_bytes() > 0);
+    assert(recon.spilled_bytes() < all.spilled_bytes());
+    assert(all.spilled_bytes() - recon.spilled_bytes() <= 4096);
+  }
+}
+
+int main()
+{
+  small();
+
+  exact();
+
+  large();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,141 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_record -I../include -Wfatal-errors -Wall -pthread test_dfloat_record.cpp
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "dfloat_record.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void fields()
+{
+  using xu::field_sign;
+
+  xu::field_layout plain = {0, 8, 2, field_sign::NONE};
+  xu::field_layout leading = {0, 8, 0, field_sign::LEADING};
+  xu::field_layout trailing = {0, 8, 2, field_sign::TRAILING};
+  xu::field_layout overpunch = {0, 8, 2, field_sign::OVERPUNCH};
+
+  assert(xu::decode_field("00012345", plain) == dfloat::parse("123.45"));
+  assert(xu::decode_field("   12345", plain) == dfloat::parse("123.45"));
+  assert(xu::decode_field("12345   ", plain) == dfloat::parse("123.45"));
+  assert(xu::decode_field("00000000", plain) == dfloat(0));
+  assert(xu::decode_field("  123.45", plain) == dfloat::parse("1.2345"));
+  assert_false(dfloat::isfinite(xu::decode_field("        ", plain)));
+  assert_false(dfloat::isfinite(xu::decode_field("  -12345", plain)));
+  assert_false(dfloat::isfinite(xu::decode_field("  12 345", plain)));
+
+  assert(xu::decode_field(" -123.45", leading) == dfloat::parse("-123.45"));
+  assert(xu::decode_field("+0000042", leading) == dfloat(42));
+  assert(xu::decode_field("     042", leading) == dfloat(42));
+  assert_false(dfloat::isfinite(xu::decode_field("     42-", leading)));
+  assert_false(dfloat::isfinite(xu::decode_field("       -", leading)));
+
+  assert(xu::decode_field("  12345-", trailing) == dfloat::parse("-123.45"));
+  assert(xu::decode_field("  12345+", trailing) == dfloat::parse("123.45"));
+  assert(xu::decode_field("  12345 ", trailing) == dfloat::parse("123.45"));
+
+  assert(xu::decode_field("0001234J", overpunch) == dfloat::parse("-123.41"));
+  assert(xu::decode_field("0001234A", overpunch) == dfloat::parse("123.41"));
+  assert(xu::decode_field("0001234}", overpunch) == dfloat::parse("-123.40"));
+  assert(xu::decode_field("0001234{", overpunch) == dfloat::parse("123.40"));
+  assert(xu::decode_field("00012345", overpunch) == dfloat::parse("123.45"));
+  assert(xu::decode_field("       R", overpunch) == dfloat::parse("-0.09"));
+  assert_false(dfloat::isfinite(xu::decode_field("0001234S", overpunch)));
+}
+
+void records()
+{
+  using xu::field_sign;
+
+  /* account id, amount (leading sign, 2 implied), fee (overpunch, 3 implied), newline */
+  xu::record_layout layout;
+  layout.record_size = 27;
+  layout.fields = {
+    {8, 10, 2, field_sign::LEADING},
+    {18, 8, 3, field_sign::OVERPUNCH},
+  };
+
+  const size_t count = 10007;
+
+  std::string path = "/tmp/test_dfloat_record.dat";
+
+  {
+    std::ofstream file(path, std::ios::binary);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      char line[32];
+      std::snprintf(line, sizeof(line), "ACCT%04zu%c%09zu%07zu%c\n",
+        i % 10000, i % 2 ? '-' : ' ', i * 31, i, "{ABCDEFGHI"[i % 10]);
+      file << line;
+    }
+
+    /* partial record at the end is ignored */
+    file << "ACCT";
+  }
+
+  xu::mapped_file mapped(path);
+  assert(mapped.is_open());
+  assert(mapped.size() == count * layout.record_size + 4);
+
+  for (size_t threads : {1, 4})
+  {
+    std::vector<xu::dfloat_column> columns = xu::decode_records(mapped.data(), mapped.size(), layout, threads);
+
+    assert(columns.size() == 2);
+    assert(columns[0].size() == count);
+    assert(columns[1].size() == count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+      dfloat amount = dfloat::from_scaled((int64_t)(i * 31) * (i % 2 ? -1 : 1), -2);
+      dfloat fee = dfloat::from_scaled((int64_t)(i * 10 + i % 10), -3);
+
+      assert(columns[0][i] == amount);
+      assert(columns[1][i] == fee);
+    }
+  }
+
+  std::remove(path.c_str());
+
+  xu::mapped_file missing(path);
+  assert_false(missing.is_open());
+  assert(missing.size() == 0);
+}
+
+int main()
+{
+  fields();
+
+  records();
+
+  std::cout << "Completed without errors" << std::endl;
+}
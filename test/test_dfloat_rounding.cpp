@@ -0,0 +1,139 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_rounding -I../include -Wfatal-errors -Wall test_dfloat_rounding.cpp
+
+#include <cassert>
+#include <iostream>
+#include "dfloat_rounding.hpp"
+
+typedef xu::dfloat dfloat;
+typedef xu::rounding_mode rounding_mode;
+
+#define assert_false(expr) assert((expr)==false)
+
+void quotients()
+{
+  using xu::divide_rounded;
+
+  assert(divide_rounded(25, 10, rounding_mode::DOWN) == 2);
+  assert(divide_rounded(25, 10, rounding_mode::UP) == 3);
+  assert(divide_rounded(25, 10, rounding_mode::HALF_UP) == 3);
+  assert(divide_rounded(25, 10, rounding_mode::HALF_EVEN) == 2);
+  assert(divide_rounded(35, 10, rounding_mode::HALF_EVEN) == 4);
+  assert(divide_rounded(26, 10, rounding_mode::HALF_EVEN) == 3);
+  assert(divide_rounded(24, 10, rounding_mode::HALF_UP) == 2);
+  assert(divide_rounded(25, 10, rounding_mode::FLOOR) == 2);
+  assert(divide_rounded(25, 10, rounding_mode::CEILING) == 3);
+
+  assert(divide_rounded(-25, 10, rounding_mode::DOWN) == -2);
+  assert(divide_rounded(-25, 10, rounding_mode::UP) == -3);
+  assert(divide_rounded(-25, 10, rounding_mode::HALF_UP) == -3);
+  assert(divide_rounded(-25, 10, rounding_mode::HALF_EVEN) == -2);
+  assert(divide_rounded(-35, 10, rounding_mode::HALF_EVEN) == -4);
+  assert(divide_rounded(-25, 10, rounding_mode::FLOOR) == -3);
+  assert(divide_rounded(-25, 10, rounding_mode::CEILING) == -2);
+
+  /* exact quotients are never moved */
+  for (rounding_mode mode : {rounding_mode::DOWN, rounding_mode::UP, rounding_mode::HALF_UP,
+    rounding_mode::HALF_EVEN, rounding_mode::FLOOR, rounding_mode::CEILING})
+  {
+    assert(divide_rounded(-30, 10, mode) == -3);
+    assert(divide_rounded(0, 7, mode) == 0);
+  }
+
+  /* beyond 64 bits */
+  xu::dfloat_accumulator::wide_t big = (xu::dfloat_accumulator::wide_t)1 << 100;
+  assert(divide_rounded(big * 10 + 5, 10, rounding_mode::HALF_UP) == big + 1);
+  assert(divide_rounded(big * 10 + 5, 10, rounding_mode::HALF_EVEN) == big);
+  assert(divide_rounded(-(big * 10 + 5), 10, rounding_mode::HALF_UP) == -(big + 1));
+}
+
+void values()
+{
+  using xu::round_to;
+
+  assert(round_to(dfloat::parse("2.345"), -2, rounding_mode::HALF_UP) == dfloat::parse("2.35"));
+  assert(round_to(dfloat::parse("2.345"), -2, rounding_mode::HALF_EVEN) == dfloat::parse("2.34"));
+  assert(round_to(dfloat::parse("2.355"), -2, rounding_mode::HALF_EVEN) == dfloat::parse("2.36"));
+  assert(round_to(dfloat::parse("-2.349"), -2, rounding_mode::DOWN) == dfloat::parse("-2.34"));
+  assert(round_to(dfloat::parse("-2.341"), -2, rounding_mode::FLOOR) == dfloat::parse("-2.35"));
+  assert(round_to(dfloat::parse("2.341"), -2, rounding_mode::CEILING) == dfloat::parse("2.35"));
+  assert(round_to(dfloat::parse("2.3"), -2, rounding_mode::UP) == dfloat::parse("2.3"));
+  assert(round_to(dfloat::parse("9.995"), -2, rounding_mode::HALF_UP) == dfloat(10));
+
+  assert(round_to(dfloat(1250), 2, rounding_mode::HALF_UP) == dfloat(1300));
+  assert(round_to(dfloat(1250), 2, rounding_mode::HALF_EVEN) == dfloat(1200));
+  assert(round_to(dfloat::parse("0.001"), 5, rounding_mode::UP) == dfloat(100000));
+  assert(round_to(dfloat::parse("0.001"), 5, rounding_mode::HALF_UP) == dfloat(0));
+  assert(round_to(dfloat::parse("-0.001"), 30, rounding_mode::FLOOR) == dfloat::parse("-1e30"));
+
+  /* already multiples, however far above 10^exp */
+  assert(round_to(dfloat::parse("1e40"), -2, rounding_mode::HALF_UP) == dfloat::parse("1e40"));
+  assert(round_to(dfloat::parse("-1.23456789012345678e47"), -2, rounding_mode::HALF_UP)
+    == dfloat::parse("-1.23456789012345678e47"));
+
+  assert(round_to(dfloat(0), -2, rounding_mode::UP) == dfloat(0));
+  assert_false(dfloat::isfinite(round_to(dfloat::parse("nan"), -2, rounding_mode::HALF_UP)));
+}
+
+void sums()
+{
+  using xu::round_to;
+
+  /* 1.0049 + 0.0001 is exactly 1.005, a tie */
+  xu::dfloat_accumulator acc;
+  acc.add(dfloat::parse("1.0049"));
+  acc.add(dfloat::parse("0.0001"));
+
+  assert(round_to(acc, -2, rounding_mode::HALF_UP) == dfloat::parse("1.01"));
+  assert(round_to(acc, -2, rounding_mode::HALF_EVEN) == dfloat::parse("1.00"));
+
+  /* 36 digits: truncating to 18 first would lose the 5 */
+  xu::dfloat_accumulator wide;
+  wide.add(dfloat::parse("100000000000000000"));
+  wide.add(dfloat::parse("0.00000000000000005"));
+  wide.subtract(dfloat::parse("100000000000000000"));
+  wide.add(dfloat::parse("0.12"));
+
+  assert(round_to(wide, -2, rounding_mode::HALF_UP) == dfloat::parse("0.12"));
+  assert(round_to(wide, -17, rounding_mode::HALF_UP) == dfloat::parse("0.12000000000000005"));
+  assert(round_to(wide, -16, rounding_mode::HALF_UP) == dfloat::parse("0.1200000000000001"));
+  assert(round_to(wide, -16, rounding_mode::HALF_EVEN) == dfloat::parse("0.12"));
+
+  xu::dfloat_accumulator nan;
+  nan.add(dfloat::parse("nan"));
+  assert_false(dfloat::isfinite(round_to(nan, -2, rounding_mode::HALF_UP)));
+}
+
+int main()
+{
+  quotients();
+
+  values();
+
+  sums();
+
+  std::cout << "Completed without errors" << std::endl;
+}
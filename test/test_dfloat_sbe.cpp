@@ -0,0 +1,207 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_sbe -I../include -Wfatal-errors -Wall test_dfloat_sbe.cpp
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "dfloat_sbe.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void endian()
+{
+  char buf[8];
+
+  xu::store<xu::byte_order::LITTLE>((uint32_t)0x01020304, buf);
+  assert(buf[0] == 0x04 and buf[3] == 0x01);
+  assert((xu::load<xu::byte_order::LITTLE, uint32_t>(buf)) == 0x01020304);
+  assert((xu::load<xu::byte_order::BIG, uint32_t>(buf)) == 0x04030201);
+
+  xu::store<xu::byte_order::BIG>((int64_t)-2, buf);
+  assert((unsigned char)buf[0] == 0xff and buf[7] == (char)0xfe);
+  assert((xu::load<xu::byte_order::BIG, int64_t>(buf)) == -2);
+
+  assert(xu::byteswap((uint16_t)0x1234) == 0x3412);
+}
+
+void decimals()
+{
+  char buf[9];
+
+  // floating exponent
+  {
+    using codec = xu::sbe_decimal<>;
+
+    xu::store<xu::byte_order::LITTLE>((int64_t)12345, buf);
+    xu::store<xu::byte_order::LITTLE>((int8_t)-2, buf + 8);
+    assert(codec::decode(buf) == dfloat::parse("123.45"));
+
+    xu::store<xu::byte_order::LITTLE>(std::numeric_limits<int64_t>::min(), buf);
+    xu::store<xu::byte_order::LITTLE>((int8_t)0, buf + 8);
+    assert(codec::decode(buf) == dfloat::parse("-9223372036854775800"));
+
+    assert(codec::encode(dfloat::parse("-0.00120"), buf));
+    assert((xu::load<xu::byte_order::LITTLE, int64_t>(buf)) == -12);
+    assert((xu::load<xu::byte_order::LITTLE, int8_t>(buf + 8)) == -4);
+    assert(codec::decode(buf) == dfloat::parse("-0.0012"));
+
+    assert(codec::encode(dfloat(0), buf));
+    assert(codec::decode(buf) == dfloat(0));
+
+    for (dfloat d : {dfloat::parse("1e100"), dfloat::parse("-1e-100"), dfloat::parse("123456789012345678"), dfloat::from_scaled(1, -101)})
+    {
+      assert(codec::encode(d, buf));
+      assert(codec::decode(buf) == d);
+    }
+
+    std::memset(buf, 0x55, sizeof(buf));
+    assert_false(codec::encode(dfloat::parse("nan"), buf));
+    assert(buf[0] == 0x55);
+  }
+
+  // nullable floating exponent
+  {
+    using codec = xu::sbe_decimal_null;
+
+    assert(codec::encode(dfloat::parse("nan"), buf));
+    assert((xu::load<xu::byte_order::LITTLE, int64_t>(buf)) == std::numeric_limits<int64_t>::min());
+    assert_false(dfloat::isfinite(codec::decode(buf)));
+
+    assert(codec::encode(dfloat::parse("1.5"), buf));
+    assert(codec::decode(buf) == dfloat::parse("1.5"));
+  }
+
+  // constant exponent
+  {
+    using codec = xu::sbe_price9;
+
+    xu::store<xu::byte_order::LITTLE>((int64_t)1234500000000ll, buf);
+    assert(codec::decode(buf) == dfloat::parse("1234.5"));
+
+    assert(codec::encode(dfloat::parse("-0.1234567891"), buf));
+    assert((xu::load<xu::byte_order::LITTLE, int64_t>(buf)) == -123456789);
+
+    assert(codec::encode(dfloat::parse("9223372036.854775807"), buf));
+    assert((xu::load<xu::byte_order::LITTLE, int64_t>(buf)) == 9223372036854775800ll);
+    assert_false(codec::encode(dfloat::parse("9223372037"), buf));
+    assert_false(codec::encode(dfloat::parse("nan"), buf));
+  }
+
+  // nullable constant exponent, with the CME null value
+  {
+    using codec = xu::sbe_fixed_decimal<-9, true, std::numeric_limits<int64_t>::max()>;
+
+    xu::store<xu::byte_order::LITTLE>(std::numeric_limits<int64_t>::max(), buf);
+    assert_false(dfloat::isfinite(codec::decode(buf)));
+
+    xu::store<xu::byte_order::LITTLE>(std::numeric_limits<int64_t>::min(), buf);
+    assert(codec::decode(buf) == dfloat::parse("-9223372036.854775808"));
+
+    assert(codec::encode(dfloat::parse("nan"), buf));
+    assert((xu::load<xu::byte_order::LITTLE, int64_t>(buf)) == std::numeric_limits<int64_t>::max());
+
+    assert(codec::encode(dfloat(-7), buf));
+    assert(codec::decode(buf) == dfloat(-7));
+  }
+}
+
+void groups()
+{
+  /*
+    Entry: int32 id, PRICENULL9 price at offset 4, decimal size at offset 12,
+    plus 3 bytes added by a newer schema version (block length 24)
+    */
+  const size_t block_length = 24;
+  const size_t count = 1000;
+
+  std::vector<char> message(4 + block_length * count + 4, 0);
+
+  xu::store<xu::byte_order::LITTLE>((uint16_t)block_length, message.data());
+  xu::store<xu::byte_order::LITTLE>((uint16_t)count, message.data() + 2);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    char* entry = message.data() + 4 + i * block_length;
+
+    xu::store<xu::byte_order::LITTLE>((int32_t)i, entry);
+
+    if (i % 7 == 0)
+    {
+      xu::sbe_price_null9::encode(dfloat::parse("nan"), entry + 4);
+    }
+    else
+    {
+      xu::sbe_price_null9::encode(dfloat::from_scaled((int64_t)i * 250, -2), entry + 4);
+    }
+
+    xu::sbe_decimal<>::encode(dfloat::from_scaled((int64_t)i, -(int)(i % 5)), entry + 12);
+  }
+
+  xu::sbe_group group = xu::sbe_read_group(message.data());
+  assert(group.block_length == block_length);
+  assert(group.count == count);
+  assert(group.end() == message.data() + message.size() - 4);
+
+  std::vector<dfloat> prices(count);
+  std::vector<dfloat> sizes(count);
+
+  xu::sbe_decode_group<xu::sbe_price_null9>(group, 4, prices.data());
+  xu::sbe_decode_group<xu::sbe_decimal<>>(group, 12, sizes.data());
+
+  for (size_t i = 0; i < count; i++)
+  {
+    if (i % 7 == 0)
+    {
+      assert_false(dfloat::isfinite(prices[i]));
+    }
+    else
+    {
+      assert(prices[i] == dfloat::from_scaled((int64_t)i * 25, -1));
+    }
+
+    assert(sizes[i] == dfloat::from_scaled((int64_t)i, -(int)(i % 5)));
+  }
+
+  // uint8 numInGroup
+  char header[3] = {8, 0, 2};
+  xu::sbe_group small = xu::sbe_read_group<uint8_t>(header);
+  assert(small.block_length == 8 and small.count == 2 and small.entries == header + 3);
+}
+
+int main()
+{
+  endian();
+
+  decimals();
+
+  groups();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,125 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_seqlock -I../include -Wfatal-errors -Wall -pthread test_dfloat_seqlock.cpp
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "dfloat_seqlock.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void basic()
+{
+  static_assert(alignof(xu::seqlock_snapshot<4>) == 64, "cache line aligned");
+
+  xu::seqlock_snapshot<4> book;
+  assert(book.version() == 0);
+
+  std::array<dfloat, 4> top = book.load();
+  for (const dfloat& d : top)
+  {
+    assert(d == 0);
+  }
+
+  book.store({dfloat::parse("99.5"), dfloat::parse("99.75"), dfloat(300), dfloat(-1)});
+  assert(book.version() == 1);
+
+  dfloat out[4];
+  assert(book.try_load(out));
+  assert(out[0] == dfloat::parse("99.5"));
+  assert(out[1] == dfloat::parse("99.75"));
+  assert(out[2] == 300);
+  assert(out[3] == -1);
+
+  book.store(3, dfloat::parse("nan"));
+  assert(book.version() == 2);
+
+  top = book.load();
+  assert(top[2] == 300);
+  assert_false(dfloat::isfinite(top[3]));
+}
+
+void concurrent()
+{
+  /* bid, ask = bid + 0.01, bid size = ask size = bid * 100 */
+  xu::seqlock_snapshot<4> book;
+
+  auto make = [](int64_t i)
+  {
+    dfloat bid = dfloat::from_scaled(10000 + i, -2);
+    return std::array<dfloat, 4>{bid, bid + dfloat::parse("0.01"), bid * 100, bid * 100};
+  };
+
+  book.store(make(0));
+
+  std::atomic<bool> done(false);
+  std::atomic<size_t> inconsistent(0);
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; r++)
+  {
+    readers.emplace_back([&]()
+    {
+      while (not done.load())
+      {
+        std::array<dfloat, 4> top = book.load();
+
+        if (top[1] != top[0] + dfloat::parse("0.01") or top[2] != top[0] * 100 or top[3] != top[2])
+        {
+          inconsistent++;
+        }
+      }
+    });
+  }
+
+  for (int64_t i = 1; i <= 200000; i++)
+  {
+    book.store(make(i));
+  }
+
+  done = true;
+  for (std::thread& t : readers)
+  {
+    t.join();
+  }
+
+  assert(inconsistent == 0);
+  assert(book.version() == 200001);
+  assert(book.load()[0] == dfloat::parse("2100"));
+}
+
+int main()
+{
+  basic();
+
+  concurrent();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,180 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_shm_ring -I../include -Wfatal-errors -Wall test_dfloat_shm_ring.cpp -lrt
+
+#include <cassert>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "dfloat_shm_ring.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+const std::string NAME = "/test_dfloat_shm_ring";
+
+void single_process()
+{
+  xu::shm_ring writer(NAME, 5, 3);
+  assert(writer.is_open());
+  assert(writer.capacity() == 8);
+  assert(writer.fields() == 3);
+
+  xu::shm_ring ring(NAME);
+  assert(ring.is_open());
+  assert(ring.capacity() == 8);
+  assert(ring.fields() == 3);
+
+  xu::shm_ring_reader reader(ring);
+
+  uint64_t key;
+  dfloat values[3];
+
+  assert(reader.poll(key, values) == xu::ring_read::NOT_READY);
+
+  dfloat quote[3] = {dfloat::parse("101.25"), dfloat::parse("-0.0001"), dfloat::parse("nan")};
+  assert(writer.publish(42, quote) == 0);
+  assert(ring.head() == 1);
+
+  assert(reader.poll(key, values) == xu::ring_read::OK);
+  assert(key == 42);
+  assert(values[0] == quote[0]);
+  assert(values[1] == quote[1]);
+  assert_false(dfloat::isfinite(values[2]));
+  assert(reader.position() == 1);
+
+  assert(reader.poll(key, values) == xu::ring_read::NOT_READY);
+
+  // zero round trips too
+  quote[2] = dfloat(0);
+  writer.publish(43, quote);
+  assert(reader.poll(key, values) == xu::ring_read::OK);
+  assert(key == 43 and values[2] == dfloat(0));
+
+  // lap the reader
+  for (uint64_t i = 0; i < 20; i++)
+  {
+    quote[0] = dfloat((int64_t)i);
+    writer.publish(100 + i, quote);
+  }
+
+  assert(ring.try_read(2, key, values) == xu::ring_read::OVERWRITTEN);
+  assert(ring.try_read(ring.head() - 1, key, values) == xu::ring_read::OK);
+  assert(key == 119 and values[0] == 19);
+  assert(ring.try_read(ring.head(), key, values) == xu::ring_read::NOT_READY);
+
+  /* 22 published, 8 slots, the reader resumes 7 records behind the head */
+  assert(reader.poll(key, values) == xu::ring_read::OK);
+  assert(reader.missed() == 13);
+  assert(key == 113);
+
+  size_t rest = 0;
+  while (reader.poll(key, values) == xu::ring_read::OK)
+  {
+    rest++;
+  }
+  assert(rest == 6);
+  assert(key == 119);
+
+  // replacing the object leaves the old mapping intact
+  xu::shm_ring replaced(NAME, 2, 1);
+  assert(replaced.is_open());
+  assert(ring.try_read(ring.head() - 1, key, values) == xu::ring_read::OK);
+  assert(key == 119 and values[0] == 19);
+
+  xu::shm_ring reopened(NAME);
+  assert(reopened.capacity() == 2 and reopened.fields() == 1);
+
+  assert(xu::shm_ring::unlink(NAME));
+
+  xu::shm_ring missing(NAME);
+  assert_false(missing.is_open());
+}
+
+void two_processes()
+{
+  const uint64_t count = 100000;
+
+  xu::shm_ring writer(NAME, count, 2);
+  assert(writer.is_open());
+
+  pid_t pid = ::fork();
+  assert(pid >= 0);
+
+  if (pid == 0)
+  {
+    xu::shm_ring ring(NAME);
+    /* the parent may have published some records already */
+    xu::shm_ring_reader reader(ring, 0);
+
+    uint64_t key;
+    dfloat values[2];
+    uint64_t expected = 0;
+
+    while (expected < count)
+    {
+      if (reader.poll(key, values) != xu::ring_read::OK)
+      {
+        ::usleep(10);
+        continue;
+      }
+
+      bool ok = key == expected
+        and values[0] == dfloat::from_scaled((int64_t)key, -2)
+        and values[1] == -dfloat((int64_t)key);
+
+      if (not ok)
+      {
+        ::_exit(1);
+      }
+
+      expected++;
+    }
+
+    ::_exit(reader.missed() == 0 ? 0 : 2);
+  }
+
+  for (uint64_t i = 0; i < count; i++)
+  {
+    dfloat values[2] = {dfloat::from_scaled((int64_t)i, -2), -dfloat((int64_t)i)};
+    writer.publish(i, values);
+  }
+
+  int status;
+  ::waitpid(pid, &status, 0);
+  assert(WIFEXITED(status) and WEXITSTATUS(status) == 0);
+
+  xu::shm_ring::unlink(NAME);
+}
+
+int main()
+{
+  single_process();
+
+  two_processes();
+
+  std::cout << "Completed without errors" << std::endl;
+}
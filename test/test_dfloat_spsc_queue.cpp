@@ -0,0 +1,109 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_spsc_queue -I../include -Wfatal-errors -Wall -pthread test_dfloat_spsc_queue.cpp
+
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "dfloat.hpp"
+#include "dfloat_spsc_queue.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+void single_thread()
+{
+  xu::spsc_queue<int> queue(5);
+  assert(queue.capacity() == 8);
+
+  int x = 0;
+  assert_false(queue.try_pop(x));
+
+  for (int i = 0; i < 8; i++)
+  {
+    assert(queue.try_push(i));
+  }
+  assert_false(queue.try_push(8));
+
+  for (int i = 0; i < 3; i++)
+  {
+    assert(queue.try_pop(x));
+    assert(x == i);
+  }
+
+  /* wraps around */
+  for (int i = 8; i < 11; i++)
+  {
+    assert(queue.try_push(i));
+  }
+  assert_false(queue.try_push(11));
+
+  for (int i = 3; i < 11; i++)
+  {
+    queue.pop(x);
+    assert(x == i);
+  }
+  assert_false(queue.try_pop(x));
+}
+
+void two_threads()
+{
+  const int count = 200000;
+
+  /* small queue, so that both sides block on each other often */
+  xu::spsc_queue<dfloat> queue(4);
+
+  std::thread producer([&]()
+  {
+    for (int i = 0; i < count; i++)
+    {
+      queue.push(dfloat::from_scaled(i, -2));
+    }
+  });
+
+  dfloat value;
+  bool in_order = true;
+
+  for (int i = 0; i < count; i++)
+  {
+    queue.pop(value);
+    in_order = in_order and value == dfloat::from_scaled(i, -2);
+  }
+
+  producer.join();
+
+  assert(in_order);
+  assert_false(queue.try_pop(value));
+}
+
+int main()
+{
+  single_thread();
+
+  two_threads();
+
+  std::cout << "Completed without errors" << std::endl;
+}
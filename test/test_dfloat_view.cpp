@@ -0,0 +1,154 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_view -I../include -Wfatal-errors -Wall test_dfloat_view.cpp
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "dfloat_view.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+using xu::byte_order;
+
+void views()
+{
+  /* odd offsets, so nothing is aligned */
+  char buf[1 + 3 * 10];
+
+  dfloat a = dfloat::parse("-123.45");
+  dfloat b = dfloat::parse("0.5");
+  dfloat c = dfloat::parse("nan");
+
+  xu::dfloat_view<byte_order::BIG>::write(a, buf + 1);
+  xu::dfloat_view<byte_order::BIG>::write(b, buf + 11);
+  xu::dfloat_view<byte_order::BIG>::write(c, buf + 21);
+
+  xu::dfloat_view<byte_order::BIG> va(buf + 1);
+  xu::dfloat_view<byte_order::BIG> vb(buf + 11);
+  xu::dfloat_view<byte_order::BIG> vc(buf + 21);
+
+  // fields in place; big-endian mantissa starts with its most significant byte
+  assert(va.sign() == dfloat::Sign::NEG);
+  assert(va.mant() == 123450000000000000ull);
+  assert(va.pow() == 2);
+  assert((unsigned char)buf[2] == (123450000000000000ull >> 56));
+
+  assert(va.get() == a);
+  assert(vb.get() == b);
+  assert_false(dfloat::isfinite(vc.get()));
+
+  // arithmetic with views, dfloats and numbers
+  assert(va + vb == dfloat::parse("-122.95"));
+  assert(va - b == dfloat::parse("-123.95"));
+  assert(b * va == dfloat::parse("-61.725"));
+  assert(va / 5 == dfloat::parse("-24.69"));
+  assert(2 * vb == dfloat(1));
+  assert_false(dfloat::isfinite(vc + 1));
+
+  // comparisons
+  assert(va < vb);
+  assert(vb > va);
+  assert(va <= a and va >= a);
+  assert(a == va);
+  assert(vb == 0.5);
+  assert(1 > vb);
+  assert(va != vb);
+  assert_false(vc == vc);
+
+  // conversion
+  dfloat d = va;
+  assert(d == a);
+  d += vb;
+  assert(d == dfloat::parse("-122.95"));
+
+  // native order is the layout of dfloat itself
+  dfloat arr[2] = {a, b};
+  xu::dfloat_view<byte_order::LITTLE> native(reinterpret_cast<const char*>(&arr[1]));
+  assert(native == b);
+
+  char little[10];
+  xu::dfloat_view<byte_order::LITTLE>::write(b, little);
+  assert(std::memcmp(little, &arr[1], 10) == 0);
+
+  // zero
+  xu::dfloat_view<byte_order::BIG>::write(dfloat(0), buf);
+  assert(xu::dfloat_view<byte_order::BIG>(buf).sign() == dfloat::Sign::ZERO);
+  assert(xu::dfloat_view<byte_order::BIG>(buf) == 0);
+}
+
+void spans()
+{
+  /* packed record: uint32 id, dfloat price, dfloat size, char flag */
+  const size_t record_size = 4 + 10 + 10 + 1;
+  const size_t count = 100;
+
+  std::vector<char> records(record_size * count);
+  for (size_t i = 0; i < count; i++)
+  {
+    char* record = records.data() + i * record_size;
+    xu::store<byte_order::BIG>((uint32_t)i, record);
+    xu::dfloat_view<byte_order::BIG>::write(dfloat::from_scaled((int64_t)i * 25, -2), record + 4);
+    xu::dfloat_view<byte_order::BIG>::write(dfloat((int64_t)i), record + 14);
+    record[24] = 'x';
+  }
+
+  xu::dfloat_span_view<byte_order::BIG> prices(records.data() + 4, count, record_size);
+  xu::dfloat_span_view<byte_order::BIG> sizes(records.data() + 14, count, record_size);
+
+  assert(prices.size() == count);
+  assert(prices[4] == 1);
+
+  dfloat notional = 0;
+  size_t i = 0;
+  for (auto price : prices)
+  {
+    notional += price * sizes[i];
+    i++;
+  }
+  assert(i == count);
+
+  /* sum of i * i / 4 */
+  assert(notional == dfloat::parse("82087.5"));
+
+  std::vector<dfloat> copied(count);
+  prices.copy_to(copied.data());
+  for (size_t j = 0; j < count; j++)
+  {
+    assert(copied[j] == prices[j]);
+  }
+}
+
+int main()
+{
+  views();
+
+  spans();
+
+  std::cout << "Completed without errors" << std::endl;
+}
@@ -0,0 +1,251 @@
+/*
+ *  MIT License
+ *
+ *  Copyright (c) 2020 Kevin Xu
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+// g++ -o bin/test_dfloat_vwap -I../include -Wfatal-errors -Wall -pthread test_dfloat_vwap.cpp
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "dfloat_vwap.hpp"
+
+typedef xu::dfloat dfloat;
+
+#define assert_false(expr) assert((expr)==false)
+
+dfloat P(const char* str)
+{
+  return dfloat::parse(str);
+}
+
+void single()
+{
+  xu::vwap v;
+  assert_false(dfloat::isfinite(v.value()));
+  assert(v.trades() == 0);
+
+  v.add(P("10.5"), dfloat(100));
+  v.add(P("10.25"), dfloat(300));
+  assert(v.value() == P("10.3125"));
+  assert(v.notional() == dfloat(4125));
+  assert(v.volume() == dfloat(400));
+  assert(v.trades() == 2);
+
+  v.remove(P("10.5"), dfloat(100));
+  assert(v.value() == P("10.25"));
+
+  /* 133.95061725839506163 / 21, truncated once */
+  dfloat prices[] = {P("1.23456789012345678"), P("9.87654321098765432"), P("5.55555555555555555")};
+  dfloat quantities[] = {dfloat(3), dfloat(7), dfloat(11)};
+
+  v.reset();
+  v.add(prices, quantities, 3);
+  assert(v.value() == P("6.37860082182833626"));
+
+  dfloat notional = 0;
+  dfloat volume = 0;
+  for (size_t i = 0; i < 3; i++)
+  {
+    notional += prices[i] * quantities[i];
+    volume += quantities[i];
+  }
+  assert(notional / volume != v.value());
+
+  xu::vwap a, b;
+  a.add(prices, quantities, 1);
+  b.add(prices + 1, quantities + 1, 2);
+  a.merge(b);
+  assert(a.value() == v.value());
+  assert(a.trades() == 3);
+}
+
+void rolling()
+{
+  xu::rolling_vwap r(10);
+
+  std::vector<xu::timed_trade> trades;
+  for (int64_t t = 0; t < 200; t += 3)
+  {
+    trades.push_back({t, dfloat::from_scaled(10000 + t * 37 % 101, -2), dfloat((int)(t % 7 + 1))});
+  }
+
+  for (const xu::timed_trade& trade : trades)
+  {
+    r.add(trade.time, trade.price, trade.quantity);
+
+    /* the same as recomputing over (time - 10, time] */
+    xu::vwap fresh;
+    size_t n = 0;
+    for (const xu::timed_trade& other : trades)
+    {
+      if (other.time > trade.time - 10 and other.time <= trade.time)
+      {
+        fresh.add(other.price, other.quantity);
+        n++;
+      }
+    }
+
+    assert(r.size() == n);
+    assert(r.value() == fresh.value());
+    assert(r.window_sum().exact_notional() == fresh.exact_notional());
+  }
+
+  r.advance(1000);
+  assert(r.size() == 0);
+  assert_false(dfloat::isfinite(r.value()));
+
+  // a NaN trade spoils the window only while it is in it
+  {
+    const dfloat NaN = dfloat::from_scaled(dfloat::Sign::_NAN_, 0, 0);
+
+    xu::rolling_vwap n(10);
+    n.add(0, dfloat(100), dfloat(1));
+    n.add(3, NaN, dfloat(2));
+    n.add(6, dfloat(102), dfloat(3));
+    assert_false(dfloat::isfinite(n.value()));
+
+    /* (4, 14]: the NaN trade at 3 has left, the one at 6 is still there */
+    n.add(14, dfloat(106), dfloat(1));
+    assert(n.size() == 2);
+
+    xu::vwap fresh;
+    fresh.add(dfloat(102), dfloat(3));
+    fresh.add(dfloat(106), dfloat(1));
+    assert(n.value() == fresh.value());
+    assert(n.window_sum().exact_notional() == fresh.exact_notional());
+
+    n.add(15, dfloat(110), NaN);
+    n.add(17, dfloat(104), dfloat(2));
+    assert_false(dfloat::isfinite(n.value()));
+
+    /* (16, 26]: only the trade at 17 remains */
+    n.advance(26);
+    assert(n.size() == 1);
+    assert(n.value() == dfloat(104));
+  }
+}
+
+void buckets()
+{
+  xu::bucketed_vwap b(60, 30);
+
+  assert(b.bucket_start(30) == 30);
+  assert(b.bucket_start(89) == 30);
+  assert(b.bucket_start(90) == 90);
+  assert(b.bucket_start(29) == -30);
+  assert(b.bucket_start(-30) == -30);
+  assert(b.bucket_start(-31) == -90);
+
+  b.add(40, dfloat(10), dfloat(1));
+  b.add(100, dfloat(20), dfloat(1));
+  b.add(50, dfloat(12), dfloat(1));   // late, back into the first bucket
+  b.add(0, dfloat(5), dfloat(2));     // before all others
+  b.add(300, dfloat(7), dfloat(1));   // skips empty buckets
+
+  const std::vector<xu::vwap_bucket>& all = b.buckets();
+
+  assert(all.size() == 4);
+  assert(all[0].start == -30 and all[0].sum.value() == dfloat(5));
+  assert(all[1].start == 30 and all[1].sum.value() == dfloat(11));
+  assert(all[2].start == 90 and all[2].sum.value() == dfloat(20));
+  assert(all[3].start == 270 and all[3].sum.value() == dfloat(7));
+
+  b.clear();
+  assert(b.buckets().empty());
+}
+
+void time_weighted()
+{
+  xu::twap t;
+  assert_false(dfloat::isfinite(t.value(0)));
+
+  t.update(0, dfloat(10));
+  assert(t.value(0) == dfloat(10));
+
+  t.update(10, dfloat(20));
+  assert(t.value(10) == dfloat(10));
+  assert(t.value(40) == P("17.5"));
+
+  /* a second price at the same time replaces the first */
+  t.update(40, dfloat(30));
+  t.update(40, dfloat(50));
+  assert(t.value(50) == dfloat(24));
+
+  t.reset();
+  assert_false(dfloat::isfinite(t.value(0)));
+}
+
+void instruments()
+{
+  const size_t num_instruments = 1000;
+  const size_t count = 100000;
+
+  std::vector<uint32_t> ids(count);
+  std::vector<dfloat> prices(count);
+  std::vector<dfloat> quantities(count);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    /* a few ids out of range, which are ignored */
+    ids[i] = (uint32_t)(i * 7919 % (num_instruments + 3));
+    prices[i] = dfloat::from_scaled((int64_t)(100000 + i * 31 % 5000), -3);
+    quantities[i] = dfloat((int)(i % 13 + 1));
+  }
+
+  std::vector<xu::vwap> expected(num_instruments);
+  for (size_t i = 0; i < count; i++)
+  {
+    if (ids[i] < num_instruments)
+    {
+      expected[ids[i]].add(prices[i], quantities[i]);
+    }
+  }
+
+  for (size_t threads : {1, 4, 16})
+  {
+    std::vector<xu::vwap> books(num_instruments);
+
+    xu::vwap_update(books.data(), num_instruments, ids.data(), prices.data(), quantities.data(), count, threads);
+
+    for (size_t k = 0; k < num_instruments; k++)
+    {
+      assert(books[k].trades() == expected[k].trades());
+      assert(books[k].value() == expected[k].value());
+    }
+  }
+}
+
+int main()
+{
+  single();
+
+  rolling();
+
+  buckets();
+
+  time_weighted();
+
+  instruments();
+
+  std::cout << "Completed without errors" << std::endl;
+}